@@ -11,9 +11,11 @@
 
 #include "datastruct/data_structures.h"
 #include "db_connection.h"
+#include "db_pool.h"
 #include "db_structure.h"
 #include "db_query.h"
 #include "db_sampledata.h"
+#include "db_bulkload.h"
 #include "db_reporting.h"
 #include "db_users.h"
 #include "db_entities.h"
@@ -23,6 +25,20 @@
 #include "db_jesrcs.h"
 #include "db_standingdata.h"
 #include "db_currenttb.h"
+#include "db_consolidation.h"
+#include "db_closure.h"
+#include "db_filter.h"
+#include "db_balances.h"
+#include "db_periodbalances.h"
+#include "db_indexes.h"
+#include "db_partitions.h"
+#include "db_periodclose.h"
+#include "db_querycache.h"
+#include "db_dimcache.h"
+#include "db_ledgerstore.h"
+#include "db_posting.h"
+#include "db_sequence.h"
+#include "db_postsvc.h"
 
 #endif      /*  PG_GENERAL_LEDGER_DATABASE_H  */
 
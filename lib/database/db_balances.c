@@ -0,0 +1,92 @@
+/*!
+ * \file            db_balances.c
+ * \brief           Implementation of account balances functionality.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include "gl_general/gl_general.h"
+#include "db_internal.h"
+
+bool db_create_account_balances_table(void) {
+    gl_log_msg("Creating account_balances table...");
+    bool status = false;
+    ds_str query = ds_str_create(db_create_account_balances_table_sql());
+    if ( query ) {
+        status = db_execute_query(query);
+        ds_str_destroy(query);
+    }
+    return status;
+}
+
+bool db_drop_account_balances_table(void) {
+    gl_log_msg("Dropping account_balances table...");
+    bool status = false;
+    ds_str query = ds_str_create(db_drop_account_balances_table_sql());
+    if ( query ) {
+        status = db_execute_query(query);
+        ds_str_destroy(query);
+    }
+    return status;
+}
+
+bool db_create_account_balances_trigger(void) {
+    gl_log_msg("Creating account balances trigger...");
+    bool status = false;
+    ds_str query = ds_str_create(db_jelines_denormalized() ?
+            db_create_denormalized_account_balances_trigger_sql() :
+            db_create_account_balances_trigger_sql());
+    if ( query ) {
+        status = db_execute_query(query);
+        ds_str_destroy(query);
+    }
+    return status;
+}
+
+bool db_drop_account_balances_trigger(void) {
+    gl_log_msg("Dropping account balances trigger...");
+    bool status = false;
+    ds_str query = ds_str_create(db_drop_account_balances_trigger_sql());
+    if ( query ) {
+        status = db_execute_query(query);
+        ds_str_destroy(query);
+    }
+    return status;
+}
+
+bool db_rebuild_account_balances(void) {
+    gl_log_msg("Rebuilding account balances...");
+
+    if ( !db_begin_transaction() ) {
+        return false;
+    }
+
+    ds_str clear = ds_str_create(db_clear_account_balances_sql());
+    ds_str rebuild = ds_str_create(db_jelines_denormalized() ?
+            db_rebuild_denormalized_account_balances_sql() :
+            db_rebuild_account_balances_sql());
+    bool status = clear && rebuild &&
+                  db_execute_query(clear) && db_execute_query(rebuild) &&
+                  db_bump_ledger_version();
+
+    if ( status ) {
+        status = db_commit_transaction();
+    }
+    else {
+        db_rollback_transaction();
+    }
+
+    if ( clear ) {
+        ds_str_destroy(clear);
+    }
+    if ( rebuild ) {
+        ds_str_destroy(rebuild);
+    }
+
+    if ( !status ) {
+        gl_log_msg("Couldn't rebuild account balances.");
+    }
+
+    return status;
+}
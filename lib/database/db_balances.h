@@ -0,0 +1,51 @@
+/*!
+ * \file            db_balances.h
+ * \brief           Interface to account balances functionality.
+ * \details         The account balances table holds the current balance of
+ * each account for each entity. It is kept up to date by a trigger on the
+ * journal entry lines table, so the trial balance and check total reports
+ * read one row per account instead of summing every line. The ledger is
+ * append-only, so only inserts are tracked.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_DATABASE_DB_BALANCES_H
+#define PG_GENERAL_LEDGER_DATABASE_DB_BALANCES_H
+
+#include <stdbool.h>
+
+/*!
+ * \brief           Creates the account balances table in the database.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_create_account_balances_table(void);
+
+/*!
+ * \brief           Drops the account balances table from the database.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_drop_account_balances_table(void);
+
+/*!
+ * \brief           Creates the trigger which maintains the account balances.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_create_account_balances_trigger(void);
+
+/*!
+ * \brief           Drops the trigger which maintains the account balances.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_drop_account_balances_trigger(void);
+
+/*!
+ * \brief           Rebuilds the account balances from the JE lines.
+ * \details         The rebuild runs in a single transaction, so reports
+ * never see a partly rebuilt table.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_rebuild_account_balances(void);
+
+#endif      /*  PG_GENERAL_LEDGER_DATABASE_DB_BALANCES_H  */
@@ -0,0 +1,179 @@
+/*!
+ * \file            db_bulkload.c
+ * \brief           Implementation of database bulk load functionality.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+/*!  UNIX feature test macro  */
+#define _XOPEN_SOURCE 600
+
+#include <string.h>
+#include <time.h>
+
+#include "db_internal.h"
+#include "file_ops/file_ops.h"
+#include "gl_general/gl_general.h"
+
+/*!
+ * \brief           Checks whether a table may be bulk loaded.
+ * \param table     The table name.
+ * \returns         `true` if the table is a known ledger table, `false`
+ * otherwise.
+ */
+static bool db_is_loadable_table(const char * table);
+
+/*!
+ * \brief           Runs a query which does not return a result.
+ * \param cquery    The query to run.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_run_query(const char * cquery);
+
+/*!
+ * \brief           Verifies that no constraints are violated.
+ * \details         Each violated constraint is logged.
+ * \returns         `true` if no constraints are violated, `false` otherwise.
+ */
+static bool db_verify_constraints(void);
+
+bool db_bulk_load(const char * table, const char * filename) {
+    if ( !db_is_loadable_table(table) ) {
+        gl_log_msg("Unknown table '%s'.", table);
+        return false;
+    }
+
+    if ( strpbrk(filename, "'\\") ) {
+        gl_log_msg("Invalid filename '%s'.", filename);
+        return false;
+    }
+
+    ds_record headers = delim_file_read_headers(filename, ':');
+    if ( !headers ) {
+        gl_log_msg("Couldn't read field names from '%s'.", filename);
+        return false;
+    }
+
+    /*  JE lines are loaded into the scratch table, and copied from
+     *  there with their account numbers translated to account IDs, and
+     *  in the denormalized layout their JEs' entity and period.        */
+
+    const bool staged = !strcmp(table, "jelines");
+
+    ds_str fields = ds_record_make_delim_string(headers, ',');
+    ds_str query = ds_str_create_sprintf(db_load_data_infile_sql(),
+            filename, staged ? "jelines_copy" : table, ds_str_cstr(fields));
+    ds_str_destroy(fields);
+    ds_record_destroy(headers);
+
+    if ( staged && !db_create_jelines_stage() ) {
+        ds_str_destroy(query);
+        return false;
+    }
+
+    gl_log_msg("Bulk loading %s from '%s'...", table, filename);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    size_t rows = 0;
+    bool status = db_begin_transaction();
+    if ( status ) {
+        status = db_run_query(db_disable_constraint_checks_sql()) &&
+                 db_execute_load_query(query, &rows) &&
+                 (!staged || db_restore_jelines_stage());
+
+        /*  Always restore checks, even if the load failed.  */
+
+        status = db_run_query(db_enable_constraint_checks_sql()) && status;
+        status = status && db_verify_constraints() &&
+                 (strcmp(table, "entities") || db_fill_entity_closure()) &&
+                 (strcmp(table, "jes") || db_sync_je_sequence()) &&
+                 db_bump_ledger_version();
+
+        if ( status ) {
+            status = db_commit_transaction();
+        }
+        else {
+            gl_log_msg("Rolling back bulk load of %s.", table);
+            db_rollback_transaction();
+        }
+    }
+
+    if ( staged ) {
+        status = db_drop_jelines_stage() && status;
+    }
+    db_dimcache_free();
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed = (end.tv_sec - start.tv_sec) +
+                     (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    if ( status ) {
+        gl_log_msg("Loaded %zu rows into %s in %.2f seconds (%.0f rows/sec).",
+                   rows, table, elapsed, elapsed > 0 ? rows / elapsed : 0.0);
+    }
+
+    ds_str_destroy(query);
+    return status;
+}
+
+static bool db_is_loadable_table(const char * table) {
+    static const char * tables[] = {
+        "standing_data",
+        "users",
+        "entities",
+        "jesrcs",
+        "nomaccts",
+        "jes",
+        "jelines",
+        NULL
+    };
+
+    for ( size_t i = 0; tables[i]; ++i ) {
+        if ( !strcmp(table, tables[i]) ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool db_run_query(const char * cquery) {
+    bool status = false;
+    ds_str query = ds_str_create(cquery);
+    if ( query ) {
+        status = db_execute_query(query);
+        ds_str_destroy(query);
+    }
+    return status;
+}
+
+static bool db_verify_constraints(void) {
+    gl_log_msg("Verifying constraints...");
+    ds_str query = ds_str_create(db_constraint_violations_report_sql());
+    ds_recordset set = db_create_recordset_from_query(query);
+    ds_str_destroy(query);
+
+    if ( !set ) {
+        return false;
+    }
+
+    bool status = true;
+    ds_record record;
+    ds_recordset_seek_start(set);
+    while ( (record = ds_recordset_next_record(set)) ) {
+        int violations;
+        ds_str count = ds_record_get_field(record, 1);
+        if ( !ds_str_intval(count, 10, &violations) || violations ) {
+            gl_log_msg("Constraint %s violated by %s rows.",
+                       ds_str_cstr(ds_record_get_field(record, 0)),
+                       ds_str_cstr(count));
+            status = false;
+        }
+    }
+
+    ds_recordset_destroy(set);
+    return status;
+}
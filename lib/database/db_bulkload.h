@@ -0,0 +1,28 @@
+/*!
+ * \file            db_bulkload.h
+ * \brief           Interface to database bulk load functionality.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_DATABASE_DB_BULKLOAD_H
+#define PG_GENERAL_LEDGER_DATABASE_DB_BULKLOAD_H
+
+#include <stdbool.h>
+
+/*!
+ * \brief           Bulk loads a data file into a database table.
+ * \details         The file is streamed to the database in a single load
+ * statement, rather than as individual INSERT statements. Foreign key and
+ * unique checks are disabled while the file is loaded, and all constraints
+ * are verified afterwards. The load is rolled back if any constraint is
+ * violated.
+ * \param table     The table into which to load the data.
+ * \param filename  The filename from which to load the data. The file
+ * should be in the same format as the sample data files.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_bulk_load(const char * table, const char * filename);
+
+#endif      /*  PG_GENERAL_LEDGER_DATABASE_DB_BULKLOAD_H  */
@@ -0,0 +1,338 @@
+/*!
+ * \file            db_closure.c
+ * \brief           Implementation of entity closure functionality.
+ * \details         The table is filled a depth at a time, each pass adding
+ * the children of the rows added by the pass before, so it needs no
+ * recursive queries. In memory, entities are numbered densely in ID order,
+ * and the closure is a square bit matrix with a row for each ancestor.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "gl_general/gl_general.h"
+#include "db_internal.h"
+
+/*!  Number of bits in a bitmap word  */
+#define WORD_BITS 64
+
+/*!  Closure row, used while loading  */
+struct closure_pair {
+    int ancestor;               /*!<  Ancestor entity ID                */
+    int descendant;             /*!<  Descendant entity ID              */
+};
+
+/*!  Closure rows, used while loading  */
+struct closure_pairs {
+    struct closure_pair * pairs;    /*!<  The rows                      */
+    size_t count;               /*!<  Number of rows                    */
+    size_t capacity;            /*!<  Number allocated                  */
+};
+
+/*!  In-memory closure structure  */
+struct closure {
+    bool loaded;                /*!<  `true` if loaded                  */
+    int * ids;                  /*!<  Entity IDs, ascending             */
+    size_t num_ids;             /*!<  Number of entities                */
+    size_t words;               /*!<  Bitmap words per entity           */
+    uint64_t * bits;            /*!<  Descendant bitmaps, by ancestor   */
+};
+
+/*!  Lock for the in-memory closure  */
+static pthread_mutex_t closure_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*!  The in-memory closure  */
+static struct closure closure;
+
+/*!
+ * \brief           Runs a query which does not return a result.
+ * \param cquery    The query.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_closure_run(const char * cquery);
+
+/*!
+ * \brief           Counts the closure rows at a depth.
+ * \param depth     The depth.
+ * \param count     Modified to contain the count.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_closure_count(const size_t depth, uint64_t * count);
+
+/*!
+ * \brief           Loads the in-memory closure.
+ * \details         Must be called with the lock held.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_closure_load_locked(void);
+
+/*!
+ * \brief           Frees the in-memory closure.
+ * \details         Must be called with the lock held.
+ */
+static void db_closure_free_locked(void);
+
+/*!
+ * \brief           Finds the dense number of an entity.
+ * \details         Must be called with the lock held.
+ * \param id        The entity ID.
+ * \returns         The number, or `num_ids` if the entity is not found.
+ */
+static size_t db_closure_index(const int id);
+
+/*!
+ * \brief           Row callback which loads a closure row.
+ * \param num_fields    The number of fields in the row.
+ * \param values    The field values.
+ * \param lengths   The field value lengths.
+ * \param ctx       A pointer to the `struct closure_pairs` list.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_closure_pair_cb(const size_t num_fields,
+                               const char * const * values,
+                               const size_t * lengths, void * ctx);
+
+/*!  Comparison function for sorting entity IDs  */
+static int db_closure_compare_ids(const void * a, const void * b);
+
+bool db_create_entity_closure_table(void) {
+    gl_log_msg("Creating entity closure table...");
+    return db_closure_run(db_create_entity_closure_table_sql());
+}
+
+bool db_drop_entity_closure_table(void) {
+    gl_log_msg("Dropping entity closure table...");
+    return db_closure_run(db_drop_entity_closure_table_sql());
+}
+
+bool db_rebuild_entity_closure(void) {
+    if ( !db_begin_transaction() ) {
+        return false;
+    }
+
+    /*  Parents may have changed, so cached and consolidated results
+     *  are stale.                                                      */
+
+    bool status = db_fill_entity_closure() && db_bump_ledger_version();
+    if ( status ) {
+        status = db_commit_transaction();
+    }
+    else {
+        db_rollback_transaction();
+    }
+    return status;
+}
+
+bool db_fill_entity_closure(void) {
+    gl_log_msg("Rebuilding entity closure...");
+
+    uint64_t num_entities = 0;
+    bool status = db_closure_run(db_clear_entity_closure_sql()) &&
+                  db_closure_run(db_init_entity_closure_sql()) &&
+                  db_closure_count(0, &num_entities);
+
+    /*  No path can be longer than the number of entities, so a pass
+     *  beyond that means the parents form a cycle. A cycle usually
+     *  fails sooner, on a duplicate key.                               */
+
+    uint64_t added = num_entities;
+    size_t depth = 0;
+    while ( status && added ) {
+        if ( depth >= num_entities ) {
+            gl_log_msg("The entity hierarchy contains a cycle.");
+            status = false;
+        }
+        else {
+            char num[32];
+            snprintf(num, sizeof num, "%zu", depth);
+            ds_str query = ds_str_create_sprintf(
+                    db_extend_entity_closure_sql(), num);
+            status = query && db_execute_query(query) &&
+                     db_closure_count(++depth, &added);
+            if ( query ) {
+                ds_str_destroy(query);
+            }
+        }
+    }
+
+    if ( !status ) {
+        gl_log_msg("Couldn't rebuild entity closure.");
+    }
+
+    db_closure_free();
+    return status;
+}
+
+bool db_closure_contains(const int ancestor, const int descendant) {
+    pthread_mutex_lock(&closure_lock);
+
+    bool found = false;
+    if ( closure.loaded || db_closure_load_locked() ) {
+        const size_t a = db_closure_index(ancestor);
+        const size_t d = db_closure_index(descendant);
+        if ( a < closure.num_ids && d < closure.num_ids ) {
+            const uint64_t word = closure.bits[a * closure.words +
+                                               d / WORD_BITS];
+            found = (word >> (d % WORD_BITS)) & 1;
+        }
+    }
+
+    pthread_mutex_unlock(&closure_lock);
+    return found;
+}
+
+void db_closure_free(void) {
+    pthread_mutex_lock(&closure_lock);
+    db_closure_free_locked();
+    pthread_mutex_unlock(&closure_lock);
+}
+
+static bool db_closure_run(const char * cquery) {
+    bool status = false;
+    ds_str query = ds_str_create(cquery);
+    if ( query ) {
+        status = db_execute_query(query);
+        ds_str_destroy(query);
+    }
+    return status;
+}
+
+static bool db_closure_count(const size_t depth, uint64_t * count) {
+    char num[32];
+    snprintf(num, sizeof num, "%zu", depth);
+    ds_str query = ds_str_create_sprintf(db_count_entity_closure_depth_sql(),
+                                         num);
+    bool status = query && db_query_integer(query, count);
+    if ( query ) {
+        ds_str_destroy(query);
+    }
+    return status;
+}
+
+static bool db_closure_load_locked(void) {
+    db_closure_free_locked();
+
+    struct closure_pairs list = {NULL, 0, 0};
+    ds_str query = ds_str_create(db_entity_closure_sql());
+    bool status = query &&
+                  db_query_foreach(query, NULL, db_closure_pair_cb, &list);
+    if ( query ) {
+        ds_str_destroy(query);
+    }
+
+    /*  Every entity is its own descendant, so the ancestors are all
+     *  the entities.                                                   */
+
+    if ( status ) {
+        closure.ids = malloc((list.count + 1) * sizeof *closure.ids);
+        if ( !closure.ids ) {
+            status = false;
+        }
+    }
+
+    if ( status ) {
+        for ( size_t p = 0; p < list.count; ++p ) {
+            closure.ids[p] = list.pairs[p].ancestor;
+        }
+        qsort(closure.ids, list.count, sizeof *closure.ids,
+              db_closure_compare_ids);
+
+        size_t num_ids = 0;
+        for ( size_t p = 0; p < list.count; ++p ) {
+            if ( !num_ids || closure.ids[num_ids - 1] != closure.ids[p] ) {
+                closure.ids[num_ids++] = closure.ids[p];
+            }
+        }
+        closure.num_ids = num_ids;
+        closure.words = (num_ids + WORD_BITS - 1) / WORD_BITS;
+        closure.bits = calloc(num_ids * closure.words + 1,
+                              sizeof *closure.bits);
+        if ( !closure.bits ) {
+            status = false;
+        }
+    }
+
+    for ( size_t p = 0; status && p < list.count; ++p ) {
+        const size_t a = db_closure_index(list.pairs[p].ancestor);
+        const size_t d = db_closure_index(list.pairs[p].descendant);
+        if ( d < closure.num_ids ) {
+            closure.bits[a * closure.words + d / WORD_BITS] |=
+                (uint64_t) 1 << (d % WORD_BITS);
+        }
+    }
+
+    free(list.pairs);
+
+    if ( status ) {
+        closure.loaded = true;
+    }
+    else {
+        gl_log_msg("Couldn't load the entity closure.");
+        db_closure_free_locked();
+    }
+    return status;
+}
+
+static void db_closure_free_locked(void) {
+    free(closure.ids);
+    free(closure.bits);
+    memset(&closure, 0, sizeof closure);
+}
+
+static size_t db_closure_index(const int id) {
+    size_t low = 0;
+    size_t high = closure.num_ids;
+
+    while ( low < high ) {
+        size_t mid = low + (high - low) / 2;
+        if ( closure.ids[mid] < id ) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+
+    return low < closure.num_ids && closure.ids[low] == id ? low
+                                                           : closure.num_ids;
+}
+
+static bool db_closure_pair_cb(const size_t num_fields,
+                               const char * const * values,
+                               const size_t * lengths, void * ctx) {
+    (void)lengths;
+
+    struct closure_pairs * list = ctx;
+    if ( num_fields < 2 || !values[0] || !values[1] ) {
+        return true;
+    }
+
+    if ( list->count == list->capacity ) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 64;
+        struct closure_pair * pairs =
+            realloc(list->pairs, capacity * sizeof *pairs);
+        if ( !pairs ) {
+            gl_log_msg("Couldn't allocate memory for entity closure.");
+            return false;
+        }
+        list->pairs = pairs;
+        list->capacity = capacity;
+    }
+
+    list->pairs[list->count].ancestor = atoi(values[0]);
+    list->pairs[list->count].descendant = atoi(values[1]);
+    ++list->count;
+    return true;
+}
+
+static int db_closure_compare_ids(const void * a, const void * b) {
+    const int ia = *(const int *) a;
+    const int ib = *(const int *) b;
+    return (ia > ib) - (ia < ib);
+}
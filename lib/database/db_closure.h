@@ -0,0 +1,50 @@
+/*!
+ * \file            db_closure.h
+ * \brief           Interface to entity closure functionality.
+ * \details         The `entity_closure` table holds a row for every entity
+ * and every entity above it in the hierarchy, including itself at depth
+ * zero, so the entities under a given entity are found with one indexed
+ * lookup rather than by walking the `parent` column. The library rebuilds
+ * it whenever it loads entities. The client also holds the closure in
+ * memory as a bitmap for each entity, with one bit for each entity under
+ * it, which is loaded the first time it is used.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_DATABASE_DB_CLOSURE_H
+#define PG_GENERAL_LEDGER_DATABASE_DB_CLOSURE_H
+
+#include <stdbool.h>
+
+/*!
+ * \brief           Creates the entity closure table in the database.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_create_entity_closure_table(void);
+
+/*!
+ * \brief           Drops the entity closure table from the database.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_drop_entity_closure_table(void);
+
+/*!
+ * \brief           Rebuilds the entity closure table from the entities.
+ * \details         This is only needed after entities are changed outside
+ * the library. An entity which is its own parent is at the top of a
+ * hierarchy. A cycle of entities fails the rebuild. The ledger version
+ * is incremented, so cached results for the old hierarchy are discarded.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_rebuild_entity_closure(void);
+
+/*!
+ * \brief           Frees the in-memory entity closure.
+ * \details         The closure is loaded again if it is used afterwards. It
+ * is safe to call this function if the closure is not loaded.
+ */
+void db_closure_free(void);
+
+#endif      /*  PG_GENERAL_LEDGER_DATABASE_DB_CLOSURE_H  */
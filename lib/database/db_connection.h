@@ -15,6 +15,8 @@
 
 /*!
  * \brief           Connects to a database.
+ * \details         Opens a pool of connections of the size given to
+ * `db_set_pool_size()`, and checks out a connection to the calling thread.
  * \param host      The hostname.
  * \param database  The database name.
  * \param username  The username with which to connect.
@@ -27,6 +29,10 @@ bool db_connect(const char * host, const char * database,
 
 /*!
  * \brief           Disconnects from a database.
+ * \details         Closes every connection in the pool. A new pool may be
+ * opened afterwards with `db_connect()`. Connections checked out by other
+ * threads are waited for until they are checked in, and no more may be
+ * checked out meanwhile.
  */
 void db_close(void);
 
@@ -0,0 +1,1008 @@
+/*!
+ * \file            db_consolidation.c
+ * \brief           Implementation of consolidation over the entity hierarchy.
+ * \details         The entities are held as an array of tree nodes, each
+ * with dense arrays of its own and consolidated balances indexed by
+ * account, with accounts in account number order. The tree is rebuilt
+ * whenever the entities, their parents or the accounts change, or the
+ * database is recreated, and otherwise only the entities whose version
+ * has moved are read again. When the query cache has a directory, the tree
+ * and both sets of balances are written to a file in it after they change,
+ * and a later process starts from that file rather than reading every
+ * entity.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "gl_general/gl_general.h"
+#include "db_internal.h"
+
+/*!  Index used for a missing node  */
+#define NO_NODE SIZE_MAX
+
+/*!  Format version of the consolidation file  */
+#define CONS_FILE_FORMAT 1
+
+/*!  Name of the consolidation file in the query cache directory  */
+static const char cons_file_name[] = "consolidation.cs";
+
+/*!  Magic number at the start of the consolidation file  */
+static const char cons_file_magic[4] = {'G', 'L', 'C', 'S'};
+
+/*!  Entity tree node  */
+struct cons_node {
+    int id;                     /*!<  Entity ID                         */
+    int parent_id;              /*!<  Parent entity ID                  */
+    size_t parent;              /*!<  Parent node, or `NO_NODE`         */
+    size_t first_child;         /*!<  First entry in the child list     */
+    size_t num_children;        /*!<  Number of children                */
+    size_t depth;               /*!<  Number of ancestors               */
+    uint64_t version;           /*!<  Version of the own balances       */
+    bool stale;                 /*!<  `true` if own balances are old    */
+    bool dirty;                 /*!<  `true` if consolidated balances
+                                      need summing                      */
+    int64_t * own;              /*!<  Own balances, by account          */
+    int64_t * total;            /*!<  Consolidated balances, by account */
+    unsigned char * own_used;   /*!<  Nonzero for accounts with an own
+                                      balance                           */
+    unsigned char * total_used; /*!<  Nonzero for accounts with an own
+                                      balance here or below             */
+};
+
+/*!  Nominal account  */
+struct cons_account {
+    int id;                     /*!<  Account ID                        */
+    ds_str num;                 /*!<  Account number                    */
+    ds_str description;         /*!<  Account description               */
+};
+
+/*!  Account ID index entry  */
+struct cons_account_id {
+    int id;                     /*!<  Account ID                        */
+    size_t index;               /*!<  Index in account number order     */
+};
+
+/*!  Entity row, used while loading  */
+struct cons_entity {
+    int id;                     /*!<  Entity ID                         */
+    int parent;                 /*!<  Parent entity ID                  */
+    uint64_t version;           /*!<  Entity version                    */
+};
+
+/*!  Entity list, used while loading  */
+struct cons_entity_list {
+    struct cons_entity * entities;  /*!<  The entities                  */
+    size_t count;               /*!<  Number of entities                */
+    size_t capacity;            /*!<  Number allocated                  */
+};
+
+/*!  Account list  */
+struct cons_account_list {
+    struct cons_account * accounts; /*!<  The accounts, by number       */
+    struct cons_account_id * ids;   /*!<  The accounts, by ID           */
+    size_t count;               /*!<  Number of accounts                */
+    size_t capacity;            /*!<  Number allocated                  */
+};
+
+/*!  List of nodes on which to run parallel tasks  */
+struct cons_tasks {
+    size_t * nodes;             /*!<  The node indices                  */
+    size_t count;               /*!<  Number of nodes                   */
+};
+
+/*!  Consolidation state structure  */
+struct consolidation {
+    bool loaded;                /*!<  `true` if the tree is built       */
+    ds_str epoch;               /*!<  Epoch of the database             */
+    struct cons_node * nodes;   /*!<  Nodes, in entity ID order         */
+    size_t num_nodes;           /*!<  Number of nodes                   */
+    size_t * children;          /*!<  Child lists of all the nodes      */
+    size_t max_depth;           /*!<  Greatest node depth               */
+    struct cons_account_list accounts;  /*!<  The accounts              */
+};
+
+/*!  Lock for the consolidation state  */
+static pthread_mutex_t cons_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*!  The consolidation state  */
+static struct consolidation cons;
+
+/*!
+ * \brief           Brings the consolidated balances up to date.
+ * \details         Must be called with the lock held.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_cons_update(void);
+
+/*!
+ * \brief           Loads the entity tree and balances from the
+ * consolidation file.
+ * \details         Must be called with the lock held, when the tree is not
+ * built. The tree is left unbuilt if there is no file or it cannot be
+ * used, and otherwise no node is stale, so only the entities which have
+ * changed since the file was written are read again.
+ */
+static void db_cons_load_file(void);
+
+/*!
+ * \brief           Writes the entity tree and balances to the consolidation
+ * file.
+ * \details         Must be called with the lock held, when the tree is up
+ * to date. Nothing is written if the query cache has no directory.
+ */
+static void db_cons_save_file(void);
+
+/*!
+ * \brief           Returns the name of the consolidation file.
+ * \returns         The name, or `NULL` if the query cache has no directory.
+ */
+static ds_str db_cons_filename(void);
+
+/*!
+ * \brief           Builds the index of an account list by account ID.
+ * \param accounts  The list.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_cons_index_accounts(struct cons_account_list * accounts);
+
+/*!
+ * \brief           Builds the entity tree.
+ * \details         Every node is marked stale. Must be called with the
+ * lock held, after the accounts are set.
+ * \param list      The entities, in ID order.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_cons_build_tree(const struct cons_entity_list * list);
+
+/*!
+ * \brief           Checks whether the tree matches the entities and
+ * accounts.
+ * \param list      The entities, in ID order.
+ * \param accounts  The accounts.
+ * \returns         `true` if the tree matches, `false` otherwise.
+ */
+static bool db_cons_same_structure(const struct cons_entity_list * list,
+                                   const struct cons_account_list * accounts);
+
+/*!
+ * \brief           Frees the entity tree and accounts.
+ * \details         Must be called with the lock held.
+ */
+static void db_cons_free_locked(void);
+
+/*!
+ * \brief           Frees an account list.
+ * \param accounts  The list.
+ */
+static void db_cons_free_accounts(struct cons_account_list * accounts);
+
+/*!
+ * \brief           Reads the own balances of one node.
+ * \details         For use with `db_run_parallel()`.
+ * \param index     The index in the task list.
+ * \param ctx       A pointer to the `struct cons_tasks` list.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_cons_read_task(const size_t index, void * ctx);
+
+/*!
+ * \brief           Sums the consolidated balances of one node.
+ * \details         For use with `db_run_parallel()`. The node's children
+ * must already be summed.
+ * \param index     The index in the task list.
+ * \param ctx       A pointer to the `struct cons_tasks` list.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_cons_sum_task(const size_t index, void * ctx);
+
+/*!
+ * \brief           Row callback which loads an entity.
+ * \param num_fields    The number of fields in the row.
+ * \param values    The field values.
+ * \param lengths   The field value lengths.
+ * \param ctx       A pointer to the `struct cons_entity_list` list.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_cons_entity_cb(const size_t num_fields,
+                              const char * const * values,
+                              const size_t * lengths, void * ctx);
+
+/*!
+ * \brief           Row callback which loads an account.
+ * \param num_fields    The number of fields in the row.
+ * \param values    The field values.
+ * \param lengths   The field value lengths.
+ * \param ctx       A pointer to the `struct cons_account_list` list.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_cons_account_cb(const size_t num_fields,
+                               const char * const * values,
+                               const size_t * lengths, void * ctx);
+
+/*!
+ * \brief           Row callback which loads an account balance.
+ * \param num_fields    The number of fields in the row.
+ * \param values    The field values.
+ * \param lengths   The field value lengths.
+ * \param ctx       A pointer to the `struct cons_node` node.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_cons_balance_cb(const size_t num_fields,
+                               const char * const * values,
+                               const size_t * lengths, void * ctx);
+
+/*!
+ * \brief           Row callback which reads the database epoch.
+ * \param num_fields    The number of fields in the row.
+ * \param values    The field values.
+ * \param lengths   The field value lengths.
+ * \param ctx       A pointer to a `ds_str` in which to store the epoch.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_cons_epoch_cb(const size_t num_fields,
+                             const char * const * values,
+                             const size_t * lengths, void * ctx);
+
+/*!
+ * \brief           Runs a query with a row callback.
+ * \param cquery    The query.
+ * \param row_cb    The row callback.
+ * \param ctx       The context pointer passed to the callback.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_cons_query(const char * cquery, db_row_callback row_cb,
+                          void * ctx);
+
+/*!
+ * \brief           Adds the rows for one node to a report record set.
+ * \param set       The record set.
+ * \param node      The node.
+ * \param with_entity   `true` to include the entity ID column.
+ */
+static void db_cons_add_rows(ds_recordset set, const struct cons_node * node,
+                             const bool with_entity);
+
+/*!  Comparison function for sorting account IDs  */
+static int db_cons_compare_account_ids(const void * a, const void * b);
+
+ds_str db_consolidated_trial_balance_report(ds_str entity) {
+    static const char * all_names[] = {
+        "Entity", "A/C No.", "Description", "Balance"
+    };
+    static const char * entity_names[] = {
+        "A/C No.", "Description", "Balance"
+    };
+
+    gl_log_msg("Creating 'consolidated trial balance' report...");
+
+    int id = 0;
+    if ( entity && !ds_str_intval(entity, 10, &id) ) {
+        gl_log_msg("Invalid entity number: %s", ds_str_cstr(entity));
+        return NULL;
+    }
+
+    pthread_mutex_lock(&cons_lock);
+
+    ds_recordset set = NULL;
+    if ( db_cons_update() ) {
+        if ( !db_recordset_header_cb(entity ? 3 : 4,
+                                     entity ? entity_names : all_names,
+                                     &set) ) {
+            gl_log_msg("Couldn't create record set.");
+        }
+    }
+
+    bool found = !entity;
+    for ( size_t n = 0; set && n < cons.num_nodes; ++n ) {
+        const struct cons_node * node = &cons.nodes[n];
+        if ( entity && node->id == id ) {
+            db_cons_add_rows(set, node, false);
+            found = true;
+        }
+        else if ( !entity && node->parent == NO_NODE ) {
+            db_cons_add_rows(set, node, true);
+        }
+    }
+
+    pthread_mutex_unlock(&cons_lock);
+
+    if ( set && !found ) {
+        gl_log_msg("Unknown entity %d.", id);
+        ds_recordset_destroy(set);
+        set = NULL;
+    }
+
+    ds_str report = NULL;
+    if ( set ) {
+        report = ds_recordset_get_text_report(set);
+        ds_recordset_destroy(set);
+    }
+    return report;
+}
+
+void db_consolidation_free(void) {
+    pthread_mutex_lock(&cons_lock);
+    db_cons_free_locked();
+    pthread_mutex_unlock(&cons_lock);
+}
+
+static bool db_cons_update(void) {
+    if ( !cons.loaded ) {
+        db_cons_load_file();
+    }
+
+    ds_str epoch = NULL;
+    struct cons_entity_list list = {NULL, 0, 0};
+    struct cons_account_list accounts = {NULL, NULL, 0, 0};
+
+    bool status = db_cons_query(db_ledger_version_sql(),
+                                db_cons_epoch_cb, &epoch) &&
+                  db_cons_query(db_consolidation_entities_sql(),
+                                db_cons_entity_cb, &list) &&
+                  db_cons_query(db_consolidation_accounts_sql(),
+                                db_cons_account_cb, &accounts);
+
+    if ( status && !epoch ) {
+        gl_log_msg("Couldn't read the ledger version.");
+        status = false;
+    }
+
+    if ( status ) {
+        status = db_cons_index_accounts(&accounts);
+    }
+
+    /*  The accounts are replaced every time, so that descriptions are
+     *  current, but the balances are only kept if the accounts and the
+     *  tree are as they were.                                          */
+
+    if ( status ) {
+        const bool same = cons.loaded &&
+                          !ds_str_compare(epoch, cons.epoch) &&
+                          db_cons_same_structure(&list, &accounts);
+
+        if ( !same ) {
+            db_cons_free_locked();
+        }
+        else {
+            db_cons_free_accounts(&cons.accounts);
+            ds_str_destroy(cons.epoch);
+        }
+
+        cons.accounts = accounts;
+        cons.epoch = epoch;
+        accounts.accounts = NULL;
+        accounts.ids = NULL;
+        accounts.count = 0;
+        epoch = NULL;
+
+        if ( !same ) {
+            status = db_cons_build_tree(&list);
+        }
+        else {
+            for ( size_t n = 0; n < cons.num_nodes; ++n ) {
+                if ( cons.nodes[n].version != list.entities[n].version ) {
+                    cons.nodes[n].stale = true;
+                }
+            }
+        }
+    }
+
+    /*  Read the stale entities' own balances, and mark them and every
+     *  ancestor as needing to be summed.                               */
+
+    struct cons_tasks tasks = {NULL, 0};
+    if ( status ) {
+        tasks.nodes = malloc((cons.num_nodes + 1) * sizeof *tasks.nodes);
+        if ( !tasks.nodes ) {
+            gl_log_msg("Couldn't allocate memory for consolidation.");
+            status = false;
+        }
+    }
+
+    size_t num_read = 0;
+    size_t num_summed = 0;
+
+    if ( status ) {
+        for ( size_t n = 0; n < cons.num_nodes; ++n ) {
+            if ( cons.nodes[n].stale ) {
+                tasks.nodes[tasks.count++] = n;
+                for ( size_t p = n; p != NO_NODE && !cons.nodes[p].dirty;
+                      p = cons.nodes[p].parent ) {
+                    cons.nodes[p].dirty = true;
+                }
+            }
+        }
+
+        num_read = tasks.count;
+        if ( tasks.count ) {
+            status = db_run_parallel(tasks.count, db_cons_read_task, &tasks);
+        }
+    }
+
+    /*  Sum a level at a time from the bottom, since each node needs the
+     *  totals of the level below.                                      */
+
+    for ( size_t d = cons.max_depth + 1; status && d-- > 0; ) {
+        tasks.count = 0;
+        for ( size_t n = 0; n < cons.num_nodes; ++n ) {
+            if ( cons.nodes[n].dirty && cons.nodes[n].depth == d ) {
+                tasks.nodes[tasks.count++] = n;
+            }
+        }
+
+        num_summed += tasks.count;
+        if ( tasks.count ) {
+            status = db_run_parallel(tasks.count, db_cons_sum_task, &tasks);
+        }
+    }
+
+    if ( status ) {
+        for ( size_t n = 0; n < cons.num_nodes; ++n ) {
+            cons.nodes[n].version = list.entities[n].version;
+        }
+        gl_log_msg("Consolidated %zu entities, reading %zu and summing %zu.",
+                   cons.num_nodes, num_read, num_summed);
+        if ( num_read || num_summed ) {
+            db_cons_save_file();
+        }
+    }
+    else {
+        gl_log_msg("Couldn't consolidate entities.");
+        db_cons_free_locked();
+    }
+
+    free(tasks.nodes);
+    free(list.entities);
+    db_cons_free_accounts(&accounts);
+    if ( epoch ) {
+        ds_str_destroy(epoch);
+    }
+
+    return status;
+}
+
+static void db_cons_load_file(void) {
+    ds_str filename = db_cons_filename();
+    FILE * fp = filename ? fopen(ds_str_cstr(filename), "rb") : NULL;
+    if ( filename ) {
+        ds_str_destroy(filename);
+    }
+    if ( !fp ) {
+        return;
+    }
+
+    size_t size = 0;
+    unsigned char * buffer = db_querycache_read_buffer(fp, &size);
+    fclose(fp);
+
+    struct db_querycache_reader reader = {buffer, buffer ? buffer + size :
+                                                           NULL};
+    struct cons_entity_list list = {NULL, 0, 0};
+    struct cons_account_list accounts = {NULL, NULL, 0, 0};
+    ds_str epoch = NULL;
+    uint32_t format = 0, num_accounts = 0, num_nodes = 0;
+
+    /*  Counts are checked against the bytes left before allocating, so a
+     *  damaged file cannot ask for more memory than its own size.      */
+
+    bool status = buffer && size >= sizeof cons_file_magic &&
+                  !memcmp(buffer, cons_file_magic, sizeof cons_file_magic);
+    if ( status ) {
+        reader.pos += sizeof cons_file_magic;
+        status = db_querycache_get_u32(&reader, &format) &&
+                 format == CONS_FILE_FORMAT &&
+                 (epoch = db_querycache_get_str(&reader)) &&
+                 db_querycache_get_u32(&reader, &num_accounts) &&
+                 num_accounts <= (size_t) (reader.end - reader.pos) &&
+                 (accounts.accounts = calloc(num_accounts + 1,
+                                             sizeof *accounts.accounts));
+    }
+
+    for ( uint32_t a = 0; status && a < num_accounts; ++a ) {
+        uint32_t id = 0;
+        ds_str num = NULL;
+        ds_str description = NULL;
+        status = db_querycache_get_u32(&reader, &id) &&
+                 (num = db_querycache_get_str(&reader)) &&
+                 (description = db_querycache_get_str(&reader));
+        if ( status ) {
+            struct cons_account * account =
+                &accounts.accounts[accounts.count++];
+            account->id = (int) id;
+            account->num = num;
+            account->description = description;
+        }
+        else if ( num ) {
+            ds_str_destroy(num);
+        }
+    }
+
+    status = status && db_querycache_get_u32(&reader, &num_nodes) &&
+             num_nodes <= (size_t) (reader.end - reader.pos) &&
+             (list.entities = malloc((num_nodes + 1) *
+                                     sizeof *list.entities));
+
+    for ( uint32_t n = 0; status && n < num_nodes; ++n ) {
+        uint32_t id = 0, parent = 0;
+        uint64_t version = 0;
+        status = db_querycache_get_u32(&reader, &id) &&
+                 db_querycache_get_u32(&reader, &parent) &&
+                 db_querycache_get_u64(&reader, &version);
+        if ( status ) {
+            list.entities[list.count].id = (int) id;
+            list.entities[list.count].parent = (int) parent;
+            list.entities[list.count++].version = version;
+        }
+    }
+
+    if ( status ) {
+        status = db_cons_index_accounts(&accounts);
+    }
+
+    if ( status ) {
+        cons.accounts = accounts;
+        cons.epoch = epoch;
+        memset(&accounts, 0, sizeof accounts);
+        epoch = NULL;
+        status = db_cons_build_tree(&list);
+    }
+
+    /*  Each node's balances are stored for the accounts used at or
+     *  below it.                                                       */
+
+    for ( size_t n = 0; status && n < cons.num_nodes; ++n ) {
+        struct cons_node * node = &cons.nodes[n];
+        uint32_t num_used = 0;
+        status = db_querycache_get_u32(&reader, &num_used);
+
+        for ( uint32_t u = 0; status && u < num_used; ++u ) {
+            uint32_t index = 0, own_used = 0;
+            uint64_t own = 0, total = 0;
+            status = db_querycache_get_u32(&reader, &index) &&
+                     db_querycache_get_u32(&reader, &own_used) &&
+                     db_querycache_get_u64(&reader, &own) &&
+                     db_querycache_get_u64(&reader, &total) &&
+                     index < cons.accounts.count;
+            if ( status ) {
+                node->own[index] = (int64_t) own;
+                node->total[index] = (int64_t) total;
+                node->own_used[index] = own_used ? 1 : 0;
+                node->total_used[index] = 1;
+            }
+        }
+
+        node->version = list.entities[n].version;
+        node->stale = false;
+    }
+
+    if ( !status ) {
+        db_cons_free_locked();
+    }
+
+    free(buffer);
+    free(list.entities);
+    db_cons_free_accounts(&accounts);
+    if ( epoch ) {
+        ds_str_destroy(epoch);
+    }
+}
+
+static void db_cons_save_file(void) {
+    ds_str filename = db_cons_filename();
+    ds_str tempname = NULL;
+    FILE * fp = filename ? db_querycache_open_temp(filename, &tempname)
+                         : NULL;
+    if ( !fp ) {
+        if ( filename ) {
+            ds_str_destroy(filename);
+        }
+        return;
+    }
+
+    bool status =
+        fwrite(cons_file_magic, sizeof cons_file_magic, 1, fp) == 1 &&
+        db_querycache_put_u32(fp, CONS_FILE_FORMAT) &&
+        db_querycache_put_str(fp, cons.epoch) &&
+        db_querycache_put_u32(fp, (uint32_t) cons.accounts.count);
+
+    for ( size_t a = 0; status && a < cons.accounts.count; ++a ) {
+        const struct cons_account * account = &cons.accounts.accounts[a];
+        status = db_querycache_put_u32(fp, (uint32_t) account->id) &&
+                 db_querycache_put_str(fp, account->num) &&
+                 db_querycache_put_str(fp, account->description);
+    }
+
+    status = status && db_querycache_put_u32(fp, (uint32_t) cons.num_nodes);
+
+    for ( size_t n = 0; status && n < cons.num_nodes; ++n ) {
+        const struct cons_node * node = &cons.nodes[n];
+        status = db_querycache_put_u32(fp, (uint32_t) node->id) &&
+                 db_querycache_put_u32(fp, (uint32_t) node->parent_id) &&
+                 db_querycache_put_u64(fp, node->version);
+    }
+
+    for ( size_t n = 0; status && n < cons.num_nodes; ++n ) {
+        const struct cons_node * node = &cons.nodes[n];
+        uint32_t num_used = 0;
+        for ( size_t a = 0; a < cons.accounts.count; ++a ) {
+            num_used += node->total_used[a] ? 1 : 0;
+        }
+
+        status = db_querycache_put_u32(fp, num_used);
+        for ( size_t a = 0; status && a < cons.accounts.count; ++a ) {
+            if ( node->total_used[a] ) {
+                status = db_querycache_put_u32(fp, (uint32_t) a) &&
+                         db_querycache_put_u32(fp, node->own_used[a]) &&
+                         db_querycache_put_u64(fp, (uint64_t) node->own[a]) &&
+                         db_querycache_put_u64(fp,
+                                               (uint64_t) node->total[a]);
+            }
+        }
+    }
+
+    if ( !db_querycache_close_temp(fp, tempname, filename, status) ) {
+        gl_log_msg("Couldn't write consolidation file %s.",
+                   ds_str_cstr(filename));
+    }
+    ds_str_destroy(filename);
+}
+
+static ds_str db_cons_filename(void) {
+    char * dir = db_querycache_dir();
+    ds_str filename = dir ? ds_str_create_sprintf("%s/%s", dir,
+                                                  cons_file_name) : NULL;
+    free(dir);
+    return filename;
+}
+
+static bool db_cons_index_accounts(struct cons_account_list * accounts) {
+    accounts->ids = malloc((accounts->count + 1) * sizeof *accounts->ids);
+    if ( !accounts->ids ) {
+        gl_log_msg("Couldn't allocate memory for accounts.");
+        return false;
+    }
+
+    for ( size_t a = 0; a < accounts->count; ++a ) {
+        accounts->ids[a].id = accounts->accounts[a].id;
+        accounts->ids[a].index = a;
+    }
+    qsort(accounts->ids, accounts->count, sizeof *accounts->ids,
+          db_cons_compare_account_ids);
+    return true;
+}
+
+static bool db_cons_build_tree(const struct cons_entity_list * list) {
+    const size_t num_nodes = list->count;
+    const size_t num_accounts = cons.accounts.count;
+
+    cons.nodes = calloc(num_nodes + 1, sizeof *cons.nodes);
+    cons.children = malloc((num_nodes + 1) * sizeof *cons.children);
+    if ( !cons.nodes || !cons.children ) {
+        gl_log_msg("Couldn't allocate memory for entity tree.");
+        return false;
+    }
+    cons.num_nodes = num_nodes;
+    cons.loaded = true;
+
+    /*  Entities are in ID order, so parents are found by binary search.
+     *  An entity which is its own parent, or whose parent is missing,
+     *  is at the top of a tree.                                        */
+
+    for ( size_t n = 0; n < num_nodes; ++n ) {
+        struct cons_node * node = &cons.nodes[n];
+        node->id = list->entities[n].id;
+        node->parent_id = list->entities[n].parent;
+        node->parent = NO_NODE;
+        node->stale = true;
+
+        const int parent = list->entities[n].parent;
+        size_t low = 0;
+        size_t high = num_nodes;
+        while ( low < high ) {
+            size_t mid = low + (high - low) / 2;
+            if ( list->entities[mid].id < parent ) {
+                low = mid + 1;
+            }
+            else {
+                high = mid;
+            }
+        }
+        if ( low < num_nodes && list->entities[low].id == parent &&
+             low != n ) {
+            node->parent = low;
+        }
+
+        node->own = calloc(num_accounts + 1, sizeof *node->own);
+        node->total = calloc(num_accounts + 1, sizeof *node->total);
+        node->own_used = calloc(num_accounts + 1, 1);
+        node->total_used = calloc(num_accounts + 1, 1);
+        if ( !node->own || !node->total ||
+             !node->own_used || !node->total_used ) {
+            gl_log_msg("Couldn't allocate memory for entity balances.");
+            return false;
+        }
+    }
+
+    cons.max_depth = 0;
+    for ( size_t n = 0; n < num_nodes; ++n ) {
+        size_t depth = 0;
+        for ( size_t p = cons.nodes[n].parent; p != NO_NODE;
+              p = cons.nodes[p].parent ) {
+            if ( ++depth > num_nodes ) {
+                gl_log_msg("Entity %d is its own ancestor.",
+                           cons.nodes[n].id);
+                return false;
+            }
+        }
+        cons.nodes[n].depth = depth;
+        if ( depth > cons.max_depth ) {
+            cons.max_depth = depth;
+        }
+    }
+
+    /*  Lay out each node's children contiguously, in ID order.  */
+
+    for ( size_t n = 0; n < num_nodes; ++n ) {
+        if ( cons.nodes[n].parent != NO_NODE ) {
+            ++cons.nodes[cons.nodes[n].parent].num_children;
+        }
+    }
+
+    size_t next = 0;
+    for ( size_t n = 0; n < num_nodes; ++n ) {
+        cons.nodes[n].first_child = next;
+        next += cons.nodes[n].num_children;
+        cons.nodes[n].num_children = 0;
+    }
+
+    for ( size_t n = 0; n < num_nodes; ++n ) {
+        const size_t p = cons.nodes[n].parent;
+        if ( p != NO_NODE ) {
+            struct cons_node * parent = &cons.nodes[p];
+            cons.children[parent->first_child + parent->num_children++] = n;
+        }
+    }
+
+    return true;
+}
+
+static bool db_cons_same_structure(const struct cons_entity_list * list,
+                                   const struct cons_account_list * accounts) {
+    if ( list->count != cons.num_nodes ||
+         accounts->count != cons.accounts.count ) {
+        return false;
+    }
+
+    for ( size_t n = 0; n < list->count; ++n ) {
+        if ( list->entities[n].id != cons.nodes[n].id ||
+             list->entities[n].parent != cons.nodes[n].parent_id ) {
+            return false;
+        }
+    }
+
+    for ( size_t a = 0; a < accounts->count; ++a ) {
+        if ( accounts->accounts[a].id != cons.accounts.accounts[a].id ||
+             ds_str_compare(accounts->accounts[a].num,
+                            cons.accounts.accounts[a].num) ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void db_cons_free_locked(void) {
+    for ( size_t n = 0; cons.nodes && n < cons.num_nodes; ++n ) {
+        free(cons.nodes[n].own);
+        free(cons.nodes[n].total);
+        free(cons.nodes[n].own_used);
+        free(cons.nodes[n].total_used);
+    }
+    free(cons.nodes);
+    free(cons.children);
+    db_cons_free_accounts(&cons.accounts);
+    if ( cons.epoch ) {
+        ds_str_destroy(cons.epoch);
+    }
+    memset(&cons, 0, sizeof cons);
+}
+
+static void db_cons_free_accounts(struct cons_account_list * accounts) {
+    for ( size_t a = 0; accounts->accounts && a < accounts->count; ++a ) {
+        ds_str_destroy(accounts->accounts[a].num);
+        ds_str_destroy(accounts->accounts[a].description);
+    }
+    free(accounts->accounts);
+    free(accounts->ids);
+    memset(accounts, 0, sizeof *accounts);
+}
+
+static bool db_cons_read_task(const size_t index, void * ctx) {
+    struct cons_tasks * tasks = ctx;
+    struct cons_node * node = &cons.nodes[tasks->nodes[index]];
+    const size_t num_accounts = cons.accounts.count;
+
+    memset(node->own, 0, num_accounts * sizeof *node->own);
+    memset(node->own_used, 0, num_accounts);
+
+    char id[32];
+    snprintf(id, sizeof id, "%d", node->id);
+    ds_str query = ds_str_create_sprintf(db_entity_account_balances_sql(),
+                                         id);
+    bool status = query &&
+                  db_query_foreach(query, NULL, db_cons_balance_cb, node);
+    if ( query ) {
+        ds_str_destroy(query);
+    }
+
+    if ( status ) {
+        node->stale = false;
+    }
+    else {
+        gl_log_msg("Couldn't read balances for entity %d.", node->id);
+    }
+    return status;
+}
+
+static bool db_cons_sum_task(const size_t index, void * ctx) {
+    struct cons_tasks * tasks = ctx;
+    struct cons_node * node = &cons.nodes[tasks->nodes[index]];
+    const size_t num_accounts = cons.accounts.count;
+
+    memcpy(node->total, node->own, num_accounts * sizeof *node->total);
+    memcpy(node->total_used, node->own_used, num_accounts);
+
+    for ( size_t c = 0; c < node->num_children; ++c ) {
+        const struct cons_node * child =
+            &cons.nodes[cons.children[node->first_child + c]];
+        for ( size_t a = 0; a < num_accounts; ++a ) {
+            node->total[a] += child->total[a];
+            node->total_used[a] |= child->total_used[a];
+        }
+    }
+
+    node->dirty = false;
+    return true;
+}
+
+static bool db_cons_entity_cb(const size_t num_fields,
+                              const char * const * values,
+                              const size_t * lengths, void * ctx) {
+    (void)lengths;
+
+    struct cons_entity_list * list = ctx;
+    if ( num_fields < 3 || !values[0] || !values[1] ) {
+        return true;
+    }
+
+    if ( list->count == list->capacity ) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 16;
+        struct cons_entity * entities =
+            realloc(list->entities, capacity * sizeof *entities);
+        if ( !entities ) {
+            gl_log_msg("Couldn't allocate memory for entity list.");
+            return false;
+        }
+        list->entities = entities;
+        list->capacity = capacity;
+    }
+
+    struct cons_entity * entity = &list->entities[list->count++];
+    entity->id = atoi(values[0]);
+    entity->parent = atoi(values[1]);
+    entity->version = values[2] ? strtoull(values[2], NULL, 10) : 0;
+    return true;
+}
+
+static bool db_cons_account_cb(const size_t num_fields,
+                               const char * const * values,
+                               const size_t * lengths, void * ctx) {
+    (void)lengths;
+
+    struct cons_account_list * list = ctx;
+    if ( num_fields < 3 || !values[0] || !values[1] ) {
+        return true;
+    }
+
+    if ( list->count == list->capacity ) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 64;
+        struct cons_account * accounts =
+            realloc(list->accounts, capacity * sizeof *accounts);
+        if ( !accounts ) {
+            gl_log_msg("Couldn't allocate memory for account list.");
+            return false;
+        }
+        list->accounts = accounts;
+        list->capacity = capacity;
+    }
+
+    struct cons_account * account = &list->accounts[list->count++];
+    account->id = atoi(values[0]);
+    account->num = ds_str_create(values[1]);
+    account->description = ds_str_create(values[2] ? values[2] : "");
+    return true;
+}
+
+static bool db_cons_balance_cb(const size_t num_fields,
+                               const char * const * values,
+                               const size_t * lengths, void * ctx) {
+    struct cons_node * node = ctx;
+    if ( num_fields < 2 || !values[0] || !values[1] ) {
+        return true;
+    }
+
+    struct cons_account_id key = {atoi(values[0]), 0};
+    struct cons_account_id * found = bsearch(&key, cons.accounts.ids,
+                                             cons.accounts.count,
+                                             sizeof *cons.accounts.ids,
+                                             db_cons_compare_account_ids);
+    int64_t cents;
+    if ( !found || !db_parse_cents(values[1], lengths[1], &cents) ) {
+        gl_log_msg("Bad balance for entity %d, account %s.",
+                   node->id, values[0]);
+        return false;
+    }
+
+    node->own[found->index] += cents;
+    node->own_used[found->index] = 1;
+    return true;
+}
+
+static bool db_cons_epoch_cb(const size_t num_fields,
+                             const char * const * values,
+                             const size_t * lengths, void * ctx) {
+    (void)lengths;
+
+    ds_str * epoch = ctx;
+    if ( num_fields >= 1 && values[0] && !*epoch ) {
+        *epoch = ds_str_create(values[0]);
+    }
+    return true;
+}
+
+static bool db_cons_query(const char * cquery, db_row_callback row_cb,
+                          void * ctx) {
+    ds_str query = ds_str_create(cquery);
+    bool status = query && db_query_foreach(query, NULL, row_cb, ctx);
+    if ( query ) {
+        ds_str_destroy(query);
+    }
+    return status;
+}
+
+static void db_cons_add_rows(ds_recordset set, const struct cons_node * node,
+                             const bool with_entity) {
+    for ( size_t a = 0; a < cons.accounts.count; ++a ) {
+        if ( !node->total_used[a] ) {
+            continue;
+        }
+
+        const struct cons_account * account = &cons.accounts.accounts[a];
+        ds_record record = ds_record_create(with_entity ? 4 : 3);
+        size_t field = 0;
+
+        if ( with_entity ) {
+            ds_record_set_field(record, field++,
+                                ds_str_create_sprintf("%d", node->id));
+        }
+        ds_record_set_field(record, field++, ds_str_dup(account->num));
+        ds_record_set_field(record, field++,
+                            ds_str_dup(account->description));
+        ds_record_set_field(record, field++,
+                            db_format_cents(node->total[a]));
+        ds_recordset_add_record(set, record);
+    }
+}
+
+static int db_cons_compare_account_ids(const void * a, const void * b) {
+    const struct cons_account_id * ia = a;
+    const struct cons_account_id * ib = b;
+    return (ia->id > ib->id) - (ia->id < ib->id);
+}
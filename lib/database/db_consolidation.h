@@ -0,0 +1,39 @@
+/*!
+ * \file            db_consolidation.h
+ * \brief           Interface to consolidation over the entity hierarchy.
+ * \details         Each entity's `parent` column places it in a tree, with
+ * top-level entities being their own parents. The consolidated balances
+ * of an entity are its own account balances plus the consolidated
+ * balances of its children. The own balances of the entities are read
+ * concurrently on pooled connections, and are then summed up the tree a
+ * level at a time, with the entities on each level summed concurrently.
+ * Both sets of balances are kept between reports, together with the
+ * ledger version at which each entity last changed, so that when an
+ * entity changes only its own balances are read again, and only it and
+ * its ancestors are summed again. When the query cache has a directory,
+ * they are also kept in a file there, so later processes reuse them.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_DATABASE_DB_CONSOLIDATION_H
+#define PG_GENERAL_LEDGER_DATABASE_DB_CONSOLIDATION_H
+
+#include "datastruct/data_structures.h"
+
+/*!
+ * \brief           Creates a consolidated trial balance report.
+ * \param entity    The entity to consolidate with the entities below it,
+ * or `NULL` for every top-level entity.
+ * \returns         A ds_str containing the report, or `NULL` on failure.
+ */
+ds_str db_consolidated_trial_balance_report(ds_str entity);
+
+/*!
+ * \brief           Frees the consolidated balances kept between reports.
+ * \details         It is safe to call this function if there are none.
+ */
+void db_consolidation_free(void);
+
+#endif      /*  PG_GENERAL_LEDGER_DATABASE_DB_CONSOLIDATION_H  */
@@ -9,6 +9,13 @@
 #include "gl_general/gl_general.h"
 #include "db_internal.h"
 
+/*!
+ * \brief           Returns the query for the current trial balance report.
+ * \param entity    The entity, or `NULL` for all entities.
+ * \returns         The query.
+ */
+static ds_str db_current_trial_balance_query(ds_str entity);
+
 bool db_create_current_trial_balance_view(void) {
     gl_log_msg("Creating current trial balance view...");
     bool status = false;
@@ -33,17 +40,34 @@ bool db_drop_current_trial_balance_view(void) {
 
 ds_str db_current_trial_balance_report(ds_str entity) {
     gl_log_msg("Creating 'current trial balance' report...");
-    ds_str query;
-    if ( entity ) {
-        const char * cquery = db_current_trial_balance_entity_report_sql();
-        query = ds_str_create_sprintf(cquery, ds_str_cstr(entity));
+    if ( db_ledgerstore_ready() ) {
+        return db_ledgerstore_current_trial_balance_report(entity, NULL);
     }
-    else {
-        const char * cquery = db_current_trial_balance_report_sql();
-        query = ds_str_create(cquery);
+
+    ds_str query = db_current_trial_balance_query(entity);
+    ds_str report = db_create_report_from_query(query);
+    ds_str_destroy(query);
+    return report;
+}
+
+ds_str db_current_trial_balance_report_with_name(ds_str entity,
+                                                 ds_str * entity_name) {
+    if ( !entity ) {
+        *entity_name = ds_str_create("All entities");
+        return db_current_trial_balance_report(entity);
     }
+
+    gl_log_msg("Creating 'current trial balance' report...");
+    if ( db_ledgerstore_ready() ) {
+        *entity_name = db_ledgerstore_entity_name(entity);
+        return db_ledgerstore_current_trial_balance_report(entity, NULL);
+    }
+
+    ds_str query = db_current_trial_balance_query(entity);
     ds_str report = db_create_report_from_query(query);
     ds_str_destroy(query);
+
+    *entity_name = db_get_entity_name_from_id(entity);
     return report;
 }
 
@@ -71,6 +95,10 @@ bool db_drop_check_total_view(void) {
 
 ds_str db_check_total_report(ds_str entity) {
     gl_log_msg("Creating 'check total' report...");
+    if ( db_ledgerstore_ready() ) {
+        return db_ledgerstore_check_total_report(entity);
+    }
+
     ds_str query;
     if ( entity ) {
         const char * cquery = db_check_total_entity_report_sql();
@@ -85,3 +113,15 @@ ds_str db_check_total_report(ds_str entity) {
     return report;
 }
 
+static ds_str db_current_trial_balance_query(ds_str entity) {
+    ds_str query;
+    if ( entity ) {
+        const char * cquery = db_current_trial_balance_entity_report_sql();
+        query = ds_str_create_sprintf(cquery, ds_str_cstr(entity));
+    }
+    else {
+        const char * cquery = db_current_trial_balance_report_sql();
+        query = ds_str_create(cquery);
+    }
+    return query;
+}
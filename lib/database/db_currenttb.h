@@ -30,6 +30,19 @@ bool db_drop_current_trial_balance_view(void);
  */
 ds_str db_current_trial_balance_report(ds_str entity);
 
+/*!
+ * \brief               Runs the current trial balance report and gets the
+ * entity name for its header.
+ * \details             The entity name is looked up in the dimension
+ * cache, so only the report queries the database.
+ * \param entity        The entity, or `NULL` for all entities.
+ * \param entity_name   A pointer to a string in which to store the entity
+ * name. The caller is responsible for `free()`ing.
+ * \returns             The report.
+ */
+ds_str db_current_trial_balance_report_with_name(ds_str entity,
+                                                 ds_str * entity_name);
+
 /*!
  * \brief           Creates the check total view in the database.
  * \returns         `true` on success, `false` on failure.
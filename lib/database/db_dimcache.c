@@ -0,0 +1,202 @@
+/*!
+ * \file            db_dimcache.c
+ * \brief           Implementation of the dimension cache.
+ * \details         Each dimension is a hash map from its key to a single
+ * value, and all four are fetched together, concurrently where the
+ * database component allows.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "gl_general/gl_general.h"
+#include "db_internal.h"
+
+/*!  Dimensions held in the cache  */
+enum dimension {
+    DIM_ENTITIES,               /*!<  Entity names, by ID               */
+    DIM_ACCOUNTS,               /*!<  Account IDs, by number            */
+    DIM_SOURCES,                /*!<  JE source descriptions, by name   */
+    DIM_USERS,                  /*!<  User names, by ID                 */
+    DIM_COUNT                   /*!<  Number of dimensions              */
+};
+
+/*!  Number of hash buckets for each dimension  */
+static const size_t dimension_sizes[DIM_COUNT] = {61, 1021, 61, 61};
+
+/*!  Lock for the cache state  */
+static pthread_mutex_t dimcache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*!  Flag indicating whether the cache is loaded  */
+static bool dimcache_loaded = false;
+
+/*!  The dimensions  */
+static ds_map dimensions[DIM_COUNT];
+
+/*!
+ * \brief           Loads the cache.
+ * \details         Must be called with the cache lock held.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_dimcache_load_locked(void);
+
+/*!
+ * \brief           Frees the cache.
+ * \details         Must be called with the cache lock held.
+ */
+static void db_dimcache_free_locked(void);
+
+/*!
+ * \brief           Looks up a key in a dimension.
+ * \details         Must be called with the cache lock held. The cache is
+ * loaded if it is not already.
+ * \param dim       The dimension.
+ * \param key       The key.
+ * \returns         The value, which is only valid while the lock is held,
+ * or `NULL` if the key is not found or the cache could not be loaded.
+ */
+static const char * db_dimcache_find_locked(const enum dimension dim,
+                                            const char * key);
+
+/*!
+ * \brief           Checks whether a key is in a dimension.
+ * \param dim       The dimension.
+ * \param key       The key.
+ * \returns         `true` if the key is found, `false` otherwise.
+ */
+static bool db_dimcache_contains(const enum dimension dim, const char * key);
+
+bool db_dimcache_load(void) {
+    pthread_mutex_lock(&dimcache_lock);
+    const bool status = db_dimcache_load_locked();
+    pthread_mutex_unlock(&dimcache_lock);
+    return status;
+}
+
+void db_dimcache_free(void) {
+    pthread_mutex_lock(&dimcache_lock);
+    db_dimcache_free_locked();
+    pthread_mutex_unlock(&dimcache_lock);
+}
+
+bool db_dimcache_ready(void) {
+    pthread_mutex_lock(&dimcache_lock);
+    const bool status = dimcache_loaded || db_dimcache_load_locked();
+    pthread_mutex_unlock(&dimcache_lock);
+    return status;
+}
+
+ds_str db_dimcache_entity_name(const char * id) {
+    pthread_mutex_lock(&dimcache_lock);
+    const char * name = db_dimcache_find_locked(DIM_ENTITIES, id);
+    ds_str result = name ? ds_str_create(name) : NULL;
+    pthread_mutex_unlock(&dimcache_lock);
+    return result;
+}
+
+bool db_dimcache_account_id(const char * num, int * id) {
+    pthread_mutex_lock(&dimcache_lock);
+    const char * value = db_dimcache_find_locked(DIM_ACCOUNTS, num);
+    if ( value ) {
+        *id = atoi(value);
+    }
+    pthread_mutex_unlock(&dimcache_lock);
+    return value != NULL;
+}
+
+bool db_dimcache_has_entity(const int id) {
+    char key[32];
+    snprintf(key, sizeof key, "%d", id);
+    return db_dimcache_contains(DIM_ENTITIES, key);
+}
+
+bool db_dimcache_has_source(const char * name) {
+    return db_dimcache_contains(DIM_SOURCES, name);
+}
+
+bool db_dimcache_has_user(const int id) {
+    char key[32];
+    snprintf(key, sizeof key, "%d", id);
+    return db_dimcache_contains(DIM_USERS, key);
+}
+
+static bool db_dimcache_load_locked(void) {
+    db_dimcache_free_locked();
+
+    ds_str queries[DIM_COUNT] = {
+        ds_str_create(db_entity_dictionary_sql()),
+        ds_str_create(db_account_dictionary_sql()),
+        ds_str_create(db_source_dictionary_sql()),
+        ds_str_create(db_user_dictionary_sql())
+    };
+    ds_recordset results[DIM_COUNT] = {NULL};
+
+    bool status = true;
+    for ( size_t d = 0; d < DIM_COUNT; ++d ) {
+        if ( !queries[d] ) {
+            status = false;
+        }
+    }
+
+    status = status &&
+             db_create_recordsets_from_queries(DIM_COUNT, queries, results);
+
+    for ( size_t d = 0; d < DIM_COUNT; ++d ) {
+        if ( status && !(dimensions[d] = ds_map_init(dimension_sizes[d])) ) {
+            status = false;
+        }
+
+        if ( status ) {
+            ds_record record;
+            ds_recordset_seek_start(results[d]);
+            while ( (record = ds_recordset_next_record(results[d])) ) {
+                ds_map_insert(dimensions[d],
+                              ds_str_cstr(ds_record_get_field(record, 0)),
+                              ds_str_cstr(ds_record_get_field(record, 1)));
+            }
+        }
+
+        if ( results[d] ) {
+            ds_recordset_destroy(results[d]);
+        }
+        if ( queries[d] ) {
+            ds_str_destroy(queries[d]);
+        }
+    }
+
+    if ( !status ) {
+        gl_log_msg("Couldn't load the dimension cache.");
+        db_dimcache_free_locked();
+    }
+
+    dimcache_loaded = status;
+    return status;
+}
+
+static void db_dimcache_free_locked(void) {
+    for ( size_t d = 0; d < DIM_COUNT; ++d ) {
+        if ( dimensions[d] ) {
+            ds_map_destroy(dimensions[d]);
+            dimensions[d] = NULL;
+        }
+    }
+    dimcache_loaded = false;
+}
+
+static const char * db_dimcache_find_locked(const enum dimension dim,
+                                            const char * key) {
+    if ( !dimcache_loaded && !db_dimcache_load_locked() ) {
+        return NULL;
+    }
+    return ds_map_get_value(dimensions[dim], key);
+}
+
+static bool db_dimcache_contains(const enum dimension dim, const char * key) {
+    pthread_mutex_lock(&dimcache_lock);
+    const bool found = db_dimcache_find_locked(dim, key) != NULL;
+    pthread_mutex_unlock(&dimcache_lock);
+    return found;
+}
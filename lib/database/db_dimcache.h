@@ -0,0 +1,34 @@
+/*!
+ * \file            db_dimcache.h
+ * \brief           Interface to the dimension cache.
+ * \details         The dimension cache holds the entities, nominal
+ * accounts, JE sources and users in memory, so that report headers and
+ * the validation of journal entries before they are posted look them up
+ * without querying the database. The cache is loaded the first time it
+ * is used, and is reloaded after the library loads data into the tables.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_DATABASE_DB_DIMCACHE_H
+#define PG_GENERAL_LEDGER_DATABASE_DB_DIMCACHE_H
+
+#include <stdbool.h>
+
+/*!
+ * \brief           Loads the dimension cache from the database.
+ * \details         Any previously loaded cache is freed first. This is
+ * only needed to see changes made to the tables outside the library.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_dimcache_load(void);
+
+/*!
+ * \brief           Frees the dimension cache.
+ * \details         The cache is loaded again if it is used afterwards. It
+ * is safe to call this function if the cache is not loaded.
+ */
+void db_dimcache_free(void);
+
+#endif      /*  PG_GENERAL_LEDGER_DATABASE_DB_DIMCACHE_H  */
@@ -6,7 +6,6 @@
  * of the GNU General Public License. <http://www.gnu.org/licenses/>
  */
 
-#include <assert.h>
 #include "db_internal.h"
 #include "gl_general/gl_general.h"
 
@@ -44,29 +43,19 @@ ds_str db_list_entities_report(void) {
 }
 
 ds_str db_get_entity_name_from_id(ds_str entity_id) {
-    const char * cquery = db_get_entity_name_from_id_sql();
-    ds_str query = ds_str_create_sprintf(cquery, ds_str_cstr(entity_id));
-    ds_recordset set = db_create_recordset_from_query(query);
+    ds_str entity_name = db_dimcache_entity_name(ds_str_cstr(entity_id));
     ds_str result;
 
-    if ( ds_recordset_num_records(set) == 0 ) {
+    if ( !entity_name ) {
         result = ds_str_create_sprintf("Unknown entity [%s]",
                 ds_str_cstr(entity_id));
     }
-    else if ( ds_recordset_num_records(set) == 1 ) {
-        ds_recordset_seek_start(set);
-        ds_record record = ds_recordset_next_record(set);
-        ds_str entity_name = ds_record_get_field(record, 0);
+    else {
         result = ds_str_create_sprintf("%s [%s]",
                 ds_str_cstr(entity_name),
                 ds_str_cstr(entity_id));
+        ds_str_destroy(entity_name);
     }
-    else {
-        assert(false);
-    }
-
-    ds_recordset_destroy(set);
-    ds_str_destroy(query);
 
     return result;
 }
@@ -0,0 +1,468 @@
+/*!
+ * \file            db_filter.c
+ * \brief           Implementation of filtered report functionality.
+ * \details         Each report names the column expression each filter
+ * applies to, and the predicates are joined into a single WHERE clause on
+ * those expressions, so the indexes on them can be used. A column list is
+ * applied by selecting the named columns from the filtered query.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "gl_general/gl_general.h"
+#include "db_internal.h"
+
+/*!  Maximum length of a column name given in a column list  */
+#define MAX_COLUMN_NAME 64
+
+/*!  Filterable report description structure  */
+struct filter_report {
+    const char * name;                  /*!<  Report name               */
+    const char * (*sql)(void);          /*!<  Filtered query function   */
+    const char * entity;                /*!<  Entity expression         */
+    const char * year;                  /*!<  Year expression           */
+    const char * period;                /*!<  Period expression         */
+    const char * account;               /*!<  Account number expression */
+    const char * source;                /*!<  JE source expression      */
+    const char * const * columns;       /*!<  Column names              */
+    size_t num_columns;                 /*!<  Number of columns         */
+};
+
+/*!
+ * \brief           Describes a filterable report.
+ * \details         A `NULL` expression means the report can't be filtered
+ * on that value.
+ * \param report    The report.
+ * \param info      Modified to contain the description.
+ */
+static void db_filter_describe(const enum db_filtered_report report,
+                               struct filter_report * info);
+
+/*!
+ * \brief           Creates the WHERE clause for a filter.
+ * \param info      The report description.
+ * \param filter    The filter.
+ * \returns         The clause, which is empty if there are no filters, or
+ * `NULL` if a filter does not apply to the report or is not valid.
+ */
+static ds_str db_filter_where_clause(const struct filter_report * info,
+                                     const struct db_report_filter * filter);
+
+/*!
+ * \brief           Adds a predicate to a WHERE clause.
+ * \param where     The clause.
+ * \param predicate The predicate, which is destroyed.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_filter_add_predicate(ds_str where, ds_str predicate);
+
+/*!
+ * \brief           Creates a predicate for a range of values.
+ * \param expr      The expression to compare.
+ * \param first     The first value, or `NULL` for no lower bound.
+ * \param last      The last value, or `NULL` for no upper bound.
+ * \returns         The predicate.
+ */
+static ds_str db_filter_range(const char * expr, const char * first,
+                              const char * last);
+
+/*!
+ * \brief           Checks a string value can be placed in a query.
+ * \param name      The name of the value, for error messages.
+ * \param value     The value.
+ * \returns         `true` if the value contains no quotes or backslashes,
+ * `false` otherwise.
+ */
+static bool db_filter_check_value(const char * name, const char * value);
+
+/*!
+ * \brief           Creates the select list for a column list.
+ * \param info      The report description.
+ * \param columns   The comma-separated column names.
+ * \returns         The select list, or `NULL` if a column is not in the
+ * report.
+ */
+static ds_str db_filter_select_list(const struct filter_report * info,
+                                    const char * columns);
+
+/*!
+ * \brief           Finds a report column by name, ignoring case.
+ * \param info      The report description.
+ * \param name      The column name.
+ * \returns         The column name as it appears in the report, or `NULL`
+ * if not found.
+ */
+static const char * db_filter_find_column(const struct filter_report * info,
+                                          const char * name);
+
+ds_str db_filtered_report(const enum db_filtered_report report,
+                          const struct db_report_filter * filter) {
+    struct filter_report info;
+    db_filter_describe(report, &info);
+
+    gl_log_msg("Running filtered '%s' report...", info.name);
+
+    const bool store_filters = !filter->year && !filter->first_period &&
+                               !filter->last_period && !filter->source &&
+                               !filter->columns;
+
+    if ( report == DB_REPORT_ALL_JES && store_filters &&
+         db_ledgerstore_ready() ) {
+        return db_ledgerstore_all_jes_report(NULL, filter);
+    }
+    else if ( report == DB_REPORT_CURRENT_TB && store_filters &&
+              db_ledgerstore_ready() ) {
+        return db_ledgerstore_current_trial_balance_report(filter->entity,
+                                                           filter);
+    }
+
+    /*  The trial balance for a single entity leaves out the entity
+     *  column, as the unfiltered report does.                          */
+
+    const char * columns = filter->columns;
+    if ( !columns && report == DB_REPORT_CURRENT_TB && filter->entity &&
+         !filter->subtree ) {
+        columns = "A/C No.,Description,Balance";
+    }
+
+    ds_str where = db_filter_where_clause(&info, filter);
+    if ( !where ) {
+        return NULL;
+    }
+
+    ds_str limit = filter->limit ?
+                   ds_str_create_sprintf("  LIMIT %zu", filter->limit) :
+                   ds_str_create("");
+    ds_str query = limit ? ds_str_create_sprintf(info.sql(),
+                                                 ds_str_cstr(where),
+                                                 ds_str_cstr(limit))
+                         : NULL;
+
+    if ( query && columns ) {
+        ds_str select_list = db_filter_select_list(&info, columns);
+        ds_str projected = select_list ?
+                           ds_str_create_sprintf(db_project_report_sql(),
+                                                 ds_str_cstr(select_list),
+                                                 ds_str_cstr(query))
+                           : NULL;
+        if ( select_list ) {
+            ds_str_destroy(select_list);
+        }
+        ds_str_destroy(query);
+        query = projected;
+    }
+
+    ds_str result = query ? db_create_report_from_query(query) : NULL;
+
+    if ( query ) {
+        ds_str_destroy(query);
+    }
+    if ( limit ) {
+        ds_str_destroy(limit);
+    }
+    ds_str_destroy(where);
+
+    return result;
+}
+
+static void db_filter_describe(const enum db_filtered_report report,
+                               struct filter_report * info) {
+    static const char * const jes_columns[] = {
+        "JE", "Source", "Entity", "Memo", "Posting Time"
+    };
+    static const char * const jelines_columns[] = {
+        "JE", "Line", "Account Number", "Amount"
+    };
+    static const char * const nomaccts_columns[] = {
+        "A/C Number", "Description", "Enabled?"
+    };
+    static const char * const all_jes_columns[] = {
+        "JE", "En", "A/C No.", "Description", "Amount"
+    };
+    static const char * const currenttb_columns[] = {
+        "Entity", "A/C No.", "Description", "Balance"
+    };
+
+    /*  Lines carry their own entity, year and period in the
+     *  denormalized layouts, and are indexed on them.                  */
+
+    const bool denormalized = db_jelines_denormalized();
+
+    memset(info, 0, sizeof *info);
+
+    switch ( report ) {
+        case DB_REPORT_LIST_JES:
+            info->name = "list journal entries";
+            info->sql = db_list_jes_filtered_report_sql;
+            info->entity = "j.entity";
+            info->year = "j.year";
+            info->period = "j.period";
+            info->source = "j.source";
+            info->columns = jes_columns;
+            info->num_columns = sizeof jes_columns / sizeof *jes_columns;
+            break;
+
+        case DB_REPORT_LIST_JELINES:
+        case DB_REPORT_ALL_JES:
+            if ( report == DB_REPORT_LIST_JELINES ) {
+                info->name = "list journal entry lines";
+                info->sql = db_list_jelines_filtered_report_sql;
+                info->columns = jelines_columns;
+                info->num_columns = sizeof jelines_columns /
+                                    sizeof *jelines_columns;
+            }
+            else {
+                info->name = "all journal entries";
+                info->sql = db_all_jes_filtered_report_sql;
+                info->columns = all_jes_columns;
+                info->num_columns = sizeof all_jes_columns /
+                                    sizeof *all_jes_columns;
+            }
+            info->entity = denormalized ? "l.entity" : "j.entity";
+            info->year = denormalized ? "l.year" : "j.year";
+            info->period = denormalized ? "l.period" : "j.period";
+            info->account = "a.num";
+            info->source = "j.source";
+            break;
+
+        case DB_REPORT_LIST_NOMACCTS:
+            info->name = "list nominal accounts";
+            info->sql = db_list_nomaccts_filtered_report_sql;
+            info->account = "num";
+            info->columns = nomaccts_columns;
+            info->num_columns = sizeof nomaccts_columns /
+                                sizeof *nomaccts_columns;
+            break;
+
+        case DB_REPORT_CURRENT_TB:
+            info->name = "current trial balance";
+            info->sql = db_current_trial_balance_filtered_report_sql;
+            info->entity = "b.entity";
+            info->account = "a.num";
+            info->columns = currenttb_columns;
+            info->num_columns = sizeof currenttb_columns /
+                                sizeof *currenttb_columns;
+            break;
+    }
+}
+
+static ds_str db_filter_where_clause(const struct filter_report * info,
+                                     const struct db_report_filter * filter) {
+    ds_str where = ds_str_create("");
+    bool status = where != NULL;
+
+    if ( status && filter->entity ) {
+        int entity;
+        if ( !info->entity ) {
+            gl_log_msg("The '%s' report can't be filtered by entity.",
+                       info->name);
+            status = false;
+        }
+        else if ( !ds_str_intval(filter->entity, 10, &entity) ) {
+            gl_log_msg("Entity '%s' is not a valid entity ID.",
+                       ds_str_cstr(filter->entity));
+            status = false;
+        }
+        else if ( filter->subtree ) {
+            status = db_filter_add_predicate(where,
+                    ds_str_create_sprintf(db_entity_subtree_predicate_sql(),
+                                          info->entity, entity));
+        }
+        else {
+            status = db_filter_add_predicate(where,
+                    ds_str_create_sprintf("%s = %d", info->entity, entity));
+        }
+    }
+
+    if ( status && filter->year ) {
+        if ( !info->year ) {
+            gl_log_msg("The '%s' report can't be filtered by year.",
+                       info->name);
+            status = false;
+        }
+        else {
+            status = db_filter_add_predicate(where,
+                    ds_str_create_sprintf("%s = %d", info->year,
+                                          filter->year));
+        }
+    }
+
+    if ( status && (filter->first_period || filter->last_period) ) {
+        if ( !info->period ) {
+            gl_log_msg("The '%s' report can't be filtered by period.",
+                       info->name);
+            status = false;
+        }
+        else {
+            char first[32], last[32];
+            snprintf(first, sizeof first, "%d", filter->first_period);
+            snprintf(last, sizeof last, "%d", filter->last_period);
+            status = db_filter_add_predicate(where,
+                    db_filter_range(info->period,
+                                    filter->first_period ? first : NULL,
+                                    filter->last_period ? last : NULL));
+        }
+    }
+
+    if ( status && (filter->first_account || filter->last_account) ) {
+        if ( !info->account ) {
+            gl_log_msg("The '%s' report can't be filtered by account.",
+                       info->name);
+            status = false;
+        }
+        else if ( db_filter_check_value("account", filter->first_account) &&
+                  db_filter_check_value("account", filter->last_account) ) {
+            ds_str first = filter->first_account ?
+                ds_str_create_sprintf("'%s'", filter->first_account) : NULL;
+            ds_str last = filter->last_account ?
+                ds_str_create_sprintf("'%s'", filter->last_account) : NULL;
+            status = db_filter_add_predicate(where,
+                    db_filter_range(info->account,
+                                    first ? ds_str_cstr(first) : NULL,
+                                    last ? ds_str_cstr(last) : NULL));
+            if ( first ) {
+                ds_str_destroy(first);
+            }
+            if ( last ) {
+                ds_str_destroy(last);
+            }
+        }
+        else {
+            status = false;
+        }
+    }
+
+    if ( status && filter->source ) {
+        if ( !info->source ) {
+            gl_log_msg("The '%s' report can't be filtered by source.",
+                       info->name);
+            status = false;
+        }
+        else if ( db_filter_check_value("source", filter->source) ) {
+            status = db_filter_add_predicate(where,
+                    ds_str_create_sprintf("%s = '%s'", info->source,
+                                          filter->source));
+        }
+        else {
+            status = false;
+        }
+    }
+
+    if ( !status && where ) {
+        ds_str_destroy(where);
+        where = NULL;
+    }
+
+    return where;
+}
+
+static bool db_filter_add_predicate(ds_str where, ds_str predicate) {
+    if ( !predicate ) {
+        return false;
+    }
+
+    ds_str_concat_cstr(where, ds_str_is_empty(where) ? "  WHERE " : " AND ");
+    ds_str_concat(where, predicate);
+    ds_str_destroy(predicate);
+    return true;
+}
+
+static ds_str db_filter_range(const char * expr, const char * first,
+                              const char * last) {
+    if ( first && last && !strcmp(first, last) ) {
+        return ds_str_create_sprintf("%s = %s", expr, first);
+    }
+    else if ( first && last ) {
+        return ds_str_create_sprintf("%s BETWEEN %s AND %s",
+                                     expr, first, last);
+    }
+    else if ( first ) {
+        return ds_str_create_sprintf("%s >= %s", expr, first);
+    }
+    return ds_str_create_sprintf("%s <= %s", expr, last);
+}
+
+static bool db_filter_check_value(const char * name, const char * value) {
+    if ( value && strpbrk(value, "'\"\\") ) {
+        gl_log_msg("The %s '%s' contains a quote or backslash.",
+                   name, value);
+        return false;
+    }
+    return true;
+}
+
+static ds_str db_filter_select_list(const struct filter_report * info,
+                                    const char * columns) {
+    ds_str list = ds_str_create("");
+    bool status = list != NULL;
+
+    const char * next = columns;
+    while ( status && next ) {
+        const char * comma = strchr(next, ',');
+        size_t length = comma ? (size_t) (comma - next) : strlen(next);
+
+        while ( length && isspace((unsigned char) *next) ) {
+            ++next;
+            --length;
+        }
+        while ( length && isspace((unsigned char) next[length - 1]) ) {
+            --length;
+        }
+
+        char name[MAX_COLUMN_NAME + 1];
+        const char * column = NULL;
+        if ( length && length <= MAX_COLUMN_NAME ) {
+            memcpy(name, next, length);
+            name[length] = '\0';
+            column = db_filter_find_column(info, name);
+        }
+
+        if ( !column ) {
+            gl_log_msg("The '%s' report has no column '%.*s'.",
+                       info->name, (int) length, next);
+            status = false;
+        }
+        else {
+            if ( !ds_str_is_empty(list) ) {
+                ds_str_concat_cstr(list, ", ");
+            }
+            ds_str quoted = ds_str_create_sprintf(db_quote_identifier_sql(),
+                                                  column);
+            status = quoted != NULL;
+            if ( quoted ) {
+                ds_str_concat(list, quoted);
+                ds_str_destroy(quoted);
+            }
+        }
+
+        next = comma ? comma + 1 : NULL;
+    }
+
+    if ( !status && list ) {
+        ds_str_destroy(list);
+        list = NULL;
+    }
+
+    return list;
+}
+
+static const char * db_filter_find_column(const struct filter_report * info,
+                                          const char * name) {
+    for ( size_t c = 0; c < info->num_columns; ++c ) {
+        const char * column = info->columns[c];
+        size_t i = 0;
+        while ( column[i] && tolower((unsigned char) column[i]) ==
+                             tolower((unsigned char) name[i]) ) {
+            ++i;
+        }
+        if ( !column[i] && !name[i] ) {
+            return column;
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,58 @@
+/*!
+ * \file            db_filter.h
+ * \brief           Interface to filtered report functionality.
+ * \details         Filters, column lists and row limits are written into
+ * the WHERE, SELECT and LIMIT clauses of the report query, so the database
+ * only reads and returns the rows and columns which will be shown. When
+ * the ledger store answers a report, it applies the filters it can as it
+ * scans, and otherwise the report is run as a query.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_DATABASE_DB_FILTER_H
+#define PG_GENERAL_LEDGER_DATABASE_DB_FILTER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "datastruct/data_structures.h"
+
+/*!  Report filter structure  */
+struct db_report_filter {
+    ds_str entity;              /*!<  Entity ID, or `NULL` for all      */
+    bool subtree;               /*!<  `true` to include the entities
+                                      below `entity`                    */
+    int year;                   /*!<  Year, or 0 for all                */
+    int first_period;           /*!<  First period, or 0 for all        */
+    int last_period;            /*!<  Last period, or 0 for all         */
+    const char * first_account; /*!<  First account number, or `NULL`   */
+    const char * last_account;  /*!<  Last account number, or `NULL`    */
+    const char * source;        /*!<  JE source, or `NULL` for all      */
+    const char * columns;       /*!<  Comma-separated names of the
+                                      columns to show, or `NULL`        */
+    size_t limit;               /*!<  Maximum number of rows, or 0      */
+};
+
+/*!  Reports which may be filtered  */
+enum db_filtered_report {
+    DB_REPORT_LIST_JES,         /*!<  List of journal entries           */
+    DB_REPORT_LIST_JELINES,     /*!<  List of journal entry lines       */
+    DB_REPORT_LIST_NOMACCTS,    /*!<  List of nominal accounts          */
+    DB_REPORT_ALL_JES,          /*!<  Detailed journal entries          */
+    DB_REPORT_CURRENT_TB        /*!<  Current trial balance             */
+};
+
+/*!
+ * \brief           Creates a filtered report.
+ * \details         An account range includes both ends, and either end may
+ * be omitted. A filter which does not apply to the report, or a column
+ * which is not in it, is logged and fails the report.
+ * \param report    The report.
+ * \param filter    The filter.
+ * \returns         A ds_str containing the report, or `NULL` on failure.
+ */
+ds_str db_filtered_report(const enum db_filtered_report report,
+                          const struct db_report_filter * filter);
+
+#endif      /*  PG_GENERAL_LEDGER_DATABASE_DB_FILTER_H  */
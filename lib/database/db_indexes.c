@@ -0,0 +1,129 @@
+/*!
+ * \file            db_indexes.c
+ * \brief           Implementation of secondary index functionality.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <string.h>
+
+#include "gl_general/gl_general.h"
+#include "db_internal.h"
+
+/*!  Mask of the JE lines layouts in which an index is created  */
+#define LAYOUT(layout) (1u << (layout))
+
+/*!  Mask of all JE lines layouts  */
+#define ALL_LAYOUTS (~0u)
+
+/*!  Mask of the JE lines layouts which store the JE entity and period  */
+#define DENORMALIZED_LAYOUTS \
+    (LAYOUT(DB_JELINES_DENORMALIZED) | LAYOUT(DB_JELINES_PARTITIONED))
+
+/*!  Secondary index definition structure  */
+struct db_index {
+    const char * name;          /*!<  Index name                    */
+    const char * table;         /*!<  Table name                    */
+    const char * columns;       /*!<  Comma-separated column list   */
+    unsigned int layouts;       /*!<  JE lines layouts using it     */
+};
+
+/*!  The managed index set  */
+static const struct db_index indexes[] = {
+
+    /*  Entity and period selection of JEs, for period reports and
+     *  period balance rebuilds.                                    */
+
+    {"jes_entity_period_idx", "jes", "entity, year, period", ALL_LAYOUTS},
+
+    /*  Covering indexes over JE lines. The first serves lookups by JE
+     *  for the JE reports, the second serves aggregation by account,
+     *  and both avoid reading the table rows. When the lines are
+     *  clustered on JE, the table itself serves lookups by JE. When
+     *  they are denormalized or partitioned, balances are aggregated
+     *  by entity and account, which the third serves without a sort. */
+
+    {"jelines_je_idx", "jelines", "je, account, amount",
+        LAYOUT(DB_JELINES_SURROGATE) | DENORMALIZED_LAYOUTS},
+    {"jelines_account_idx", "jelines", "account, je, amount",
+        LAYOUT(DB_JELINES_SURROGATE) | LAYOUT(DB_JELINES_CLUSTERED)},
+    {"jelines_entity_account_idx", "jelines",
+        "entity, account, year, period, amount", DENORMALIZED_LAYOUTS},
+
+    /*  Ancestors of an entity. The primary key serves descendants.  */
+
+    {"entity_closure_descendant_idx", "entity_closure",
+        "descendant, ancestor, depth", ALL_LAYOUTS},
+
+    {NULL, NULL, NULL, 0}
+};
+
+/*!
+ * \brief           Runs an index query for one index.
+ * \param format    The query format string, taking the index name, table
+ * and columns.
+ * \param index     The index.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_index_query(const char * format, const struct db_index * index);
+
+bool db_create_indexes(void) {
+    return db_create_table_indexes(NULL);
+}
+
+bool db_create_table_indexes(const char * table) {
+    const unsigned int layout = LAYOUT(db_get_jelines_layout());
+    bool status = true;
+    for ( size_t i = 0; indexes[i].name; ++i ) {
+        if ( (table && strcmp(indexes[i].table, table)) ||
+             !(indexes[i].layouts & layout) ) {
+            continue;
+        }
+
+        gl_log_msg("Creating index %s...", indexes[i].name);
+        if ( !db_index_query(db_create_index_sql(), &indexes[i]) ) {
+            status = false;
+        }
+    }
+    return status;
+}
+
+bool db_drop_indexes(void) {
+    bool status = true;
+    for ( size_t i = 0; indexes[i].name; ++i ) {
+        ds_str query = ds_str_create_sprintf(db_index_exists_sql(),
+                                             indexes[i].name,
+                                             indexes[i].table);
+        uint64_t exists = 0;
+        bool found = db_query_integer(query, &exists);
+        ds_str_destroy(query);
+
+        if ( !found ) {
+            status = false;
+        }
+        else if ( exists ) {
+            gl_log_msg("Dropping index %s...", indexes[i].name);
+            if ( !db_index_query(db_drop_index_sql(), &indexes[i]) ) {
+                status = false;
+            }
+        }
+    }
+    return status;
+}
+
+bool db_reindex(void) {
+    return db_drop_indexes() && db_create_indexes();
+}
+
+static bool db_index_query(const char * format,
+                           const struct db_index * index) {
+    ds_str query = ds_str_create_sprintf(format, index->name, index->table,
+                                         index->columns);
+    bool status = false;
+    if ( query ) {
+        status = db_execute_query(query);
+        ds_str_destroy(query);
+    }
+    return status;
+}
@@ -0,0 +1,44 @@
+/*!
+ * \file            db_indexes.h
+ * \brief           Interface to secondary index functionality.
+ * \details         The tables only declare primary and foreign keys. The
+ * secondary indexes used by the report paths are managed as a set, so
+ * they can be dropped before a large bulk load and rebuilt after it.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_DATABASE_DB_INDEXES_H
+#define PG_GENERAL_LEDGER_DATABASE_DB_INDEXES_H
+
+#include <stdbool.h>
+
+/*!
+ * \brief           Creates the secondary indexes.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_create_indexes(void);
+
+/*!
+ * \brief           Creates the secondary indexes on one table.
+ * \param table     The table name, or `NULL` for all tables.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_create_table_indexes(const char * table);
+
+/*!
+ * \brief           Drops the secondary indexes.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_drop_indexes(void);
+
+/*!
+ * \brief           Drops and recreates the secondary indexes.
+ * \details         Indexes which do not exist are skipped when dropping,
+ * so this may be used after `db_drop_indexes()`.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_reindex(void);
+
+#endif      /*  PG_GENERAL_LEDGER_DATABASE_DB_INDEXES_H  */
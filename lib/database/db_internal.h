@@ -11,8 +11,400 @@
 #ifndef PG_GENERAL_LEDGER_DATABASE_DB_INTERNAL_H
 #define PG_GENERAL_LEDGER_DATABASE_DB_INTERNAL_H
 
+#include <stdio.h>
+#include <stdint.h>
+
 #include "database.h"
 #include "db_sql.h"
 
+/*!
+ * \brief           Header callback which creates a record set.
+ * \details         For use with `db_query_foreach()`, together with
+ * `db_recordset_row_cb()`.
+ * \param num_fields    The number of fields in the result.
+ * \param names     The field names.
+ * \param ctx       A pointer to a `ds_recordset` in which to store the
+ * new record set.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_recordset_header_cb(const size_t num_fields,
+                            const char * const * names,
+                            void * ctx);
+
+/*!
+ * \brief           Row callback which adds a record to a record set.
+ * \param num_fields    The number of fields in the row.
+ * \param values    The field values.
+ * \param lengths   The field value lengths.
+ * \param ctx       A pointer to the `ds_recordset` to which to add.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_recordset_row_cb(const size_t num_fields,
+                         const char * const * values,
+                         const size_t * lengths,
+                         void * ctx);
+
+/*!
+ * \brief           Gets a single integer value from a query.
+ * \param query     The query.
+ * \param value     Modified to contain the first field of the first row,
+ * or 0 if the query returns no rows or a NULL value.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_query_integer(ds_str query, uint64_t * value);
+
+/*!
+ * \brief           Increments the ledger version.
+ * \details         This should be called by every operation which changes
+ * the ledger, in the same transaction as the change where there is one,
+ * so that cached query results are no longer used. Every entity is marked
+ * as changed at the new version.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_bump_ledger_version(void);
+
+/*!
+ * \brief           Increments the ledger version for changes to some
+ * entities.
+ * \details         As `db_bump_ledger_version()`, except that only the
+ * given entities are marked as changed at the new version.
+ * \param entities  The entity IDs, which may contain duplicates.
+ * \param num_entities  The number of entity IDs.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_bump_entity_ledger_version(const int * entities,
+                                   const size_t num_entities);
+
+/*!
+ * \brief           Looks up a query result in the query cache.
+ * \param query     The query.
+ * \param version   Modified to contain the current ledger version if the
+ * cache is enabled and the result is not cached, which should be passed to
+ * `db_querycache_store()` with the result and then destroyed, or `NULL`
+ * otherwise.
+ * \returns         A copy of the cached result, which should be destroyed
+ * with `ds_recordset_destroy()`, or `NULL` if the result is not cached.
+ */
+ds_recordset db_querycache_lookup(ds_str query, ds_str * version);
+
+/*!
+ * \brief           Stores a query result in the query cache.
+ * \param query     The query.
+ * \param version   The ledger version returned by `db_querycache_lookup()`
+ * before the query was run.
+ * \param set       The result, which is copied.
+ */
+void db_querycache_store(ds_str query, ds_str version, ds_recordset set);
+
+/*!  Query cache file reader structure  */
+struct db_querycache_reader {
+    const unsigned char * pos;          /*!<  Current position      */
+    const unsigned char * end;          /*!<  End of the buffer     */
+};
+
+/*!
+ * \brief           Returns the query cache directory.
+ * \returns         A copy of the directory, which should be freed with
+ * `free()`, or `NULL` if the cache is disabled or held in memory only.
+ */
+char * db_querycache_dir(void);
+
+/*!
+ * \brief           Reads the whole of a query cache file.
+ * \param fp        The file.
+ * \param size      Modified to contain the size of the contents.
+ * \returns         The contents, which should be freed with `free()`, or
+ * `NULL` if the file is empty or cannot be read.
+ */
+unsigned char * db_querycache_read_buffer(FILE * fp, size_t * size);
+
+/*!
+ * \brief           Opens a temporary file to be renamed to a query cache
+ * file by `db_querycache_close_temp()`.
+ * \details         Files are written under a temporary name and renamed
+ * into place, so several programs may share a cache directory.
+ * \param filename  The name of the cache file.
+ * \param tempname  Modified to contain the temporary name.
+ * \returns         The open temporary file, or `NULL` on failure.
+ */
+FILE * db_querycache_open_temp(ds_str filename, ds_str * tempname);
+
+/*!
+ * \brief           Closes a temporary file and renames it into place.
+ * \details         The temporary file is removed if it was not written or
+ * cannot be renamed, and its name is destroyed.
+ * \param fp        The temporary file.
+ * \param tempname  The temporary name.
+ * \param filename  The name of the cache file.
+ * \param status    `true` if the file was written successfully.
+ * \returns         `true` if the cache file was replaced, `false`
+ * otherwise.
+ */
+bool db_querycache_close_temp(FILE * fp, ds_str tempname, ds_str filename,
+                              const bool status);
+
+/*!
+ * \brief           Writes a little endian 32 bit integer to a query cache
+ * file.
+ * \param fp        The file.
+ * \param value     The value.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_querycache_put_u32(FILE * fp, const uint32_t value);
+
+/*!
+ * \brief           Writes a little endian 64 bit integer to a query cache
+ * file.
+ * \param fp        The file.
+ * \param value     The value.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_querycache_put_u64(FILE * fp, const uint64_t value);
+
+/*!
+ * \brief           Writes a string with a length prefix to a query cache
+ * file.
+ * \param fp        The file.
+ * \param str       The string, or `NULL` for an empty string.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_querycache_put_str(FILE * fp, ds_str str);
+
+/*!
+ * \brief           Reads a little endian 32 bit integer.
+ * \param reader    The reader.
+ * \param value     Modified to contain the value.
+ * \returns         `true` on success, `false` if the buffer is overrun.
+ */
+bool db_querycache_get_u32(struct db_querycache_reader * reader,
+                           uint32_t * value);
+
+/*!
+ * \brief           Reads a little endian 64 bit integer.
+ * \param reader    The reader.
+ * \param value     Modified to contain the value.
+ * \returns         `true` on success, `false` if the buffer is overrun.
+ */
+bool db_querycache_get_u64(struct db_querycache_reader * reader,
+                           uint64_t * value);
+
+/*!
+ * \brief           Reads a string stored by `db_querycache_put_str()`.
+ * \param reader    The reader.
+ * \returns         The string, or `NULL` if the buffer is overrun.
+ */
+ds_str db_querycache_get_str(struct db_querycache_reader * reader);
+
+/*!
+ * \brief           Loads the dimension cache if it is not already loaded.
+ * \returns         `true` if the cache is loaded, `false` on failure.
+ */
+bool db_dimcache_ready(void);
+
+/*!
+ * \brief           Looks up an entity name in the dimension cache.
+ * \param id        The entity ID.
+ * \returns         The entity name, which should be destroyed with
+ * `ds_str_destroy()`, or `NULL` if the entity is not found.
+ */
+ds_str db_dimcache_entity_name(const char * id);
+
+/*!
+ * \brief           Looks up a nominal account ID in the dimension cache.
+ * \details         Account numbers are the external keys of nominal
+ * accounts, and IDs are the keys stored in the database.
+ * \param num       The account number.
+ * \param id        Modified to contain the account ID if it is found.
+ * \returns         `true` if the account is found, `false` otherwise.
+ */
+bool db_dimcache_account_id(const char * num, int * id);
+
+/*!
+ * \brief           Checks whether an entity is in the dimension cache.
+ * \param id        The entity ID.
+ * \returns         `true` if the entity is found, `false` otherwise.
+ */
+bool db_dimcache_has_entity(const int id);
+
+/*!
+ * \brief           Checks whether a JE source is in the dimension cache.
+ * \param name      The source name.
+ * \returns         `true` if the source is found, `false` otherwise.
+ */
+bool db_dimcache_has_source(const char * name);
+
+/*!
+ * \brief           Checks whether a user is in the dimension cache.
+ * \param id        The user ID.
+ * \returns         `true` if the user is found, `false` otherwise.
+ */
+bool db_dimcache_has_user(const int id);
+
+/*!
+ * \brief           Creates an empty JE lines scratch table.
+ * \details         The scratch table has JE, line number, account number
+ * and amount columns in every layout.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_create_jelines_stage(void);
+
+/*!
+ * \brief           Inserts the lines in the scratch table into the JE lines
+ * table.
+ * \details         Account numbers are translated to account IDs, and in
+ * the denormalized layout, the entity, year and period of each line are
+ * taken from its JE. Lines with an unknown JE or account number fail the
+ * insert.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_restore_jelines_stage(void);
+
+/*!
+ * \brief           Drops the JE lines scratch table.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_drop_jelines_stage(void);
+
+/*!
+ * \brief           Checks whether reports should use the ledger store.
+ * \details         Loads the store on first use if it is enabled.
+ * \returns         `true` if the store is enabled and loaded, `false`
+ * otherwise.
+ */
+bool db_ledgerstore_ready(void);
+
+/*!
+ * \brief           Runs the current trial balance report from the store.
+ * \param entity    The entity, or `NULL` for all entities.
+ * \param filter    The account range and row limit, or `NULL` for none.
+ * Other filters are ignored.
+ * \returns         The report.
+ */
+ds_str db_ledgerstore_current_trial_balance_report(ds_str entity,
+        const struct db_report_filter * filter);
+
+/*!
+ * \brief           Runs the check total report from the store.
+ * \param entity    The entity, or `NULL` for all entities.
+ * \returns         The report.
+ */
+ds_str db_ledgerstore_check_total_report(ds_str entity);
+
+/*!
+ * \brief           Runs the all JEs report from the store.
+ * \param je_num    The JE number, or `NULL` for all JEs.
+ * \param filter    The entity, account range and row limit, or `NULL` for
+ * none. Other filters are ignored.
+ * \returns         The report.
+ */
+ds_str db_ledgerstore_all_jes_report(ds_str je_num,
+                                     const struct db_report_filter * filter);
+
+/*!
+ * \brief           Returns an entity name from the store.
+ * \param entity_id The entity ID.
+ * \returns         The string, containing an "Unknown entity" string if
+ * the ID was not found.
+ */
+ds_str db_ledgerstore_entity_name(ds_str entity_id);
+
+/*!
+ * \brief           Parses a decimal amount into cents.
+ * \details         Digits past the second decimal place are rounded.
+ * \param value     The amount.
+ * \param length    The length of the amount.
+ * \param cents     Modified to contain the result.
+ * \returns         `true` on success, `false` if the amount is not a
+ * decimal number.
+ */
+bool db_parse_cents(const char * value, const size_t length,
+                    int64_t * cents);
+
+/*!
+ * \brief           Formats an amount in cents as a decimal string.
+ * \param cents     The amount.
+ * \returns         The string.
+ */
+ds_str db_format_cents(const int64_t cents);
+
+/*!
+ * \brief           Task function for `db_run_parallel()`.
+ * \param index     The index of the task to run.
+ * \param ctx       The context pointer passed to `db_run_parallel()`.
+ * \returns         `true` on success, `false` on failure.
+ */
+typedef bool (*db_task_func)(const size_t index, void * ctx);
+
+/*!
+ * \brief           Runs a set of tasks concurrently on pooled connections.
+ * \details         The calling thread and up to one fewer worker threads
+ * than the pool size each run tasks on their own connection until none
+ * remain. With a pool of one connection, the tasks run one after another
+ * in the calling thread.
+ * \param num_tasks The number of tasks.
+ * \param task      The function to call for each task.
+ * \param ctx       A context pointer to pass to the task function.
+ * \returns         `true` if every task succeeded, `false` otherwise.
+ */
+bool db_run_parallel(const size_t num_tasks, db_task_func task, void * ctx);
+
+/*!
+ * \brief           Fills the entity closure table from the entities.
+ * \details         Unlike `db_rebuild_entity_closure()`, this function does
+ * not start a transaction, so it may be called inside one.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_fill_entity_closure(void);
+
+/*!
+ * \brief           Checks whether one entity is under another.
+ * \details         The in-memory closure is loaded on first use. Every
+ * entity is under itself.
+ * \param ancestor  The ID of the higher entity.
+ * \param descendant    The ID of the lower entity.
+ * \returns         `true` if `descendant` is `ancestor` or is below it,
+ * `false` otherwise, or if the closure could not be loaded.
+ */
+bool db_closure_contains(const int ancestor, const int descendant);
+
+/*!
+ * \brief           Takes consecutive JE IDs for the calling thread.
+ * \details         The IDs come from the block reserved by
+ * `db_reserve_je_ids()` if it holds enough and the sequence has not been
+ * moved by `db_sync_je_sequence()` since, and are otherwise reserved in
+ * the caller's transaction.
+ * \param count     The number of IDs.
+ * \param first     Modified to contain the first ID.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_take_je_ids(const size_t count, uint64_t * first);
+
+/*!
+ * \brief           Inserts journal entries into the database, whatever
+ * their period.
+ * \details         As `db_insert_journal_entries()`, except that the
+ * entries are not checked against the current period. This is for the
+ * closing entries of a year, which are posted to its last period after
+ * the year is closed.
+ * \param jes       The entries.
+ * \param num_jes   The number of entries.
+ * \param ids       Modified to contain the ID given to each entry, in
+ * order, or `NULL` if the IDs are not needed.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_insert_closing_entries(const struct db_je * jes,
+                               const size_t num_jes, uint64_t * ids);
+
+/*!
+ * \brief           Moves the JE ID sequence past the JE IDs in use.
+ * \details         This should be called after JEs are loaded without IDs,
+ * in the same transaction where there is one. The database may have given
+ * the loaded JEs IDs from blocks which other threads have reserved, so a
+ * new generation of the sequence is started, and blocks reserved in an
+ * earlier one are given up the next time IDs are taken from them.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_sync_je_sequence(void);
+
 #endif      /*  PG_GENERAL_LEDGER_DATABASE_DB_INTERNAL_H  */
 
@@ -9,10 +9,53 @@
 #include "gl_general/gl_general.h"
 #include "db_internal.h"
 
+/*!  Layout used when creating the JE lines table  */
+static enum db_jelines_layout jelines_layout = DB_JELINES_SURROGATE;
+
+/*!
+ * \brief           Runs a query which does not return a result.
+ * \param cquery    The query to run.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_run_query(const char * cquery);
+
+/*!
+ * \brief           Creates the unique key on JEs referenced by denormalized
+ * JE lines, if it does not already exist.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_create_jes_denormalized_key(void);
+
+void db_set_jelines_layout(const enum db_jelines_layout layout) {
+    jelines_layout = layout;
+}
+
+enum db_jelines_layout db_get_jelines_layout(void) {
+    return jelines_layout;
+}
+
+bool db_jelines_denormalized(void) {
+    return jelines_layout == DB_JELINES_DENORMALIZED ||
+           jelines_layout == DB_JELINES_PARTITIONED;
+}
+
 bool db_create_jelines_table(void) {
+    const char * cquery = db_create_jelines_table_sql();
+    if ( jelines_layout == DB_JELINES_CLUSTERED ) {
+        cquery = db_create_clustered_jelines_table_sql();
+    }
+    else if ( db_jelines_denormalized() ) {
+        if ( !db_create_jes_denormalized_key() ) {
+            return false;
+        }
+        cquery = jelines_layout == DB_JELINES_PARTITIONED ?
+                 db_create_partitioned_jelines_table_sql() :
+                 db_create_denormalized_jelines_table_sql();
+    }
+
     gl_log_msg("Creating jelines table...");
     bool status = false;
-    ds_str query = ds_str_create(db_create_jelines_table_sql());
+    ds_str query = ds_str_create(cquery);
     if ( query ) {
         status = db_execute_query(query);
         ds_str_destroy(query);
@@ -31,6 +74,63 @@ bool db_drop_jelines_table(void) {
     return status;
 }
 
+bool db_create_jelines_stage(void) {
+    return db_run_query(db_create_jelines_copy_sql());
+}
+
+bool db_restore_jelines_stage(void) {
+    return db_run_query(db_jelines_denormalized() ?
+                        db_restore_denormalized_jelines_sql() :
+                        db_restore_jelines_sql());
+}
+
+bool db_drop_jelines_stage(void) {
+    return db_run_query(db_drop_jelines_copy_sql());
+}
+
+bool db_migrate_jelines_table(void) {
+    static const char * layout_names[] = {
+        "surrogate", "clustered", "denormalized", "partitioned"
+    };
+
+    if ( jelines_layout == DB_JELINES_PARTITIONED ) {
+        gl_log_msg("The partitioned layout can only be used when the "
+                   "database structure is created.");
+        return false;
+    }
+
+    gl_log_msg("Migrating jelines table to %s layout...",
+               layout_names[jelines_layout]);
+
+    if ( !db_begin_transaction() ) {
+        return false;
+    }
+
+    /*  Dropping the table drops its triggers and indexes, so the lines
+     *  are restored without firing the balance triggers again. The all
+     *  JEs view differs between layouts, so it is recreated.           */
+
+    bool status = db_run_query(db_copy_jelines_sql()) &&
+                  db_drop_all_jes_view() &&
+                  db_drop_jelines_table() &&
+                  db_create_jelines_table() &&
+                  db_restore_jelines_stage() &&
+                  db_drop_jelines_stage() &&
+                  db_create_account_balances_trigger() &&
+                  db_create_period_balances_trigger() &&
+                  db_create_table_indexes("jelines") &&
+                  db_create_all_jes_view();
+
+    if ( status ) {
+        status = db_commit_transaction();
+    }
+    else {
+        db_rollback_transaction();
+    }
+
+    return status;
+}
+
 ds_str db_list_jelines_report(void) {
     gl_log_msg("Running 'list journal entry lines' report...");
     ds_str report = NULL;
@@ -42,3 +142,30 @@ ds_str db_list_jelines_report(void) {
     return report;
 }
 
+
+static bool db_run_query(const char * cquery) {
+    bool status = false;
+    ds_str query = ds_str_create(cquery);
+    if ( query ) {
+        status = db_execute_query(query);
+        ds_str_destroy(query);
+    }
+    return status;
+}
+
+static bool db_create_jes_denormalized_key(void) {
+    ds_str query = ds_str_create_sprintf(db_index_exists_sql(),
+                                         "jes_denormalized_uk", "jes");
+    uint64_t exists = 0;
+    bool status = query && db_query_integer(query, &exists);
+    if ( query ) {
+        ds_str_destroy(query);
+    }
+
+    if ( status && !exists ) {
+        gl_log_msg("Creating jes denormalized key...");
+        status = db_run_query(db_create_jes_denormalized_key_sql());
+    }
+
+    return status;
+}
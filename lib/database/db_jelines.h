@@ -12,6 +12,50 @@
 #include <stdbool.h>
 #include "datastruct/data_structures.h"
 
+/*!  Physical layouts of the journal entry lines table  */
+enum db_jelines_layout {
+    DB_JELINES_SURROGATE,       /*!<  Clustered on a surrogate line ID  */
+    DB_JELINES_CLUSTERED,       /*!<  Clustered on JE and line number   */
+    DB_JELINES_DENORMALIZED,    /*!<  Clustered on entity and period    */
+    DB_JELINES_PARTITIONED      /*!<  Partitioned on year               */
+};
+
+/*!
+ * \brief           Sets the layout used when creating the JE lines table.
+ * \details         The surrogate layout keys each line on an
+ * auto-incremented ID, so lines are stored in insertion order, and lines
+ * from concurrent postings are interleaved. The clustered layout keys
+ * each line on its JE and line number, so the lines of an entry are
+ * stored together. The denormalized layout also stores the entity, year
+ * and period of each line's JE on the line, clustered in that order,
+ * so the balance triggers, balance rebuilds and all JEs view read them
+ * without joining to the JEs table. A foreign key to the JEs table
+ * ensures they match the JE. The partitioned layout stores the same
+ * columns, and partitions both the JE lines and JEs tables on year, so
+ * queries on a year only read its partition, and a closed year can be
+ * dropped or archived with `db_drop_partition()` and
+ * `db_archive_partition()`. MySQL does not support foreign keys on
+ * partitioned tables, so they are not declared in this layout, and SQLite
+ * does not partition tables, so it clusters the lines on year instead.
+ * The default is the surrogate layout.
+ * \param layout    The layout.
+ */
+void db_set_jelines_layout(const enum db_jelines_layout layout);
+
+/*!
+ * \brief           Returns the layout used when creating the JE lines table.
+ * \returns         The layout.
+ */
+enum db_jelines_layout db_get_jelines_layout(void);
+
+/*!
+ * \brief           Checks if JE lines store the entity, year and period of
+ * their JE.
+ * \returns         `true` if the current layout is denormalized or
+ * partitioned, `false` otherwise.
+ */
+bool db_jelines_denormalized(void);
+
 /*!
  * \brief           Creates the journal entry lines table in the database.
  * \returns         `true` on success, `false` on failure.
@@ -24,6 +68,23 @@ bool db_create_jelines_table(void);
  */
 bool db_drop_jelines_table(void);
 
+/*!
+ * \brief           Rebuilds the journal entry lines table in the current
+ * layout.
+ * \details         The lines are copied to a scratch table, and the table
+ * is dropped and recreated with the layout set by
+ * `db_set_jelines_layout()`. The lines are then copied back in key order,
+ * and the balance triggers, secondary indexes and all JEs view are
+ * recreated. The balance tables are unchanged. SQLite runs the whole
+ * migration in one transaction, but MySQL commits each table change as
+ * it is made, so if it fails part way the lines are left in the
+ * `jelines_copy` table. The JEs table is not rebuilt, so the table cannot
+ * be migrated to the partitioned layout, which must be set when the
+ * database structure is created.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_migrate_jelines_table(void);
+
 /*!
  * \brief           Creates a report listing all journal entry lines..
  * \returns         A ds_str containing the report.
@@ -6,13 +6,19 @@
  * of the GNU General Public License. <http://www.gnu.org/licenses/>
  */
 
+#include <stdio.h>
+#include <inttypes.h>
+
 #include "gl_general/gl_general.h"
 #include "db_internal.h"
 
 bool db_create_jes_table(void) {
     gl_log_msg("Creating jes table...");
     bool status = false;
-    ds_str query = ds_str_create(db_create_jes_table_sql());
+    ds_str query = ds_str_create(
+            db_get_jelines_layout() == DB_JELINES_PARTITIONED ?
+            db_create_partitioned_jes_table_sql() :
+            db_create_jes_table_sql());
     if ( query ) {
         status = db_execute_query(query);
         ds_str_destroy(query);
@@ -45,7 +51,9 @@ ds_str db_list_jes_report(void) {
 bool db_create_all_jes_view(void) {
     gl_log_msg("Creating all JEs view...");
     bool status = false;
-    ds_str query = ds_str_create(db_create_all_jes_view_sql());
+    ds_str query = ds_str_create(db_jelines_denormalized() ?
+                                 db_create_denormalized_all_jes_view_sql() :
+                                 db_create_all_jes_view_sql());
     if ( query ) {
         status = db_execute_query(query);
         ds_str_destroy(query);
@@ -66,6 +74,10 @@ bool db_drop_all_jes_view(void) {
 
 ds_str db_all_jes_report(ds_str je_num) {
     gl_log_msg("Running 'All JEs' report...");
+    if ( db_ledgerstore_ready() ) {
+        return db_ledgerstore_all_jes_report(je_num, NULL);
+    }
+
     ds_str report = NULL;
     ds_str query;
     
@@ -84,3 +96,58 @@ ds_str db_all_jes_report(ds_str je_num) {
     return report;
 }
 
+bool db_all_jes_report_paged(const uint64_t after_je, const uint64_t last_je,
+                             const size_t page_size,
+                             db_page_callback page_cb, void * ctx) {
+    gl_log_msg("Running paged 'All JEs' report...");
+
+    char size[32];
+    snprintf(size, sizeof size, "%zu", page_size);
+
+    bool status = true;
+    bool more = true;
+    uint64_t page_start = after_je;
+
+    while ( status && more && (!last_je || page_start < last_je) ) {
+        char start[32];
+        snprintf(start, sizeof start, "%" PRIu64, page_start);
+
+        uint64_t page_end = 0;
+        ds_str query = ds_str_create_sprintf(db_je_page_end_sql(),
+                                             start, size);
+        status = query && db_query_integer(query, &page_end);
+        if ( query ) {
+            ds_str_destroy(query);
+        }
+
+        /*  An empty page leaves the end at zero.  */
+
+        if ( !status || page_end <= page_start ) {
+            break;
+        }
+        if ( last_je && page_end > last_je ) {
+            page_end = last_je;
+        }
+
+        char end[32];
+        snprintf(end, sizeof end, "%" PRIu64, page_end);
+        query = ds_str_create_sprintf(db_all_jes_page_report_sql(),
+                                      start, end);
+        ds_str page = query ? db_create_report_from_query(query) : NULL;
+        if ( query ) {
+            ds_str_destroy(query);
+        }
+
+        if ( page ) {
+            more = page_cb(page, ctx);
+            ds_str_destroy(page);
+        }
+        else {
+            status = false;
+        }
+
+        page_start = page_end;
+    }
+
+    return status;
+}
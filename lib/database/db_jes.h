@@ -9,6 +9,8 @@
 #ifndef PG_GENERAL_LEDGER_DATABASE_DB_JES_H
 #define PG_GENERAL_LEDGER_DATABASE_DB_JES_H
 
+#include <stddef.h>
+#include <stdint.h>
 #include <stdbool.h>
 #include "datastruct/data_structures.h"
 
@@ -50,5 +52,33 @@ bool db_drop_all_jes_view(void);
  */
 ds_str db_all_jes_report(ds_str je_num);
 
+/*!
+ * \brief           Callback function for report pages.
+ * \param page      The page, which is destroyed after the call.
+ * \param ctx       The context pointer passed to the report function.
+ * \returns         `true` to continue with the next page, `false` to stop.
+ */
+typedef bool (*db_page_callback)(ds_str page, void * ctx);
+
+/*!
+ * \brief           Creates a report showing journal entries, a page at a
+ * time.
+ * \details         Each page holds the lines of up to `page_size` JEs, and
+ * is found from the last JE ID on the page before it rather than with an
+ * offset, so every page takes about the same time to fetch, and only one
+ * page is held in memory at once. Each page is passed to `page_cb` as it
+ * is fetched.
+ * \param after_je  The JE ID after which to start, or 0 to start from the
+ * first JE.
+ * \param last_je   The last JE ID to show, or 0 to show JEs up to the last.
+ * \param page_size The number of JEs on each page.
+ * \param page_cb   A function to call for each page.
+ * \param ctx       A pointer to pass to `page_cb`.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_all_jes_report_paged(const uint64_t after_je, const uint64_t last_je,
+                             const size_t page_size,
+                             db_page_callback page_cb, void * ctx);
+
 #endif      /*  PG_GENERAL_LEDGER_DATABASE_DB_JES_H  */
 
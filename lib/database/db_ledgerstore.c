@@ -0,0 +1,966 @@
+/*!
+ * \file            db_ledgerstore.c
+ * \brief           Implementation of the in-memory ledger store.
+ * \details         JE lines are held as parallel column arrays of entity
+ * code, account code and amount in cents, grouped by JE and ordered by
+ * account within each JE. Reports aggregate with single branch-free passes
+ * over these arrays, indexing dense result arrays by dictionary code, so
+ * no hashing or string comparison is done per line.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+/*!  UNIX feature test macro  */
+#define _XOPEN_SOURCE 600
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <time.h>
+
+#include "db_internal.h"
+#include "gl_general/gl_general.h"
+
+/*!  Code returned for a value not found in a dictionary  */
+#define NO_CODE UINT32_MAX
+
+/*!  Initial number of elements allocated for a loading array  */
+#define INITIAL_CAPACITY 256
+
+/*!  Entity dictionary entry  */
+struct store_entity {
+    int id;                     /*!<  Entity ID                 */
+    char * name;                /*!<  Entity name               */
+};
+
+/*!  Account dictionary entry  */
+struct store_account {
+    char * num;                 /*!<  Account number            */
+    char * description;         /*!<  Account description       */
+};
+
+/*!  Journal entry, used while loading  */
+struct store_je {
+    int id;                     /*!<  JE ID                     */
+    uint32_t entity;            /*!<  Entity code               */
+};
+
+/*!  JE line, used while loading  */
+struct store_line {
+    int je;                     /*!<  JE ID                     */
+    uint32_t account;           /*!<  Account code              */
+    int64_t amount;             /*!<  Amount in cents           */
+};
+
+/*!  Growable array, used while loading  */
+struct store_array {
+    void * data;                /*!<  The elements              */
+    size_t count;               /*!<  Number of elements        */
+    size_t capacity;            /*!<  Number allocated          */
+    size_t elem_size;           /*!<  Size of each element      */
+};
+
+/*!  Ledger store structure  */
+struct ledgerstore {
+    bool loaded;                    /*!<  `true` if loaded          */
+    struct store_entity * entities; /*!<  Entities, by ID           */
+    size_t num_entities;            /*!<  Number of entities        */
+    struct store_account * accounts;    /*!<  Accounts, by number   */
+    size_t num_accounts;            /*!<  Number of accounts        */
+    int * je_id;                    /*!<  JE ID column, ascending   */
+    uint32_t * je_entity;           /*!<  JE entity code column     */
+    size_t * je_first_line;         /*!<  First line of each JE,
+                                          with a final end entry    */
+    size_t num_jes;                 /*!<  Number of JEs             */
+    uint32_t * line_entity;         /*!<  Line entity code column   */
+    uint32_t * line_account;        /*!<  Line account code column  */
+    int64_t * line_amount;          /*!<  Line amount column, cents */
+    size_t num_lines;               /*!<  Number of lines           */
+};
+
+/*!  The ledger store  */
+static struct ledgerstore store;
+
+/*!  `true` if reports should use the store  */
+static bool store_enabled = false;
+
+/*!  `true` if loading the store has been attempted  */
+static bool load_attempted = false;
+
+/*!
+ * \brief           Appends an element to a growable array.
+ * \param array     The array.
+ * \returns         A pointer to the new element, or `NULL` on failure.
+ */
+static void * db_store_array_append(struct store_array * array);
+
+/*!
+ * \brief           Row callback which loads an entity.
+ * \param num_fields    The number of fields in the row.
+ * \param values    The field values.
+ * \param lengths   The field value lengths.
+ * \param ctx       The `struct store_array` of entities.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_store_entity_cb(const size_t num_fields,
+                               const char * const * values,
+                               const size_t * lengths, void * ctx);
+
+/*!
+ * \brief           Row callback which loads an account.
+ * \param num_fields    The number of fields in the row.
+ * \param values    The field values.
+ * \param lengths   The field value lengths.
+ * \param ctx       The `struct store_array` of accounts.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_store_account_cb(const size_t num_fields,
+                                const char * const * values,
+                                const size_t * lengths, void * ctx);
+
+/*!
+ * \brief           Row callback which loads a journal entry.
+ * \param num_fields    The number of fields in the row.
+ * \param values    The field values.
+ * \param lengths   The field value lengths.
+ * \param ctx       The `struct store_array` of JEs.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_store_je_cb(const size_t num_fields,
+                           const char * const * values,
+                           const size_t * lengths, void * ctx);
+
+/*!
+ * \brief           Row callback which loads a JE line.
+ * \param num_fields    The number of fields in the row.
+ * \param values    The field values.
+ * \param lengths   The field value lengths.
+ * \param ctx       The `struct store_array` of lines.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_store_line_cb(const size_t num_fields,
+                             const char * const * values,
+                             const size_t * lengths, void * ctx);
+
+/*!
+ * \brief           Runs a load query.
+ * \param cquery    The query.
+ * \param row_cb    The row callback.
+ * \param array     The array to pass to the row callback.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_store_load_query(const char * cquery, db_row_callback row_cb,
+                                struct store_array * array);
+
+/*!
+ * \brief           Builds the JE and line columns from loaded rows.
+ * \param jes       The loaded JEs.
+ * \param lines     The loaded lines.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_store_build_columns(struct store_array * jes,
+                                   struct store_array * lines);
+
+/*!
+ * \brief           Looks up an entity code by ID.
+ * \param id        The entity ID.
+ * \returns         The code, or `NO_CODE` if not found.
+ */
+static uint32_t db_store_entity_code(const int id);
+
+/*!
+ * \brief           Looks up an entity code from a string ID.
+ * \param entity    The entity ID.
+ * \returns         The code, or `NO_CODE` if not found.
+ */
+static uint32_t db_store_entity_code_str(ds_str entity);
+
+/*!
+ * \brief           Marks the entity codes selected by a filter.
+ * \details         With a subtree filter, every entity at or below the
+ * filter's entity is marked, using the in-memory entity closure, so that
+ * the report loops test one byte per row rather than walk the hierarchy.
+ * \param filter    The filter, which must have an entity.
+ * \returns         An array with one element per entity code, 1 for the
+ * selected entities and 0 for the others, or `NULL` on failure. The
+ * caller must free it.
+ */
+static uint8_t * db_store_entity_mask(const struct db_report_filter * filter);
+
+/*!
+ * \brief           Looks up an account code by number.
+ * \param num       The account number.
+ * \returns         The code, or `NO_CODE` if not found.
+ */
+static uint32_t db_store_account_code(const char * num);
+
+/*!
+ * \brief           Finds the account codes within a filter's account range.
+ * \details         Accounts are held in account number order, so the range
+ * is a contiguous run of codes.
+ * \param filter    The filter, or `NULL` for all accounts.
+ * \param first     Modified to contain the first code in the range.
+ * \param end       Modified to contain one past the last code in the range.
+ */
+static void db_store_account_range(const struct db_report_filter * filter,
+                                   uint32_t * first, uint32_t * end);
+
+/*!
+ * \brief           Finds the first account at or after an account number.
+ * \param num       The account number.
+ * \param inclusive `true` to include an account equal to `num`, `false`
+ * to find the first account after it.
+ * \returns         The code of the account, or the number of accounts if
+ * there is none.
+ */
+static uint32_t db_store_account_bound(const char * num,
+                                       const bool inclusive);
+
+/*!
+ * \brief           Looks up a JE row by ID.
+ * \param id        The JE ID.
+ * \returns         The row, or `num_jes` if not found.
+ */
+static size_t db_store_je_row(const int id);
+
+/*!
+ * \brief           Parses an integer field.
+ * \param value     The field value.
+ * \param length    The field length.
+ * \param result    Modified to contain the result.
+ * \returns         `true` on success, `false` if the field is not an
+ * integer.
+ */
+static bool db_store_parse_int(const char * value, const size_t length,
+                               int * result);
+
+/*!
+ * \brief           Creates a record set with the given field names.
+ * \param num_fields    The number of fields.
+ * \param names     The field names.
+ * \returns         The record set.
+ */
+static ds_recordset db_store_recordset(const size_t num_fields,
+                                       const char * const * names);
+
+/*!
+ * \brief           Converts a record set to a report and destroys it.
+ * \param set       The record set.
+ * \returns         The report.
+ */
+static ds_str db_store_report(ds_recordset set);
+
+/*!  Comparison function for sorting entities by ID  */
+static int db_store_compare_entities(const void * a, const void * b);
+
+/*!  Comparison function for sorting accounts by number  */
+static int db_store_compare_accounts(const void * a, const void * b);
+
+/*!  Comparison function for sorting JEs by ID  */
+static int db_store_compare_jes(const void * a, const void * b);
+
+void db_ledgerstore_enable(const bool enable) {
+    store_enabled = enable;
+}
+
+bool db_ledgerstore_ready(void) {
+    if ( !store_enabled ) {
+        return false;
+    }
+
+    if ( !store.loaded && !load_attempted ) {
+        load_attempted = true;
+        if ( !db_ledgerstore_load() ) {
+            gl_log_msg("Couldn't load ledger store, using SQL reports.");
+        }
+    }
+
+    return store.loaded;
+}
+
+bool db_ledgerstore_load(void) {
+    gl_log_msg("Loading ledger store...");
+    db_ledgerstore_free();
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    struct store_array entities = {NULL, 0, 0, sizeof(struct store_entity)};
+    struct store_array accounts = {NULL, 0, 0, sizeof(struct store_account)};
+    struct store_array jes = {NULL, 0, 0, sizeof(struct store_je)};
+    struct store_array lines = {NULL, 0, 0, sizeof(struct store_line)};
+
+    /*  Dictionaries are loaded and sorted first, so JEs and lines can
+     *  be encoded as they are streamed in.                             */
+
+    bool status = db_store_load_query(db_ledgerstore_entities_sql(),
+                                      db_store_entity_cb, &entities);
+    store.entities = entities.data;
+    store.num_entities = entities.count;
+    if ( status ) {
+        qsort(store.entities, store.num_entities, sizeof *store.entities,
+              db_store_compare_entities);
+        status = db_store_load_query(db_ledgerstore_nomaccts_sql(),
+                                     db_store_account_cb, &accounts);
+    }
+
+    store.accounts = accounts.data;
+    store.num_accounts = accounts.count;
+    if ( status ) {
+        qsort(store.accounts, store.num_accounts, sizeof *store.accounts,
+              db_store_compare_accounts);
+        status = db_store_load_query(db_ledgerstore_jes_sql(),
+                                     db_store_je_cb, &jes) &&
+                 db_store_load_query(db_ledgerstore_jelines_sql(),
+                                     db_store_line_cb, &lines);
+    }
+
+    status = status && db_store_build_columns(&jes, &lines);
+    free(jes.data);
+    free(lines.data);
+
+    if ( !status ) {
+        db_ledgerstore_free();
+        return false;
+    }
+
+    store.loaded = true;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed = (end.tv_sec - start.tv_sec) +
+                     (end.tv_nsec - start.tv_nsec) / 1e9;
+    gl_log_msg("Loaded %zu JEs and %zu lines into ledger store in %.2f "
+               "seconds.", store.num_jes, store.num_lines, elapsed);
+
+    return true;
+}
+
+void db_ledgerstore_free(void) {
+    for ( size_t i = 0; i < store.num_entities; ++i ) {
+        free(store.entities[i].name);
+    }
+    for ( size_t i = 0; i < store.num_accounts; ++i ) {
+        free(store.accounts[i].num);
+        free(store.accounts[i].description);
+    }
+
+    free(store.entities);
+    free(store.accounts);
+    free(store.je_id);
+    free(store.je_entity);
+    free(store.je_first_line);
+    free(store.line_entity);
+    free(store.line_account);
+    free(store.line_amount);
+
+    memset(&store, 0, sizeof store);
+}
+
+ds_str db_ledgerstore_current_trial_balance_report(ds_str entity,
+        const struct db_report_filter * filter) {
+    static const char * all_names[] = {
+        "Entity", "A/C No.", "Description", "Balance"
+    };
+    static const char * entity_names[] = {
+        "A/C No.", "Description", "Balance"
+    };
+
+    const size_t num_accounts = store.num_accounts;
+    const size_t num_lines = store.num_lines;
+    const uint32_t * line_entity = store.line_entity;
+    const uint32_t * line_account = store.line_account;
+    const int64_t * line_amount = store.line_amount;
+
+    const size_t limit = filter ? filter->limit : 0;
+    uint32_t first_account, end_account;
+    db_store_account_range(filter, &first_account, &end_account);
+
+    /*  A subtree is reported by entity, as for all entities, and the
+     *  entities outside it are left out as the report is built.        */
+
+    uint8_t * mask = NULL;
+    if ( entity && filter && filter->subtree ) {
+        mask = db_store_entity_mask(filter);
+        if ( !mask ) {
+            return NULL;
+        }
+        entity = NULL;
+    }
+
+    uint32_t code = entity ? db_store_entity_code_str(entity) : NO_CODE;
+    size_t num_cells = entity ? num_accounts
+                              : store.num_entities * num_accounts;
+
+    /*  One extra cell, so calloc() never sees a zero size.  */
+
+    int64_t * sums = calloc(num_cells + 1, sizeof *sums);
+    uint32_t * counts = calloc(num_cells + 1, sizeof *counts);
+    if ( !sums || !counts ) {
+        free(sums);
+        free(counts);
+        free(mask);
+        gl_log_msg("Couldn't allocate memory for trial balance.");
+        return NULL;
+    }
+
+    if ( !entity ) {
+        for ( size_t i = 0; i < num_lines; ++i ) {
+            const size_t cell = line_entity[i] * num_accounts +
+                                line_account[i];
+            sums[cell] += line_amount[i];
+            ++counts[cell];
+        }
+    }
+    else if ( code != NO_CODE ) {
+
+        /*  Mask rather than branch on the entity, so the loop runs at
+         *  the same speed whatever the mix of entities.                */
+
+        for ( size_t i = 0; i < num_lines; ++i ) {
+            const uint32_t match = line_entity[i] == code;
+            sums[line_account[i]] += line_amount[i] & -(int64_t) match;
+            counts[line_account[i]] += match;
+        }
+    }
+
+    ds_recordset set = entity ? db_store_recordset(3, entity_names)
+                              : db_store_recordset(4, all_names);
+
+    size_t num_rows = 0;
+    for ( size_t cell = 0; set && cell < num_cells &&
+                           (!limit || num_rows < limit); ++cell ) {
+        const size_t acct = cell % num_accounts;
+        if ( !counts[cell] || acct < first_account || acct >= end_account ||
+             (mask && !mask[cell / num_accounts]) ) {
+            continue;
+        }
+
+        const struct store_account * account = &store.accounts[acct];
+        ds_record record;
+        size_t field = 0;
+
+        if ( entity ) {
+            record = ds_record_create(3);
+        }
+        else {
+            record = ds_record_create(4);
+            ds_record_set_field(record, field++, ds_str_create_sprintf("%d",
+                    store.entities[cell / num_accounts].id));
+        }
+
+        ds_record_set_field(record, field++, ds_str_create(account->num));
+        ds_record_set_field(record, field++,
+                            ds_str_create(account->description));
+        ds_record_set_field(record, field++,
+                            db_format_cents(sums[cell]));
+        ds_recordset_add_record(set, record);
+        ++num_rows;
+    }
+
+    free(sums);
+    free(counts);
+    free(mask);
+
+    return db_store_report(set);
+}
+
+ds_str db_ledgerstore_check_total_report(ds_str entity) {
+    static const char * names[] = {"Entity", "Check Total"};
+
+    const size_t num_lines = store.num_lines;
+    const uint32_t * line_entity = store.line_entity;
+    const int64_t * line_amount = store.line_amount;
+
+    int64_t * totals = calloc(store.num_entities + 1, sizeof *totals);
+    uint32_t * counts = calloc(store.num_entities + 1, sizeof *counts);
+    if ( !totals || !counts ) {
+        free(totals);
+        free(counts);
+        gl_log_msg("Couldn't allocate memory for check total.");
+        return NULL;
+    }
+
+    for ( size_t i = 0; i < num_lines; ++i ) {
+        totals[line_entity[i]] += line_amount[i];
+        ++counts[line_entity[i]];
+    }
+
+    uint32_t code = entity ? db_store_entity_code_str(entity) : NO_CODE;
+    ds_recordset set = db_store_recordset(2, names);
+
+    for ( size_t e = 0; set && e < store.num_entities; ++e ) {
+        if ( !counts[e] || (entity && e != code) ) {
+            continue;
+        }
+
+        ds_record record = ds_record_create(2);
+        ds_record_set_field(record, 0,
+                ds_str_create_sprintf("%d", store.entities[e].id));
+        ds_record_set_field(record, 1, db_format_cents(totals[e]));
+        ds_recordset_add_record(set, record);
+    }
+
+    free(totals);
+    free(counts);
+
+    return db_store_report(set);
+}
+
+ds_str db_ledgerstore_all_jes_report(ds_str je_num,
+                                     const struct db_report_filter * filter) {
+    static const char * names[] = {
+        "JE", "En", "A/C No.", "Description", "Amount"
+    };
+
+    size_t first_je = 0;
+    size_t end_je = store.num_jes;
+
+    if ( je_num ) {
+        int id;
+        first_je = ds_str_intval(je_num, 10, &id) ? db_store_je_row(id)
+                                                  : store.num_jes;
+        end_je = first_je < store.num_jes ? first_je + 1 : first_je;
+    }
+
+    const bool by_entity = filter && filter->entity;
+    const uint32_t code = by_entity ?
+                          db_store_entity_code_str(filter->entity) : NO_CODE;
+    uint8_t * mask = NULL;
+    if ( by_entity && filter->subtree ) {
+        mask = db_store_entity_mask(filter);
+        if ( !mask ) {
+            return NULL;
+        }
+    }
+    const size_t limit = filter ? filter->limit : 0;
+    uint32_t first_account, end_account;
+    db_store_account_range(filter, &first_account, &end_account);
+
+    ds_recordset set = db_store_recordset(5, names);
+    size_t num_rows = 0;
+
+    for ( size_t j = first_je; set && j < end_je &&
+                               (!limit || num_rows < limit); ++j ) {
+        if ( mask ? !mask[store.je_entity[j]]
+                  : by_entity && store.je_entity[j] != code ) {
+            continue;
+        }
+
+        const int entity_id = store.entities[store.je_entity[j]].id;
+
+        for ( size_t i = store.je_first_line[j];
+              i < store.je_first_line[j + 1] &&
+              (!limit || num_rows < limit); ++i ) {
+            if ( store.line_account[i] < first_account ||
+                 store.line_account[i] >= end_account ) {
+                continue;
+            }
+
+            const struct store_account * account =
+                &store.accounts[store.line_account[i]];
+
+            ds_record record = ds_record_create(5);
+            ds_record_set_field(record, 0,
+                    ds_str_create_sprintf("%d", store.je_id[j]));
+            ds_record_set_field(record, 1,
+                    ds_str_create_sprintf("%d", entity_id));
+            ds_record_set_field(record, 2, ds_str_create(account->num));
+            ds_record_set_field(record, 3,
+                                ds_str_create(account->description));
+            ds_record_set_field(record, 4,
+                                db_format_cents(store.line_amount[i]));
+            ds_recordset_add_record(set, record);
+            ++num_rows;
+        }
+    }
+
+    free(mask);
+    return db_store_report(set);
+}
+
+ds_str db_ledgerstore_entity_name(ds_str entity_id) {
+    uint32_t code = db_store_entity_code_str(entity_id);
+
+    if ( code == NO_CODE ) {
+        return ds_str_create_sprintf("Unknown entity [%s]",
+                                     ds_str_cstr(entity_id));
+    }
+
+    return ds_str_create_sprintf("%s [%s]", store.entities[code].name,
+                                 ds_str_cstr(entity_id));
+}
+
+static void * db_store_array_append(struct store_array * array) {
+    if ( array->count == array->capacity ) {
+        size_t new_capacity = array->capacity ? array->capacity * 2
+                                              : INITIAL_CAPACITY;
+        void * new_data = realloc(array->data,
+                                  new_capacity * array->elem_size);
+        if ( !new_data ) {
+            gl_log_msg("Couldn't allocate memory for ledger store.");
+            return NULL;
+        }
+        array->data = new_data;
+        array->capacity = new_capacity;
+    }
+
+    return (char *) array->data + array->elem_size * array->count++;
+}
+
+static bool db_store_entity_cb(const size_t num_fields,
+                               const char * const * values,
+                               const size_t * lengths, void * ctx) {
+    (void)num_fields;
+
+    int id;
+    if ( !db_store_parse_int(values[0], lengths[0], &id) ) {
+        gl_log_msg("Bad entity ID in ledger store load.");
+        return false;
+    }
+
+    struct store_entity * entity = db_store_array_append(ctx);
+    if ( !entity ) {
+        return false;
+    }
+
+    entity->id = id;
+    entity->name = strdup(values[1] ? values[1] : "");
+    return entity->name != NULL;
+}
+
+static bool db_store_account_cb(const size_t num_fields,
+                                const char * const * values,
+                                const size_t * lengths, void * ctx) {
+    (void)num_fields;
+    (void)lengths;
+
+    struct store_account * account = db_store_array_append(ctx);
+    if ( !account ) {
+        return false;
+    }
+
+    account->num = strdup(values[0] ? values[0] : "");
+    account->description = strdup(values[1] ? values[1] : "");
+    return account->num && account->description;
+}
+
+static bool db_store_je_cb(const size_t num_fields,
+                           const char * const * values,
+                           const size_t * lengths, void * ctx) {
+    (void)num_fields;
+
+    int id, entity_id;
+    if ( !db_store_parse_int(values[0], lengths[0], &id) ||
+         !db_store_parse_int(values[1], lengths[1], &entity_id) ) {
+        gl_log_msg("Bad JE in ledger store load.");
+        return false;
+    }
+
+    uint32_t entity = db_store_entity_code(entity_id);
+    if ( entity == NO_CODE ) {
+        gl_log_msg("Skipping JE %d with unknown entity %d.", id, entity_id);
+        return true;
+    }
+
+    struct store_je * je = db_store_array_append(ctx);
+    if ( !je ) {
+        return false;
+    }
+
+    je->id = id;
+    je->entity = entity;
+    return true;
+}
+
+static bool db_store_line_cb(const size_t num_fields,
+                             const char * const * values,
+                             const size_t * lengths, void * ctx) {
+    (void)num_fields;
+
+    int je_id;
+    int64_t amount;
+    if ( !db_store_parse_int(values[0], lengths[0], &je_id) ||
+         !values[1] ||
+         !db_parse_cents(values[2], lengths[2], &amount) ) {
+        gl_log_msg("Bad JE line in ledger store load.");
+        return false;
+    }
+
+    uint32_t account = db_store_account_code(values[1]);
+    if ( account == NO_CODE ) {
+        gl_log_msg("Skipping JE %d line with unknown account %s.",
+                   je_id, values[1]);
+        return true;
+    }
+
+    struct store_line * line = db_store_array_append(ctx);
+    if ( !line ) {
+        return false;
+    }
+
+    line->je = je_id;
+    line->account = account;
+    line->amount = amount;
+    return true;
+}
+
+static bool db_store_load_query(const char * cquery, db_row_callback row_cb,
+                                struct store_array * array) {
+    ds_str query = ds_str_create(cquery);
+    bool status = db_query_foreach(query, NULL, row_cb, array);
+    ds_str_destroy(query);
+    return status;
+}
+
+static bool db_store_build_columns(struct store_array * jes,
+                                   struct store_array * lines) {
+    struct store_je * je_rows = jes->data;
+    struct store_line * line_rows = lines->data;
+    const size_t num_jes = jes->count;
+
+    qsort(je_rows, num_jes, sizeof *je_rows, db_store_compare_jes);
+
+    store.num_jes = num_jes;
+    store.je_id = malloc((num_jes + 1) * sizeof *store.je_id);
+    store.je_entity = malloc((num_jes + 1) * sizeof *store.je_entity);
+    store.je_first_line = calloc(num_jes + 1, sizeof *store.je_first_line);
+    if ( !store.je_id || !store.je_entity || !store.je_first_line ) {
+        gl_log_msg("Couldn't allocate memory for ledger store.");
+        return false;
+    }
+
+    for ( size_t j = 0; j < num_jes; ++j ) {
+        store.je_id[j] = je_rows[j].id;
+        store.je_entity[j] = je_rows[j].entity;
+    }
+
+    /*  Resolve each line's JE to a row, and count lines per JE.  */
+
+    size_t * line_je = malloc((lines->count + 1) * sizeof *line_je);
+    if ( !line_je ) {
+        gl_log_msg("Couldn't allocate memory for ledger store.");
+        return false;
+    }
+
+    size_t num_lines = 0;
+    for ( size_t i = 0; i < lines->count; ++i ) {
+        line_je[i] = db_store_je_row(line_rows[i].je);
+        if ( line_je[i] == num_jes ) {
+            gl_log_msg("Skipping line with unknown JE %d.", line_rows[i].je);
+        }
+        else {
+            ++store.je_first_line[line_je[i]];
+            ++num_lines;
+        }
+    }
+
+    size_t offset = 0;
+    for ( size_t j = 0; j <= num_jes; ++j ) {
+        size_t count = j < num_jes ? store.je_first_line[j] : 0;
+        store.je_first_line[j] = offset;
+        offset += count;
+    }
+
+    store.num_lines = num_lines;
+    store.line_entity = malloc((num_lines + 1) * sizeof *store.line_entity);
+    store.line_account = malloc((num_lines + 1) * sizeof *store.line_account);
+    store.line_amount = malloc((num_lines + 1) * sizeof *store.line_amount);
+    size_t * next = malloc((num_jes + 1) * sizeof *next);
+    if ( !store.line_entity || !store.line_account ||
+         !store.line_amount || !next ) {
+        free(line_je);
+        free(next);
+        gl_log_msg("Couldn't allocate memory for ledger store.");
+        return false;
+    }
+
+    /*  Scatter lines into their JE's range, then order each range by
+     *  account. Ranges are short, so an insertion sort is used.        */
+
+    memcpy(next, store.je_first_line, (num_jes + 1) * sizeof *next);
+
+    for ( size_t i = 0; i < lines->count; ++i ) {
+        const size_t j = line_je[i];
+        if ( j == num_jes ) {
+            continue;
+        }
+
+        size_t pos = next[j]++;
+        store.line_entity[pos] = je_rows[j].entity;
+
+        while ( pos > store.je_first_line[j] &&
+                store.line_account[pos - 1] > line_rows[i].account ) {
+            store.line_account[pos] = store.line_account[pos - 1];
+            store.line_amount[pos] = store.line_amount[pos - 1];
+            --pos;
+        }
+
+        store.line_account[pos] = line_rows[i].account;
+        store.line_amount[pos] = line_rows[i].amount;
+    }
+
+    free(line_je);
+    free(next);
+    return true;
+}
+
+static uint32_t db_store_entity_code(const int id) {
+    struct store_entity key = {id, NULL};
+    struct store_entity * found = bsearch(&key, store.entities,
+                                          store.num_entities,
+                                          sizeof *store.entities,
+                                          db_store_compare_entities);
+    return found ? (uint32_t) (found - store.entities) : NO_CODE;
+}
+
+static uint32_t db_store_entity_code_str(ds_str entity) {
+    int id;
+    if ( !ds_str_intval(entity, 10, &id) ) {
+        return NO_CODE;
+    }
+    return db_store_entity_code(id);
+}
+
+static uint8_t * db_store_entity_mask(const struct db_report_filter * filter) {
+    uint8_t * mask = calloc(store.num_entities + 1, sizeof *mask);
+    if ( !mask ) {
+        gl_log_msg("Couldn't allocate memory for entity mask.");
+        return NULL;
+    }
+
+    int id;
+    if ( ds_str_intval(filter->entity, 10, &id) ) {
+        for ( size_t e = 0; e < store.num_entities; ++e ) {
+            mask[e] = filter->subtree ?
+                      db_closure_contains(id, store.entities[e].id) :
+                      store.entities[e].id == id;
+        }
+    }
+    return mask;
+}
+
+static uint32_t db_store_account_code(const char * num) {
+    struct store_account key = {(char *) num, NULL};
+    struct store_account * found = bsearch(&key, store.accounts,
+                                           store.num_accounts,
+                                           sizeof *store.accounts,
+                                           db_store_compare_accounts);
+    return found ? (uint32_t) (found - store.accounts) : NO_CODE;
+}
+
+static void db_store_account_range(const struct db_report_filter * filter,
+                                   uint32_t * first, uint32_t * end) {
+    *first = 0;
+    *end = (uint32_t) store.num_accounts;
+
+    if ( filter && filter->first_account ) {
+        *first = db_store_account_bound(filter->first_account, true);
+    }
+    if ( filter && filter->last_account ) {
+        *end = db_store_account_bound(filter->last_account, false);
+    }
+}
+
+static uint32_t db_store_account_bound(const char * num,
+                                       const bool inclusive) {
+    size_t low = 0;
+    size_t high = store.num_accounts;
+
+    while ( low < high ) {
+        size_t mid = low + (high - low) / 2;
+        const int cmp = strcmp(store.accounts[mid].num, num);
+        if ( cmp < 0 || (!inclusive && cmp == 0) ) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+
+    return (uint32_t) low;
+}
+
+static size_t db_store_je_row(const int id) {
+    size_t low = 0;
+    size_t high = store.num_jes;
+
+    while ( low < high ) {
+        size_t mid = low + (high - low) / 2;
+        if ( store.je_id[mid] < id ) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+
+    return low < store.num_jes && store.je_id[low] == id ? low
+                                                         : store.num_jes;
+}
+
+static bool db_store_parse_int(const char * value, const size_t length,
+                               int * result) {
+    if ( !value || !length ) {
+        return false;
+    }
+
+    size_t i = 0;
+    bool negative = value[0] == '-';
+    if ( negative ) {
+        ++i;
+    }
+
+    if ( i == length ) {
+        return false;
+    }
+
+    long n = 0;
+    for ( ; i < length; ++i ) {
+        if ( value[i] < '0' || value[i] > '9' || n > INT32_MAX / 10 ) {
+            return false;
+        }
+        n = n * 10 + (value[i] - '0');
+    }
+
+    *result = (int) (negative ? -n : n);
+    return true;
+}
+
+static ds_recordset db_store_recordset(const size_t num_fields,
+                                       const char * const * names) {
+    ds_recordset set = NULL;
+    if ( !db_recordset_header_cb(num_fields, names, &set) ) {
+        gl_log_msg("Couldn't create record set.");
+        return NULL;
+    }
+    return set;
+}
+
+static ds_str db_store_report(ds_recordset set) {
+    if ( !set ) {
+        return NULL;
+    }
+    ds_str report = ds_recordset_get_text_report(set);
+    ds_recordset_destroy(set);
+    return report;
+}
+
+static int db_store_compare_entities(const void * a, const void * b) {
+    const struct store_entity * ea = a;
+    const struct store_entity * eb = b;
+    return (ea->id > eb->id) - (ea->id < eb->id);
+}
+
+static int db_store_compare_accounts(const void * a, const void * b) {
+    const struct store_account * aa = a;
+    const struct store_account * ab = b;
+    return strcmp(aa->num, ab->num);
+}
+
+static int db_store_compare_jes(const void * a, const void * b) {
+    const struct store_je * ja = a;
+    const struct store_je * jb = b;
+    return (ja->id > jb->id) - (ja->id < jb->id);
+}
@@ -0,0 +1,43 @@
+/*!
+ * \file            db_ledgerstore.h
+ * \brief           Interface to the in-memory ledger store.
+ * \details         The ledger store holds the journal entries, JE lines,
+ * nominal accounts and entities in memory as typed column arrays, with
+ * accounts and entities dictionary encoded as small integers. When it is
+ * enabled, the current trial balance, check total and all JEs reports are
+ * answered by scanning these arrays instead of by running SQL queries.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_DATABASE_DB_LEDGERSTORE_H
+#define PG_GENERAL_LEDGER_DATABASE_DB_LEDGERSTORE_H
+
+#include <stdbool.h>
+
+/*!
+ * \brief           Enables or disables the ledger store for reports.
+ * \details         When enabled, the store is loaded from the database the
+ * first time a report needs it. If it cannot be loaded, reports fall back
+ * to running SQL queries.
+ * \param enable    `true` to enable the store, `false` to disable it.
+ */
+void db_ledgerstore_enable(const bool enable);
+
+/*!
+ * \brief           Loads the ledger store from the database.
+ * \details         Any previously loaded store is freed first. The store
+ * is a snapshot, and does not see changes made after it is loaded.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_ledgerstore_load(void);
+
+/*!
+ * \brief           Frees the ledger store.
+ * \details         It is safe to call this function if the store is not
+ * loaded.
+ */
+void db_ledgerstore_free(void);
+
+#endif      /*  PG_GENERAL_LEDGER_DATABASE_DB_LEDGERSTORE_H  */
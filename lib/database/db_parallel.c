@@ -0,0 +1,115 @@
+/*!
+ * \file            db_parallel.c
+ * \brief           Implementation of parallel database task functionality.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <stdlib.h>
+#include <pthread.h>
+#include "gl_general/gl_general.h"
+#include "db_internal.h"
+
+/*!  Shared state for a set of parallel tasks  */
+struct db_parallel_state {
+    pthread_mutex_t lock;       /*!<  Protects the fields below     */
+    size_t next_task;           /*!<  Index of the next task to run */
+    size_t num_tasks;           /*!<  Number of tasks               */
+    db_task_func task;          /*!<  The task function             */
+    void * ctx;                 /*!<  The task context pointer      */
+    bool status;                /*!<  `false` if any task failed    */
+};
+
+/*!
+ * \brief           Runs tasks until none remain.
+ * \param state     The shared state.
+ */
+static void db_parallel_run_tasks(struct db_parallel_state * state);
+
+/*!
+ * \brief           Worker thread function.
+ * \details         Checks out a connection, runs tasks until none remain,
+ * and checks the connection back in.
+ * \param arg       A pointer to the shared state.
+ * \returns         `NULL`.
+ */
+static void * db_parallel_worker(void * arg);
+
+bool db_run_parallel(const size_t num_tasks, db_task_func task, void * ctx) {
+    struct db_parallel_state state;
+    pthread_mutex_init(&state.lock, NULL);
+    state.next_task = 0;
+    state.num_tasks = num_tasks;
+    state.task = task;
+    state.ctx = ctx;
+    state.status = true;
+
+    /*  The calling thread already has a connection, and runs tasks too,
+     *  so one fewer worker than the pool size is needed.               */
+
+    size_t num_workers = db_pool_size() > 1 ? db_pool_size() - 1 : 0;
+    if ( num_tasks && num_workers > num_tasks - 1 ) {
+        num_workers = num_tasks - 1;
+    }
+
+    pthread_t * workers = NULL;
+    if ( num_workers ) {
+        workers = malloc(num_workers * sizeof *workers);
+        if ( !workers ) {
+            num_workers = 0;
+        }
+    }
+
+    size_t started = 0;
+    while ( started < num_workers &&
+            !pthread_create(&workers[started], NULL,
+                            db_parallel_worker, &state) ) {
+        ++started;
+    }
+
+    db_parallel_run_tasks(&state);
+
+    for ( size_t i = 0; i < started; ++i ) {
+        pthread_join(workers[i], NULL);
+    }
+    free(workers);
+    pthread_mutex_destroy(&state.lock);
+
+    return state.status;
+}
+
+static void db_parallel_run_tasks(struct db_parallel_state * state) {
+    while ( true ) {
+        pthread_mutex_lock(&state->lock);
+        size_t index = state->next_task;
+        if ( index < state->num_tasks ) {
+            ++state->next_task;
+        }
+        pthread_mutex_unlock(&state->lock);
+
+        if ( index >= state->num_tasks ) {
+            break;
+        }
+
+        if ( !state->task(index, state->ctx) ) {
+            pthread_mutex_lock(&state->lock);
+            state->status = false;
+            pthread_mutex_unlock(&state->lock);
+        }
+    }
+}
+
+static void * db_parallel_worker(void * arg) {
+    struct db_parallel_state * state = arg;
+
+    /*  If no connection can be had, the remaining tasks are left to the
+     *  other threads.                                                  */
+
+    if ( db_pool_checkout() ) {
+        db_parallel_run_tasks(state);
+        db_pool_checkin();
+    }
+
+    return NULL;
+}
@@ -0,0 +1,387 @@
+/*!
+ * \file            db_partitions.c
+ * \brief           Implementation of year partition maintenance functionality.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <stdio.h>
+
+#include "gl_general/gl_general.h"
+#include "db_internal.h"
+
+/*!  The partitioned tables, with referencing tables first  */
+static const char * partitioned_tables[] = {"jelines", "jes", NULL};
+
+/*!  Number of partitioned tables  */
+#define NUM_PARTITIONED_TABLES \
+    (sizeof partitioned_tables / sizeof *partitioned_tables - 1)
+
+/*!
+ * \brief           Checks the partitioned JE lines layout is in use.
+ * \returns         `true` if it is, `false` otherwise.
+ */
+static bool db_check_partitioned_layout(void);
+
+/*!
+ * \brief           Runs and destroys a partition maintenance query.
+ * \param query     The query, or `NULL` if it could not be created.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_run_partition_query(ds_str query);
+
+/*!
+ * \brief           Runs and destroys a partition maintenance query which
+ * returns a single integer.
+ * \param query     The query, or `NULL` if it could not be created.
+ * \param value     Modified to contain the integer.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_partition_integer(ds_str query, uint64_t * value);
+
+/*!
+ * \brief           Checks if the partition for a year of a table exists.
+ * \details         Where tables are not partitioned, every year is treated
+ * as having a partition.
+ * \param table     The table name.
+ * \param year      The year.
+ * \param exists    Modified to contain `true` if the partition exists.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_partition_exists(const char * table, const int year,
+                                bool * exists);
+
+/*!
+ * \brief           Checks if the archive table for a year of a table
+ * exists.
+ * \param table     The table name.
+ * \param year      The year.
+ * \param exists    Modified to contain `true` if the archive table exists.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_archive_exists(const char * table, const int year,
+                              bool * exists);
+
+/*!
+ * \brief           Counts the rows for a year of a table and in its
+ * archive table.
+ * \param table     The table name.
+ * \param year      The year.
+ * \param rows      Modified to contain the rows for the year.
+ * \param archived  Modified to contain the rows in the archive table.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_count_archive_rows(const char * table, const int year,
+                                  uint64_t * rows, uint64_t * archived);
+
+/*!
+ * \brief           Moves the partition for a year of a table into its
+ * archive table.
+ * \details         Each step is skipped if an earlier run which failed part
+ * way already did it, so that running again finishes the move.
+ * \param table     The table name.
+ * \param year      The year.
+ * \param archived  `true` if the archive table already exists.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_archive_table_partition(const char * table, const int year,
+                                       const bool archived);
+
+bool db_add_partition(const int year) {
+    if ( !db_check_partitioned_layout() ) {
+        return false;
+    }
+
+    const char * format = db_add_partition_sql();
+    if ( !format ) {
+        gl_log_msg("Tables are not partitioned in this database, and "
+                   "years are clustered instead.");
+        return true;
+    }
+
+    /*  Each ALTER TABLE commits at once, so every table is checked before
+     *  any is changed. A table which already has the partition was done
+     *  by an earlier run which failed part way, and is skipped.          */
+
+    bool done[NUM_PARTITIONED_TABLES] = {false};
+    bool first[NUM_PARTITIONED_TABLES] = {false};
+    for ( size_t i = 0; partitioned_tables[i]; ++i ) {
+        const char * table = partitioned_tables[i];
+        uint64_t bound;
+        if ( !db_partition_exists(table, year, &done[i]) ||
+             !db_partition_integer(ds_str_create_sprintf(
+                        db_partition_bound_sql(), table), &bound) ) {
+            return false;
+        }
+
+        /*  The first partition is split off with a catch-all below it for
+         *  earlier years, so that dropping a year never removes others.   */
+
+        if ( !done[i] && bound && bound != (uint64_t) year ) {
+            gl_log_msg("The next partition of %s must be p%d.", table,
+                       (int) bound);
+            return false;
+        }
+        first[i] = !bound;
+    }
+
+    for ( size_t i = 0; partitioned_tables[i]; ++i ) {
+        if ( done[i] ) {
+            gl_log_msg("Table %s already has partition p%d.",
+                       partitioned_tables[i], year);
+            continue;
+        }
+
+        gl_log_msg("Adding partition p%d to %s...", year,
+                   partitioned_tables[i]);
+        ds_str query = first[i] ?
+            ds_str_create_sprintf(db_add_first_partition_sql(),
+                                  partitioned_tables[i], year, year,
+                                  year + 1) :
+            ds_str_create_sprintf(format, partitioned_tables[i],
+                                  year, year + 1);
+        if ( !db_run_partition_query(query) ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool db_drop_partition(const int year) {
+    if ( !db_check_partitioned_layout() ) {
+        return false;
+    }
+
+    /*  A table without the partition was done by an earlier run which
+     *  failed part way, and is skipped.                                */
+
+    bool exists[NUM_PARTITIONED_TABLES] = {false};
+    bool any = false;
+    for ( size_t i = 0; partitioned_tables[i]; ++i ) {
+        if ( !db_partition_exists(partitioned_tables[i], year,
+                                  &exists[i]) ) {
+            return false;
+        }
+        any = any || exists[i];
+    }
+    if ( !any ) {
+        gl_log_msg("There is no partition p%d to drop.", year);
+        return false;
+    }
+
+    if ( !db_begin_transaction() ) {
+        return false;
+    }
+
+    bool status = true;
+    for ( size_t i = 0; status && partitioned_tables[i]; ++i ) {
+        if ( exists[i] ) {
+            gl_log_msg("Dropping partition p%d from %s...", year,
+                       partitioned_tables[i]);
+            ds_str query = ds_str_create_sprintf(db_drop_partition_sql(),
+                                                 partitioned_tables[i],
+                                                 year);
+            status = db_run_partition_query(query);
+        }
+    }
+    status = status && db_bump_ledger_version();
+
+    if ( status ) {
+        status = db_commit_transaction();
+    }
+    else {
+        db_rollback_transaction();
+    }
+
+    return status;
+}
+
+bool db_archive_partition(const int year) {
+    if ( !db_check_partitioned_layout() ) {
+        return false;
+    }
+
+    /*  Every table is checked before any is changed. A table whose
+     *  partition is gone and whose archive table exists was done by an
+     *  earlier run which failed part way, and is skipped. A table with
+     *  both was stopped part way through, and is finished, unless both
+     *  hold rows, which no run leaves behind.                          */
+
+    bool exists[NUM_PARTITIONED_TABLES] = {false};
+    bool archived[NUM_PARTITIONED_TABLES] = {false};
+    for ( size_t i = 0; partitioned_tables[i]; ++i ) {
+        const char * table = partitioned_tables[i];
+        if ( !db_partition_exists(table, year, &exists[i]) ||
+             !db_archive_exists(table, year, &archived[i]) ) {
+            return false;
+        }
+
+        uint64_t rows, archived_rows;
+        if ( !exists[i] && !archived[i] ) {
+            gl_log_msg("Table %s has no partition p%d to archive.",
+                       table, year);
+            return false;
+        }
+        else if ( exists[i] && archived[i] ) {
+            if ( !db_count_archive_rows(table, year, &rows,
+                                        &archived_rows) ) {
+                return false;
+            }
+            if ( rows && archived_rows ) {
+                gl_log_msg("Both partition p%d of %s and %s_archive_%d "
+                           "hold rows.", year, table, table, year);
+                return false;
+            }
+        }
+    }
+
+    if ( !db_begin_transaction() ) {
+        return false;
+    }
+
+    bool status = true;
+    for ( size_t i = 0; status && partitioned_tables[i]; ++i ) {
+        if ( !exists[i] ) {
+            gl_log_msg("Partition p%d of %s is already archived.",
+                       year, partitioned_tables[i]);
+        }
+        else {
+            status = db_archive_table_partition(partitioned_tables[i], year,
+                                                archived[i]);
+        }
+    }
+    status = status && db_bump_ledger_version();
+
+    if ( status ) {
+        status = db_commit_transaction();
+    }
+    else {
+        db_rollback_transaction();
+    }
+
+    return status;
+}
+
+static bool db_check_partitioned_layout(void) {
+    if ( db_get_jelines_layout() != DB_JELINES_PARTITIONED ) {
+        gl_log_msg("Partition maintenance needs the partitioned JE lines "
+                   "layout.");
+        return false;
+    }
+    return true;
+}
+
+static bool db_run_partition_query(ds_str query) {
+    bool status = false;
+    if ( query ) {
+        status = db_execute_query(query);
+        ds_str_destroy(query);
+    }
+    return status;
+}
+
+static bool db_partition_integer(ds_str query, uint64_t * value) {
+    bool status = false;
+    if ( query ) {
+        status = db_query_integer(query, value);
+        ds_str_destroy(query);
+    }
+    return status;
+}
+
+static bool db_partition_exists(const char * table, const int year,
+                                bool * exists) {
+    const char * format = db_partition_exists_sql();
+    if ( !format ) {
+        *exists = true;
+        return true;
+    }
+
+    uint64_t count;
+    if ( !db_partition_integer(ds_str_create_sprintf(format, table, year),
+                               &count) ) {
+        return false;
+    }
+    *exists = count > 0;
+    return true;
+}
+
+static bool db_archive_exists(const char * table, const int year,
+                              bool * exists) {
+    char name[64];
+    snprintf(name, sizeof name, "%s_archive_%d", table, year);
+
+    uint64_t count;
+    if ( !db_partition_integer(ds_str_create_sprintf(db_table_exists_sql(),
+                                                     name), &count) ) {
+        return false;
+    }
+    *exists = count > 0;
+    return true;
+}
+
+static bool db_count_archive_rows(const char * table, const int year,
+                                  uint64_t * rows, uint64_t * archived) {
+    return db_partition_integer(ds_str_create_sprintf(
+                    db_count_year_rows_sql(), table, year), rows) &&
+           db_partition_integer(ds_str_create_sprintf(
+                    db_count_archive_rows_sql(), table, year), archived);
+}
+
+static bool db_archive_table_partition(const char * table, const int year,
+                                       const bool archived) {
+    gl_log_msg("Archiving partition p%d of %s to %s_archive_%d...",
+               year, table, table, year);
+
+    /*  MySQL exchanges the partition with an empty archive table,
+     *  which swaps their data without copying it, and drops the
+     *  emptied partition. SQLite copies the year into the archive
+     *  table, and deletes it. Each MySQL statement commits at once,
+     *  so each step checks whether a failed run already did it.   */
+
+    if ( !archived &&
+         !db_run_partition_query(
+                ds_str_create_sprintf(db_create_archive_table_sql(),
+                                      table, year, table, year)) ) {
+        return false;
+    }
+
+    const char * format = db_archive_partitioned_sql();
+    uint64_t partitioned = 0;
+    if ( format &&
+         !db_partition_integer(ds_str_create_sprintf(format, table, year),
+                               &partitioned) ) {
+        return false;
+    }
+
+    if ( partitioned &&
+         !db_run_partition_query(
+                ds_str_create_sprintf(db_remove_partitioning_sql(),
+                                      table, year)) ) {
+        return false;
+    }
+
+    uint64_t rows, archived_rows;
+    if ( !db_count_archive_rows(table, year, &rows, &archived_rows) ) {
+        return false;
+    }
+
+    if ( rows && archived_rows ) {
+        gl_log_msg("Both partition p%d of %s and %s_archive_%d hold rows.",
+                   year, table, table, year);
+        return false;
+    }
+
+    if ( rows &&
+         !db_run_partition_query(
+                ds_str_create_sprintf(db_exchange_partition_sql(),
+                                      table, year, table, year)) ) {
+        return false;
+    }
+
+    return db_run_partition_query(
+                ds_str_create_sprintf(db_drop_partition_sql(),
+                                      table, year));
+}
@@ -0,0 +1,57 @@
+/*!
+ * \file            db_partitions.h
+ * \brief           Interface to year partition maintenance functionality.
+ * \details         In the partitioned JE lines layout, the JEs and JE lines
+ * tables are partitioned on year. New partitions are split off the
+ * catch-all partition for later years, and must be added a year at a time
+ * in order. The first one added also splits off a catch-all partition for
+ * any earlier years, so each year partition holds exactly one year. A
+ * closed year can then be dropped, or moved into archive tables named
+ * `jes_archive_<year>` and `jelines_archive_<year>`. The balance tables
+ * are not changed, so they still include the years removed. On MySQL,
+ * each change to a table's partitions commits at once, so these functions
+ * are not atomic across tables. Every table is checked before any is
+ * changed, and if a function fails part way, calling it again with the
+ * same year finishes the tables not yet done.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_DATABASE_DB_PARTITIONS_H
+#define PG_GENERAL_LEDGER_DATABASE_DB_PARTITIONS_H
+
+#include <stdbool.h>
+
+/*!
+ * \brief           Adds the partition for a year.
+ * \details         The year must follow the last year partition, if any.
+ * SQLite does not partition tables, so this only checks the layout.
+ * \param year      The year.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_add_partition(const int year);
+
+/*!
+ * \brief           Drops the partition for a year, with its JEs and lines.
+ * \details         On SQLite, the year's rows are deleted.
+ * \param year      The year.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_drop_partition(const int year);
+
+/*!
+ * \brief           Moves the partition for a year into archive tables.
+ * \details         On MySQL, each partition is exchanged with an empty
+ * archive table, which moves no rows, and the emptied partition is then
+ * dropped. On SQLite, the year's rows are copied into the archive tables
+ * and deleted, all in one transaction. Each step, creating the archive
+ * table, exchanging the partition and dropping it, is skipped if a failed
+ * call already did it. Fails if a table's year partition and its archive
+ * table both hold rows.
+ * \param year      The year.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_archive_partition(const int year);
+
+#endif      /*  PG_GENERAL_LEDGER_DATABASE_DB_PARTITIONS_H  */
@@ -0,0 +1,205 @@
+/*!
+ * \file            db_periodbalances.c
+ * \brief           Implementation of period balances functionality.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <stdlib.h>
+#include <limits.h>
+#include "gl_general/gl_general.h"
+#include "db_internal.h"
+
+/*!  Entity ID list structure  */
+struct entity_ids {
+    int * ids;                  /*!<  The IDs                       */
+    size_t count;               /*!<  Number of IDs                 */
+    size_t capacity;            /*!<  Capacity of the ID array      */
+};
+
+/*!
+ * \brief           Row callback which adds an entity ID to a list.
+ * \param num_fields    The number of fields in the row.
+ * \param values    The field values.
+ * \param lengths   The field value lengths.
+ * \param ctx       A pointer to the `struct entity_ids` list.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_entity_id_cb(const size_t num_fields,
+                            const char * const * values,
+                            const size_t * lengths, void * ctx);
+
+/*!
+ * \brief           Rebuilds the period balances for one entity.
+ * \details         For use with `db_run_parallel()`.
+ * \param index     The index of the entity in the list.
+ * \param ctx       A pointer to the `struct entity_ids` list.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_rebuild_entity_period_balances(const size_t index,
+                                              void * ctx);
+
+bool db_create_period_balances_table(void) {
+    gl_log_msg("Creating period_balances table...");
+    bool status = false;
+    ds_str query = ds_str_create(db_create_period_balances_table_sql());
+    if ( query ) {
+        status = db_execute_query(query);
+        ds_str_destroy(query);
+    }
+    return status;
+}
+
+bool db_drop_period_balances_table(void) {
+    gl_log_msg("Dropping period_balances table...");
+    bool status = false;
+    ds_str query = ds_str_create(db_drop_period_balances_table_sql());
+    if ( query ) {
+        status = db_execute_query(query);
+        ds_str_destroy(query);
+    }
+    return status;
+}
+
+bool db_create_period_balances_trigger(void) {
+    gl_log_msg("Creating period balances trigger...");
+    bool status = false;
+    ds_str query = ds_str_create(db_jelines_denormalized() ?
+            db_create_denormalized_period_balances_trigger_sql() :
+            db_create_period_balances_trigger_sql());
+    if ( query ) {
+        status = db_execute_query(query);
+        ds_str_destroy(query);
+    }
+    return status;
+}
+
+bool db_drop_period_balances_trigger(void) {
+    gl_log_msg("Dropping period balances trigger...");
+    bool status = false;
+    ds_str query = ds_str_create(db_drop_period_balances_trigger_sql());
+    if ( query ) {
+        status = db_execute_query(query);
+        ds_str_destroy(query);
+    }
+    return status;
+}
+
+bool db_rebuild_period_balances(void) {
+    gl_log_msg("Rebuilding period balances...");
+
+    struct entity_ids entities = {NULL, 0, 0};
+    ds_str query = ds_str_create(db_list_entity_ids_sql());
+    bool status = db_query_foreach(query, NULL, db_entity_id_cb, &entities);
+    ds_str_destroy(query);
+
+    if ( status ) {
+        status = db_run_parallel(entities.count,
+                                 db_rebuild_entity_period_balances,
+                                 &entities);
+
+        /*  Each entity commits on its own, so the version changes even
+         *  if some fail.                                               */
+
+        status = db_bump_ledger_version() && status;
+    }
+
+    if ( status ) {
+        gl_log_msg("Rebuilt period balances for %zu entities.",
+                   entities.count);
+    }
+    else {
+        gl_log_msg("Couldn't rebuild period balances.");
+    }
+
+    free(entities.ids);
+    return status;
+}
+
+ds_str db_period_trial_balance_report(ds_str entity, ds_str year,
+                                      ds_str period) {
+    gl_log_msg("Creating 'period trial balance' report...");
+
+    /*  Without a period, every period of the year is included.  */
+
+    ds_str last_period = period ? ds_str_dup(period) :
+                                  ds_str_create_sprintf("%d", INT_MAX);
+    ds_str query;
+
+    if ( entity ) {
+        query = ds_str_create_sprintf(
+                    db_period_trial_balance_entity_report_sql(),
+                    ds_str_cstr(entity), ds_str_cstr(year),
+                    ds_str_cstr(year), ds_str_cstr(last_period));
+    }
+    else {
+        query = ds_str_create_sprintf(db_period_trial_balance_report_sql(),
+                                      ds_str_cstr(year), ds_str_cstr(year),
+                                      ds_str_cstr(last_period));
+    }
+
+    ds_str report = db_create_report_from_query(query);
+    ds_str_destroy(query);
+    ds_str_destroy(last_period);
+    return report;
+}
+
+static bool db_entity_id_cb(const size_t num_fields,
+                            const char * const * values,
+                            const size_t * lengths, void * ctx) {
+    (void)lengths;
+
+    struct entity_ids * entities = ctx;
+    if ( num_fields < 1 || !values[0] ) {
+        return true;
+    }
+
+    if ( entities->count == entities->capacity ) {
+        size_t capacity = entities->capacity ? entities->capacity * 2 : 16;
+        int * ids = realloc(entities->ids, capacity * sizeof *ids);
+        if ( !ids ) {
+            gl_log_msg("Couldn't allocate memory for entity list.");
+            return false;
+        }
+        entities->ids = ids;
+        entities->capacity = capacity;
+    }
+
+    entities->ids[entities->count++] = atoi(values[0]);
+    return true;
+}
+
+static bool db_rebuild_entity_period_balances(const size_t index,
+                                              void * ctx) {
+    struct entity_ids * entities = ctx;
+    ds_str entity = ds_str_create_sprintf("%d", entities->ids[index]);
+    ds_str clear = ds_str_create_sprintf(
+            db_clear_entity_period_balances_sql(), ds_str_cstr(entity));
+    ds_str rebuild = ds_str_create_sprintf(
+            db_jelines_denormalized() ?
+                db_rebuild_denormalized_entity_period_balances_sql() :
+                db_rebuild_entity_period_balances_sql(),
+            ds_str_cstr(entity));
+
+    bool status = db_begin_transaction();
+    if ( status ) {
+        status = db_execute_query(clear) && db_execute_query(rebuild);
+        if ( status ) {
+            status = db_commit_transaction();
+        }
+        else {
+            db_rollback_transaction();
+        }
+    }
+
+    if ( !status ) {
+        gl_log_msg("Couldn't rebuild period balances for entity %s.",
+                   ds_str_cstr(entity));
+    }
+
+    ds_str_destroy(rebuild);
+    ds_str_destroy(clear);
+    ds_str_destroy(entity);
+    return status;
+}
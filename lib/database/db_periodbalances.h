@@ -0,0 +1,62 @@
+/*!
+ * \file            db_periodbalances.h
+ * \brief           Interface to period balances functionality.
+ * \details         The period balances table holds the net movement on
+ * each account for each entity, year and period. Like the account
+ * balances table, it is kept up to date by a trigger on the journal entry
+ * lines table, so reports for a given year and period read one row per
+ * account and period instead of every line.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_DATABASE_DB_PERIODBALANCES_H
+#define PG_GENERAL_LEDGER_DATABASE_DB_PERIODBALANCES_H
+
+#include <stdbool.h>
+#include "datastruct/data_structures.h"
+
+/*!
+ * \brief           Creates the period balances table in the database.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_create_period_balances_table(void);
+
+/*!
+ * \brief           Drops the period balances table from the database.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_drop_period_balances_table(void);
+
+/*!
+ * \brief           Creates the trigger which maintains the period balances.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_create_period_balances_trigger(void);
+
+/*!
+ * \brief           Drops the trigger which maintains the period balances.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_drop_period_balances_trigger(void);
+
+/*!
+ * \brief           Rebuilds the period balances from the JE lines.
+ * \details         Each entity is rebuilt in its own transaction, and the
+ * entities are rebuilt concurrently on pooled connections.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_rebuild_period_balances(void);
+
+/*!
+ * \brief           Runs the trial balance report as at the end of a period.
+ * \param entity    The entity, or `NULL` for all entities.
+ * \param year      The year.
+ * \param period    The period, or `NULL` for the end of the year.
+ * \returns         The report.
+ */
+ds_str db_period_trial_balance_report(ds_str entity, ds_str year,
+                                      ds_str period);
+
+#endif      /*  PG_GENERAL_LEDGER_DATABASE_DB_PERIODBALANCES_H  */
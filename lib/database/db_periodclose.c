@@ -0,0 +1,419 @@
+/*!
+ * \file            db_periodclose.c
+ * \brief           Implementation of period-end and year-end close
+ * functionality.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gl_general/gl_general.h"
+#include "db_internal.h"
+
+/*!  Current period structure  */
+struct ledger_period {
+    int year;                   /*!<  Current year                  */
+    int period;                 /*!<  Current period                */
+    int num_periods;            /*!<  Number of periods in a year   */
+};
+
+/*!  Closing entry lines for one entity  */
+struct closing_entity {
+    int id;                     /*!<  Entity ID                     */
+    struct db_je_line * lines;  /*!<  The lines                     */
+    size_t num_lines;           /*!<  Number of lines               */
+    size_t capacity;            /*!<  Number of lines allocated     */
+};
+
+/*!  Closing entry list structure  */
+struct closing_list {
+    struct closing_entity * entities;   /*!<  The entities          */
+    size_t count;               /*!<  Number of entities            */
+    size_t capacity;            /*!<  Number of entities allocated  */
+    int year;                   /*!<  The year being closed         */
+};
+
+/*!
+ * \brief           Gets the current period from the standing data.
+ * \details         Inside a transaction, the period stays locked until
+ * the transaction ends.
+ * \param current   Modified to contain the current period.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_get_ledger_period(struct ledger_period * current);
+
+/*!
+ * \brief           Sets the current period in the standing data.
+ * \details         The ledger version is incremented with the change.
+ * \param year      The new current year.
+ * \param period    The new current period.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_set_ledger_period(const int year, const int period);
+
+/*!
+ * \brief           Reads the closing entry lines for one entity.
+ * \details         For use with `db_run_parallel()`. Each task writes only
+ * to its own entity.
+ * \param index     The index of the entity in the list.
+ * \param ctx       A pointer to the `struct closing_list` list.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_closing_entity_task(const size_t index, void * ctx);
+
+/*!
+ * \brief           Adds a line to an entity's closing entry.
+ * \param entity    The entity.
+ * \param account   The account number.
+ * \param amount    The amount in cents.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_closing_add_line(struct closing_entity * entity,
+                                const char * account, const int64_t amount);
+
+/*!
+ * \brief           Frees a closing entry list.
+ * \param list      The list.
+ */
+static void db_closing_list_free(struct closing_list * list);
+
+/*!
+ * \brief           Row callback which reads the current period.
+ * \param num_fields    The number of fields in the row.
+ * \param values    The field values.
+ * \param lengths   The field value lengths.
+ * \param ctx       A pointer to the `struct ledger_period` structure.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_ledger_period_cb(const size_t num_fields,
+                                const char * const * values,
+                                const size_t * lengths, void * ctx);
+
+/*!
+ * \brief           Row callback which adds an entity to a closing list.
+ * \param num_fields    The number of fields in the row.
+ * \param values    The field values.
+ * \param lengths   The field value lengths.
+ * \param ctx       A pointer to the `struct closing_list` list.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_closing_entity_cb(const size_t num_fields,
+                                 const char * const * values,
+                                 const size_t * lengths, void * ctx);
+
+/*!
+ * \brief           Row callback which adds an account balance to an
+ * entity's closing entry.
+ * \param num_fields    The number of fields in the row.
+ * \param values    The field values.
+ * \param lengths   The field value lengths.
+ * \param ctx       A pointer to the `struct closing_entity` entity.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_closing_balance_cb(const size_t num_fields,
+                                  const char * const * values,
+                                  const size_t * lengths, void * ctx);
+
+bool db_close_period(void) {
+    if ( !db_begin_transaction() ) {
+        return false;
+    }
+
+    struct ledger_period current;
+    bool status = db_get_ledger_period(&current);
+
+    if ( status && current.period >= current.num_periods ) {
+        gl_log_msg("Period %d is the last period of %d, so the year must "
+                   "be closed instead.", current.period, current.year);
+        status = false;
+    }
+    else if ( status ) {
+        gl_log_msg("Closing period %d of %d...", current.period,
+                   current.year);
+        status = db_set_ledger_period(current.year, current.period + 1);
+        if ( !status ) {
+            gl_log_msg("Couldn't close period %d of %d.",
+                       current.period, current.year);
+        }
+    }
+
+    if ( status ) {
+        status = db_commit_transaction();
+    }
+    else {
+        db_rollback_transaction();
+    }
+    return status;
+}
+
+bool db_close_year(const int user) {
+    int retained_earnings;
+    if ( !db_dimcache_ready() ||
+         !db_dimcache_account_id(DB_RETAINED_EARNINGS_ACCOUNT,
+                                 &retained_earnings) ) {
+        gl_log_msg("Couldn't find retained earnings account %s.",
+                   DB_RETAINED_EARNINGS_ACCOUNT);
+        return false;
+    }
+
+    if ( !db_begin_transaction() ) {
+        return false;
+    }
+
+    struct ledger_period current;
+    bool status = db_get_ledger_period(&current);
+
+    if ( status && current.period != current.num_periods ) {
+        gl_log_msg("Period %d of %d is open, so the year can't be closed "
+                   "until period %d.", current.period, current.year,
+                   current.num_periods);
+        db_rollback_transaction();
+        return false;
+    }
+    else if ( !status ) {
+        db_rollback_transaction();
+        return false;
+    }
+
+    gl_log_msg("Closing year %d...", current.year);
+
+    /*  The year is closed before its balances are read. Postings to it
+     *  which got in first hold the current period until they commit, so
+     *  the change waits for them and the balances include them. Later
+     *  ones wait for this transaction, and are then refused.           */
+
+    status = db_set_ledger_period(current.year + 1, 1);
+
+    struct closing_list list = {NULL, 0, 0, current.year};
+    ds_str query = status ? ds_str_create(db_list_entity_ids_sql()) : NULL;
+    status = query &&
+             db_query_foreach(query, NULL, db_closing_entity_cb, &list);
+    if ( query ) {
+        ds_str_destroy(query);
+    }
+
+    status = status &&
+             db_run_parallel(list.count, db_closing_entity_task, &list);
+
+    /*  Entities with nothing to close are left out of the batch.  */
+
+    struct db_je * jes = status ? calloc(list.count + 1, sizeof *jes) : NULL;
+    size_t num_jes = 0;
+    if ( status && !jes ) {
+        gl_log_msg("Couldn't allocate memory for closing entries.");
+        status = false;
+    }
+
+    for ( size_t e = 0; status && e < list.count; ++e ) {
+        if ( list.entities[e].num_lines ) {
+            struct db_je * je = &jes[num_jes++];
+            je->user = user;
+            je->period = current.num_periods;
+            je->year = current.year;
+            strcpy(je->source, DB_CLOSING_SOURCE);
+            je->entity = list.entities[e].id;
+            snprintf(je->memo, sizeof je->memo, "Year-end close %d",
+                     current.year);
+            je->num_lines = list.entities[e].num_lines;
+            je->lines = list.entities[e].lines;
+        }
+    }
+
+    status = status &&
+             (!num_jes || db_insert_closing_entries(jes, num_jes, NULL));
+
+    if ( status ) {
+        status = db_commit_transaction();
+    }
+    else {
+        db_rollback_transaction();
+    }
+
+    if ( status ) {
+        gl_log_msg("Closed %d with %zu closing entries for %zu entities.",
+                   current.year, num_jes, list.count);
+    }
+    else {
+        gl_log_msg("Couldn't close year %d.", current.year);
+    }
+
+    free(jes);
+    db_closing_list_free(&list);
+    return status;
+}
+
+bool db_get_current_period(int * year, int * period) {
+    struct ledger_period current;
+    if ( !db_get_ledger_period(&current) ) {
+        return false;
+    }
+    *year = current.year;
+    *period = current.period;
+    return true;
+}
+
+static bool db_get_ledger_period(struct ledger_period * current) {
+    memset(current, 0, sizeof *current);
+
+    ds_str query = ds_str_create(db_lock_standing_data_period_sql());
+    bool status = query &&
+                  db_query_foreach(query, NULL, db_ledger_period_cb, current);
+    if ( query ) {
+        ds_str_destroy(query);
+    }
+
+    if ( status && (current->year < 1 || current->period < 1 ||
+                    current->num_periods < 1) ) {
+        gl_log_msg("The standing data has no valid current period.");
+        status = false;
+    }
+    return status;
+}
+
+static bool db_set_ledger_period(const int year, const int period) {
+    char year_str[32], period_str[32];
+    snprintf(year_str, sizeof year_str, "%d", year);
+    snprintf(period_str, sizeof period_str, "%d", period);
+
+    ds_str query = ds_str_create_sprintf(db_set_standing_data_period_sql(),
+                                         year_str, period_str);
+    bool status = query && db_execute_query(query) &&
+                  db_bump_entity_ledger_version(NULL, 0);
+    if ( query ) {
+        ds_str_destroy(query);
+    }
+    return status;
+}
+
+static bool db_closing_entity_task(const size_t index, void * ctx) {
+    struct closing_list * list = ctx;
+    struct closing_entity * entity = &list->entities[index];
+
+    char entity_str[32], year_str[32];
+    snprintf(entity_str, sizeof entity_str, "%d", entity->id);
+    snprintf(year_str, sizeof year_str, "%d", list->year);
+
+    ds_str query = ds_str_create_sprintf(db_entity_closing_balances_sql(),
+                                         entity_str, year_str,
+                                         DB_FIRST_INCOME_ACCOUNT);
+    bool status = query && db_query_foreach(query, NULL,
+                                            db_closing_balance_cb, entity);
+    if ( query ) {
+        ds_str_destroy(query);
+    }
+
+    /*  The income and expense lines reverse the balances, so the
+     *  retained earnings line takes their total.                       */
+
+    int64_t total = 0;
+    for ( size_t i = 0; status && i < entity->num_lines; ++i ) {
+        total -= entity->lines[i].amount;
+    }
+    if ( status && total ) {
+        status = db_closing_add_line(entity, DB_RETAINED_EARNINGS_ACCOUNT,
+                                     total);
+    }
+
+    if ( !status ) {
+        gl_log_msg("Couldn't read closing balances for entity %d.",
+                   entity->id);
+    }
+    return status;
+}
+
+static bool db_closing_add_line(struct closing_entity * entity,
+                                const char * account, const int64_t amount) {
+    if ( strlen(account) > DB_ACCOUNT_MAX_LEN ) {
+        gl_log_msg("Account number '%s' is too long.", account);
+        return false;
+    }
+
+    if ( entity->num_lines == entity->capacity ) {
+        size_t capacity = entity->capacity ? entity->capacity * 2 : 8;
+        struct db_je_line * lines =
+            realloc(entity->lines, capacity * sizeof *lines);
+        if ( !lines ) {
+            gl_log_msg("Couldn't allocate memory for closing entry.");
+            return false;
+        }
+        entity->lines = lines;
+        entity->capacity = capacity;
+    }
+
+    struct db_je_line * line = &entity->lines[entity->num_lines++];
+    strcpy(line->account, account);
+    line->amount = amount;
+    return true;
+}
+
+static void db_closing_list_free(struct closing_list * list) {
+    for ( size_t e = 0; e < list->count; ++e ) {
+        free(list->entities[e].lines);
+    }
+    free(list->entities);
+    memset(list, 0, sizeof *list);
+}
+
+static bool db_ledger_period_cb(const size_t num_fields,
+                                const char * const * values,
+                                const size_t * lengths, void * ctx) {
+    (void)lengths;
+
+    struct ledger_period * current = ctx;
+    if ( num_fields < 3 || !values[0] || !values[1] || !values[2] ) {
+        return true;
+    }
+
+    current->year = atoi(values[0]);
+    current->period = atoi(values[1]);
+    current->num_periods = atoi(values[2]);
+    return true;
+}
+
+static bool db_closing_entity_cb(const size_t num_fields,
+                                 const char * const * values,
+                                 const size_t * lengths, void * ctx) {
+    (void)lengths;
+
+    struct closing_list * list = ctx;
+    if ( num_fields < 1 || !values[0] ) {
+        return true;
+    }
+
+    if ( list->count == list->capacity ) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 16;
+        struct closing_entity * entities =
+            realloc(list->entities, capacity * sizeof *entities);
+        if ( !entities ) {
+            gl_log_msg("Couldn't allocate memory for entity list.");
+            return false;
+        }
+        list->entities = entities;
+        list->capacity = capacity;
+    }
+
+    struct closing_entity * entity = &list->entities[list->count++];
+    memset(entity, 0, sizeof *entity);
+    entity->id = atoi(values[0]);
+    return true;
+}
+
+static bool db_closing_balance_cb(const size_t num_fields,
+                                  const char * const * values,
+                                  const size_t * lengths, void * ctx) {
+    if ( num_fields < 2 || !values[0] || !values[1] ) {
+        return true;
+    }
+
+    int64_t balance;
+    if ( !db_parse_cents(values[1], lengths[1], &balance) ) {
+        gl_log_msg("Bad balance '%s' for account %s.", values[1], values[0]);
+        return false;
+    }
+
+    return !balance || db_closing_add_line(ctx, values[0], -balance);
+}
@@ -0,0 +1,60 @@
+/*!
+ * \file            db_periodclose.h
+ * \brief           Interface to period-end and year-end close functionality.
+ * \details         The current year and period are kept in the
+ * `standing_data` table. Closing a period moves on to the next period of
+ * the year. Closing a year, which may only be done in its last period,
+ * posts a closing entry for each entity which zeroes the year's income and
+ * expense accounts into retained earnings, and moves on to the first
+ * period of the next year. Income and expense accounts are those numbered
+ * from `DB_FIRST_INCOME_ACCOUNT` on. The year is closed first, in a
+ * transaction which waits for postings already holding the current period
+ * to commit, and keeps later ones out until it ends, after which entries
+ * for the closed year are refused. The balances of the entities are then
+ * read concurrently on pooled connections, and the closing entries are
+ * posted in the same transaction.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_DATABASE_DB_PERIODCLOSE_H
+#define PG_GENERAL_LEDGER_DATABASE_DB_PERIODCLOSE_H
+
+#include <stdbool.h>
+
+/*!  Number of the first income or expense account  */
+#define DB_FIRST_INCOME_ACCOUNT "40000000"
+
+/*!  Number of the retained earnings account  */
+#define DB_RETAINED_EARNINGS_ACCOUNT "30003000"
+
+/*!  Source of closing entries  */
+#define DB_CLOSING_SOURCE "CLOSING"
+
+/*!
+ * \brief           Gets the current year and period.
+ * \param year      Modified to contain the current year.
+ * \param period    Modified to contain the current period.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_get_current_period(int * year, int * period);
+
+/*!
+ * \brief           Closes the current period.
+ * \details         The last period of a year is closed with
+ * `db_close_year()` instead.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_close_period(void);
+
+/*!
+ * \brief           Closes the current year.
+ * \details         The closing entries are posted in the last period of
+ * the year. An entity with no income or expense balances gets no entry.
+ * \param user      The ID of the user to post the closing entries as.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_close_year(const int user);
+
+#endif      /*  PG_GENERAL_LEDGER_DATABASE_DB_PERIODCLOSE_H  */
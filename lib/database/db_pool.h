@@ -0,0 +1,53 @@
+/*!
+ * \file            db_pool.h
+ * \brief           Interface to database connection pool functionality.
+ * \details         `db_connect()` opens a pool of connections and checks
+ * one out to the calling thread. Other threads must check out their own
+ * connection with `db_pool_checkout()` before running any queries, and
+ * check it back in with `db_pool_checkin()` when finished. Function
+ * implementations are provided by the individual database components.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_DATABASE_DB_POOL_H
+#define PG_GENERAL_LEDGER_DATABASE_DB_POOL_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/*!
+ * \brief           Sets the number of connections in the pool.
+ * \details         This must be called before `db_connect()` to have any
+ * effect. Connections are opened as they are first checked out.
+ * \param size      The maximum number of connections, or 0 to use the
+ * default of one connection.
+ */
+void db_set_pool_size(const size_t size);
+
+/*!
+ * \brief           Returns the number of connections in the pool.
+ * \returns         The maximum number of connections.
+ */
+size_t db_pool_size(void);
+
+/*!
+ * \brief           Checks out a connection to the calling thread.
+ * \details         If no connection is available, this function blocks
+ * until another thread checks one in. A connection which has been idle
+ * is checked, and reconnected if the server has closed it. If the calling
+ * thread already has a connection, this function does nothing.
+ * \returns         `true` on success, `false` if the pool is not open or
+ * a connection could not be made.
+ */
+bool db_pool_checkout(void);
+
+/*!
+ * \brief           Returns the calling thread's connection to the pool.
+ * \details         If the calling thread has no connection, this function
+ * does nothing.
+ */
+void db_pool_checkin(void);
+
+#endif      /*  PG_GENERAL_LEDGER_DATABASE_DB_POOL_H  */
@@ -0,0 +1,648 @@
+/*!
+ * \file            db_posting.c
+ * \brief           Implementation of journal entry posting functionality.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "db_internal.h"
+#include "file_ops/file_ops.h"
+#include "gl_general/gl_general.h"
+
+/*!  Fields of a journal entry file, in the order stored  */
+enum je_file_field {
+    JE_FIELD_REF,
+    JE_FIELD_USER,
+    JE_FIELD_PERIOD,
+    JE_FIELD_YEAR,
+    JE_FIELD_SOURCE,
+    JE_FIELD_ENTITY,
+    JE_FIELD_MEMO,
+    JE_FIELD_ACCOUNT,
+    JE_FIELD_AMOUNT,
+    JE_NUM_FIELDS
+};
+
+/*!  Current period, as read when checking entries  */
+struct open_period {
+    int year;                   /*!<  Current year                  */
+    int period;                 /*!<  Current period                */
+};
+
+/*!  Multi-row INSERT statement builder  */
+struct row_writer {
+    ds_str prefix;              /*!<  The INSERT ... VALUES prefix  */
+    ds_str query;               /*!<  The statement being built     */
+    size_t rows;                /*!<  Rows in the statement         */
+    size_t max_length;          /*!<  Maximum statement length      */
+};
+
+/*!
+ * \brief           Adds a row to a multi-row INSERT statement.
+ * \details         The statement is executed first if the row would take
+ * it over the maximum query length.
+ * \param writer    The statement builder.
+ * \param tuple     The row, as a parenthesized list of values.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_writer_add(struct row_writer * writer, ds_str tuple);
+
+/*!
+ * \brief           Executes any rows remaining in a multi-row INSERT.
+ * \param writer    The statement builder.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_writer_flush(struct row_writer * writer);
+
+/*!
+ * \brief           Quotes a string for use as an SQL literal.
+ * \details         Single quotes are doubled. Backslashes are treated
+ * differently by different databases, so are not allowed.
+ * \param str       The string.
+ * \returns         The quoted string, or `NULL` if the string contains a
+ * backslash.
+ */
+static ds_str db_quote_string(const char * str);
+
+/*!
+ * \brief           Copies a field into a fixed size buffer.
+ * \param dst       The buffer.
+ * \param dst_size  The size of the buffer.
+ * \param field     The field.
+ * \returns         `true` on success, `false` if the field is too long.
+ */
+static bool db_copy_field(char * dst, const size_t dst_size, ds_str field);
+
+/*!
+ * \brief           Checks whether a journal name is safe to use in SQL.
+ * \param journal   The journal name.
+ * \returns         `true` if the name is valid, `false` otherwise.
+ */
+static bool db_is_valid_journal_name(const char * journal);
+
+/*!
+ * \brief           Checks journal entries against the dimension cache.
+ * \details         Every user, source, entity and account must exist, so
+ * entries are rejected before anything is written rather than by a
+ * foreign key part way through an insert. Each problem found is logged.
+ * \param jes       The entries.
+ * \param num_jes   The number of entries.
+ * \returns         `true` if the entries are valid, `false` otherwise.
+ */
+static bool db_validate_journal_entries(const struct db_je * jes,
+                                        const size_t num_jes);
+
+/*!
+ * \brief           Row callback which reads the current period.
+ * \param num_fields    The number of fields in the row.
+ * \param values    The field values.
+ * \param lengths   The field value lengths.
+ * \param ctx       A pointer to the `struct open_period` structure.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_open_period_cb(const size_t num_fields,
+                              const char * const * values,
+                              const size_t * lengths, void * ctx);
+
+/*!
+ * \brief           Increments the ledger version for the entities of
+ * journal entries.
+ * \param jes       The entries.
+ * \param num_jes   The number of entries.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_bump_je_ledger_version(const struct db_je * jes,
+                                      const size_t num_jes);
+
+struct db_je * db_read_journal_entries(const char * filename,
+                                       size_t * num_jes) {
+    static const char * field_names[JE_NUM_FIELDS] = {
+        "ref", "user", "period", "year", "source",
+        "entity", "memo", "account", "amount"
+    };
+
+    *num_jes = 0;
+
+    ds_record headers = delim_file_read_headers(filename, ':');
+    if ( !headers ) {
+        gl_log_msg("Couldn't read field names from '%s'.", filename);
+        return NULL;
+    }
+
+    size_t index[JE_NUM_FIELDS];
+    bool status = true;
+    for ( size_t f = 0; f < JE_NUM_FIELDS; ++f ) {
+        index[f] = ds_record_size(headers);
+        for ( size_t i = 0; i < ds_record_size(headers); ++i ) {
+            if ( !ds_str_compare_cstr(ds_record_get_field(headers, i),
+                                      field_names[f]) ) {
+                index[f] = i;
+            }
+        }
+        if ( index[f] == ds_record_size(headers) ) {
+            gl_log_msg("No '%s' field in '%s'.", field_names[f], filename);
+            status = false;
+        }
+    }
+    ds_record_destroy(headers);
+
+    ds_recordset data = status ? delim_file_read(filename, ':') : NULL;
+    if ( !data ) {
+        return NULL;
+    }
+
+    const size_t num_records = ds_recordset_num_records(data);
+    struct db_je * jes = calloc(num_records + 1, sizeof *jes);
+    struct db_je_line * lines = calloc(num_records + 1, sizeof *lines);
+    if ( !jes || !lines ) {
+        free(jes);
+        free(lines);
+        ds_recordset_destroy(data);
+        gl_log_msg("Couldn't allocate memory for journal entries.");
+        return NULL;
+    }
+
+    /*  All lines share one allocation, owned by the first entry.  */
+
+    ds_str last_ref = NULL;
+    size_t line_num = 0;
+    size_t count = 0;
+    ds_record record;
+
+    ds_recordset_seek_start(data);
+    while ( status && (record = ds_recordset_next_record(data)) ) {
+        ds_str ref = ds_record_get_field(record, index[JE_FIELD_REF]);
+        struct db_je_line * line = &lines[line_num];
+
+        if ( !last_ref || ds_str_compare(ref, last_ref) ) {
+            struct db_je * je = &jes[count++];
+            je->lines = line;
+
+            status =
+                ds_str_intval(ds_record_get_field(record,
+                              index[JE_FIELD_USER]), 10, &je->user) &&
+                ds_str_intval(ds_record_get_field(record,
+                              index[JE_FIELD_PERIOD]), 10, &je->period) &&
+                ds_str_intval(ds_record_get_field(record,
+                              index[JE_FIELD_YEAR]), 10, &je->year) &&
+                ds_str_intval(ds_record_get_field(record,
+                              index[JE_FIELD_ENTITY]), 10, &je->entity) &&
+                db_copy_field(je->source, sizeof je->source,
+                    ds_record_get_field(record, index[JE_FIELD_SOURCE])) &&
+                db_copy_field(je->memo, sizeof je->memo,
+                    ds_record_get_field(record, index[JE_FIELD_MEMO]));
+            last_ref = ref;
+        }
+
+        ds_str amount = ds_record_get_field(record, index[JE_FIELD_AMOUNT]);
+        status = status &&
+                 db_copy_field(line->account, sizeof line->account,
+                     ds_record_get_field(record, index[JE_FIELD_ACCOUNT])) &&
+                 db_parse_cents(ds_str_cstr(amount), ds_str_length(amount),
+                                &line->amount);
+
+        if ( !status ) {
+            gl_log_msg("Bad journal entry line %zu in '%s'.",
+                       line_num + 1, filename);
+        }
+
+        ++jes[count - 1].num_lines;
+        ++line_num;
+    }
+
+    ds_recordset_destroy(data);
+
+    if ( !status || count == 0 ) {
+        free(lines);
+        free(jes);
+        return NULL;
+    }
+
+    *num_jes = count;
+    return jes;
+}
+
+void db_free_journal_entries(struct db_je * jes, const size_t num_jes) {
+    if ( jes ) {
+        if ( num_jes ) {
+            free(jes[0].lines);
+        }
+        free(jes);
+    }
+}
+
+bool db_journal_entries_balance(const struct db_je * jes,
+                                const size_t num_jes) {
+    bool status = true;
+    for ( size_t j = 0; j < num_jes; ++j ) {
+        int64_t total = 0;
+        for ( size_t i = 0; i < jes[j].num_lines; ++i ) {
+            total += jes[j].lines[i].amount;
+        }
+
+        if ( !jes[j].num_lines ) {
+            gl_log_msg("Journal entry %zu has no lines.", j + 1);
+            status = false;
+        }
+        else if ( total ) {
+            ds_str amount = db_format_cents(total);
+            gl_log_msg("Journal entry %zu is out of balance by %s.",
+                       j + 1, ds_str_cstr(amount));
+            ds_str_destroy(amount);
+            status = false;
+        }
+    }
+    return status;
+}
+
+bool db_post_journal_entries(const struct db_je * jes, const size_t num_jes,
+                             uint64_t * ids) {
+    if ( !db_reserve_je_ids(num_jes) || !db_begin_transaction() ) {
+        return false;
+    }
+
+    bool status = db_insert_journal_entries(jes, num_jes, ids);
+    if ( status ) {
+        status = db_commit_transaction();
+    }
+    else {
+        db_rollback_transaction();
+    }
+
+    if ( !status ) {
+        gl_log_msg("Couldn't post %zu journal entries.", num_jes);
+    }
+    return status;
+}
+
+bool db_journal_entries_open(const struct db_je * jes,
+                             const size_t num_jes) {
+    struct open_period current = {0, 0};
+    ds_str query = ds_str_create(db_lock_standing_data_period_sql());
+    bool status = query && db_query_foreach(query, NULL, db_open_period_cb,
+                                            &current);
+    if ( query ) {
+        ds_str_destroy(query);
+    }
+
+    if ( status && (current.year < 1 || current.period < 1) ) {
+        gl_log_msg("The standing data has no valid current period.");
+        status = false;
+    }
+
+    for ( size_t j = 0; status && j < num_jes; ++j ) {
+        if ( jes[j].year < current.year ||
+             (jes[j].year == current.year &&
+              jes[j].period < current.period) ) {
+            gl_log_msg("Journal entry %zu is for period %d of %d, which "
+                       "is closed.", j + 1, jes[j].period, jes[j].year);
+            status = false;
+        }
+    }
+
+    return status;
+}
+
+bool db_insert_journal_entries(const struct db_je * jes,
+                               const size_t num_jes, uint64_t * ids) {
+    return db_journal_entries_open(jes, num_jes) &&
+           db_insert_closing_entries(jes, num_jes, ids);
+}
+
+bool db_insert_closing_entries(const struct db_je * jes,
+                               const size_t num_jes, uint64_t * ids) {
+    if ( !db_journal_entries_balance(jes, num_jes) ||
+         !db_dimcache_ready() || !db_validate_journal_entries(jes, num_jes) ) {
+        return false;
+    }
+
+    uint64_t first_id = 0;
+    if ( !db_take_je_ids(num_jes, &first_id) ) {
+        return false;
+    }
+
+    bool status = true;
+
+    const bool denormalized = db_jelines_denormalized();
+    const size_t max_length = db_max_query_length();
+    struct row_writer je_writer = {
+        ds_str_create("INSERT INTO jes"
+                      " (id, user, period, year, source, entity, memo)"
+                      " VALUES "),
+        NULL, 0, max_length
+    };
+    struct row_writer line_writer = {
+        ds_str_create(denormalized ?
+                      "INSERT INTO jelines (je, line_no, entity, year,"
+                      " period, account, amount) VALUES " :
+                      "INSERT INTO jelines"
+                      " (je, line_no, account, amount) VALUES "),
+        NULL, 0, max_length
+    };
+    je_writer.query = ds_str_dup(je_writer.prefix);
+    line_writer.query = ds_str_dup(line_writer.prefix);
+
+    /*  All headers are written before any lines, so the lines' foreign
+     *  keys are satisfied.                                             */
+
+    for ( size_t j = 0; status && j < num_jes; ++j ) {
+        ds_str source = db_quote_string(jes[j].source);
+        ds_str memo = db_quote_string(jes[j].memo);
+
+        if ( !source || !memo ) {
+            gl_log_msg("Journal entry %zu contains a backslash.", j + 1);
+            status = false;
+        }
+        else {
+            ds_str tuple = ds_str_create_sprintf(
+                    "(%" PRIu64 ", %d, %d, %d, %s, %d, %s)",
+                    first_id + j, jes[j].user, jes[j].period,
+                    jes[j].year, ds_str_cstr(source), jes[j].entity,
+                    ds_str_cstr(memo));
+            status = db_writer_add(&je_writer, tuple);
+            ds_str_destroy(tuple);
+        }
+
+        if ( source ) {
+            ds_str_destroy(source);
+        }
+        if ( memo ) {
+            ds_str_destroy(memo);
+        }
+    }
+
+    status = status && db_writer_flush(&je_writer);
+
+    for ( size_t j = 0; status && j < num_jes; ++j ) {
+        for ( size_t i = 0; status && i < jes[j].num_lines; ++i ) {
+            int account = 0;
+            db_dimcache_account_id(jes[j].lines[i].account, &account);
+
+            ds_str amount = db_format_cents(jes[j].lines[i].amount);
+            ds_str tuple = denormalized ?
+                ds_str_create_sprintf(
+                    "(%" PRIu64 ", %zu, %d, %d, %d, %d, %s)",
+                    first_id + j, i + 1, jes[j].entity, jes[j].year,
+                    jes[j].period, account, ds_str_cstr(amount)) :
+                ds_str_create_sprintf(
+                    "(%" PRIu64 ", %zu, %d, %s)",
+                    first_id + j, i + 1, account, ds_str_cstr(amount));
+            status = db_writer_add(&line_writer, tuple);
+            ds_str_destroy(tuple);
+            ds_str_destroy(amount);
+        }
+    }
+
+    status = status && db_writer_flush(&line_writer) &&
+             db_bump_je_ledger_version(jes, num_jes);
+
+    for ( size_t j = 0; status && ids && j < num_jes; ++j ) {
+        ids[j] = first_id + j;
+    }
+
+    ds_str_destroy(je_writer.prefix);
+    ds_str_destroy(je_writer.query);
+    ds_str_destroy(line_writer.prefix);
+    ds_str_destroy(line_writer.query);
+
+    return status;
+}
+
+bool db_get_journal_checkpoint(const char * journal, uint64_t * seq) {
+    if ( !db_is_valid_journal_name(journal) ) {
+        return false;
+    }
+
+    ds_str query = ds_str_create_sprintf(db_get_journal_checkpoint_sql(),
+                                         journal);
+    bool status = db_query_integer(query, seq);
+    ds_str_destroy(query);
+    return status;
+}
+
+bool db_set_journal_checkpoint(const char * journal, const uint64_t seq) {
+    if ( !db_is_valid_journal_name(journal) ) {
+        return false;
+    }
+
+    ds_str seq_str = ds_str_create_sprintf("%" PRIu64, seq);
+    ds_str query = ds_str_create_sprintf(db_set_journal_checkpoint_sql(),
+                                         journal, ds_str_cstr(seq_str));
+    bool status = db_execute_query(query);
+    ds_str_destroy(query);
+    ds_str_destroy(seq_str);
+    return status;
+}
+
+bool db_create_posting_journal_table(void) {
+    gl_log_msg("Creating posting journal table...");
+    bool status = false;
+    ds_str query = ds_str_create(db_create_posting_journal_table_sql());
+    if ( query ) {
+        status = db_execute_query(query);
+        ds_str_destroy(query);
+    }
+    return status;
+}
+
+bool db_drop_posting_journal_table(void) {
+    gl_log_msg("Dropping posting journal table...");
+    bool status = false;
+    ds_str query = ds_str_create(db_drop_posting_journal_table_sql());
+    if ( query ) {
+        status = db_execute_query(query);
+        ds_str_destroy(query);
+    }
+    return status;
+}
+
+bool db_parse_cents(const char * value, const size_t length,
+                    int64_t * cents) {
+    if ( !value || !length ) {
+        return false;
+    }
+
+    size_t i = 0;
+    bool negative = value[0] == '-';
+    if ( negative || value[0] == '+' ) {
+        ++i;
+    }
+
+    int64_t units = 0;
+    bool digits = false;
+    while ( i < length && value[i] >= '0' && value[i] <= '9' ) {
+        if ( units > INT64_MAX / 1000 ) {
+            return false;
+        }
+        units = units * 10 + (value[i++] - '0');
+        digits = true;
+    }
+
+    int64_t fraction = 0;
+    int places = 0;
+    bool round_up = false;
+    if ( i < length && value[i] == '.' ) {
+        ++i;
+        while ( i < length && value[i] >= '0' && value[i] <= '9' ) {
+            if ( places < 2 ) {
+                fraction = fraction * 10 + (value[i] - '0');
+                ++places;
+            }
+            else if ( places++ == 2 ) {
+                round_up = value[i] >= '5';
+            }
+            ++i;
+            digits = true;
+        }
+    }
+
+    if ( !digits || i != length ) {
+        return false;
+    }
+
+    while ( places < 2 ) {
+        fraction *= 10;
+        ++places;
+    }
+
+    int64_t result = units * 100 + fraction + (round_up ? 1 : 0);
+    *cents = negative ? -result : result;
+    return true;
+}
+
+ds_str db_format_cents(const int64_t cents) {
+    uint64_t magnitude = cents < 0 ? -(uint64_t) cents : (uint64_t) cents;
+    return ds_str_create_sprintf("%s%" PRIu64 ".%02" PRIu64,
+                                 cents < 0 ? "-" : "",
+                                 magnitude / 100, magnitude % 100);
+}
+
+static bool db_writer_add(struct row_writer * writer, ds_str tuple) {
+    if ( writer->rows &&
+         ds_str_length(writer->query) + ds_str_length(tuple) + 1 >=
+             writer->max_length &&
+         !db_writer_flush(writer) ) {
+        return false;
+    }
+
+    if ( writer->rows++ ) {
+        ds_str_concat_cstr(writer->query, ",");
+    }
+    ds_str_concat(writer->query, tuple);
+    return true;
+}
+
+static bool db_writer_flush(struct row_writer * writer) {
+    if ( !writer->rows ) {
+        return true;
+    }
+
+    bool status = db_execute_query(writer->query);
+    ds_str_assign(writer->query, writer->prefix);
+    writer->rows = 0;
+    return status;
+}
+
+static ds_str db_quote_string(const char * str) {
+    if ( strchr(str, '\\') ) {
+        return NULL;
+    }
+
+    ds_str quoted = ds_str_create("'");
+    const char * p;
+    while ( (p = strchr(str, '\'')) ) {
+        ds_str part = ds_str_create_sprintf("%.*s''", (int) (p - str), str);
+        ds_str_concat(quoted, part);
+        ds_str_destroy(part);
+        str = p + 1;
+    }
+    ds_str_concat_cstr(quoted, str);
+    ds_str_concat_cstr(quoted, "'");
+
+    return quoted;
+}
+
+static bool db_copy_field(char * dst, const size_t dst_size, ds_str field) {
+    if ( !field || ds_str_length(field) >= dst_size ) {
+        return false;
+    }
+
+    memcpy(dst, ds_str_cstr(field), ds_str_length(field) + 1);
+    return true;
+}
+
+static bool db_is_valid_journal_name(const char * journal) {
+    if ( !journal || !*journal || strpbrk(journal, "'\\") ) {
+        gl_log_msg("Invalid journal name.");
+        return false;
+    }
+    return true;
+}
+
+static bool db_validate_journal_entries(const struct db_je * jes,
+                                        const size_t num_jes) {
+    bool status = true;
+    for ( size_t j = 0; j < num_jes; ++j ) {
+        if ( !db_dimcache_has_user(jes[j].user) ) {
+            gl_log_msg("Journal entry %zu has unknown user %d.",
+                       j + 1, jes[j].user);
+            status = false;
+        }
+        if ( !db_dimcache_has_source(jes[j].source) ) {
+            gl_log_msg("Journal entry %zu has unknown source %s.",
+                       j + 1, jes[j].source);
+            status = false;
+        }
+        if ( !db_dimcache_has_entity(jes[j].entity) ) {
+            gl_log_msg("Journal entry %zu has unknown entity %d.",
+                       j + 1, jes[j].entity);
+            status = false;
+        }
+
+        int account;
+        for ( size_t i = 0; i < jes[j].num_lines; ++i ) {
+            if ( !db_dimcache_account_id(jes[j].lines[i].account,
+                                         &account) ) {
+                gl_log_msg("Journal entry %zu has unknown account %s.",
+                           j + 1, jes[j].lines[i].account);
+                status = false;
+            }
+        }
+    }
+    return status;
+}
+
+static bool db_open_period_cb(const size_t num_fields,
+                              const char * const * values,
+                              const size_t * lengths, void * ctx) {
+    (void)lengths;
+
+    struct open_period * current = ctx;
+    if ( num_fields >= 2 && values[0] && values[1] ) {
+        current->year = atoi(values[0]);
+        current->period = atoi(values[1]);
+    }
+    return true;
+}
+
+static bool db_bump_je_ledger_version(const struct db_je * jes,
+                                      const size_t num_jes) {
+    int * entities = malloc((num_jes + 1) * sizeof *entities);
+    if ( !entities ) {
+        gl_log_msg("Couldn't allocate memory for entity list.");
+        return false;
+    }
+
+    for ( size_t j = 0; j < num_jes; ++j ) {
+        entities[j] = jes[j].entity;
+    }
+
+    const bool status = db_bump_entity_ledger_version(entities, num_jes);
+    free(entities);
+    return status;
+}
@@ -0,0 +1,156 @@
+/*!
+ * \file            db_posting.h
+ * \brief           Interface to journal entry posting functionality.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_DATABASE_DB_POSTING_H
+#define PG_GENERAL_LEDGER_DATABASE_DB_POSTING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*!  Maximum length of an account number  */
+#define DB_ACCOUNT_MAX_LEN 20
+
+/*!  Maximum length of a JE source name  */
+#define DB_SOURCE_MAX_LEN 10
+
+/*!  Maximum length of a JE memo  */
+#define DB_MEMO_MAX_LEN 100
+
+/*!  Journal entry line structure  */
+struct db_je_line {
+    char account[DB_ACCOUNT_MAX_LEN + 1];   /*!<  Account number        */
+    int64_t amount;                         /*!<  Amount in cents       */
+};
+
+/*!  Journal entry structure  */
+struct db_je {
+    int user;                               /*!<  Posting user ID       */
+    int period;                             /*!<  Accounting period     */
+    int year;                               /*!<  Accounting year       */
+    char source[DB_SOURCE_MAX_LEN + 1];     /*!<  JE source name        */
+    int entity;                             /*!<  Entity ID             */
+    char memo[DB_MEMO_MAX_LEN + 1];         /*!<  Memo                  */
+    size_t num_lines;                       /*!<  Number of lines       */
+    struct db_je_line * lines;              /*!<  The lines             */
+};
+
+/*!
+ * \brief           Reads journal entries from a file.
+ * \details         The file is in the same format as the sample data
+ * files, with the fields `ref`, `user`, `period`, `year`, `source`,
+ * `entity`, `memo`, `account` and `amount`. Consecutive lines with the
+ * same `ref` make up one journal entry.
+ * \param filename  The filename.
+ * \param num_jes   Modified to contain the number of entries read.
+ * \returns         An array of entries, which should be freed with
+ * `db_free_journal_entries()`, or `NULL` on failure or if the file
+ * contains no entries.
+ */
+struct db_je * db_read_journal_entries(const char * filename,
+                                       size_t * num_jes);
+
+/*!
+ * \brief           Frees an array of journal entries.
+ * \param jes       The entries.
+ * \param num_jes   The number of entries.
+ */
+void db_free_journal_entries(struct db_je * jes, const size_t num_jes);
+
+/*!
+ * \brief           Checks that journal entries balance.
+ * \details         Each entry must have at least one line, and its lines
+ * must sum to zero. Each entry which does not is logged.
+ * \param jes       The entries.
+ * \param num_jes   The number of entries.
+ * \returns         `true` if every entry balances, `false` otherwise.
+ */
+bool db_journal_entries_balance(const struct db_je * jes,
+                                const size_t num_jes);
+
+/*!
+ * \brief           Checks that journal entries are not for closed periods.
+ * \details         Each entry must be for the current period, or a later
+ * one. Each entry which is not is logged. Inside a transaction, the
+ * current period stays locked until the transaction ends, so it cannot be
+ * closed before the entries are committed.
+ * \param jes       The entries.
+ * \param num_jes   The number of entries.
+ * \returns         `true` if no entry is for a closed period, `false`
+ * otherwise, or on failure.
+ */
+bool db_journal_entries_open(const struct db_je * jes,
+                             const size_t num_jes);
+
+/*!
+ * \brief           Posts journal entries to the database.
+ * \details         As `db_insert_journal_entries()`, except that the
+ * entries are written in a transaction of their own, and are either all
+ * posted or, on failure, none are.
+ * \param jes       The entries.
+ * \param num_jes   The number of entries.
+ * \param ids       Modified to contain the ID given to each entry, in
+ * order, or `NULL` if the IDs are not needed.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_post_journal_entries(const struct db_je * jes, const size_t num_jes,
+                             uint64_t * ids);
+
+/*!
+ * \brief           Inserts journal entries into the database.
+ * \details         Entries are given the next free JE IDs, and are written
+ * with multi-row INSERT statements. The entries are checked to balance,
+ * and their users, sources, entities and accounts are checked against the
+ * dimension cache, and checked by `db_journal_entries_open()` not to be
+ * for a closed period, before anything is written, and any problem fails
+ * the insert. Account numbers are translated to account IDs through the same
+ * cache. The ledger version is incremented with the entries. This
+ * function must be called inside a transaction, which locks the JE IDs
+ * until it is committed.
+ * \param jes       The entries.
+ * \param num_jes   The number of entries.
+ * \param ids       Modified to contain the ID given to each entry, in
+ * order, or `NULL` if the IDs are not needed.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_insert_journal_entries(const struct db_je * jes,
+                               const size_t num_jes, uint64_t * ids);
+
+/*!
+ * \brief           Gets the sequence number forwarded from a posting journal.
+ * \param journal   The journal name.
+ * \param seq       Modified to contain the last sequence number committed
+ * to the database, or 0 if none has been.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_get_journal_checkpoint(const char * journal, uint64_t * seq);
+
+/*!
+ * \brief           Records the sequence number forwarded from a journal.
+ * \details         This should be called in the same transaction as the
+ * `db_insert_journal_entries()` call for the entries, so that they are
+ * committed together.
+ * \param journal   The journal name.
+ * \param seq       The last sequence number forwarded.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_set_journal_checkpoint(const char * journal, const uint64_t seq);
+
+/*!
+ * \brief           Creates the posting journal table in the database.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_create_posting_journal_table(void);
+
+/*!
+ * \brief           Drops the posting journal table from the database.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_drop_posting_journal_table(void);
+
+#endif      /*  PG_GENERAL_LEDGER_DATABASE_DB_POSTING_H  */
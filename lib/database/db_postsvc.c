@@ -0,0 +1,328 @@
+/*!
+ * \file            db_postsvc.c
+ * \brief           Implementation of the in-process posting service.
+ * \details         Each submitting thread queues a request on its stack
+ * and waits on the request's own condition variable. The shard's thread
+ * takes up to a batch of requests off the queue, copies their entries into
+ * one array, and posts them without holding the lock, then marks each
+ * request done and wakes only the thread which submitted it.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+/*!  UNIX feature test macro  */
+#define _XOPEN_SOURCE 600
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "gl_general/gl_general.h"
+#include "db_internal.h"
+
+/*!  Queued posting request  */
+struct postsvc_request {
+    struct postsvc_request * next;  /*!<  Next request in the queue     */
+    const struct db_je * je;        /*!<  The entry                     */
+    uint64_t id;                    /*!<  The ID given to the entry     */
+    bool done;                      /*!<  `true` once posted or failed  */
+    bool status;                    /*!<  `true` if posted              */
+    pthread_cond_t posted;          /*!<  Signaled when the request is
+                                          done                          */
+};
+
+/*!  Posting service shard  */
+struct postsvc_shard {
+    struct db_postsvc * svc;        /*!<  The service                   */
+    pthread_t thread;               /*!<  The shard's posting thread    */
+    pthread_mutex_t lock;           /*!<  Lock for the queue            */
+    pthread_cond_t queued;          /*!<  Signaled when a request is
+                                          queued, or on closing         */
+    struct postsvc_request * head;  /*!<  First queued request          */
+    struct postsvc_request * tail;  /*!<  Last queued request           */
+    size_t num_queued;              /*!<  Number of queued requests     */
+    bool closing;                   /*!<  `true` when the service stops */
+    struct db_postsvc_stats stats;  /*!<  Shard statistics              */
+};
+
+/*!  Posting service structure  */
+struct db_postsvc {
+    struct postsvc_shard * shards;  /*!<  The shards                    */
+    size_t num_shards;              /*!<  Number of shards              */
+    size_t num_started;             /*!<  Number of threads started     */
+    size_t max_batch;               /*!<  Maximum entries per batch     */
+    long window_us;                 /*!<  Batch window in microseconds  */
+};
+
+/*!
+ * \brief           Shard thread function.
+ * \param arg       A pointer to the shard.
+ * \returns         `NULL`.
+ */
+static void * db_postsvc_thread(void * arg);
+
+/*!
+ * \brief           Waits for the batch window to end or the batch to fill.
+ * \details         Must be called with the shard lock held.
+ * \param shard     The shard.
+ */
+static void db_postsvc_wait_window(struct postsvc_shard * shard);
+
+/*!
+ * \brief           Posts a batch of requests.
+ * \details         Called without the shard lock held.
+ * \param shard     The shard.
+ * \param batch     The first request of the batch.
+ * \param count     The number of requests in the batch.
+ */
+static void db_postsvc_post_batch(struct postsvc_shard * shard,
+                                  struct postsvc_request * batch,
+                                  const size_t count);
+
+db_postsvc db_postsvc_open(const size_t num_shards, const size_t max_batch,
+                           const long window_us) {
+    struct db_postsvc * svc = calloc(1, sizeof *svc);
+    if ( !svc || !num_shards ||
+         !(svc->shards = calloc(num_shards, sizeof *svc->shards)) ) {
+        gl_log_msg("Couldn't allocate memory for posting service.");
+        free(svc);
+        return NULL;
+    }
+
+    svc->num_shards = num_shards;
+    svc->max_batch = max_batch ? max_batch : DB_POSTSVC_DEFAULT_MAX_BATCH;
+    svc->window_us = window_us;
+
+    for ( size_t s = 0; s < num_shards; ++s ) {
+        struct postsvc_shard * shard = &svc->shards[s];
+        shard->svc = svc;
+        pthread_mutex_init(&shard->lock, NULL);
+        pthread_cond_init(&shard->queued, NULL);
+    }
+
+    for ( ; svc->num_started < num_shards; ++svc->num_started ) {
+        if ( pthread_create(&svc->shards[svc->num_started].thread, NULL,
+                            db_postsvc_thread,
+                            &svc->shards[svc->num_started]) ) {
+            gl_log_msg("Couldn't start posting service thread.");
+            db_postsvc_close(svc);
+            return NULL;
+        }
+    }
+
+    return svc;
+}
+
+void db_postsvc_close(db_postsvc svc) {
+    if ( !svc ) {
+        return;
+    }
+
+    for ( size_t s = 0; s < svc->num_started; ++s ) {
+        struct postsvc_shard * shard = &svc->shards[s];
+        pthread_mutex_lock(&shard->lock);
+        shard->closing = true;
+        pthread_cond_signal(&shard->queued);
+        pthread_mutex_unlock(&shard->lock);
+        pthread_join(shard->thread, NULL);
+    }
+
+    for ( size_t s = 0; s < svc->num_shards; ++s ) {
+        struct postsvc_shard * shard = &svc->shards[s];
+        pthread_cond_destroy(&shard->queued);
+        pthread_mutex_destroy(&shard->lock);
+    }
+
+    free(svc->shards);
+    free(svc);
+}
+
+bool db_postsvc_post(db_postsvc svc, const struct db_je * je, uint64_t * id) {
+    struct postsvc_request request;
+    memset(&request, 0, sizeof request);
+    request.je = je;
+
+    /*  Entity IDs start from 1, but any value maps to a shard.  */
+
+    const unsigned int entity = (unsigned int) je->entity;
+    struct postsvc_shard * shard = &svc->shards[entity % svc->num_shards];
+
+    pthread_mutex_lock(&shard->lock);
+
+    if ( shard->closing ) {
+        pthread_mutex_unlock(&shard->lock);
+        gl_log_msg("The posting service is closing.");
+        return false;
+    }
+
+    pthread_cond_init(&request.posted, NULL);
+    if ( shard->tail ) {
+        shard->tail->next = &request;
+    }
+    else {
+        shard->head = &request;
+    }
+    shard->tail = &request;
+    ++shard->num_queued;
+    pthread_cond_signal(&shard->queued);
+
+    while ( !request.done ) {
+        pthread_cond_wait(&request.posted, &shard->lock);
+    }
+
+    pthread_mutex_unlock(&shard->lock);
+    pthread_cond_destroy(&request.posted);
+
+    if ( request.status && id ) {
+        *id = request.id;
+    }
+    return request.status;
+}
+
+void db_postsvc_get_stats(db_postsvc svc, struct db_postsvc_stats * stats) {
+    memset(stats, 0, sizeof *stats);
+
+    for ( size_t s = 0; s < svc->num_started; ++s ) {
+        struct postsvc_shard * shard = &svc->shards[s];
+        pthread_mutex_lock(&shard->lock);
+        stats->posted += shard->stats.posted;
+        stats->rejected += shard->stats.rejected;
+        stats->transactions += shard->stats.transactions;
+        pthread_mutex_unlock(&shard->lock);
+    }
+}
+
+static void * db_postsvc_thread(void * arg) {
+    struct postsvc_shard * shard = arg;
+
+    pthread_mutex_lock(&shard->lock);
+
+    while ( true ) {
+        while ( !shard->head && !shard->closing ) {
+            pthread_cond_wait(&shard->queued, &shard->lock);
+        }
+        if ( !shard->head ) {
+            break;
+        }
+
+        if ( !shard->closing ) {
+            db_postsvc_wait_window(shard);
+        }
+
+        struct postsvc_request * batch = shard->head;
+        struct postsvc_request * last = NULL;
+        size_t count = 0;
+
+        while ( shard->head && count < shard->svc->max_batch ) {
+            last = shard->head;
+            shard->head = shard->head->next;
+            ++count;
+        }
+        if ( !shard->head ) {
+            shard->tail = NULL;
+        }
+        last->next = NULL;
+        shard->num_queued -= count;
+
+        pthread_mutex_unlock(&shard->lock);
+        db_postsvc_post_batch(shard, batch, count);
+        pthread_mutex_lock(&shard->lock);
+
+        for ( struct postsvc_request * r = batch; r; ) {
+            struct postsvc_request * next = r->next;
+            if ( r->status ) {
+                ++shard->stats.posted;
+            }
+            else {
+                ++shard->stats.rejected;
+            }
+            r->done = true;
+            pthread_cond_signal(&r->posted);
+            r = next;
+        }
+    }
+
+    pthread_mutex_unlock(&shard->lock);
+
+    db_sequence_free();
+    return NULL;
+}
+
+static void db_postsvc_wait_window(struct postsvc_shard * shard) {
+    const long window_us = shard->svc->window_us;
+    if ( window_us <= 0 || shard->num_queued >= shard->svc->max_batch ) {
+        return;
+    }
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += window_us / 1000000;
+    deadline.tv_nsec += (window_us % 1000000) * 1000;
+    if ( deadline.tv_nsec >= 1000000000 ) {
+        deadline.tv_nsec -= 1000000000;
+        ++deadline.tv_sec;
+    }
+
+    while ( shard->num_queued < shard->svc->max_batch && !shard->closing &&
+            pthread_cond_timedwait(&shard->queued, &shard->lock,
+                                   &deadline) != ETIMEDOUT ) {
+        ;
+    }
+}
+
+static void db_postsvc_post_batch(struct postsvc_shard * shard,
+                                  struct postsvc_request * batch,
+                                  const size_t count) {
+    struct db_je * jes = malloc(count * sizeof *jes);
+    uint64_t * ids = malloc(count * sizeof *ids);
+    if ( !jes || !ids ) {
+        gl_log_msg("Couldn't allocate memory for posting batch.");
+        free(jes);
+        free(ids);
+        return;
+    }
+
+    size_t i = 0;
+    for ( struct postsvc_request * r = batch; r; r = r->next ) {
+        jes[i++] = *r->je;
+    }
+
+    bool status = db_pool_checkout();
+    if ( status ) {
+        status = db_post_journal_entries(jes, count, ids);
+        if ( status ) {
+            i = 0;
+            for ( struct postsvc_request * r = batch; r; r = r->next ) {
+                r->id = ids[i++];
+                r->status = true;
+            }
+        }
+        else if ( count > 1 ) {
+
+            /*  Post the entries one at a time, so only the bad ones
+             *  fail.                                                   */
+
+            gl_log_msg("Posting %zu journal entries one at a time.", count);
+            i = 0;
+            for ( struct postsvc_request * r = batch; r; r = r->next ) {
+                r->status = db_post_journal_entries(&jes[i++], 1, &r->id);
+                pthread_mutex_lock(&shard->lock);
+                shard->stats.transactions += r->status;
+                pthread_mutex_unlock(&shard->lock);
+            }
+        }
+        db_pool_checkin();
+    }
+
+    if ( status ) {
+        pthread_mutex_lock(&shard->lock);
+        ++shard->stats.transactions;
+        pthread_mutex_unlock(&shard->lock);
+    }
+
+    free(jes);
+    free(ids);
+}
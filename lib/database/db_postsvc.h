@@ -0,0 +1,82 @@
+/*!
+ * \file            db_postsvc.h
+ * \brief           Interface to the in-process posting service.
+ * \details         Threads which post journal entries one at a time submit
+ * them to the service and wait. Entries are queued on a shard chosen by
+ * their entity, and each shard's thread posts whatever is queued as one
+ * multi-row transaction with `db_post_journal_entries()`, so many small
+ * postings share a transaction and its sync. Entries which arrive while a
+ * shard is posting wait for its next transaction. A shard may also wait a
+ * short window after the first entry arrives for more to join it. Each
+ * submitting thread is woken once its entry is committed. If a
+ * transaction fails, its entries are posted again one at a time, so that
+ * a bad entry fails only itself.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_DATABASE_DB_POSTSVC_H
+#define PG_GENERAL_LEDGER_DATABASE_DB_POSTSVC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "db_posting.h"
+
+/*!  Default maximum number of entries per transaction  */
+#define DB_POSTSVC_DEFAULT_MAX_BATCH 1000
+
+/*!  Opaque posting service type  */
+typedef struct db_postsvc * db_postsvc;
+
+/*!  Posting service statistics structure  */
+struct db_postsvc_stats {
+    uint64_t posted;            /*!<  Entries posted                    */
+    uint64_t rejected;          /*!<  Entries which failed              */
+    uint64_t transactions;      /*!<  Transactions committed            */
+};
+
+/*!
+ * \brief           Starts a posting service.
+ * \details         Each shard's thread checks out a pooled connection
+ * for each transaction, so shards beyond the size of the pool wait for
+ * each other, and submitting threads should not hold every pooled
+ * connection while they wait.
+ * \param num_shards    The number of shards.
+ * \param max_batch The maximum number of entries per transaction, or 0
+ * for the default.
+ * \param window_us The time in microseconds for which a shard waits for
+ * more entries after the first arrives, or 0 not to wait.
+ * \returns         The service, or `NULL` on failure.
+ */
+db_postsvc db_postsvc_open(const size_t num_shards, const size_t max_batch,
+                           const long window_us);
+
+/*!
+ * \brief           Stops a posting service.
+ * \details         Entries already submitted are posted first.
+ * \param svc       The service.
+ */
+void db_postsvc_close(db_postsvc svc);
+
+/*!
+ * \brief           Posts a journal entry through a posting service.
+ * \details         The function returns once the entry is committed or
+ * has failed. The entry must not be changed until then.
+ * \param svc       The service.
+ * \param je        The entry.
+ * \param id        Modified to contain the ID given to the entry, or
+ * `NULL` if it is not needed.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_postsvc_post(db_postsvc svc, const struct db_je * je, uint64_t * id);
+
+/*!
+ * \brief           Gets posting service statistics.
+ * \param svc       The service.
+ * \param stats     Modified to contain the statistics.
+ */
+void db_postsvc_get_stats(db_postsvc svc, struct db_postsvc_stats * stats);
+
+#endif      /*  PG_GENERAL_LEDGER_DATABASE_DB_POSTSVC_H  */
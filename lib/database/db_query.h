@@ -11,6 +11,7 @@
 #ifndef PG_GENERAL_LEDGER_DATABASE_DB_QUERY_H
 #define PG_GENERAL_LEDGER_DATABASE_DB_QUERY_H
 
+#include <stddef.h>
 #include <stdbool.h>
 
 /*!
@@ -21,5 +22,98 @@
  */
 bool db_execute_query(ds_str query);
 
+/*!
+ * \brief           Callback function for query field names.
+ * \param num_fields    The number of fields in the result.
+ * \param names     An array of `num_fields` field names.
+ * \param ctx       The context pointer passed to `db_query_foreach()`.
+ * \returns         `true` to continue processing the result, `false` to
+ * stop.
+ */
+typedef bool (*db_header_callback)(const size_t num_fields,
+                                   const char * const * names,
+                                   void * ctx);
+
+/*!
+ * \brief           Callback function for query result rows.
+ * \details         The values are only valid for the duration of the call.
+ * \param num_fields    The number of fields in the row.
+ * \param values    An array of `num_fields` values. Each value is `NULL`
+ * for an SQL `NULL`.
+ * \param lengths   An array of `num_fields` value lengths.
+ * \param ctx       The context pointer passed to `db_query_foreach()`.
+ * \returns         `true` to continue processing the result, `false` to
+ * stop.
+ */
+typedef bool (*db_row_callback)(const size_t num_fields,
+                                const char * const * values,
+                                const size_t * lengths,
+                                void * ctx);
+
+/*!
+ * \brief           Executes a SELECT query and streams the result.
+ * \details         Rows are passed to `row_cb` as they are received from
+ * the database, and are not buffered, so results of any size may be
+ * processed in constant memory. The connection may not be used for other
+ * queries from within the callbacks.
+ * \param query     The query to execute.
+ * \param header_cb A function to call once with the field names before
+ * any rows, or `NULL`.
+ * \param row_cb    A function to call for each row.
+ * \param ctx       A pointer to pass to the callbacks.
+ * \returns         `true` if the query was successfully executed and
+ * the result fully processed or stopped by a callback, `false` otherwise.
+ */
+bool db_query_foreach(ds_str query, db_header_callback header_cb,
+                      db_row_callback row_cb, void * ctx);
+
+/*!
+ * \brief           Executes a bulk load query on the database.
+ * \details         The query is a `LOAD DATA LOCAL INFILE` statement, or
+ * the database's equivalent. The named file is read by the client and
+ * must be in the sample data format: the first two records, holding the
+ * field names and types, are skipped, as are blank lines and lines where
+ * the first printable character is '#'.
+ * \param query     The query to execute.
+ * \param rows      A pointer to a variable in which to store the number
+ * of rows loaded, or `NULL`.
+ * \returns         `true` if the query was successfully executed,
+ * `false` otherwise.
+ */
+bool db_execute_load_query(ds_str query, size_t * rows);
+
+/*!
+ * \brief           Starts a transaction on the database.
+ * \details         Statements executed after a successful call to this
+ * function are not made permanent until `db_commit_transaction()` is
+ * called, and are discarded by `db_rollback_transaction()`.
+ * \returns         `true` if the transaction was successfully started,
+ * `false` otherwise.
+ */
+bool db_begin_transaction(void);
+
+/*!
+ * \brief           Commits the current transaction.
+ * \returns         `true` if the transaction was successfully committed,
+ * `false` otherwise.
+ */
+bool db_commit_transaction(void);
+
+/*!
+ * \brief           Rolls back the current transaction.
+ * \returns         `true` if the transaction was successfully rolled back,
+ * `false` otherwise.
+ */
+bool db_rollback_transaction(void);
+
+/*!
+ * \brief           Returns the maximum length of a single query.
+ * \details         For MySQL this is the server's `max_allowed_packet`
+ * setting. Callers building multi-row queries should keep each query
+ * below this length.
+ * \returns         The maximum query length in bytes.
+ */
+size_t db_max_query_length(void);
+
 #endif      /*  PG_GENERAL_LEDGER_DATABASE_DB_QUERY_H  */
 
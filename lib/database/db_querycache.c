@@ -0,0 +1,865 @@
+/*!
+ * \file            db_querycache.c
+ * \brief           Implementation of the query result cache.
+ * \details         Results are held in memory in a hash table of copies,
+ * which is emptied whenever the ledger version changes. Each result in
+ * the cache directory is a file named for a hash of its query, holding
+ * the ledger version, the query text, and the headers and fields of the
+ * result, with every string preceded by its little endian 32 bit length.
+ * Files are written under a temporary name and renamed into place, so
+ * several programs may share a directory.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+/*!  UNIX feature test macro  */
+#define _XOPEN_SOURCE 600
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "gl_general/gl_general.h"
+#include "db_internal.h"
+
+/*!  Number of hash buckets for results held in memory  */
+#define QUERYCACHE_BUCKETS 64
+
+/*!  Maximum number of results held in memory  */
+#define QUERYCACHE_MAX_ENTRIES 256
+
+/*!  Maximum number of records in a result held in memory  */
+#define QUERYCACHE_MAX_ENTRY_RECORDS 10000
+
+/*!  Cache file format version  */
+#define QUERYCACHE_FILE_FORMAT 1
+
+/*!  File name suffix of results in the cache directory  */
+#define QUERYCACHE_SUFFIX ".qc"
+
+/*!  Cache file magic number  */
+static const char file_magic[4] = {'G', 'L', 'Q', 'C'};
+
+/*!  Cached result structure  */
+struct db_querycache_entry {
+    ds_str query;                       /*!<  The query text        */
+    ds_recordset set;                   /*!<  The result            */
+    struct db_querycache_entry * next;  /*!<  Next in the bucket    */
+};
+
+/*!  Lock for the cache state  */
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*!  Flag indicating whether the cache is enabled  */
+static bool cache_enabled = false;
+
+/*!  The cache directory, or `NULL` to cache in memory only  */
+static char * cache_dir = NULL;
+
+/*!  The ledger version of the results held in memory  */
+static ds_str cache_version = NULL;
+
+/*!  Results held in memory  */
+static struct db_querycache_entry * cache_buckets[QUERYCACHE_BUCKETS];
+
+/*!  Number of results held in memory  */
+static size_t cache_entries = 0;
+
+/*!  Sequence number for temporary file names  */
+static unsigned long cache_temp_seq = 0;
+
+/*!  Cache statistics  */
+static struct db_querycache_stats cache_stats;
+
+/*!
+ * \brief           Reads the ledger epoch and version from the database.
+ * \returns         A string identifying the version, or `NULL` on failure.
+ */
+static ds_str db_read_ledger_version(void);
+
+/*!
+ * \brief           Row callback for `db_read_ledger_version()`.
+ * \param num_fields    The number of fields in the row.
+ * \param values    The field values.
+ * \param lengths   The field value lengths.
+ * \param ctx       A pointer to a `ds_str` in which to store the version.
+ * \returns         `false`, as only the first row is needed.
+ */
+static bool db_ledger_version_cb(const size_t num_fields,
+                                 const char * const * values,
+                                 const size_t * lengths, void * ctx);
+
+/*!
+ * \brief           Row callback for `db_get_ledger_epoch()`.
+ * \param num_fields    The number of fields in the row.
+ * \param values    The field values.
+ * \param lengths   The field value lengths.
+ * \param ctx       A pointer to a `ds_str` in which to store the epoch.
+ * \returns         `false`, as only one row is read.
+ */
+static bool db_ledger_epoch_cb(const size_t num_fields,
+                               const char * const * values,
+                               const size_t * lengths, void * ctx);
+
+/*!
+ * \brief           Returns a 64 bit FNV-1a hash of a query.
+ * \param query     The query.
+ * \returns         The hash.
+ */
+static uint64_t db_querycache_hash(ds_str query);
+
+/*!
+ * \brief           Frees the results held in memory.
+ * \details         Must be called with the cache lock held.
+ */
+static void db_querycache_clear(void);
+
+/*!
+ * \brief           Finds a result held in memory.
+ * \details         Must be called with the cache lock held.
+ * \param query     The query.
+ * \returns         The entry, or `NULL` if the query is not cached.
+ */
+static struct db_querycache_entry * db_querycache_find(ds_str query);
+
+/*!
+ * \brief           Holds a copy of a result in memory.
+ * \details         Must be called with the cache lock held. Nothing is
+ * held if the query is already cached, the cache is full, or the result
+ * is too large to be worth copying, since large results are read from
+ * the cache directory about as quickly.
+ * \param query     The query.
+ * \param set       The result.
+ */
+static void db_querycache_insert(ds_str query, ds_recordset set);
+
+/*!
+ * \brief           Returns the name of the cache file for a query.
+ * \param dir       The cache directory.
+ * \param query     The query.
+ * \returns         The file name.
+ */
+static ds_str db_querycache_filename(const char * dir, ds_str query);
+
+/*!
+ * \brief           Reads a result from the cache directory.
+ * \details         A file for another ledger version is removed.
+ * \param dir       The cache directory.
+ * \param query     The query.
+ * \param version   The current ledger version.
+ * \returns         The result, or `NULL` if there is no current result
+ * for the query.
+ */
+static ds_recordset db_querycache_read_file(const char * dir, ds_str query,
+                                            ds_str version);
+
+/*!
+ * \brief           Reads the ledger version of a result in the cache
+ * directory.
+ * \param filename  The file name.
+ * \param size      Modified to contain the size of the file.
+ * \returns         The version, or `NULL` if the file is not a result or
+ * on failure.
+ */
+static ds_str db_querycache_file_version(const char * filename,
+                                         size_t * size);
+
+/*!
+ * \brief           Writes a result to the cache directory.
+ * \param dir       The cache directory.
+ * \param query     The query.
+ * \param version   The ledger version of the result.
+ * \param set       The result.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_querycache_write_file(const char * dir, ds_str query,
+                                     ds_str version, ds_recordset set);
+
+bool db_create_ledger_version_table(void) {
+    gl_log_msg("Creating ledger version table...");
+    bool status = false;
+    ds_str create = ds_str_create(db_create_ledger_version_table_sql());
+    ds_str init = ds_str_create(db_init_ledger_version_sql());
+    if ( create && init ) {
+        status = db_execute_query(create) && db_execute_query(init);
+    }
+    if ( create ) {
+        ds_str_destroy(create);
+    }
+    if ( init ) {
+        ds_str_destroy(init);
+    }
+    return status;
+}
+
+bool db_drop_ledger_version_table(void) {
+    gl_log_msg("Dropping ledger version table...");
+    bool status = false;
+    ds_str query = ds_str_create(db_drop_ledger_version_table_sql());
+    if ( query ) {
+        status = db_execute_query(query);
+        ds_str_destroy(query);
+    }
+    return status;
+}
+
+ds_str db_get_ledger_epoch(void) {
+    ds_str epoch = NULL;
+    ds_str query = ds_str_create(db_ledger_version_sql());
+    bool status = query && db_query_foreach(query, NULL,
+                                            db_ledger_epoch_cb, &epoch);
+    if ( query ) {
+        ds_str_destroy(query);
+    }
+
+    if ( !status && epoch ) {
+        ds_str_destroy(epoch);
+        epoch = NULL;
+    }
+
+    return epoch;
+}
+
+bool db_create_entity_versions_table(void) {
+    gl_log_msg("Creating entity versions table...");
+    bool status = false;
+    ds_str query = ds_str_create(db_create_entity_versions_table_sql());
+    if ( query ) {
+        status = db_execute_query(query);
+        ds_str_destroy(query);
+    }
+    return status;
+}
+
+bool db_drop_entity_versions_table(void) {
+    gl_log_msg("Dropping entity versions table...");
+    bool status = false;
+    ds_str query = ds_str_create(db_drop_entity_versions_table_sql());
+    if ( query ) {
+        status = db_execute_query(query);
+        ds_str_destroy(query);
+    }
+    return status;
+}
+
+bool db_bump_ledger_version(void) {
+    bool status = false;
+    ds_str bump = ds_str_create(db_bump_ledger_version_sql());
+    ds_str stamp = ds_str_create(db_stamp_all_entity_versions_sql());
+    if ( bump && stamp ) {
+        status = db_execute_query(bump) && db_execute_query(stamp);
+    }
+    if ( bump ) {
+        ds_str_destroy(bump);
+    }
+    if ( stamp ) {
+        ds_str_destroy(stamp);
+    }
+    return status;
+}
+
+bool db_bump_entity_ledger_version(const int * entities,
+                                   const size_t num_entities) {
+    int * distinct = malloc((num_entities + 1) * sizeof *distinct);
+    ds_str list = ds_str_create("");
+    if ( !distinct || !list ) {
+        free(distinct);
+        if ( list ) {
+            ds_str_destroy(list);
+        }
+        gl_log_msg("Couldn't allocate memory for entity list.");
+        return false;
+    }
+
+    /*  A batch touches few entities, so each ID is only checked against
+     *  the distinct IDs found so far.                                  */
+
+    size_t num_distinct = 0;
+    for ( size_t i = 0; i < num_entities; ++i ) {
+        size_t d = 0;
+        while ( d < num_distinct && distinct[d] != entities[i] ) {
+            ++d;
+        }
+        if ( d == num_distinct ) {
+            distinct[num_distinct++] = entities[i];
+            ds_str id = ds_str_create_sprintf("%s%d", d ? ", " : "",
+                                              entities[i]);
+            ds_str_concat(list, id);
+            ds_str_destroy(id);
+        }
+    }
+
+    bool status = false;
+    ds_str bump = ds_str_create(db_bump_ledger_version_sql());
+    ds_str stamp = num_distinct ?
+        ds_str_create_sprintf(db_stamp_entity_versions_sql(),
+                              ds_str_cstr(list)) : NULL;
+    if ( bump ) {
+        status = db_execute_query(bump) &&
+                 (!stamp || db_execute_query(stamp));
+        ds_str_destroy(bump);
+    }
+    if ( stamp ) {
+        ds_str_destroy(stamp);
+    }
+    ds_str_destroy(list);
+    free(distinct);
+    return status;
+}
+
+void db_querycache_enable(const bool enable, const char * dir) {
+    pthread_mutex_lock(&cache_lock);
+
+    db_querycache_clear();
+    free(cache_dir);
+    cache_dir = NULL;
+    memset(&cache_stats, 0, sizeof cache_stats);
+    cache_enabled = enable;
+
+    if ( enable && dir ) {
+        if ( mkdir(dir, 0755) && errno != EEXIST ) {
+            gl_log_msg("Couldn't create query cache directory '%s'.", dir);
+        }
+        else if ( !(cache_dir = strdup(dir)) ) {
+            gl_log_msg("Couldn't allocate memory for query cache.");
+        }
+    }
+
+    pthread_mutex_unlock(&cache_lock);
+}
+
+void db_querycache_get_stats(struct db_querycache_stats * stats) {
+    pthread_mutex_lock(&cache_lock);
+    *stats = cache_stats;
+    pthread_mutex_unlock(&cache_lock);
+}
+
+bool db_querycache_get_dir_stats(struct db_querycache_dir_stats * stats) {
+    memset(stats, 0, sizeof *stats);
+
+    char * dir = db_querycache_dir();
+    DIR * dp = dir ? opendir(dir) : NULL;
+    if ( !dp ) {
+        free(dir);
+        return false;
+    }
+
+    ds_str current = db_read_ledger_version();
+    const size_t suffix_len = strlen(QUERYCACHE_SUFFIX);
+    struct dirent * entry;
+    while ( (entry = readdir(dp)) ) {
+        const size_t len = strlen(entry->d_name);
+        if ( len <= suffix_len ||
+             strcmp(entry->d_name + len - suffix_len, QUERYCACHE_SUFFIX) ) {
+            continue;
+        }
+
+        ds_str filename = ds_str_create_sprintf("%s/%s", dir,
+                                                entry->d_name);
+        size_t size = 0;
+        ds_str version = filename ?
+            db_querycache_file_version(ds_str_cstr(filename), &size) : NULL;
+        if ( version ) {
+            ++stats->results;
+            stats->bytes += size;
+            if ( current && !ds_str_compare(version, current) ) {
+                ++stats->current;
+            }
+            ds_str_destroy(version);
+        }
+        if ( filename ) {
+            ds_str_destroy(filename);
+        }
+    }
+
+    closedir(dp);
+    free(dir);
+    if ( current ) {
+        ds_str_destroy(current);
+    }
+    return true;
+}
+
+void db_querycache_free(void) {
+    db_querycache_enable(false, NULL);
+}
+
+char * db_querycache_dir(void) {
+    pthread_mutex_lock(&cache_lock);
+    char * dir = cache_enabled && cache_dir ? strdup(cache_dir) : NULL;
+    pthread_mutex_unlock(&cache_lock);
+    return dir;
+}
+
+ds_recordset db_querycache_lookup(ds_str query, ds_str * version) {
+    *version = NULL;
+
+    pthread_mutex_lock(&cache_lock);
+    const bool enabled = cache_enabled;
+    pthread_mutex_unlock(&cache_lock);
+
+    if ( !enabled ) {
+        return NULL;
+    }
+
+    /*  The version is read before the query is run, so a posting
+     *  committed in between can only make the stored result newer
+     *  than its version, and never older.                          */
+
+    ds_str current = db_read_ledger_version();
+    if ( !current ) {
+        gl_log_msg("Couldn't read the ledger version, disabling the "
+                   "query cache.");
+        pthread_mutex_lock(&cache_lock);
+        db_querycache_clear();
+        cache_enabled = false;
+        pthread_mutex_unlock(&cache_lock);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&cache_lock);
+
+    if ( !cache_version || ds_str_compare(cache_version, current) ) {
+        cache_stats.invalidations += cache_entries;
+        db_querycache_clear();
+        cache_version = ds_str_dup(current);
+    }
+
+    struct db_querycache_entry * entry = db_querycache_find(query);
+    ds_recordset set = entry ? ds_recordset_copy(entry->set) : NULL;
+    if ( set ) {
+        ++cache_stats.memory_hits;
+    }
+
+    char * dir = cache_dir ? strdup(cache_dir) : NULL;
+    pthread_mutex_unlock(&cache_lock);
+
+    if ( !set && dir ) {
+        set = db_querycache_read_file(dir, query, current);
+        if ( set ) {
+            pthread_mutex_lock(&cache_lock);
+            ++cache_stats.disk_hits;
+            if ( cache_version && !ds_str_compare(cache_version, current) ) {
+                db_querycache_insert(query, set);
+            }
+            pthread_mutex_unlock(&cache_lock);
+        }
+    }
+    free(dir);
+
+    if ( set ) {
+        ds_str_destroy(current);
+    }
+    else {
+        pthread_mutex_lock(&cache_lock);
+        ++cache_stats.misses;
+        pthread_mutex_unlock(&cache_lock);
+        *version = current;
+    }
+
+    return set;
+}
+
+void db_querycache_store(ds_str query, ds_str version, ds_recordset set) {
+    pthread_mutex_lock(&cache_lock);
+    if ( !cache_enabled ) {
+        pthread_mutex_unlock(&cache_lock);
+        return;
+    }
+
+    if ( cache_version && !ds_str_compare(cache_version, version) ) {
+        db_querycache_insert(query, set);
+    }
+
+    char * dir = cache_dir ? strdup(cache_dir) : NULL;
+    pthread_mutex_unlock(&cache_lock);
+
+    if ( dir && !db_querycache_write_file(dir, query, version, set) ) {
+        gl_log_msg("Couldn't write query cache file in '%s'.", dir);
+    }
+    free(dir);
+}
+
+static ds_str db_read_ledger_version(void) {
+    ds_str version = NULL;
+    ds_str query = ds_str_create(db_ledger_version_sql());
+    bool status = query && db_query_foreach(query, NULL,
+                                            db_ledger_version_cb, &version);
+    if ( query ) {
+        ds_str_destroy(query);
+    }
+
+    if ( !status && version ) {
+        ds_str_destroy(version);
+        version = NULL;
+    }
+
+    return version;
+}
+
+static bool db_ledger_version_cb(const size_t num_fields,
+                                 const char * const * values,
+                                 const size_t * lengths, void * ctx) {
+    ds_str * version = ctx;
+    if ( num_fields == 2 && values[0] && values[1] ) {
+        *version = ds_str_create_sprintf("%.*s:%.*s",
+                                         (int) lengths[0], values[0],
+                                         (int) lengths[1], values[1]);
+    }
+    return false;
+}
+
+static bool db_ledger_epoch_cb(const size_t num_fields,
+                               const char * const * values,
+                               const size_t * lengths, void * ctx) {
+    ds_str * epoch = ctx;
+    if ( num_fields >= 1 && values[0] && !*epoch ) {
+        *epoch = ds_str_create_sprintf("%.*s", (int) lengths[0], values[0]);
+    }
+    return false;
+}
+
+static uint64_t db_querycache_hash(ds_str query) {
+    uint64_t hash = UINT64_C(14695981039346656037);
+    const unsigned char * p = (const unsigned char *) ds_str_cstr(query);
+    for ( size_t i = 0; i < ds_str_length(query); ++i ) {
+        hash ^= p[i];
+        hash *= UINT64_C(1099511628211);
+    }
+    return hash;
+}
+
+static void db_querycache_clear(void) {
+    for ( size_t i = 0; i < QUERYCACHE_BUCKETS; ++i ) {
+        struct db_querycache_entry * entry = cache_buckets[i];
+        while ( entry ) {
+            struct db_querycache_entry * next = entry->next;
+            ds_str_destroy(entry->query);
+            ds_recordset_destroy(entry->set);
+            free(entry);
+            entry = next;
+        }
+        cache_buckets[i] = NULL;
+    }
+    cache_entries = 0;
+
+    if ( cache_version ) {
+        ds_str_destroy(cache_version);
+        cache_version = NULL;
+    }
+}
+
+static struct db_querycache_entry * db_querycache_find(ds_str query) {
+    const size_t bucket = db_querycache_hash(query) % QUERYCACHE_BUCKETS;
+    for ( struct db_querycache_entry * entry = cache_buckets[bucket];
+          entry; entry = entry->next ) {
+        if ( !ds_str_compare(entry->query, query) ) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void db_querycache_insert(ds_str query, ds_recordset set) {
+    if ( cache_entries >= QUERYCACHE_MAX_ENTRIES ||
+         ds_recordset_num_records(set) > QUERYCACHE_MAX_ENTRY_RECORDS ||
+         db_querycache_find(query) ) {
+        return;
+    }
+
+    struct db_querycache_entry * entry = malloc(sizeof *entry);
+    if ( !entry ) {
+        return;
+    }
+
+    entry->query = ds_str_dup(query);
+    entry->set = ds_recordset_copy(set);
+    if ( !entry->query || !entry->set ) {
+        if ( entry->query ) {
+            ds_str_destroy(entry->query);
+        }
+        if ( entry->set ) {
+            ds_recordset_destroy(entry->set);
+        }
+        free(entry);
+        return;
+    }
+
+    const size_t bucket = db_querycache_hash(query) % QUERYCACHE_BUCKETS;
+    entry->next = cache_buckets[bucket];
+    cache_buckets[bucket] = entry;
+    ++cache_entries;
+}
+
+static ds_str db_querycache_filename(const char * dir, ds_str query) {
+    return ds_str_create_sprintf("%s/%016llx" QUERYCACHE_SUFFIX, dir,
+                    (unsigned long long) db_querycache_hash(query));
+}
+
+static ds_recordset db_querycache_read_file(const char * dir, ds_str query,
+                                            ds_str version) {
+    ds_str filename = db_querycache_filename(dir, query);
+    FILE * fp = filename ? fopen(ds_str_cstr(filename), "rb") : NULL;
+    if ( !fp ) {
+        if ( filename ) {
+            ds_str_destroy(filename);
+        }
+        return NULL;
+    }
+
+    size_t size = 0;
+    unsigned char * buffer = db_querycache_read_buffer(fp, &size);
+    fclose(fp);
+
+    struct db_querycache_reader reader = {buffer, buffer ? buffer + size :
+                                                           NULL};
+    uint32_t format = 0, num_fields = 0, num_records = 0;
+    ds_str file_version = NULL;
+    ds_str file_query = NULL;
+    ds_recordset set = NULL;
+    bool stale = false;
+
+    if ( buffer && size >= sizeof file_magic &&
+         !memcmp(buffer, file_magic, sizeof file_magic) ) {
+        reader.pos += sizeof file_magic;
+        if ( db_querycache_get_u32(&reader, &format) &&
+             format == QUERYCACHE_FILE_FORMAT &&
+             (file_version = db_querycache_get_str(&reader)) ) {
+            stale = ds_str_compare(file_version, version) != 0;
+        }
+    }
+
+    if ( file_version && !stale &&
+         (file_query = db_querycache_get_str(&reader)) &&
+         !ds_str_compare(file_query, query) &&
+         db_querycache_get_u32(&reader, &num_fields) &&
+         db_querycache_get_u32(&reader, &num_records) &&
+         num_fields > 0 && (set = ds_recordset_create(num_fields)) ) {
+        bool status = true;
+        for ( uint32_t r = 0; status && r <= num_records; ++r ) {
+            ds_record record = ds_record_create(num_fields);
+            for ( uint32_t i = 0; record && i < num_fields; ++i ) {
+                ds_str field = db_querycache_get_str(&reader);
+                if ( !field ) {
+                    ds_record_destroy(record);
+                    record = NULL;
+                }
+                else {
+                    ds_record_set_field(record, i, field);
+                }
+            }
+
+            /*  The headers are stored before the first record.  */
+
+            if ( !record ) {
+                status = false;
+            }
+            else if ( r == 0 ) {
+                ds_recordset_set_headers(set, record);
+            }
+            else {
+                ds_recordset_add_record(set, record);
+            }
+        }
+
+        if ( !status ) {
+            ds_recordset_destroy(set);
+            set = NULL;
+        }
+    }
+
+    if ( stale ) {
+        remove(ds_str_cstr(filename));
+        pthread_mutex_lock(&cache_lock);
+        ++cache_stats.invalidations;
+        pthread_mutex_unlock(&cache_lock);
+    }
+
+    if ( file_version ) {
+        ds_str_destroy(file_version);
+    }
+    if ( file_query ) {
+        ds_str_destroy(file_query);
+    }
+    ds_str_destroy(filename);
+    free(buffer);
+    return set;
+}
+
+static ds_str db_querycache_file_version(const char * filename,
+                                         size_t * size) {
+    FILE * fp = fopen(filename, "rb");
+    if ( !fp ) {
+        return NULL;
+    }
+
+    unsigned char * buffer = db_querycache_read_buffer(fp, size);
+    fclose(fp);
+
+    struct db_querycache_reader reader = {buffer, buffer ? buffer + *size :
+                                                           NULL};
+    uint32_t format = 0;
+    ds_str version = NULL;
+    if ( buffer && *size >= sizeof file_magic &&
+         !memcmp(buffer, file_magic, sizeof file_magic) ) {
+        reader.pos += sizeof file_magic;
+        if ( db_querycache_get_u32(&reader, &format) &&
+             format == QUERYCACHE_FILE_FORMAT ) {
+            version = db_querycache_get_str(&reader);
+        }
+    }
+
+    free(buffer);
+    return version;
+}
+
+static bool db_querycache_write_file(const char * dir, ds_str query,
+                                     ds_str version, ds_recordset set) {
+    ds_str filename = db_querycache_filename(dir, query);
+    ds_str tempname = NULL;
+    FILE * fp = filename ? db_querycache_open_temp(filename, &tempname)
+                         : NULL;
+    if ( !fp ) {
+        if ( filename ) {
+            ds_str_destroy(filename);
+        }
+        return false;
+    }
+
+    const size_t num_fields = ds_recordset_num_fields(set);
+    ds_record headers = ds_recordset_get_headers(set);
+    bool status = fwrite(file_magic, sizeof file_magic, 1, fp) == 1 &&
+        db_querycache_put_u32(fp, QUERYCACHE_FILE_FORMAT) &&
+        db_querycache_put_str(fp, version) &&
+        db_querycache_put_str(fp, query) &&
+        db_querycache_put_u32(fp, (uint32_t) num_fields) &&
+        db_querycache_put_u32(fp,
+                (uint32_t) ds_recordset_num_records(set));
+
+    for ( size_t i = 0; status && i < num_fields; ++i ) {
+        status = db_querycache_put_str(fp, headers ?
+                    ds_record_get_field(headers, i) : NULL);
+    }
+
+    ds_record record;
+    ds_recordset_seek_start(set);
+    while ( status && (record = ds_recordset_next_record(set)) ) {
+        for ( size_t i = 0; status && i < num_fields; ++i ) {
+            status = db_querycache_put_str(fp,
+                        ds_record_get_field(record, i));
+        }
+    }
+    ds_recordset_seek_start(set);
+
+    status = db_querycache_close_temp(fp, tempname, filename, status);
+    ds_str_destroy(filename);
+    return status;
+}
+
+unsigned char * db_querycache_read_buffer(FILE * fp, size_t * size) {
+    unsigned char * buffer = NULL;
+    long length = -1;
+    if ( !fseek(fp, 0, SEEK_END) && (length = ftell(fp)) > 0 &&
+         !fseek(fp, 0, SEEK_SET) && (buffer = malloc(length)) &&
+         fread(buffer, 1, length, fp) != (size_t) length ) {
+        free(buffer);
+        buffer = NULL;
+    }
+
+    *size = buffer ? (size_t) length : 0;
+    return buffer;
+}
+
+FILE * db_querycache_open_temp(ds_str filename, ds_str * tempname) {
+    pthread_mutex_lock(&cache_lock);
+    const unsigned long seq = ++cache_temp_seq;
+    pthread_mutex_unlock(&cache_lock);
+
+    *tempname = ds_str_create_sprintf("%s.%ld.%lu.tmp",
+                                      ds_str_cstr(filename),
+                                      (long) getpid(), seq);
+    FILE * fp = *tempname ? fopen(ds_str_cstr(*tempname), "wb") : NULL;
+    if ( !fp && *tempname ) {
+        ds_str_destroy(*tempname);
+        *tempname = NULL;
+    }
+    return fp;
+}
+
+bool db_querycache_close_temp(FILE * fp, ds_str tempname, ds_str filename,
+                              const bool status) {
+    const bool renamed = !fclose(fp) && status &&
+                         !rename(ds_str_cstr(tempname),
+                                 ds_str_cstr(filename));
+    if ( !renamed ) {
+        remove(ds_str_cstr(tempname));
+    }
+    ds_str_destroy(tempname);
+    return renamed;
+}
+
+bool db_querycache_put_u32(FILE * fp, const uint32_t value) {
+    const unsigned char bytes[4] = {
+        value & 0xff, (value >> 8) & 0xff,
+        (value >> 16) & 0xff, (value >> 24) & 0xff
+    };
+    return fwrite(bytes, sizeof bytes, 1, fp) == 1;
+}
+
+bool db_querycache_put_str(FILE * fp, ds_str str) {
+    const size_t length = str ? ds_str_length(str) : 0;
+    return db_querycache_put_u32(fp, (uint32_t) length) &&
+           (!length || fwrite(ds_str_cstr(str), length, 1, fp) == 1);
+}
+
+bool db_querycache_put_u64(FILE * fp, const uint64_t value) {
+    return db_querycache_put_u32(fp, (uint32_t) (value & 0xffffffff)) &&
+           db_querycache_put_u32(fp, (uint32_t) (value >> 32));
+}
+
+bool db_querycache_get_u32(struct db_querycache_reader * reader,
+                           uint32_t * value) {
+    if ( reader->end - reader->pos < 4 ) {
+        return false;
+    }
+
+    const unsigned char * p = reader->pos;
+    *value = (uint32_t) p[0] | ((uint32_t) p[1] << 8) |
+             ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+    reader->pos += 4;
+    return true;
+}
+
+bool db_querycache_get_u64(struct db_querycache_reader * reader,
+                           uint64_t * value) {
+    uint32_t low, high;
+    if ( !db_querycache_get_u32(reader, &low) ||
+         !db_querycache_get_u32(reader, &high) ) {
+        return false;
+    }
+    *value = (uint64_t) low | ((uint64_t) high << 32);
+    return true;
+}
+
+ds_str db_querycache_get_str(struct db_querycache_reader * reader) {
+    uint32_t length;
+    if ( !db_querycache_get_u32(reader, &length) ||
+         (uint32_t) (reader->end - reader->pos) < length ) {
+        return NULL;
+    }
+
+    char * data = malloc(length + 1);
+    if ( !data ) {
+        return NULL;
+    }
+
+    memcpy(data, reader->pos, length);
+    data[length] = '\0';
+    reader->pos += length;
+    return ds_str_create_direct(data, length + 1);
+}
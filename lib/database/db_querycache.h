@@ -0,0 +1,109 @@
+/*!
+ * \file            db_querycache.h
+ * \brief           Interface to the query result cache.
+ * \details         When enabled, the results of report queries are cached
+ * in memory and, optionally, in files in a cache directory, keyed on the
+ * query text and the ledger version. The ledger version is a counter in
+ * the database which is incremented by every posting, load and balance
+ * rebuild, so a cached result is only returned while the data it was
+ * read from is unchanged. Entries for older versions are discarded as
+ * they are found.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_DATABASE_DB_QUERYCACHE_H
+#define PG_GENERAL_LEDGER_DATABASE_DB_QUERYCACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "datastruct/data_structures.h"
+
+/*!  Query result cache statistics structure  */
+struct db_querycache_stats {
+    uint64_t memory_hits;       /*!<  Results found in memory           */
+    uint64_t disk_hits;         /*!<  Results found in the directory    */
+    uint64_t misses;            /*!<  Results read from the database    */
+    uint64_t invalidations;     /*!<  Stale results discarded           */
+};
+
+/*!  Query result cache directory statistics structure  */
+struct db_querycache_dir_stats {
+    uint64_t results;           /*!<  Results in the directory          */
+    uint64_t current;           /*!<  Results for the current version   */
+    uint64_t bytes;             /*!<  Total size of the results         */
+};
+
+/*!
+ * \brief           Creates the ledger version table in the database.
+ * \details         The version starts at zero, with a new epoch.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_create_ledger_version_table(void);
+
+/*!
+ * \brief           Drops the ledger version table from the database.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_drop_ledger_version_table(void);
+
+/*!
+ * \brief           Gets the epoch of the database.
+ * \details         The epoch is set when the ledger version table is
+ * created, so it changes whenever the database structure is recreated.
+ * \returns         The epoch, or `NULL` on failure.
+ */
+ds_str db_get_ledger_epoch(void);
+
+/*!
+ * \brief           Creates the entity versions table in the database.
+ * \details         The table holds the ledger version at which each
+ * entity last changed, so that results for one entity can be kept while
+ * others change.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_create_entity_versions_table(void);
+
+/*!
+ * \brief           Drops the entity versions table from the database.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_drop_entity_versions_table(void);
+
+/*!
+ * \brief           Enables or disables the query result cache.
+ * \details         Disabling the cache frees any results held in memory.
+ * If the ledger version cannot be read, for instance because the
+ * database was created before it was added, the cache disables itself.
+ * \param enable    `true` to enable the cache, `false` to disable it.
+ * \param dir       The cache directory, which is created if it does not
+ * exist, or `NULL` to cache in memory only.
+ */
+void db_querycache_enable(const bool enable, const char * dir);
+
+/*!
+ * \brief           Gets query result cache statistics.
+ * \param stats     Modified to contain the statistics since the cache was
+ * enabled.
+ */
+void db_querycache_get_stats(struct db_querycache_stats * stats);
+
+/*!
+ * \brief           Gets statistics for the results in the cache directory.
+ * \details         Results for older ledger versions are counted, but not
+ * as current.
+ * \param stats     Modified to contain the statistics.
+ * \returns         `true` on success, `false` if the cache has no
+ * directory or on failure.
+ */
+bool db_querycache_get_dir_stats(struct db_querycache_dir_stats * stats);
+
+/*!
+ * \brief           Frees the query result cache.
+ * \details         The files in the cache directory are kept. It is safe
+ * to call this function if the cache is not enabled.
+ */
+void db_querycache_free(void);
+
+#endif      /*  PG_GENERAL_LEDGER_DATABASE_DB_QUERYCACHE_H  */
@@ -6,13 +6,112 @@
  * of the GNU General Public License. <http://www.gnu.org/licenses/>
  */
 
+#include <stdlib.h>
 #include "db_internal.h"
 #include "gl_general/gl_general.h"
 
+/*!
+ * \brief           Row callback for `db_query_integer()`.
+ * \param num_fields    The number of fields in the row.
+ * \param values    The field values.
+ * \param lengths   The field value lengths.
+ * \param ctx       A pointer to a `uint64_t` in which to store the value.
+ * \returns         `false`, as only the first row is needed.
+ */
+static bool db_integer_value_cb(const size_t num_fields,
+                                const char * const * values,
+                                const size_t * lengths, void * ctx);
+
 ds_str db_create_report_from_query(ds_str query) {
     ds_recordset results = db_create_recordset_from_query(query);
+    if ( !results ) {
+        return NULL;
+    }
     ds_str report = ds_recordset_get_text_report(results);
     ds_recordset_destroy(results);
     return report;
 }
 
+ds_recordset db_create_recordset_from_query(ds_str query) {
+    ds_str version;
+    ds_recordset set = db_querycache_lookup(query, &version);
+    if ( set ) {
+        return set;
+    }
+
+    if ( !db_query_foreach(query, db_recordset_header_cb,
+                           db_recordset_row_cb, &set) ) {
+        if ( set ) {
+            ds_recordset_destroy(set);
+        }
+        set = NULL;
+    }
+    else if ( set && version ) {
+        db_querycache_store(query, version, set);
+    }
+
+    if ( version ) {
+        ds_str_destroy(version);
+    }
+    return set;
+}
+
+bool db_recordset_header_cb(const size_t num_fields,
+                            const char * const * names,
+                            void * ctx) {
+    ds_recordset * set = ctx;
+
+    *set = ds_recordset_create(num_fields);
+    if ( !*set ) {
+        return false;
+    }
+
+    ds_record field_names = ds_record_create(num_fields);
+    for ( size_t i = 0; i < num_fields; ++i ) {
+        ds_record_set_field(field_names, i, ds_str_create(names[i]));
+    }
+    ds_recordset_set_headers(*set, field_names);
+
+    return true;
+}
+
+bool db_recordset_row_cb(const size_t num_fields,
+                         const char * const * values,
+                         const size_t * lengths,
+                         void * ctx) {
+    ds_recordset * set = ctx;
+    ds_record record = ds_record_create(num_fields);
+
+    for ( size_t i = 0; i < num_fields; ++i ) {
+        ds_str new_field;
+        if ( values[i] && lengths[i] ) {
+            new_field = ds_str_create_sprintf("%.*s",
+                    (int) lengths[i], values[i]);
+        }
+        else {
+            new_field = ds_str_create("");
+        }
+        ds_record_set_field(record, i, new_field);
+    }
+
+    ds_recordset_add_record(*set, record);
+    return true;
+}
+
+bool db_query_integer(ds_str query, uint64_t * value) {
+    *value = 0;
+    return db_query_foreach(query, NULL, db_integer_value_cb, value);
+}
+
+static bool db_integer_value_cb(const size_t num_fields,
+                                const char * const * values,
+                                const size_t * lengths, void * ctx) {
+    (void)lengths;
+
+    uint64_t * value = ctx;
+    if ( num_fields && values[0] ) {
+        *value = strtoull(values[0], NULL, 10);
+    }
+
+    return false;
+}
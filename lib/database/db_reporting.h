@@ -26,5 +26,22 @@ ds_str db_create_report_from_query(ds_str query);
  */
 ds_recordset db_create_recordset_from_query(ds_str query);
 
+/*!
+ * \brief               Creates ds_recordsets from several queries at once.
+ * \details             The queries are independent of each other, and are
+ * run concurrently on separate connections where the database component
+ * and connection pool allow, so the total time taken is close to that of
+ * the slowest query rather than the sum of them all. Function
+ * implementations are provided by the individual database components.
+ * \param num_queries   The number of queries.
+ * \param queries       An array of `num_queries` SELECT queries to run.
+ * \param results       An array of `num_queries` record sets in which to
+ * store the results. An element is set to `NULL` if its query failed.
+ * \returns             `true` if all queries succeeded, `false` otherwise.
+ */
+bool db_create_recordsets_from_queries(const size_t num_queries,
+                                       ds_str * queries,
+                                       ds_recordset * results);
+
 #endif      /*  PG_GENERAL_LEDGER_DATABASE_DB_REPORTING_H  */
 
@@ -6,12 +6,29 @@
  * of the GNU General Public License. <http://www.gnu.org/licenses/>
  */
 
+/*!  UNIX feature test macro  */
+#define _XOPEN_SOURCE 600
+
 #include <assert.h>
+#include <string.h>
+#include <time.h>
 
 #include "db_internal.h"
 #include "file_ops/file_ops.h"
 #include "gl_general/gl_general.h"
 
+/*!  Default number of rows sent in each INSERT statement  */
+#define DEFAULT_ROWS_PER_INSERT 500
+
+/*!  Default number of rows loaded in each transaction  */
+#define DEFAULT_ROWS_PER_COMMIT 10000
+
+/*!  Number of rows sent in each INSERT statement  */
+static size_t rows_per_insert = DEFAULT_ROWS_PER_INSERT;
+
+/*!  Number of rows loaded in each transaction  */
+static size_t rows_per_commit = DEFAULT_ROWS_PER_COMMIT;
+
 /*!
  * \brief           Adds sample data from a file to a database table.
  * \param table     The table into which to load the sample data.
@@ -24,6 +41,43 @@
  */
 static bool db_add_sample_data(const char * table, const char * filename);
 
+/*!
+ * \brief           Returns the number of seconds elapsed since a time.
+ * \param start     The starting time, from `clock_gettime()`.
+ * \returns         The number of seconds elapsed.
+ */
+static double seconds_since(const struct timespec * start);
+
+/*!
+ * \brief           Replaces account numbers in sample data with account IDs.
+ * \details         The account numbers in the `account` field are looked up
+ * in the dimension cache, so the rows can be inserted without the database
+ * looking up each number.
+ * \param data      The sample data.
+ * \param filename  The filename from which the data was read.
+ * \returns         `true` on success, `false` if the data contains an
+ * unknown account number or the cache could not be loaded.
+ */
+static bool db_map_sample_accounts(ds_recordset data, const char * filename);
+
+/*!
+ * \brief           Adds sample JE lines through the JE lines scratch table.
+ * \details         Used in the denormalized layout, where the entity, year
+ * and period of each line are filled from its JE.
+ * \param filename  The filename from which to load the data.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_add_staged_sample_jelines(const char * filename);
+
+void db_set_load_batch_sizes(const size_t insert_rows,
+                             const size_t commit_rows) {
+    rows_per_insert = insert_rows ? insert_rows : DEFAULT_ROWS_PER_INSERT;
+    rows_per_commit = commit_rows ? commit_rows : DEFAULT_ROWS_PER_COMMIT;
+    if ( rows_per_commit < rows_per_insert ) {
+        rows_per_commit = rows_per_insert;
+    }
+}
+
 bool db_load_sample_data(void) {
     static const char * sample_data[][2] = {
         {"standing_data", "sample_data/standing_data"},
@@ -37,34 +91,187 @@ bool db_load_sample_data(void) {
     };
 
     bool status = true;
-    for ( size_t i = 0; sample_data[i][0]; ++i ) {
+    for ( size_t i = 0; status && sample_data[i][0]; ++i ) {
         gl_log_msg("Loading sample data for table %s...", sample_data[i][0]);
-        status = db_add_sample_data(sample_data[i][0],
-                                    sample_data[i][1]);
+        if ( !strcmp(sample_data[i][0], "jelines") &&
+             db_jelines_denormalized() ) {
+            status = db_add_staged_sample_jelines(sample_data[i][1]);
+        }
+        else {
+            status = db_add_sample_data(sample_data[i][0],
+                                        sample_data[i][1]);
+        }
+
+        /*  The dimension cache is reloaded when next used, so JE lines
+         *  see the accounts loaded before them.                        */
+
+        db_dimcache_free();
     }
 
-    return status;
+    status = status && db_rebuild_entity_closure() && db_sync_je_sequence();
+    return db_bump_ledger_version() && status;
 }
 
 static bool db_add_sample_data(const char * table, const char * filename) {
-    bool ret_val = true;
-
     ds_recordset data = delim_file_read(filename, ':');
-    assert(data);
+    if ( !data ) {
+        gl_log_msg("Couldn't read sample data from '%s'.", filename);
+        return false;
+    }
+
+    if ( !strcmp(table, "jelines") &&
+         !db_map_sample_accounts(data, filename) ) {
+        ds_recordset_destroy(data);
+        return false;
+    }
     ds_recordset_seek_start(data);
 
-    ds_str query;
-    while ( (query = ds_recordset_get_next_insert_query(data, table)) ) {
+    const size_t max_length = db_max_query_length();
+    ds_str prefix = ds_recordset_get_insert_prefix(data, table);
+    ds_str query = ds_str_dup(prefix);
+    ds_str tuple = ds_recordset_get_next_values_tuple(data);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    size_t rows_in_query = 0;
+    size_t rows_in_transaction = 0;
+    size_t rows_loaded = 0;
+    bool in_transaction = false;
+    bool ret_val = true;
+
+    while ( ret_val && tuple ) {
+        if ( !in_transaction ) {
+            ret_val = in_transaction = db_begin_transaction();
+            if ( !ret_val ) {
+                break;
+            }
+        }
+
+        /*  Append rows until the statement is full or the next row
+         *  would take it over the server's packet limit.               */
+
+        if ( rows_in_query == 0 ||
+             ds_str_length(query) + ds_str_length(tuple) + 1 < max_length ) {
+            if ( rows_in_query ) {
+                ds_str_concat_cstr(query, ",");
+            }
+            ds_str_concat(query, tuple);
+            ++rows_in_query;
+            ++rows_in_transaction;
+
+            ds_str_destroy(tuple);
+            tuple = ds_recordset_get_next_values_tuple(data);
+
+            if ( tuple && rows_in_query < rows_per_insert &&
+                 rows_in_transaction < rows_per_commit ) {
+                continue;
+            }
+        }
+
         ret_val = db_execute_query(query);
-        ds_str_destroy(query);
+        ds_str_assign(query, prefix);
+        rows_in_query = 0;
+
+        if ( ret_val && (!tuple || rows_in_transaction >= rows_per_commit) ) {
+            ret_val = db_commit_transaction();
+            in_transaction = false;
+            if ( ret_val ) {
+                rows_loaded += rows_in_transaction;
+                rows_in_transaction = 0;
 
-        if ( !ret_val ) {
-            ds_recordset_destroy(data);
-            return false;
+                double elapsed = seconds_since(&start);
+                gl_log_msg("Loaded %zu rows into %s (%.0f rows/sec)...",
+                           rows_loaded, table,
+                           elapsed > 0 ? rows_loaded / elapsed : 0.0);
+            }
         }
     }
 
+    if ( !ret_val ) {
+        if ( in_transaction ) {
+            db_rollback_transaction();
+        }
+        gl_log_msg("Loading %s failed, rolled back %zu uncommitted rows "
+                   "(%zu rows committed).", table,
+                   rows_in_transaction, rows_loaded);
+    }
+
+    ds_str_destroy(tuple);
+    ds_str_destroy(query);
+    ds_str_destroy(prefix);
     ds_recordset_destroy(data);
-    return true;
+    return ret_val;
+}
+
+static bool db_map_sample_accounts(ds_recordset data, const char * filename) {
+    ds_record headers = delim_file_read_headers(filename, ':');
+    if ( !headers ) {
+        gl_log_msg("Couldn't read field names from '%s'.", filename);
+        return false;
+    }
+
+    size_t field = 0;
+    const size_t num_fields = ds_record_size(headers);
+    while ( field < num_fields &&
+            ds_str_compare_cstr(ds_record_get_field(headers, field),
+                                "account") ) {
+        ++field;
+    }
+    ds_record_destroy(headers);
+
+    if ( field == num_fields ) {
+        return true;
+    }
+
+    if ( !db_dimcache_ready() ) {
+        return false;
+    }
+
+    bool status = true;
+    ds_record record;
+    ds_recordset_seek_start(data);
+    while ( status && (record = ds_recordset_next_record(data)) ) {
+        ds_str num = ds_record_get_field(record, field);
+        int id;
+        if ( db_dimcache_account_id(ds_str_cstr(num), &id) ) {
+            ds_record_set_field(record, field,
+                                ds_str_create_sprintf("%d", id));
+        }
+        else {
+            gl_log_msg("Unknown account '%s' in '%s'.",
+                       ds_str_cstr(num), filename);
+            status = false;
+        }
+    }
+    ds_recordset_set_type(data, field, DS_FIELD_INT);
+
+    return status;
 }
 
+static bool db_add_staged_sample_jelines(const char * filename) {
+    if ( !db_create_jelines_stage() ) {
+        return false;
+    }
+
+    bool status = db_add_sample_data("jelines_copy", filename) &&
+                  db_begin_transaction();
+    if ( status ) {
+        status = db_restore_jelines_stage();
+        if ( status ) {
+            status = db_commit_transaction();
+        }
+        else {
+            db_rollback_transaction();
+        }
+    }
+
+    return db_drop_jelines_stage() && status;
+}
+
+static double seconds_since(const struct timespec * start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) +
+           (now.tv_nsec - start->tv_nsec) / 1e9;
+}
@@ -9,12 +9,27 @@
 #ifndef PG_GENERAL_LEDGER_DATABASE_DB_SAMPLEDATA_H
 #define PG_GENERAL_LEDGER_DATABASE_DB_SAMPLEDATA_H
 
+#include <stddef.h>
 #include <stdbool.h>
 
 /*!
  * \brief           Loads sample data into the database.
+ * \details         Rows are sent in multi-row INSERT statements, each kept
+ * below the server's maximum query length, and committed in batches.
+ * Should a statement fail, the current batch is rolled back.
+ * \returns         `true` on success, `false` on failure.
  */
 bool db_load_sample_data(void);
 
+/*!
+ * \brief               Sets the batch sizes used when loading data.
+ * \param insert_rows   The maximum number of rows to send in each INSERT
+ * statement, or 0 to use the default.
+ * \param commit_rows   The maximum number of rows to load in each
+ * transaction, or 0 to use the default.
+ */
+void db_set_load_batch_sizes(const size_t insert_rows,
+                             const size_t commit_rows);
+
 #endif      /*  PG_GENERAL_LEDGER_DATABASE_DB_SAMPLEDATA_H  */
 
@@ -0,0 +1,230 @@
+/*!
+ * \file            db_sequence.c
+ * \brief           Implementation of JE ID sequence functionality.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "gl_general/gl_general.h"
+#include "db_internal.h"
+
+/*!  Block of reserved JE IDs  */
+struct id_block {
+    uint64_t next;              /*!<  Next ID to hand out           */
+    uint64_t end;               /*!<  One past the last ID          */
+    uint64_t generation;        /*!<  Sequence generation the block
+                                      was reserved in               */
+};
+
+/*!  Key for each thread's block of IDs  */
+static pthread_key_t block_key;
+
+/*!  Once control for creating the block key  */
+static pthread_once_t key_once = PTHREAD_ONCE_INIT;
+
+/*!
+ * \brief           Creates the block key.
+ */
+static void db_sequence_key_init(void);
+
+/*!
+ * \brief           Gets the calling thread's block of IDs.
+ * \returns         The block, which is created empty if the thread has
+ * none, or `NULL` on failure.
+ */
+static struct id_block * db_sequence_block(void);
+
+/*!
+ * \brief           Reserves IDs in the database.
+ * \details         Runs in the caller's transaction, if any.
+ * \param count     The number of IDs.
+ * \param first     Modified to contain the first ID reserved.
+ * \param generation    Modified to contain the sequence generation, if
+ * not `NULL`.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_sequence_advance(const size_t count, uint64_t * first,
+                                uint64_t * generation);
+
+/*!
+ * \brief           Checks that a block was reserved in the current
+ * sequence generation.
+ * \details         A block from an earlier generation may overlap JEs
+ * loaded since, so it is emptied.
+ * \param block     The block.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_sequence_check_block(struct id_block * block);
+
+/*!
+ * \brief           Runs a query which does not return a result.
+ * \param cquery    The query.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_sequence_run(const char * cquery);
+
+bool db_create_sequences_table(void) {
+    gl_log_msg("Creating sequences table...");
+    return db_sequence_run(db_create_sequences_table_sql()) &&
+           db_sequence_run(db_init_je_sequence_sql());
+}
+
+bool db_drop_sequences_table(void) {
+    gl_log_msg("Dropping sequences table...");
+    db_sequence_free();
+    return db_sequence_run(db_drop_sequences_table_sql());
+}
+
+bool db_reserve_je_ids(const size_t count) {
+    struct id_block * block = db_sequence_block();
+    if ( !block ) {
+        return false;
+    }
+    if ( block->end - block->next >= count ) {
+        return true;
+    }
+
+    const size_t size = count > DB_JE_ID_BLOCK_SIZE ? count
+                                                    : DB_JE_ID_BLOCK_SIZE;
+    uint64_t first, generation;
+    bool status = db_begin_transaction();
+    if ( status ) {
+        status = db_sequence_advance(size, &first, &generation);
+        if ( status ) {
+            status = db_commit_transaction();
+        }
+        else {
+            db_rollback_transaction();
+        }
+    }
+
+    if ( status ) {
+        block->next = first;
+        block->end = first + size;
+        block->generation = generation;
+    }
+    else {
+        gl_log_msg("Couldn't reserve JE IDs.");
+    }
+    return status;
+}
+
+void db_sequence_free(void) {
+    pthread_once(&key_once, db_sequence_key_init);
+
+    struct id_block * block = pthread_getspecific(block_key);
+    if ( block ) {
+        pthread_setspecific(block_key, NULL);
+        free(block);
+    }
+}
+
+bool db_take_je_ids(const size_t count, uint64_t * first) {
+    struct id_block * block = db_sequence_block();
+    if ( !block ) {
+        return false;
+    }
+
+    /*  IDs reserved in the caller's transaction would be reserved again
+     *  by others if it rolled back, so none are kept for later.         */
+
+    if ( block->end - block->next >= count &&
+         !db_sequence_check_block(block) ) {
+        return false;
+    }
+    if ( block->end - block->next < count ) {
+        return db_sequence_advance(count, first, NULL);
+    }
+
+    *first = block->next;
+    block->next += count;
+    return true;
+}
+
+bool db_sync_je_sequence(void) {
+    db_sequence_free();
+    return db_sequence_run(db_sync_je_sequence_sql());
+}
+
+static void db_sequence_key_init(void) {
+    pthread_key_create(&block_key, free);
+}
+
+static struct id_block * db_sequence_block(void) {
+    pthread_once(&key_once, db_sequence_key_init);
+
+    struct id_block * block = pthread_getspecific(block_key);
+    if ( !block ) {
+        block = calloc(1, sizeof *block);
+        if ( !block || pthread_setspecific(block_key, block) ) {
+            free(block);
+            gl_log_msg("Couldn't allocate memory for JE IDs.");
+            return NULL;
+        }
+    }
+    return block;
+}
+
+static bool db_sequence_advance(const size_t count, uint64_t * first,
+                                uint64_t * generation) {
+    char num[32];
+    snprintf(num, sizeof num, "%zu", count);
+
+    ds_str advance = ds_str_create_sprintf(db_advance_je_sequence_sql(), num);
+    ds_str select = ds_str_create(db_je_sequence_next_id_sql());
+    ds_str gen = generation ? ds_str_create(db_je_sequence_generation_sql())
+                            : NULL;
+    uint64_t next = 0;
+    bool status = advance && select && (gen || !generation) &&
+                  db_execute_query(advance) &&
+                  db_query_integer(select, &next) &&
+                  (!gen || db_query_integer(gen, generation));
+    if ( advance ) {
+        ds_str_destroy(advance);
+    }
+    if ( select ) {
+        ds_str_destroy(select);
+    }
+    if ( gen ) {
+        ds_str_destroy(gen);
+    }
+
+    if ( status && next < count + 1 ) {
+        gl_log_msg("The JE ID sequence is missing.");
+        status = false;
+    }
+
+    if ( status ) {
+        *first = next - count;
+    }
+    return status;
+}
+
+static bool db_sequence_check_block(struct id_block * block) {
+    ds_str query = ds_str_create(db_je_sequence_generation_sql());
+    uint64_t generation = 0;
+    bool status = query && db_query_integer(query, &generation);
+    if ( query ) {
+        ds_str_destroy(query);
+    }
+
+    if ( status && generation != block->generation ) {
+        block->next = block->end;
+    }
+    return status;
+}
+
+static bool db_sequence_run(const char * cquery) {
+    bool status = false;
+    ds_str query = ds_str_create(cquery);
+    if ( query ) {
+        status = db_execute_query(query);
+        ds_str_destroy(query);
+    }
+    return status;
+}
@@ -0,0 +1,64 @@
+/*!
+ * \file            db_sequence.h
+ * \brief           Interface to JE ID sequence functionality.
+ * \details         JE IDs are handed out from the `sequences` table, which
+ * holds the next unreserved ID. Each thread reserves a block of IDs at a
+ * time in a short transaction of its own, and then gives them to the JEs
+ * it posts without going back to the database, so concurrent posters
+ * neither wait on each other for IDs nor look them up after inserting,
+ * and a JE's lines can be written in the same batch as the JE. IDs
+ * reserved but not used are never used. JEs loaded without IDs are given
+ * them by the database, and the sequence is moved past them when the load
+ * finishes, so loads should not run while other programs are posting.
+ * Moving the sequence also starts a new generation of it, and a block
+ * reserved in an earlier generation, which the loaded JEs may have taken
+ * IDs from, is given up and reserved again. Checking the generation costs
+ * one indexed read each time IDs are taken from a block.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_DATABASE_DB_SEQUENCE_H
+#define PG_GENERAL_LEDGER_DATABASE_DB_SEQUENCE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/*!  Number of JE IDs reserved at a time  */
+#define DB_JE_ID_BLOCK_SIZE 1000
+
+/*!
+ * \brief           Creates the sequences table in the database.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_create_sequences_table(void);
+
+/*!
+ * \brief           Drops the sequences table from the database.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_drop_sequences_table(void);
+
+/*!
+ * \brief           Makes sure the calling thread holds enough JE IDs.
+ * \details         If the thread holds fewer than `count` IDs, a new block
+ * of at least `count` IDs is reserved, and any IDs left in the old block
+ * are dropped. This function must be called outside a transaction, since
+ * it commits the reservation at once. Posting functions call it before
+ * they begin their transaction. A thread which has not reserved enough IDs
+ * when it posts reserves exactly the IDs it needs in the posting's
+ * transaction, which then holds other reservations up until it ends.
+ * \param count     The number of IDs needed.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool db_reserve_je_ids(const size_t count);
+
+/*!
+ * \brief           Drops the JE IDs held by the calling thread.
+ * \details         It is safe to call this function if the thread holds
+ * none.
+ */
+void db_sequence_free(void);
+
+#endif      /*  PG_GENERAL_LEDGER_DATABASE_DB_SEQUENCE_H  */
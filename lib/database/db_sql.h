@@ -220,11 +220,770 @@ const char * db_all_jes_report_sql(void);
  */
 const char * db_all_jes_number_report_sql(void);
 
-/*!\
- * \brief           Returns the SQL query to get an entity name from its ID.
+/*!
+ * \brief           Returns the SQL query to disable foreign key and unique
+ * constraint checks for the current session.
+ * \returns         The SQL query.
+ */
+const char * db_disable_constraint_checks_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to enable foreign key and unique
+ * constraint checks for the current session.
+ * \returns         The SQL query.
+ */
+const char * db_enable_constraint_checks_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to bulk load a data file.
+ * \details         The query takes the filename, the table name and a
+ * comma-separated list of fields as `sprintf()` arguments.
+ * \returns         The SQL query.
+ */
+const char * db_load_data_infile_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to count constraint violations.
+ * \details         The query returns one row per foreign key or unique
+ * constraint, with the number of rows violating it in the second field.
+ * \returns         The SQL query.
+ */
+const char * db_constraint_violations_report_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to load entities into the ledger
+ * store.
+ * \details         The query returns the ID and name of each entity.
+ * \returns         The SQL query.
+ */
+const char * db_ledgerstore_entities_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to load nominal accounts into the
+ * ledger store.
+ * \details         The query returns the number and description of each
+ * account.
+ * \returns         The SQL query.
+ */
+const char * db_ledgerstore_nomaccts_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to load journal entries into the
+ * ledger store.
+ * \details         The query returns the ID and entity of each JE.
+ * \returns         The SQL query.
+ */
+const char * db_ledgerstore_jes_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to load JE lines into the ledger
+ * store.
+ * \details         The query returns the JE, account and amount of each
+ * line.
+ * \returns         The SQL query.
+ */
+const char * db_ledgerstore_jelines_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to create the posting journal table.
+ * \returns         The SQL query.
+ */
+const char * db_create_posting_journal_table_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to drop the posting journal table.
+ * \returns         The SQL query.
+ */
+const char * db_drop_posting_journal_table_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to get a journal checkpoint.
+ * \details         The query is a format string taking the journal name, and
+ * returns the last sequence number forwarded from that journal.
+ * \returns         The SQL query.
+ */
+const char * db_get_journal_checkpoint_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to set a journal checkpoint.
+ * \details         The query is a format string taking the journal name and
+ * the sequence number, both as strings.
+ * \returns         The SQL query.
+ */
+const char * db_set_journal_checkpoint_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to create the sequences table.
+ * \returns         The SQL query.
+ */
+const char * db_create_sequences_table_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to drop the sequences table.
+ * \returns         The SQL query.
+ */
+const char * db_drop_sequences_table_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to initialize the JE ID sequence.
+ * \details         The sequence starts after any JEs already present.
+ * \returns         The SQL query.
+ */
+const char * db_init_je_sequence_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to reserve a block of JE IDs.
+ * \details         The query takes the number of IDs. The row stays locked
+ * against other reservations until the transaction ends.
+ * \returns         The SQL query.
+ */
+const char * db_advance_je_sequence_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to get the next unreserved JE ID.
+ * \returns         The SQL query.
+ */
+const char * db_je_sequence_next_id_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to get the generation of the JE ID
+ * sequence.
+ * \returns         The SQL query.
+ */
+const char * db_je_sequence_generation_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to move the JE ID sequence past
+ * the JE IDs in use and start a new generation.
+ * \returns         The SQL query.
+ */
+const char * db_sync_je_sequence_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to create the account balances
+ * table.
+ * \returns         The SQL query.
+ */
+const char * db_create_account_balances_table_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to drop the account balances table.
+ * \returns         The SQL query.
+ */
+const char * db_drop_account_balances_table_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to create the trigger which adds
+ * each new JE line to the account balances.
+ * \returns         The SQL query.
+ */
+const char * db_create_account_balances_trigger_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to drop the account balances
+ * trigger.
+ * \returns         The SQL query.
+ */
+const char * db_drop_account_balances_trigger_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to delete all account balances.
+ * \returns         The SQL query.
+ */
+const char * db_clear_account_balances_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to recalculate the account balances
+ * from the JE lines.
+ * \returns         The SQL query.
+ */
+const char * db_rebuild_account_balances_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to create the period balances
+ * table.
+ * \returns         The SQL query.
+ */
+const char * db_create_period_balances_table_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to drop the period balances table.
+ * \returns         The SQL query.
+ */
+const char * db_drop_period_balances_table_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to create the trigger which adds
+ * each new JE line to the period balances.
+ * \returns         The SQL query.
+ */
+const char * db_create_period_balances_trigger_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to drop the period balances
+ * trigger.
+ * \returns         The SQL query.
+ */
+const char * db_drop_period_balances_trigger_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to delete an entity's period
+ * balances.
+ * \details         The query is a format string taking the entity ID.
+ * \returns         The SQL query.
+ */
+const char * db_clear_entity_period_balances_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to recalculate an entity's period
+ * balances from the JE lines.
+ * \details         The query is a format string taking the entity ID.
+ * \returns         The SQL query.
+ */
+const char * db_rebuild_entity_period_balances_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to list all entity IDs.
+ * \returns         The SQL query.
+ */
+const char * db_list_entity_ids_sql(void);
+
+/*!
+ * \brief           Returns the SQL query for the trial balance report as at
+ * the end of a period, for all entities.
+ * \details         The query is a format string taking the year, the year
+ * again, and the period.
+ * \returns         The SQL query.
+ */
+const char * db_period_trial_balance_report_sql(void);
+
+/*!
+ * \brief           Returns the SQL query for the trial balance report as at
+ * the end of a period, for one entity.
+ * \details         The query is a format string taking the entity, the
+ * year, the year again, and the period.
+ * \returns         The SQL query.
+ */
+const char * db_period_trial_balance_entity_report_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to create an index.
+ * \details         The query is a format string taking the index name, the
+ * table name and the column list.
+ * \returns         The SQL query.
+ */
+const char * db_create_index_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to drop an index.
+ * \details         The query is a format string taking the index name and
+ * the table name.
+ * \returns         The SQL query.
+ */
+const char * db_drop_index_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to check whether an index exists.
+ * \details         The query is a format string taking the index name and
+ * the table name, and returns a count of matching indexes.
+ * \returns         The SQL query.
+ */
+const char * db_index_exists_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to create the JE lines table
+ * clustered on JE and line number.
+ * \returns         The SQL query.
+ */
+const char * db_create_clustered_jelines_table_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to copy the JE lines to a scratch
+ * table.
+ * \returns         The SQL query.
+ */
+const char * db_copy_jelines_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to restore the JE lines from the
+ * scratch table.
+ * \returns         The SQL query.
+ */
+const char * db_restore_jelines_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to drop the JE lines scratch table.
+ * \returns         The SQL query.
+ */
+const char * db_drop_jelines_copy_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to create the JE lines table
+ * with denormalized entity, year and period columns.
+ * \returns         The SQL query.
+ */
+const char * db_create_denormalized_jelines_table_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to create the unique key on JEs
+ * referenced by the denormalized JE lines.
+ * \returns         The SQL query.
+ */
+const char * db_create_jes_denormalized_key_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to create an empty JE lines
+ * scratch table.
+ * \returns         The SQL query.
+ */
+const char * db_create_jelines_copy_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to restore the JE lines from the
+ * scratch table with denormalized columns.
+ * \returns         The SQL query.
+ */
+const char * db_restore_denormalized_jelines_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to create the account balances
+ * trigger on denormalized JE lines.
+ * \returns         The SQL query.
+ */
+const char * db_create_denormalized_account_balances_trigger_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to create the period balances
+ * trigger on denormalized JE lines.
+ * \returns         The SQL query.
+ */
+const char * db_create_denormalized_period_balances_trigger_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to rebuild the account balances
+ * from denormalized JE lines.
+ * \returns         The SQL query.
+ */
+const char * db_rebuild_denormalized_account_balances_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to rebuild the period balances
+ * for an entity from denormalized JE lines.
+ * \details         The query is a format string taking the entity ID.
+ * \returns         The SQL query.
+ */
+const char * db_rebuild_denormalized_entity_period_balances_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to create the all JEs view on
+ * denormalized JE lines.
+ * \returns         The SQL query.
+ */
+const char * db_create_denormalized_all_jes_view_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to get the ID of every nominal
+ * account, by account number.
+ * \returns         The SQL query.
+ */
+const char * db_account_dictionary_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to create the partitioned JE lines
+ * table.
+ * \returns         The SQL query.
+ */
+const char * db_create_partitioned_jelines_table_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to create the partitioned journal
+ * entries table.
+ * \returns         The SQL query.
+ */
+const char * db_create_partitioned_jes_table_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to add a year partition to a table.
+ * \details         The query is a format string taking the table name, the
+ * year, and the year after it.
+ * \returns         The SQL query, or `NULL` if the database does not
+ * partition tables.
+ */
+const char * db_add_partition_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to add the first year partition
+ * to a table, below which a catch-all partition holds any earlier years.
+ * \details         The query is a format string taking the table name, the
+ * year, the year again, and the year after it.
+ * \returns         The SQL query, or `NULL` if the database does not
+ * partition tables.
+ */
+const char * db_add_first_partition_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to check if a year partition of a
+ * table exists.
+ * \details         The query is a format string taking the table name and
+ * the year.
+ * \returns         The SQL query, or `NULL` if the database does not
+ * partition tables.
+ */
+const char * db_partition_exists_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to get the year after the last
+ * year partition of a table, or 0 if it has none.
+ * \details         The query is a format string taking the table name.
+ * \returns         The SQL query, or `NULL` if the database does not
+ * partition tables.
+ */
+const char * db_partition_bound_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to check if a table exists.
+ * \details         The query is a format string taking the table name.
+ * \returns         The SQL query.
+ */
+const char * db_table_exists_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to check if the archive table for
+ * a year of a table is partitioned.
+ * \details         The query is a format string taking the table name and
+ * the year.
+ * \returns         The SQL query, or `NULL` if the database does not
+ * partition tables.
+ */
+const char * db_archive_partitioned_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to count the rows for a year of a
+ * table.
+ * \details         The query is a format string taking the table name and
+ * the year.
+ * \returns         The SQL query.
+ */
+const char * db_count_year_rows_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to count the rows in the archive
+ * table for a year of a table.
+ * \details         The query is a format string taking the table name and
+ * the year.
+ * \returns         The SQL query.
+ */
+const char * db_count_archive_rows_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to drop a year partition from a
+ * table, with its rows.
+ * \details         The query is a format string taking the table name and
+ * the year.
+ * \returns         The SQL query.
+ */
+const char * db_drop_partition_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to create the empty archive table
+ * for a year of a table.
+ * \details         The query is a format string taking the table name and
+ * the year, twice.
+ * \returns         The SQL query.
+ */
+const char * db_create_archive_table_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to remove partitioning from the
+ * archive table for a year of a table.
+ * \details         The query is a format string taking the table name and
+ * the year.
+ * \returns         The SQL query, or `NULL` if the database does not
+ * partition tables.
+ */
+const char * db_remove_partitioning_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to move a year partition of a
+ * table into its archive table.
+ * \details         The query is a format string taking the table name and
+ * the year, twice.
+ * \returns         The SQL query.
+ */
+const char * db_exchange_partition_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to create the ledger version table.
+ * \returns         The SQL query.
+ */
+const char * db_create_ledger_version_table_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to drop the ledger version table.
+ * \returns         The SQL query.
+ */
+const char * db_drop_ledger_version_table_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to initialize the ledger version.
+ * \details         The version starts at zero, with an epoch taken from
+ * the current time, so that a recreated database does not repeat the
+ * versions of the one it replaced.
+ * \returns         The SQL query.
+ */
+const char * db_init_ledger_version_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to get the ledger epoch and
+ * version.
+ * \returns         The SQL query.
+ */
+const char * db_ledger_version_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to increment the ledger version.
+ * \returns         The SQL query.
+ */
+const char * db_bump_ledger_version_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to get the name of every entity,
+ * by ID.
+ * \returns         The SQL query.
+ */
+const char * db_entity_dictionary_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to get the user name of every user, by
+ * ID.
+ * \returns         The SQL query.
+ */
+const char * db_user_dictionary_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to get the description of every JE
+ * source, by name.
+ * \returns         The SQL query.
+ */
+const char * db_source_dictionary_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to get the last JE ID in a page of
+ * JEs.
+ * \details         The page is found from its key, the JE ID before it,
+ * rather than with an offset, so each page is read from the primary key
+ * index in the same time wherever it is in the ledger.
+ * \returns         The SQL query.
+ */
+const char * db_je_page_end_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to show the JEs with IDs after one
+ * ID and up to and including another.
+ * \returns         The SQL query.
+ */
+const char * db_all_jes_page_report_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to show a filtered list of journal
+ * entries.
+ * \details         The query takes a WHERE clause and a LIMIT clause, either
+ * of which may be empty, each with a leading space.
+ * \returns         The SQL query.
+ */
+const char * db_list_jes_filtered_report_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to show a filtered list of journal
+ * entry lines.
+ * \details         The query takes a WHERE clause and a LIMIT clause, either
+ * of which may be empty, each with a leading space.
+ * \returns         The SQL query.
+ */
+const char * db_list_jelines_filtered_report_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to show a filtered list of nominal
+ * accounts.
+ * \details         The query takes a WHERE clause and a LIMIT clause, either
+ * of which may be empty, each with a leading space.
+ * \returns         The SQL query.
+ */
+const char * db_list_nomaccts_filtered_report_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to show filtered detailed journal
+ * entries.
+ * \details         The query takes a WHERE clause and a LIMIT clause, either
+ * of which may be empty, each with a leading space.
+ * \returns         The SQL query.
+ */
+const char * db_all_jes_filtered_report_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to show a filtered current trial
+ * balance.
+ * \details         The query takes a WHERE clause and a LIMIT clause, either
+ * of which may be empty, each with a leading space.
+ * \returns         The SQL query.
+ */
+const char * db_current_trial_balance_filtered_report_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to select columns from a report
+ * query.
+ * \details         The query takes a list of quoted column names, and the
+ * report query.
+ * \returns         The SQL query.
+ */
+const char * db_project_report_sql(void);
+
+/*!
+ * \brief           Returns the SQL to quote an identifier.
+ * \returns         The SQL, which takes the identifier.
+ */
+const char * db_quote_identifier_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to create the entity versions
+ * table.
+ * \returns         The SQL query.
+ */
+const char * db_create_entity_versions_table_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to drop the entity versions table.
+ * \returns         The SQL query.
+ */
+const char * db_drop_entity_versions_table_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to set the version of every entity
+ * to the ledger version.
+ * \returns         The SQL query.
+ */
+const char * db_stamp_all_entity_versions_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to set the version of a list of
+ * entities to the ledger version.
+ * \details         The query takes a comma-separated list of entity IDs.
+ * \returns         The SQL query.
+ */
+const char * db_stamp_entity_versions_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to get the entity hierarchy and
+ * entity versions.
+ * \returns         The SQL query.
+ */
+const char * db_consolidation_entities_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to get the nominal accounts for
+ * consolidation.
+ * \returns         The SQL query.
+ */
+const char * db_consolidation_accounts_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to get the account balances of an
+ * entity.
+ * \details         The query takes the entity ID.
+ * \returns         The SQL query.
+ */
+const char * db_entity_account_balances_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to create the entity closure
+ * table.
+ * \returns         The SQL query.
+ */
+const char * db_create_entity_closure_table_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to drop the entity closure table.
+ * \returns         The SQL query.
+ */
+const char * db_drop_entity_closure_table_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to clear the entity closure table.
+ * \returns         The SQL query.
+ */
+const char * db_clear_entity_closure_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to add every entity to the entity
+ * closure as its own descendant.
+ * \returns         The SQL query.
+ */
+const char * db_init_entity_closure_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to add the children of the
+ * descendants at a depth to the entity closure.
+ * \details         The query takes the depth.
+ * \returns         The SQL query.
+ */
+const char * db_extend_entity_closure_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to count the entity closure rows
+ * at a depth.
+ * \details         The query takes the depth.
+ * \returns         The SQL query.
+ */
+const char * db_count_entity_closure_depth_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to get the entity closure.
+ * \returns         The SQL query.
+ */
+const char * db_entity_closure_sql(void);
+
+/*!
+ * \brief           Returns the SQL predicate to test whether an entity is
+ * under another.
+ * \details         The predicate takes the entity expression and the ID of
+ * the entity above it. An entity is under itself.
+ * \returns         The SQL predicate.
+ */
+const char * db_entity_subtree_predicate_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to get the current year and
+ * period.
+ * \returns         The SQL query.
+ */
+const char * db_standing_data_period_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to get the current year and
+ * period, locked against changes until the transaction ends.
+ * \details         Run in a posting's transaction, this makes a year-end
+ * close wait for the posting to commit, and the posting wait for the
+ * close to commit.
+ * \returns         The SQL query.
+ */
+const char * db_lock_standing_data_period_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to set the current year and
+ * period.
+ * \details         The query takes the year and period.
+ * \returns         The SQL query.
+ */
+const char * db_set_standing_data_period_sql(void);
+
+/*!
+ * \brief           Returns the SQL query to get an entity's income and
+ * expense balances for a year.
+ * \details         The query takes the entity ID, the year, and the first
+ * income account number.
  * \returns         The SQL query.
  */
-const char * db_get_entity_name_from_id_sql(void);
+const char * db_entity_closing_balances_sql(void);
 
 #endif      /*  PG_GENERAL_LEDGER_DATABASE_DB_SQL_H  */
 
@@ -17,6 +17,16 @@ bool db_create_database_structure(void) {
         db_create_nomaccts_table,
         db_create_jes_table,
         db_create_jelines_table,
+        db_create_posting_journal_table,
+        db_create_ledger_version_table,
+        db_create_sequences_table,
+        db_create_entity_versions_table,
+        db_create_entity_closure_table,
+        db_create_account_balances_table,
+        db_create_account_balances_trigger,
+        db_create_period_balances_table,
+        db_create_period_balances_trigger,
+        db_create_indexes,
         db_create_current_trial_balance_view,
         db_create_check_total_view,
         db_create_all_jes_view,
@@ -28,6 +38,7 @@ bool db_create_database_structure(void) {
         status = createfunc[i]();
     }
 
+    db_dimcache_free();
     return status;
 }
 
@@ -36,6 +47,15 @@ bool db_delete_database_structure(void) {
         db_drop_all_jes_view,
         db_drop_check_total_view,
         db_drop_current_trial_balance_view,
+        db_drop_period_balances_trigger,
+        db_drop_period_balances_table,
+        db_drop_account_balances_trigger,
+        db_drop_account_balances_table,
+        db_drop_entity_closure_table,
+        db_drop_entity_versions_table,
+        db_drop_sequences_table,
+        db_drop_ledger_version_table,
+        db_drop_posting_journal_table,
         db_drop_jelines_table,
         db_drop_jes_table,
         db_drop_nomaccts_table,
@@ -51,6 +71,7 @@ bool db_delete_database_structure(void) {
         status = dropfunc[i]();
     }
 
+    db_dimcache_free();
     return status;
 }
 
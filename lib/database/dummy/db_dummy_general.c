@@ -35,35 +35,86 @@ void db_close(void) {
     gl_log_msg("Dummy connection closed.");
 }
 
+void db_set_pool_size(const size_t size) {
+    (void)size;
+}
+
+size_t db_pool_size(void) {
+    return 1;
+}
+
+bool db_pool_checkout(void) {
+    return true;
+}
+
+void db_pool_checkin(void) {
+}
+
 bool db_execute_query(ds_str query) {
     gl_log_msg("Dummy query successful");
     (void)query;
     return true;
 }
 
-ds_recordset db_create_recordset_from_query(ds_str query) {
-    const size_t num_fields = 4;
-    const size_t num_rows = 5;
-    ds_recordset set = ds_recordset_create(num_fields);
+bool db_execute_load_query(ds_str query, size_t * rows) {
+    gl_log_msg("Dummy load successful");
+    (void)query;
+    if ( rows ) {
+        *rows = 0;
+    }
+    return true;
+}
+
+bool db_begin_transaction(void) {
+    gl_log_msg("Dummy transaction started.");
+    return true;
+}
+
+bool db_commit_transaction(void) {
+    gl_log_msg("Dummy transaction committed.");
+    return true;
+}
+
+bool db_rollback_transaction(void) {
+    gl_log_msg("Dummy transaction rolled back.");
+    return true;
+}
+
+size_t db_max_query_length(void) {
+    return 1024 * 1024;
+}
+
+bool db_query_foreach(ds_str query, db_header_callback header_cb,
+                      db_row_callback row_cb, void * ctx) {
+    enum { num_fields = 4, num_rows = 5 };
+    char names[num_fields][20];
+    char values[num_fields][20];
+    const char * name_ptrs[num_fields];
+    const char * value_ptrs[num_fields];
+    size_t lengths[num_fields];
 
-    ds_record field_names = ds_record_create(num_fields);
     for ( size_t i = 0; i < num_fields; ++i ) {
-        ds_str field = ds_str_create_sprintf("Header %zu", i+1);
-        ds_record_set_field(field_names, i, field);
+        sprintf(names[i], "Header %zu", i+1);
+        name_ptrs[i] = names[i];
+        sprintf(values[i], "Dummy data %zu", i+1);
+        value_ptrs[i] = values[i];
+        lengths[i] = strlen(values[i]);
     }
 
-    ds_recordset_set_headers(set, field_names);
-
-    for ( size_t j = 0; j < num_rows; ++j ) {
-        ds_record record = ds_record_create(num_fields);
-        for ( size_t i = 0; i < num_fields; ++i ) {
-            ds_str data = ds_str_create_sprintf("Dummy data %zu", i+1);
-            ds_record_set_field(record, i, data);
-        }
-        ds_recordset_add_record(set, record);
+    bool keep_going = header_cb ? header_cb(num_fields, name_ptrs, ctx) : true;
+    for ( size_t j = 0; keep_going && j < num_rows; ++j ) {
+        keep_going = row_cb(num_fields, value_ptrs, lengths, ctx);
     }
 
     (void)query;
-    return set;
+    return true;
 }
 
+bool db_create_recordsets_from_queries(const size_t num_queries,
+                                       ds_str * queries,
+                                       ds_recordset * results) {
+    for ( size_t i = 0; i < num_queries; ++i ) {
+        results[i] = db_create_recordset_from_query(queries[i]);
+    }
+    return true;
+}
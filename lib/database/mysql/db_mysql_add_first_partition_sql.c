@@ -0,0 +1,17 @@
+/*!
+ * \file            db_mysql_add_first_partition_sql.c
+ * \brief           Returns MYSQL SQL query to add the first year partition.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_add_first_partition_sql(void) {
+    static const char * query = 
+        "ALTER TABLE %s REORGANIZE PARTITION pmax INTO ("
+        "    PARTITION pold VALUES LESS THAN (%d),"
+        "    PARTITION p%d VALUES LESS THAN (%d),"
+        "    PARTITION pmax VALUES LESS THAN MAXVALUE"
+        "  )";
+    return query;
+}
@@ -0,0 +1,17 @@
+/*!
+ * \file            db_mysql_archive_partitioned_sql.c
+ * \brief           Returns MYSQL SQL query to check if the archive table for
+ * a year is partitioned.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_archive_partitioned_sql(void) {
+    static const char * query = 
+        "SELECT COUNT(*) FROM information_schema.partitions"
+        "  WHERE table_name = '%s_archive_%d'"
+        "    AND partition_name IS NOT NULL"
+        "    AND table_schema = DATABASE()";
+    return query;
+}
@@ -0,0 +1,369 @@
+/*!
+ * \file            db_mysql_async.c
+ * \brief           Implementation of MYSQL concurrent query functionality.
+ * \details         With a client library providing the non-blocking API
+ * (MariaDB Connector/C, or libmysqlclient from MariaDB) queries are run
+ * concurrently on separate pooled connections from a single thread,
+ * driven by a `poll()` loop. Otherwise they are run one after another.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+/*!  UNIX feature test macro  */
+#define _XOPEN_SOURCE 600
+
+#include <my_global.h>
+#include <my_sys.h>
+#include <mysql.h>
+
+#include <stdlib.h>
+#include <errno.h>
+#include <poll.h>
+
+#include "gl_general/gl_general.h"
+#include "database/db_internal.h"
+#include "db_mysql_internal.h"
+
+#ifdef DB_MYSQL_NONBLOCKING
+
+/*!  Enumeration for the phase of a concurrent query  */
+enum async_phase {
+    ASYNC_QUERY,            /*!<  Sending query, awaiting status    */
+    ASYNC_STORE,            /*!<  Receiving result set              */
+    ASYNC_DONE              /*!<  Finished, successfully or not     */
+};
+
+/*!  Concurrent query structure  */
+struct async_query {
+    MYSQL * mss;                /*!<  The connection running the query  */
+    ds_str query;               /*!<  The query                         */
+    ds_recordset * result;      /*!<  Where to store the result         */
+    enum async_phase phase;     /*!<  The current phase                 */
+    int wait_status;            /*!<  Events the library is waiting for */
+    MYSQL_RES * res;            /*!<  The result, once received         */
+    bool failed;                /*!<  `true` if the query failed        */
+};
+
+/*!
+ * \brief           Starts running a query.
+ * \param aq        The query, with its connection set.
+ */
+static void async_start(struct async_query * aq);
+
+/*!
+ * \brief           Continues running a query after an event.
+ * \param aq        The query.
+ * \param events    The `MYSQL_WAIT_*` events which occurred.
+ */
+static void async_continue(struct async_query * aq, const int events);
+
+/*!
+ * \brief           Handles completion of the query phase.
+ * \param aq        The query.
+ * \param err       The error status of the query.
+ */
+static void async_query_done(struct async_query * aq, const int err);
+
+/*!
+ * \brief           Handles completion of the result phase.
+ * \param aq        The query.
+ */
+static void async_store_done(struct async_query * aq);
+
+/*!
+ * \brief           Converts `MYSQL_WAIT_*` events to `poll()` events.
+ * \param wait_status   The `MYSQL_WAIT_*` events.
+ * \returns         The `poll()` events.
+ */
+static short wait_to_poll_events(const int wait_status);
+
+/*!
+ * \brief           Converts `poll()` events to `MYSQL_WAIT_*` events.
+ * \param revents   The `poll()` events.
+ * \returns         The `MYSQL_WAIT_*` events.
+ */
+static int poll_to_wait_events(const short revents);
+
+bool db_create_recordsets_from_queries(const size_t num_queries,
+                                       ds_str * queries,
+                                       ds_recordset * results) {
+    MYSQL * own_mss = db_mysql_connection();
+    if ( !own_mss ) {
+        gl_log_msg("Attempting to run queries with no connection.");
+        return false;
+    }
+
+    struct async_query * aqs = calloc(num_queries, sizeof *aqs);
+    MYSQL ** conns = calloc(num_queries, sizeof *conns);
+    struct async_query ** running = calloc(num_queries, sizeof *running);
+    struct pollfd * fds = calloc(num_queries, sizeof *fds);
+    if ( !aqs || !conns || !running || !fds ) {
+        free(aqs);
+        free(conns);
+        free(running);
+        free(fds);
+        gl_log_msg("Couldn't allocate memory for concurrent queries.");
+        return false;
+    }
+
+    /*  Use the calling thread's connection plus as many idle pooled
+     *  connections as there are queries, without waiting for any.     */
+
+    size_t num_conns = 0;
+    conns[num_conns++] = own_mss;
+    while ( num_conns < num_queries &&
+            (conns[num_conns] = db_mysql_pool_acquire(false)) ) {
+        ++num_conns;
+    }
+
+    for ( size_t i = 0; i < num_queries; ++i ) {
+        results[i] = NULL;
+        aqs[i].query = queries[i];
+        aqs[i].result = &results[i];
+        aqs[i].phase = ASYNC_QUERY;
+    }
+
+    /*  Each connection runs one query at a time. When a query finishes,
+     *  the next pending one is started on its connection.              */
+
+    size_t next_query = 0;
+    size_t num_running = 0;
+    for ( size_t c = 0; c < num_conns; ++c ) {
+        running[c] = NULL;
+    }
+
+    do {
+        for ( size_t c = 0; c < num_conns; ++c ) {
+            while ( (!running[c] || running[c]->phase == ASYNC_DONE) &&
+                    next_query < num_queries ) {
+                if ( !running[c] ) {
+                    ++num_running;
+                }
+                running[c] = &aqs[next_query++];
+                running[c]->mss = conns[c];
+                async_start(running[c]);
+            }
+
+            if ( running[c] && running[c]->phase == ASYNC_DONE ) {
+                running[c] = NULL;
+                --num_running;
+            }
+        }
+
+        if ( num_running == 0 ) {
+            break;
+        }
+
+        int timeout = -1;
+        for ( size_t c = 0; c < num_conns; ++c ) {
+            fds[c].fd = -1;
+            fds[c].events = 0;
+            fds[c].revents = 0;
+
+            if ( running[c] ) {
+                fds[c].fd = mysql_get_socket(conns[c]);
+                fds[c].events = wait_to_poll_events(running[c]->wait_status);
+
+                if ( running[c]->wait_status & MYSQL_WAIT_TIMEOUT ) {
+                    int ms = (int) mysql_get_timeout_value_ms(conns[c]);
+                    if ( timeout < 0 || ms < timeout ) {
+                        timeout = ms;
+                    }
+                }
+            }
+        }
+
+        int num_ready = poll(fds, num_conns, timeout);
+        if ( num_ready < 0 ) {
+            if ( errno == EINTR ) {
+                continue;
+            }
+            gl_log_msg("Couldn't poll database connections.");
+            break;
+        }
+
+        for ( size_t c = 0; c < num_conns; ++c ) {
+            if ( !running[c] ) {
+                continue;
+            }
+
+            int events = poll_to_wait_events(fds[c].revents);
+            if ( !events && num_ready == 0 &&
+                 (running[c]->wait_status & MYSQL_WAIT_TIMEOUT) ) {
+                events = MYSQL_WAIT_TIMEOUT;
+            }
+
+            if ( events ) {
+                async_continue(running[c], events);
+            }
+        }
+    } while ( true );
+
+    /*  A connection left mid-query after a poll failure is unusable,
+     *  so it is closed rather than returned to the pool in that state. */
+
+    for ( size_t c = 0; c < num_conns; ++c ) {
+        if ( running[c] ) {
+            running[c]->failed = true;
+            db_mysql_pool_discard(conns[c]);
+        }
+        else if ( c > 0 ) {
+            db_mysql_pool_release(conns[c]);
+        }
+    }
+
+    bool ret_val = true;
+    for ( size_t i = 0; i < num_queries; ++i ) {
+        if ( aqs[i].failed || aqs[i].phase != ASYNC_DONE ) {
+            ret_val = false;
+        }
+    }
+
+    free(aqs);
+    free(conns);
+    free(running);
+    free(fds);
+
+    return ret_val;
+}
+
+static void async_start(struct async_query * aq) {
+    int err = 0;
+    aq->phase = ASYNC_QUERY;
+    aq->wait_status = mysql_real_query_start(&err, aq->mss,
+            ds_str_cstr(aq->query), ds_str_length(aq->query));
+    if ( !aq->wait_status ) {
+        async_query_done(aq, err);
+    }
+}
+
+static void async_continue(struct async_query * aq, const int events) {
+    if ( aq->phase == ASYNC_QUERY ) {
+        int err = 0;
+        aq->wait_status = mysql_real_query_cont(&err, aq->mss, events);
+        if ( !aq->wait_status ) {
+            async_query_done(aq, err);
+        }
+    }
+    else if ( aq->phase == ASYNC_STORE ) {
+        aq->wait_status = mysql_store_result_cont(&aq->res, aq->mss, events);
+        if ( !aq->wait_status ) {
+            async_store_done(aq);
+        }
+    }
+}
+
+static void async_query_done(struct async_query * aq, const int err) {
+    if ( err ) {
+        db_mysql_error_msg("Query unsuccessful", aq->mss);
+        aq->failed = true;
+        aq->phase = ASYNC_DONE;
+        return;
+    }
+
+    aq->phase = ASYNC_STORE;
+    aq->wait_status = mysql_store_result_start(&aq->res, aq->mss);
+    if ( !aq->wait_status ) {
+        async_store_done(aq);
+    }
+}
+
+static void async_store_done(struct async_query * aq) {
+    aq->phase = ASYNC_DONE;
+
+    if ( !aq->res ) {
+        db_mysql_error_msg("Couldn't store result", aq->mss);
+        aq->failed = true;
+        return;
+    }
+
+    /*  The whole result is now held by the client library, so fetching
+     *  rows from it does not block.                                    */
+
+    unsigned int num_fields = mysql_num_fields(aq->res);
+    MYSQL_FIELD * fields = mysql_fetch_fields(aq->res);
+    const char ** names = malloc(num_fields * sizeof *names);
+    size_t * lengths = malloc(num_fields * sizeof *lengths);
+
+    bool keep_going = names && lengths;
+    if ( keep_going ) {
+        for ( size_t i = 0; i < num_fields; ++i ) {
+            names[i] = fields[i].name;
+        }
+        keep_going = db_recordset_header_cb(num_fields, names, aq->result);
+    }
+
+    MYSQL_ROW row;
+    while ( keep_going && (row = mysql_fetch_row(aq->res)) ) {
+        unsigned long * row_lengths = mysql_fetch_lengths(aq->res);
+        for ( size_t i = 0; i < num_fields; ++i ) {
+            lengths[i] = row_lengths[i];
+        }
+        keep_going = db_recordset_row_cb(num_fields,
+                (const char * const *) row, lengths, aq->result);
+    }
+
+    if ( !keep_going ) {
+        gl_log_msg("Couldn't create record set from result.");
+        aq->failed = true;
+        if ( *aq->result ) {
+            ds_recordset_destroy(*aq->result);
+            *aq->result = NULL;
+        }
+    }
+
+    mysql_free_result(aq->res);
+    aq->res = NULL;
+    free(names);
+    free(lengths);
+}
+
+static short wait_to_poll_events(const int wait_status) {
+    short events = 0;
+    if ( wait_status & MYSQL_WAIT_READ ) {
+        events |= POLLIN;
+    }
+    if ( wait_status & MYSQL_WAIT_WRITE ) {
+        events |= POLLOUT;
+    }
+    if ( wait_status & MYSQL_WAIT_EXCEPT ) {
+        events |= POLLPRI;
+    }
+    return events;
+}
+
+static int poll_to_wait_events(const short revents) {
+    int events = 0;
+
+    /*  Errors and hangups are reported as readable, so that the client
+     *  library notices them on its next read.                          */
+
+    if ( revents & (POLLIN | POLLERR | POLLHUP) ) {
+        events |= MYSQL_WAIT_READ;
+    }
+    if ( revents & POLLOUT ) {
+        events |= MYSQL_WAIT_WRITE;
+    }
+    if ( revents & POLLPRI ) {
+        events |= MYSQL_WAIT_EXCEPT;
+    }
+    return events;
+}
+
+#else
+
+bool db_create_recordsets_from_queries(const size_t num_queries,
+                                       ds_str * queries,
+                                       ds_recordset * results) {
+    bool ret_val = true;
+    for ( size_t i = 0; i < num_queries; ++i ) {
+        results[i] = db_create_recordset_from_query(queries[i]);
+        if ( !results[i] ) {
+            ret_val = false;
+        }
+    }
+    return ret_val;
+}
+
+#endif
@@ -0,0 +1,17 @@
+/*!
+ * \file            db_mysql_copy_jelines_sql.c
+ * \brief           Returns MYSQL SQL query to copy JE lines to a scratch table.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_copy_jelines_sql(void) {
+    static const char * query = 
+        "CREATE TABLE jelines_copy AS"
+        "  SELECT l.je, l.line_no, a.num AS account, l.amount"
+        "    FROM jelines AS l"
+        "    INNER JOIN nomaccts AS a"
+        "      ON a.id = l.account";
+    return query;
+}
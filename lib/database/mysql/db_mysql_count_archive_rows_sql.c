@@ -0,0 +1,13 @@
+/*!
+ * \file            db_mysql_count_archive_rows_sql.c
+ * \brief           Returns MYSQL SQL query to count the rows in the archive
+ * table for a year.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_count_archive_rows_sql(void) {
+    static const char * query = "SELECT COUNT(*) FROM %s_archive_%d";
+    return query;
+}
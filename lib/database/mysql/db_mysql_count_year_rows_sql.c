@@ -0,0 +1,13 @@
+/*!
+ * \file            db_mysql_count_year_rows_sql.c
+ * \brief           Returns MYSQL SQL query to count the rows for a year of a
+ * table.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_count_year_rows_sql(void) {
+    static const char * query = "SELECT COUNT(*) FROM %s WHERE year = %d";
+    return query;
+}
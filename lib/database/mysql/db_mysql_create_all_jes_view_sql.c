@@ -12,15 +12,15 @@ const char * db_create_all_jes_view_sql(void) {
         "  SELECT"
         "    l.je AS 'JE',"
         "    j.entity AS 'En',"
-        "    l.account AS 'A/C No.',"
+        "    a.num AS 'A/C No.',"
         "    a.description AS 'Description',"
         "    l.amount AS 'Amount'"
         "    FROM jelines AS l"
         "    INNER JOIN jes AS j"
         "      ON j.id = l.je"
         "    INNER JOIN nomaccts AS a"
-        "      ON a.num = l.account"
-        "    ORDER BY j.id ASC, l.account ASC";
+        "      ON a.id = l.account"
+        "    ORDER BY j.id ASC, a.num ASC";
     return query;
 }
 
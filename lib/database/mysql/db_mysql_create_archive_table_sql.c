@@ -0,0 +1,12 @@
+/*!
+ * \file            db_mysql_create_archive_table_sql.c
+ * \brief           Returns MYSQL SQL query to create a year archive table.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_create_archive_table_sql(void) {
+    static const char * query = "CREATE TABLE %s_archive_%d LIKE %s";
+    return query;
+}
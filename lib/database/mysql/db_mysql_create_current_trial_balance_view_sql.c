@@ -10,17 +10,14 @@ const char * db_create_current_trial_balance_view_sql(void) {
     static const char * query = 
         "CREATE VIEW current_trial_balance AS"
         "  SELECT"
-        "    j.entity AS 'Entity',"
+        "    b.entity AS 'Entity',"
         "    a.num AS 'A/C No.',"
         "    a.description AS 'Description',"
-        "    sum(l.amount) AS 'Balance'"
-        "    FROM nomaccts AS a"
-        "    LEFT OUTER JOIN jelines AS l"
-        "      ON a.num = l.account"
-        "    INNER JOIN jes AS j"
-        "      ON l.je = j.id"
-        "    GROUP BY j.entity, a.num"
-        "    ORDER BY j.entity ASC, l.account ASC";
+        "    b.balance AS 'Balance'"
+        "    FROM account_balances AS b"
+        "    INNER JOIN nomaccts AS a"
+        "      ON a.id = b.account"
+        "    ORDER BY b.entity ASC, a.num ASC";
     return query;
 }
 
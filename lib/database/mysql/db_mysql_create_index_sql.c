@@ -0,0 +1,12 @@
+/*!
+ * \file            db_mysql_create_index_sql.c
+ * \brief           Returns MYSQL SQL query to create an index.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_create_index_sql(void) {
+    static const char * query = "CREATE INDEX %s ON %s (%s)";
+    return query;
+}
@@ -0,0 +1,19 @@
+/*!
+ * \file            db_mysql_create_jelines_copy_sql.c
+ * \brief           Returns MYSQL SQL query to create an empty JE lines scratch
+ * table.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_create_jelines_copy_sql(void) {
+    static const char * query = 
+        "CREATE TABLE jelines_copy ("
+        "    je         INTEGER         NOT NULL,"
+        "    line_no    INTEGER         NOT NULL,"
+        "    account    VARCHAR(20)     NOT NULL,"
+        "    amount     DECIMAL(20,2)   NOT NULL"
+        ")";
+    return query;
+}
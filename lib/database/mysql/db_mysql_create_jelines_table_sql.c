@@ -11,7 +11,8 @@ const char * db_create_jelines_table_sql(void) {
         "CREATE TABLE jelines ("
         "    id         INTEGER         NOT NULL AUTO_INCREMENT,"
         "    je         INTEGER         NOT NULL,"
-        "    account    VARCHAR(20)     NOT NULL,"
+        "    line_no    INTEGER         NOT NULL,"
+        "    account    INTEGER         NOT NULL,"
         "    amount     DECIMAL(20,2)   NOT NULL,"
         "  CONSTRAINT jelines_pk"
         "    PRIMARY KEY (id),"
@@ -20,7 +21,7 @@ const char * db_create_jelines_table_sql(void) {
         "    REFERENCES jes(id),"
         "  CONSTRAINT jes_account_fk"
         "    FOREIGN KEY (account)"
-        "    REFERENCES nomaccts(num)"
+        "    REFERENCES nomaccts(id)"
         ");";
     return query;
 }
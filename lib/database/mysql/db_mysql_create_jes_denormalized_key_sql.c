@@ -0,0 +1,15 @@
+/*!
+ * \file            db_mysql_create_jes_denormalized_key_sql.c
+ * \brief           Returns MYSQL SQL query to create JE denormalized columns
+ * key.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_create_jes_denormalized_key_sql(void) {
+    static const char * query = 
+        "CREATE UNIQUE INDEX jes_denormalized_uk"
+        "  ON jes (id, entity, year, period)";
+    return query;
+}
@@ -9,11 +9,14 @@
 const char * db_create_nomaccts_table_sql(void) {
     static const char * query = 
         "CREATE TABLE nomaccts ("
+        "    id             INTEGER         NOT NULL AUTO_INCREMENT,"
         "    num            VARCHAR(20)     NOT NULL,"
         "    description    VARCHAR(100)    NOT NULL,"
         "    enabled        BOOLEAN         NOT NULL DEFAULT TRUE,"
         "  CONSTRAINT nomaccts"
-        "    PRIMARY KEY (num)"
+        "    PRIMARY KEY (id),"
+        "  CONSTRAINT nomaccts_num_uk"
+        "    UNIQUE (num)"
         ");";
     return query;
 }
@@ -0,0 +1,28 @@
+/*!
+ * \file            db_mysql_create_partitioned_jes_table_sql.c
+ * \brief           Returns MYSQL SQL query to create partitioned journal
+ * entries table.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_create_partitioned_jes_table_sql(void) {
+    static const char * query = 
+        "CREATE TABLE jes ("
+        "    id         INTEGER         NOT NULL AUTO_INCREMENT,"
+        "    user       INTEGER         NOT NULL,"
+        "    period     INTEGER         NOT NULL,"
+        "    year       INTEGER         NOT NULL,"
+        "    source     VARCHAR(10)     NOT NULL,"
+        "    entity     INTEGER         NOT NULL,"
+        "    memo       VARCHAR(100)    NOT NULL,"
+        "    posted     TIMESTAMP       NOT NULL DEFAULT CURRENT_TIMESTAMP,"
+        "  CONSTRAINT jes_pk"
+        "    PRIMARY KEY (id, year)"
+        ")"
+        "  PARTITION BY RANGE (year) ("
+        "    PARTITION pmax VALUES LESS THAN MAXVALUE"
+        "  );";
+    return query;
+}
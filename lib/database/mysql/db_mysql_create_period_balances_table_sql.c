@@ -0,0 +1,27 @@
+/*!
+ * \file            db_mysql_create_period_balances_table_sql.c
+ * \brief           Returns MYSQL SQL query to create period balances table.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_create_period_balances_table_sql(void) {
+    static const char * query = 
+        "CREATE TABLE period_balances ("
+        "    entity     INTEGER         NOT NULL,"
+        "    account    INTEGER         NOT NULL,"
+        "    year       INTEGER         NOT NULL,"
+        "    period     INTEGER         NOT NULL,"
+        "    movement   DECIMAL(20,2)   NOT NULL,"
+        "  CONSTRAINT period_balances_pk"
+        "    PRIMARY KEY (entity, account, year, period),"
+        "  CONSTRAINT period_balances_entity_fk"
+        "    FOREIGN KEY (entity)"
+        "    REFERENCES entities(id),"
+        "  CONSTRAINT period_balances_account_fk"
+        "    FOREIGN KEY (account)"
+        "    REFERENCES nomaccts(id)"
+        ");";
+    return query;
+}
@@ -0,0 +1,21 @@
+/*!
+ * \file            db_mysql_create_period_balances_trigger_sql.c
+ * \brief           Returns MYSQL SQL query to create period balances trigger.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_create_period_balances_trigger_sql(void) {
+    static const char * query = 
+        "CREATE TRIGGER jelines_period_balances_insert"
+        "  AFTER INSERT ON jelines"
+        "  FOR EACH ROW"
+        "    INSERT INTO period_balances"
+        "        (entity, account, year, period, movement)"
+        "      SELECT entity, NEW.account, year, period, NEW.amount"
+        "        FROM jes"
+        "        WHERE id = NEW.je"
+        "    ON DUPLICATE KEY UPDATE movement = movement + VALUES(movement)";
+    return query;
+}
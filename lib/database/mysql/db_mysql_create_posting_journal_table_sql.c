@@ -0,0 +1,18 @@
+/*!
+ * \file            db_mysql_create_posting_journal_table_sql.c
+ * \brief           Returns MYSQL SQL query to create posting journal table.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_create_posting_journal_table_sql(void) {
+    static const char * query = 
+        "CREATE TABLE posting_journal ("
+        "    journal    VARCHAR(100)    NOT NULL,"
+        "    seq        BIGINT          NOT NULL,"
+        "  CONSTRAINT posting_journal_pk"
+        "    PRIMARY KEY (journal)"
+        ");";
+    return query;
+}
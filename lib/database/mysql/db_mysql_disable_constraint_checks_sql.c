@@ -0,0 +1,13 @@
+/*!
+ * \file            db_mysql_disable_constraint_checks_sql.c
+ * \brief           Returns MYSQL SQL query to disable constraint checks.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_disable_constraint_checks_sql(void) {
+    static const char * query = 
+        "SET foreign_key_checks = 0, unique_checks = 0";
+    return query;
+}
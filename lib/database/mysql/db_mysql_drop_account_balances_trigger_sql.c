@@ -0,0 +1,12 @@
+/*!
+ * \file            db_mysql_drop_account_balances_trigger_sql.c
+ * \brief           Returns MYSQL SQL query to drop balances trigger.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_drop_account_balances_trigger_sql(void) {
+    static const char * query = "DROP TRIGGER jelines_balances_insert";
+    return query;
+}
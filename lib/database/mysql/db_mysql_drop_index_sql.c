@@ -0,0 +1,12 @@
+/*!
+ * \file            db_mysql_drop_index_sql.c
+ * \brief           Returns MYSQL SQL query to drop an index.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_drop_index_sql(void) {
+    static const char * query = "DROP INDEX %s ON %s";
+    return query;
+}
@@ -0,0 +1,12 @@
+/*!
+ * \file            db_mysql_drop_jelines_copy_sql.c
+ * \brief           Returns MYSQL SQL query to drop the JE lines scratch table.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_drop_jelines_copy_sql(void) {
+    static const char * query = "DROP TABLE jelines_copy";
+    return query;
+}
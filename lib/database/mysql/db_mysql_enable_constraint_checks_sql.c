@@ -0,0 +1,13 @@
+/*!
+ * \file            db_mysql_enable_constraint_checks_sql.c
+ * \brief           Returns MYSQL SQL query to enable constraint checks.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_enable_constraint_checks_sql(void) {
+    static const char * query = 
+        "SET foreign_key_checks = 1, unique_checks = 1";
+    return query;
+}
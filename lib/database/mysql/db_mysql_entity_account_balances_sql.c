@@ -0,0 +1,16 @@
+/*!
+ * \file            db_mysql_entity_account_balances_sql.c
+ * \brief           Returns MYSQL SQL query to get the account balances of an
+ * entity.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_entity_account_balances_sql(void) {
+    static const char * query = 
+        "SELECT account, balance"
+        "  FROM account_balances"
+        "  WHERE entity = %s";
+    return query;
+}
@@ -0,0 +1,23 @@
+/*!
+ * \file            db_mysql_entity_closing_balances_sql.c
+ * \brief           Returns MYSQL SQL query to get an entity's income and
+ * expense balances for a year.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_entity_closing_balances_sql(void) {
+    static const char * query = 
+        "SELECT n.num, SUM(b.movement)"
+        "  FROM period_balances AS b"
+        "  INNER JOIN nomaccts AS n"
+        "    ON n.id = b.account"
+        "  WHERE b.entity = %s"
+        "    AND b.year = %s"
+        "    AND n.num >= '%s'"
+        "  GROUP BY n.num"
+        "  HAVING SUM(b.movement) <> 0"
+        "  ORDER BY n.num";
+    return query;
+}
@@ -0,0 +1,15 @@
+/*!
+ * \file            db_mysql_exchange_partition_sql.c
+ * \brief           Returns MYSQL SQL query to exchange a year partition with
+ * its archive table.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_exchange_partition_sql(void) {
+    static const char * query = 
+        "ALTER TABLE %s EXCHANGE PARTITION p%d"
+        "  WITH TABLE %s_archive_%d";
+    return query;
+}
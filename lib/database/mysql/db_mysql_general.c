@@ -13,150 +13,344 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 
 #include "gl_general/gl_general.h"
 #include "database/db_internal.h"
+#include "db_mysql_internal.h"
 
-/*!  MYSQL initialization object.  */
-MYSQL * main_mss = NULL;
+/*!  Maximum length of a line in a bulk load file  */
+#define MAX_INFILE_LINE_SIZE 1024
 
-/*!  MYSQL connection object.  */
-MYSQL * conn_mss = NULL;
+/*!  Number of leading records (field names and types) in a load file  */
+#define INFILE_HEADER_RECORDS 2
 
-/*
-static void db_error_quit(const char * msg, MYSQL * mss) {
-    if ( mss ) {
-        gl_log_msg("%s: %s", msg, mysql_error(mss));
+/*!  State for the local infile handler  */
+struct infile_state {
+    FILE * fp;                              /*!<  The file being loaded    */
+    char line[MAX_INFILE_LINE_SIZE];        /*!<  The current line         */
+    size_t length;                          /*!<  Length of current line   */
+    size_t offset;                          /*!<  Bytes of line sent       */
+    int records_skipped;                    /*!<  Header records skipped   */
+    char error[MAX_INFILE_LINE_SIZE];       /*!<  Error message            */
+};
+
+/*!
+ * \brief           Local infile handler initialization function.
+ * \details         Opens the named file and allocates the handler state.
+ * \param ptr       A pointer in which to store the handler state.
+ * \param filename  The filename from the `LOAD DATA` statement.
+ * \param userdata  Unused.
+ * \returns         0 on success, non-zero on failure.
+ */
+static int db_infile_init(void ** ptr, const char * filename,
+                          void * userdata);
+
+/*!
+ * \brief           Local infile handler read function.
+ * \details         Copies data lines from the file into the buffer,
+ * skipping blank lines, comment lines and the field name and type records.
+ * \param ptr       The handler state.
+ * \param buf       The buffer to fill.
+ * \param buf_len   The size of the buffer.
+ * \returns         The number of bytes copied, 0 at end of file, or -1
+ * on error.
+ */
+static int db_infile_read(void * ptr, char * buf, unsigned int buf_len);
+
+/*!
+ * \brief           Local infile handler end function.
+ * \param ptr       The handler state.
+ */
+static void db_infile_end(void * ptr);
+
+/*!
+ * \brief           Local infile handler error function.
+ * \param ptr       The handler state.
+ * \param error_msg A buffer in which to store the error message.
+ * \param error_msg_len The size of the buffer.
+ * \returns         The error number.
+ */
+static int db_infile_error(void * ptr, char * error_msg,
+                           unsigned int error_msg_len);
+
+bool db_execute_query(ds_str query) {
+    MYSQL * conn_mss = db_mysql_connection();
+    bool ret_val = false;
+
+    if ( conn_mss ) {
+        int status = mysql_query(conn_mss, ds_str_cstr(query));
+        if ( status ) {
+            db_mysql_error_msg("Query unsuccessful", conn_mss);
+        }
+        else {
+            ret_val = true;
+        }
     }
     else {
-        gl_log_msg("%s");
+        gl_log_msg("Attempting to write query with no connection.");
     }
-    exit(EXIT_FAILURE);
+
+    return ret_val;
 }
-*/
 
-/*!
- * \brief           Logs a MYSQL error message.
- * \param msg       The plain error message to log.
- * \param mss       The MYSQL connection from which to retrieve the MYSQL
- * error message.
- */
-static void db_error_msg(const char * msg, MYSQL * mss);
+bool db_execute_load_query(ds_str query, size_t * rows) {
+    MYSQL * conn_mss = db_mysql_connection();
 
-bool db_connect(const char * host, const char * database,
-                const char * username, const char * password) {
-    main_mss = mysql_init(NULL);
-    if ( !main_mss ) {
-        db_error_msg("Couldn't initialize mysql.", NULL);
+    if ( !conn_mss ) {
+        gl_log_msg("Attempting to load data with no connection.");
+        return false;
+    }
+
+    mysql_set_local_infile_handler(conn_mss, db_infile_init, db_infile_read,
+                                   db_infile_end, db_infile_error, NULL);
+    int status = mysql_query(conn_mss, ds_str_cstr(query));
+    mysql_set_local_infile_default(conn_mss);
+
+    if ( status ) {
+        db_mysql_error_msg("Load unsuccessful", conn_mss);
         return false;
     }
 
-    conn_mss = mysql_real_connect(main_mss, host, username, password,
-                                  database, 0, NULL, 0);
+    if ( rows ) {
+        *rows = (size_t) mysql_affected_rows(conn_mss);
+    }
+
+    return true;
+}
+
+bool db_begin_transaction(void) {
+    MYSQL * conn_mss = db_mysql_connection();
+
     if ( !conn_mss ) {
-        db_error_msg("Couldn't connect to database", main_mss);
+        gl_log_msg("Attempting to begin transaction with no connection.");
+        return false;
+    }
+
+    if ( mysql_autocommit(conn_mss, 0) ) {
+        db_mysql_error_msg("Couldn't begin transaction", conn_mss);
         return false;
     }
 
     return true;
 }
 
-void db_close(void) {
+bool db_commit_transaction(void) {
+    MYSQL * conn_mss = db_mysql_connection();
+
     if ( !conn_mss ) {
-        gl_error_quit("Closing connection which is not open.");
+        gl_log_msg("Attempting to commit transaction with no connection.");
+        return false;
+    }
+
+    bool ret_val = true;
+    if ( mysql_commit(conn_mss) ) {
+        db_mysql_error_msg("Couldn't commit transaction", conn_mss);
+        ret_val = false;
     }
-    mysql_close(conn_mss);
-    mysql_library_end();
-    main_mss = NULL;
-    conn_mss = NULL;
+    mysql_autocommit(conn_mss, 1);
+
+    return ret_val;
 }
 
-bool db_execute_query(ds_str query) {
-    bool ret_val = false;
+bool db_rollback_transaction(void) {
+    MYSQL * conn_mss = db_mysql_connection();
 
-    if ( conn_mss ) {
-        int status = mysql_query(conn_mss, ds_str_cstr(query));
-        if ( status ) {
-            db_error_msg("Query unsuccessful", conn_mss);
-        }
-        else {
-            ret_val = true;
-        }
+    if ( !conn_mss ) {
+        gl_log_msg("Attempting to roll back transaction with no connection.");
+        return false;
     }
-    else {
-        gl_log_msg("Attempting to write query with no connection.");
+
+    bool ret_val = true;
+    if ( mysql_rollback(conn_mss) ) {
+        db_mysql_error_msg("Couldn't roll back transaction", conn_mss);
+        ret_val = false;
     }
+    mysql_autocommit(conn_mss, 1);
 
     return ret_val;
 }
 
-ds_recordset db_create_recordset_from_query(ds_str query) {
-    if ( conn_mss ) {
-        int status = mysql_query(conn_mss, ds_str_cstr(query));
-        if ( status ) {
-            db_error_msg("Query unsuccessful", conn_mss);
-            return NULL;
-        }
+size_t db_max_query_length(void) {
+    MYSQL * conn_mss = db_mysql_connection();
 
-        MYSQL_RES * result = mysql_store_result(conn_mss);
+    static const size_t default_length = 1024 * 1024;
+    static size_t max_length = 0;
 
-        if ( !result ) {
-            db_error_msg("Couldn't store result", conn_mss);
-            return NULL;
+    if ( max_length || !conn_mss ) {
+        return max_length ? max_length : default_length;
+    }
+
+    max_length = default_length;
+    if ( mysql_query(conn_mss, "SELECT @@max_allowed_packet") ) {
+        db_mysql_error_msg("Couldn't get max_allowed_packet", conn_mss);
+        return max_length;
+    }
+
+    MYSQL_RES * result = mysql_store_result(conn_mss);
+    if ( result ) {
+        MYSQL_ROW row = mysql_fetch_row(result);
+        if ( row && row[0] ) {
+            unsigned long packet = strtoul(row[0], NULL, 10);
+            if ( packet ) {
+                max_length = packet;
+            }
         }
+        mysql_free_result(result);
+    }
 
-        MYSQL_ROW row;
+    return max_length;
+}
+
+bool db_query_foreach(ds_str query, db_header_callback header_cb,
+                      db_row_callback row_cb, void * ctx) {
+    MYSQL * conn_mss = db_mysql_connection();
+
+    if ( !conn_mss ) {
+        gl_log_msg("Attempting to run query with no connection.");
+        return false;
+    }
+
+    if ( mysql_query(conn_mss, ds_str_cstr(query)) ) {
+        db_mysql_error_msg("Query unsuccessful", conn_mss);
+        return false;
+    }
+
+    MYSQL_RES * result = mysql_use_result(conn_mss);
+    if ( !result ) {
+        db_mysql_error_msg("Couldn't use result", conn_mss);
+        return false;
+    }
+
+    unsigned int num_fields = mysql_num_fields(result);
+    MYSQL_FIELD * fields = mysql_fetch_fields(result);
+    const char ** names = malloc(num_fields * sizeof *names);
+    size_t * lengths = malloc(num_fields * sizeof *lengths);
+    if ( !names || !lengths ) {
+        free(names);
+        free(lengths);
+        mysql_free_result(result);
+        gl_log_msg("Couldn't allocate memory for query result.");
+        return false;
+    }
 
-        unsigned int num_fields = mysql_num_fields(result);
-        ds_recordset set = ds_recordset_create(num_fields);
+    for ( size_t i = 0; i < num_fields; ++i ) {
+        names[i] = fields[i].name;
+    }
 
-        ds_record field_names = ds_record_create(num_fields);
-        MYSQL_FIELD * fields = mysql_fetch_fields(result);
+    bool keep_going = header_cb ? header_cb(num_fields, names, ctx) : true;
+    MYSQL_ROW row;
 
+    while ( keep_going && (row = mysql_fetch_row(result)) ) {
+        unsigned long * row_lengths = mysql_fetch_lengths(result);
         for ( size_t i = 0; i < num_fields; ++i ) {
-            ds_str new_field = ds_str_create(fields[i].name);
-            ds_record_set_field(field_names, i, new_field);
+            lengths[i] = row_lengths[i];
         }
 
-        ds_recordset_set_headers(set, field_names);
+        keep_going = row_cb(num_fields, (const char * const *) row,
+                            lengths, ctx);
+    }
 
-        while ( (row = mysql_fetch_row(result)) ) {
-            ds_record record = ds_record_create(num_fields);
+    /*  A NULL row means either the end of the result or an error.  */
 
-            unsigned long * lengths = mysql_fetch_lengths(result);
+    bool ret_val = true;
+    if ( keep_going && mysql_errno(conn_mss) ) {
+        db_mysql_error_msg("Couldn't fetch row", conn_mss);
+        ret_val = false;
+    }
 
-            for ( size_t i = 0; i < num_fields; ++i ) {
-                ds_str new_field;
-                if ( lengths[i] ) {
+    /*  mysql_free_result() discards any rows not yet fetched.  */
 
-                    /*  CHECK IF THIS IS BAD  */
+    mysql_free_result(result);
+    free(names);
+    free(lengths);
 
-                    new_field = ds_str_create_sprintf("%.*s",
-                            (int) lengths[i], row[i]);
-                }
-                else {
-                    new_field = ds_str_create("");
-                }
+    return ret_val;
+}
 
-                ds_record_set_field(record, i, new_field);
-            }
+static int db_infile_init(void ** ptr, const char * filename,
+                          void * userdata) {
+    (void)userdata;
 
-            ds_recordset_add_record(set, record);
+    struct infile_state * state = calloc(1, sizeof *state);
+    *ptr = state;
+    if ( !state ) {
+        return 1;
+    }
+
+    state->fp = fopen(filename, "r");
+    if ( !state->fp ) {
+        snprintf(state->error, sizeof state->error,
+                 "Couldn't open file '%s'", filename);
+        return 1;
+    }
+
+    return 0;
+}
+
+static int db_infile_read(void * ptr, char * buf, unsigned int buf_len) {
+    struct infile_state * state = ptr;
+
+    while ( state->offset == state->length ) {
+        if ( !fgets(state->line, sizeof state->line, state->fp) ) {
+            return 0;
         }
 
-        mysql_free_result(result);
-        return set;
+        state->length = strlen(state->line);
+        state->offset = 0;
+
+        if ( state->line[state->length - 1] != '\n' && !feof(state->fp) ) {
+            snprintf(state->error, sizeof state->error,
+                     "Line too long in load file");
+            return -1;
+        }
+
+        const char * p = state->line;
+        while ( isspace((unsigned char) *p) ) {
+            ++p;
+        }
+
+        if ( *p == '\0' || *p == '#' ||
+             state->records_skipped++ < INFILE_HEADER_RECORDS ) {
+            state->length = 0;
+        }
+    }
+
+    size_t num_bytes = state->length - state->offset;
+    if ( num_bytes > buf_len ) {
+        num_bytes = buf_len;
     }
 
-    return NULL;
+    memcpy(buf, state->line + state->offset, num_bytes);
+    state->offset += num_bytes;
+
+    return (int) num_bytes;
+}
+
+static void db_infile_end(void * ptr) {
+    struct infile_state * state = ptr;
+    if ( state ) {
+        if ( state->fp ) {
+            fclose(state->fp);
+        }
+        free(state);
+    }
+}
+
+static int db_infile_error(void * ptr, char * error_msg,
+                           unsigned int error_msg_len) {
+    struct infile_state * state = ptr;
+    snprintf(error_msg, error_msg_len, "%s",
+             state ? state->error : "Couldn't allocate memory");
+    return 1;
 }
 
-static void db_error_msg(const char * msg, MYSQL * mss) {
+void db_mysql_error_msg(const char * msg, MYSQL * mss) {
     if ( mss ) {
         gl_log_msg("%s: %s", msg, mysql_error(mss));
     }
     else {
-        gl_log_msg("%s");
+        gl_log_msg("%s", msg);
     }
 }
 
@@ -0,0 +1,16 @@
+/*!
+ * \file            db_mysql_index_exists_sql.c
+ * \brief           Returns MYSQL SQL query to check if an index exists.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_index_exists_sql(void) {
+    static const char * query = 
+        "SELECT COUNT(*) FROM information_schema.statistics"
+        "  WHERE index_name = '%s'"
+        "    AND table_name = '%s'"
+        "    AND table_schema = DATABASE()";
+    return query;
+}
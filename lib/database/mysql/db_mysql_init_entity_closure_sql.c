@@ -0,0 +1,16 @@
+/*!
+ * \file            db_mysql_init_entity_closure_sql.c
+ * \brief           Returns MYSQL SQL query to add every entity to the entity
+ * closure as its own descendant.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_init_entity_closure_sql(void) {
+    static const char * query = 
+        "INSERT INTO entity_closure (ancestor, descendant, depth)"
+        "  SELECT id, id, 0"
+        "  FROM entities";
+    return query;
+}
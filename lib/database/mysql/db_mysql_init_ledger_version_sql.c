@@ -0,0 +1,14 @@
+/*!
+ * \file            db_mysql_init_ledger_version_sql.c
+ * \brief           Returns MYSQL SQL query to initialize the ledger version.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_init_ledger_version_sql(void) {
+    static const char * query = 
+        "INSERT INTO ledger_version (id, epoch, version)"
+        "  VALUES (1, NOW(6), 0)";
+    return query;
+}
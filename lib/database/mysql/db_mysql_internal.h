@@ -0,0 +1,65 @@
+/*!
+ * \file            db_mysql_internal.h
+ * \brief           Internal interface to MYSQL database functionality.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_DATABASE_DB_MYSQL_INTERNAL_H
+#define PG_GENERAL_LEDGER_DATABASE_DB_MYSQL_INTERNAL_H
+
+#include <stdbool.h>
+#include <mysql.h>
+
+#if defined(MARIADB_BASE_VERSION) || defined(MARIADB_PACKAGE_VERSION_ID)
+
+/*!  Defined if the client library supports the non-blocking API  */
+#define DB_MYSQL_NONBLOCKING 1
+
+#endif
+
+/*!
+ * \brief           Returns the calling thread's connection.
+ * \returns         The connection checked out to the calling thread, or
+ * `NULL` if it has none.
+ */
+MYSQL * db_mysql_connection(void);
+
+/*!
+ * \brief           Acquires a connection from the pool.
+ * \details         The connection is not bound to the calling thread, so
+ * a thread may hold several connections at once.
+ * \param wait      `true` to wait for a connection if none are available,
+ * `false` to return immediately.
+ * \returns         The connection, or `NULL` on failure or if none is
+ * available and `wait` is `false`.
+ */
+MYSQL * db_mysql_pool_acquire(const bool wait);
+
+/*!
+ * \brief           Returns a connection acquired with
+ * `db_mysql_pool_acquire()` to the pool.
+ * \param mss       The connection.
+ */
+void db_mysql_pool_release(MYSQL * mss);
+
+/*!
+ * \brief           Closes a pooled connection which is no longer usable.
+ * \details         The connection is reopened when next checked out. If
+ * it was acquired with `db_mysql_pool_acquire()` it is also returned to
+ * the pool; if it is the calling thread's connection, the thread has no
+ * usable connection until it checks it in and out again.
+ * \param mss       The connection.
+ */
+void db_mysql_pool_discard(MYSQL * mss);
+
+/*!
+ * \brief           Logs a MYSQL error message.
+ * \param msg       The plain error message to log.
+ * \param mss       The MYSQL connection from which to retrieve the MYSQL
+ * error message, or `NULL`.
+ */
+void db_mysql_error_msg(const char * msg, MYSQL * mss);
+
+#endif      /*  PG_GENERAL_LEDGER_DATABASE_DB_MYSQL_INTERNAL_H  */
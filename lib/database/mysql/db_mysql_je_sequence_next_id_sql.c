@@ -0,0 +1,15 @@
+/*!
+ * \file            db_mysql_je_sequence_next_id_sql.c
+ * \brief           Returns MYSQL SQL query to get the next unreserved JE ID.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_je_sequence_next_id_sql(void) {
+    static const char * query = 
+        "SELECT next_id"
+        "  FROM sequences"
+        "  WHERE name = 'jes'";
+    return query;
+}
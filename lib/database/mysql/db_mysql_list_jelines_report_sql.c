@@ -9,12 +9,14 @@
 const char * db_list_jelines_report_sql(void) {
     static const char * query = 
         "SELECT"
-        "  id AS 'ID',"
-        "  je AS 'JE',"
-        "  account AS 'Account Number',"
-        "  amount AS 'Amount'"
-        "  FROM jelines"
-        "  ORDER BY id";
+        "  l.je AS 'JE',"
+        "  l.line_no AS 'Line',"
+        "  a.num AS 'Account Number',"
+        "  l.amount AS 'Amount'"
+        "  FROM jelines AS l"
+        "  INNER JOIN nomaccts AS a"
+        "    ON a.id = l.account"
+        "  ORDER BY l.je, l.line_no";
     return query;
 }
 
@@ -0,0 +1,28 @@
+/*!
+ * \file            db_mysql_list_nomaccts_filtered_report_sql.c
+ * \brief           Returns MYSQL SQL query to show a filtered list of nominal
+ * accounts.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_list_nomaccts_filtered_report_sql(void) {
+    static const char * query = 
+        "SELECT"
+        "  num AS 'A/C Number',"
+        "  description AS 'Description',"
+        "  CASE enabled"
+        "    WHEN TRUE"
+        "      THEN 'Yes'"
+        "    WHEN FALSE"
+        "      THEN 'No'"
+        "    ELSE 'Unknown'"
+        "  END"
+        "    AS 'Enabled?'"
+        "  FROM nomaccts"
+        "%s"
+        "  ORDER BY num"
+        "%s";
+    return query;
+}
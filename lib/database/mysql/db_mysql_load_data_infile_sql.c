@@ -0,0 +1,17 @@
+/*!
+ * \file            db_mysql_load_data_infile_sql.c
+ * \brief           Returns MYSQL SQL query to bulk load a data file.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_load_data_infile_sql(void) {
+    static const char * query = 
+        "LOAD DATA LOCAL INFILE '%s'"
+        "  INTO TABLE %s"
+        "  FIELDS TERMINATED BY ':'"
+        "  LINES TERMINATED BY '\\n'"
+        "  (%s)";
+    return query;
+}
@@ -0,0 +1,18 @@
+/*!
+ * \file            db_mysql_partition_bound_sql.c
+ * \brief           Returns MYSQL SQL query to get the year after the last
+ * year partition.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_partition_bound_sql(void) {
+    static const char * query = 
+        "SELECT COALESCE(MAX(CAST(partition_description AS UNSIGNED)), 0)"
+        "  FROM information_schema.partitions"
+        "  WHERE table_name = '%s'"
+        "    AND partition_name NOT IN ('pmax', 'pold')"
+        "    AND table_schema = DATABASE()";
+    return query;
+}
@@ -0,0 +1,17 @@
+/*!
+ * \file            db_mysql_partition_exists_sql.c
+ * \brief           Returns MYSQL SQL query to check if a year partition
+ * exists.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_partition_exists_sql(void) {
+    static const char * query = 
+        "SELECT COUNT(*) FROM information_schema.partitions"
+        "  WHERE table_name = '%s'"
+        "    AND partition_name = 'p%d'"
+        "    AND table_schema = DATABASE()";
+    return query;
+}
@@ -0,0 +1,23 @@
+/*!
+ * \file            db_mysql_period_trial_balance_entity_report_sql.c
+ * \brief           Returns MYSQL SQL query to run entity period TB report.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_period_trial_balance_entity_report_sql(void) {
+    static const char * query = 
+        "SELECT"
+        "    a.num AS 'A/C No.',"
+        "    a.description AS 'Description',"
+        "    sum(b.movement) AS 'Balance'"
+        "  FROM period_balances AS b"
+        "  INNER JOIN nomaccts AS a"
+        "    ON a.id = b.account"
+        "  WHERE b.entity = %s"
+        "    AND (b.year < %s OR (b.year = %s AND b.period <= %s))"
+        "  GROUP BY a.num, a.description"
+        "  ORDER BY a.num ASC";
+    return query;
+}
@@ -0,0 +1,382 @@
+/*!
+ * \file            db_mysql_pool.c
+ * \brief           Implementation of MYSQL connection pool functionality.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <my_global.h>
+#include <my_sys.h>
+#include <mysql.h>
+
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "gl_general/gl_general.h"
+#include "database/db_internal.h"
+#include "db_mysql_internal.h"
+
+/*!  Default number of connections in the pool  */
+#define DEFAULT_POOL_SIZE 1
+
+/*!  Seconds a connection may be idle before it is checked on checkout  */
+#define POOL_IDLE_CHECK_SECONDS 30
+
+/*!  Pooled connection structure  */
+struct db_pool_conn {
+    MYSQL * mss;                /*!<  The connection, or `NULL`     */
+    bool in_use;                /*!<  `true` if checked out         */
+    time_t last_used;           /*!<  Time of last checkin          */
+};
+
+/*!  Connection pool structure  */
+struct db_pool {
+    struct db_pool_conn * conns;    /*!<  Array of connections      */
+    size_t size;                    /*!<  Number of connections     */
+    ds_str host;                    /*!<  Database hostname         */
+    ds_str database;                /*!<  Database name             */
+    ds_str username;                /*!<  Database username         */
+    ds_str password;                /*!<  Database password         */
+    pthread_mutex_t lock;           /*!<  Protects the pool         */
+    pthread_cond_t available;       /*!<  Signalled on checkin      */
+    bool closing;                   /*!<  `true` while being closed */
+};
+
+/*!  The connection pool  */
+static struct db_pool pool = {
+    NULL, 0, NULL, NULL, NULL, NULL,
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, false
+};
+
+/*!  Requested pool size  */
+static size_t requested_pool_size = DEFAULT_POOL_SIZE;
+
+/*!  Key for the connection checked out to each thread  */
+static pthread_key_t conn_key;
+
+/*!  Key marking threads which have called `mysql_thread_init()`  */
+static pthread_key_t thread_init_key;
+
+/*!  Ensures the client library is initialized once only  */
+static pthread_once_t library_once = PTHREAD_ONCE_INIT;
+
+/*!
+ * \brief           Initializes the client library and thread keys.
+ */
+static void db_library_init(void);
+
+/*!
+ * \brief           Shuts down the client library at program exit.
+ */
+static void db_library_end(void);
+
+/*!
+ * \brief           Thread key destructor which calls `mysql_thread_end()`.
+ * \param value     Unused.
+ */
+static void db_thread_end(void * value);
+
+/*!
+ * \brief           Acquires a connection slot from the pool.
+ * \details         The slot's connection is opened or health checked as
+ * necessary.
+ * \param wait      `true` to wait for a slot if none are available,
+ * `false` to return immediately.
+ * \returns         The slot, or `NULL` on failure or if no slot is
+ * available and `wait` is `false`.
+ */
+static struct db_pool_conn * db_pool_acquire_slot(const bool wait);
+
+/*!
+ * \brief           Returns a connection slot to the pool.
+ * \param conn      The slot.
+ */
+static void db_pool_release_slot(struct db_pool_conn * conn);
+
+/*!
+ * \brief           Opens a new connection using the pool credentials.
+ * \returns         The connection, or `NULL` on failure.
+ */
+static MYSQL * db_pool_open_connection(void);
+
+void db_set_pool_size(const size_t size) {
+    requested_pool_size = size ? size : DEFAULT_POOL_SIZE;
+}
+
+size_t db_pool_size(void) {
+    return pool.size;
+}
+
+bool db_connect(const char * host, const char * database,
+                const char * username, const char * password) {
+    pthread_once(&library_once, db_library_init);
+
+    pthread_mutex_lock(&pool.lock);
+    if ( pool.conns ) {
+        pthread_mutex_unlock(&pool.lock);
+        gl_log_msg("Connection pool is already open.");
+        return false;
+    }
+
+    pool.conns = calloc(requested_pool_size, sizeof *pool.conns);
+    if ( !pool.conns ) {
+        pthread_mutex_unlock(&pool.lock);
+        gl_log_msg("Couldn't allocate memory for connection pool.");
+        return false;
+    }
+
+    pool.size = requested_pool_size;
+    pool.host = ds_str_create(host);
+    pool.database = ds_str_create(database);
+    pool.username = ds_str_create(username);
+    pool.password = ds_str_create(password);
+    pthread_mutex_unlock(&pool.lock);
+
+    if ( !db_pool_checkout() ) {
+        db_close();
+        return false;
+    }
+
+#ifndef DB_MYSQL_NONBLOCKING
+    if ( pool.size > 1 ) {
+        gl_log_msg("The MySQL client library has no non-blocking API, so "
+                   "concurrent queries will run one after another.");
+    }
+#endif
+
+    return true;
+}
+
+void db_close(void) {
+    db_pool_checkin();
+
+    pthread_mutex_lock(&pool.lock);
+    if ( !pool.conns ) {
+        pthread_mutex_unlock(&pool.lock);
+        gl_error_quit("Closing connection which is not open.");
+    }
+
+    /*  Connections still checked out by other threads are waited for,
+     *  since those threads will write to their slots on checkin.      */
+
+    pool.closing = true;
+    pthread_cond_broadcast(&pool.available);
+
+    bool logged = false;
+    for ( size_t i = 0; i < pool.size; ++i ) {
+        while ( pool.conns[i].in_use ) {
+            if ( !logged ) {
+                gl_log_msg("Waiting for checked out connections to close.");
+                logged = true;
+            }
+            pthread_cond_wait(&pool.available, &pool.lock);
+        }
+        if ( pool.conns[i].mss ) {
+            mysql_close(pool.conns[i].mss);
+        }
+    }
+
+    free(pool.conns);
+    pool.conns = NULL;
+    pool.size = 0;
+    pool.closing = false;
+    ds_str_destroy(pool.host);
+    ds_str_destroy(pool.database);
+    ds_str_destroy(pool.username);
+    ds_str_destroy(pool.password);
+    pool.host = pool.database = pool.username = pool.password = NULL;
+
+    pthread_cond_broadcast(&pool.available);
+    pthread_mutex_unlock(&pool.lock);
+}
+
+bool db_pool_checkout(void) {
+    pthread_once(&library_once, db_library_init);
+
+    if ( pthread_getspecific(conn_key) ) {
+        return true;
+    }
+
+    struct db_pool_conn * conn = db_pool_acquire_slot(true);
+    if ( !conn ) {
+        return false;
+    }
+
+    pthread_setspecific(conn_key, conn);
+    return true;
+}
+
+void db_pool_checkin(void) {
+    pthread_once(&library_once, db_library_init);
+
+    struct db_pool_conn * conn = pthread_getspecific(conn_key);
+    if ( conn ) {
+        pthread_setspecific(conn_key, NULL);
+        db_pool_release_slot(conn);
+    }
+}
+
+MYSQL * db_mysql_pool_acquire(const bool wait) {
+    pthread_once(&library_once, db_library_init);
+
+    struct db_pool_conn * conn = db_pool_acquire_slot(wait);
+    return conn ? conn->mss : NULL;
+}
+
+void db_mysql_pool_release(MYSQL * mss) {
+    pthread_mutex_lock(&pool.lock);
+    struct db_pool_conn * conn = NULL;
+    for ( size_t i = 0; pool.conns && i < pool.size; ++i ) {
+        if ( pool.conns[i].mss == mss ) {
+            conn = &pool.conns[i];
+        }
+    }
+    pthread_mutex_unlock(&pool.lock);
+
+    if ( conn ) {
+        db_pool_release_slot(conn);
+    }
+}
+
+void db_mysql_pool_discard(MYSQL * mss) {
+    struct db_pool_conn * own = pthread_getspecific(conn_key);
+
+    pthread_mutex_lock(&pool.lock);
+    struct db_pool_conn * conn = NULL;
+    for ( size_t i = 0; pool.conns && i < pool.size; ++i ) {
+        if ( pool.conns[i].mss == mss ) {
+            conn = &pool.conns[i];
+        }
+    }
+    pthread_mutex_unlock(&pool.lock);
+
+    if ( conn ) {
+        mysql_close(conn->mss);
+        conn->mss = NULL;
+        if ( conn != own ) {
+            db_pool_release_slot(conn);
+        }
+    }
+}
+
+MYSQL * db_mysql_connection(void) {
+    pthread_once(&library_once, db_library_init);
+
+    struct db_pool_conn * conn = pthread_getspecific(conn_key);
+    return conn ? conn->mss : NULL;
+}
+
+static void db_library_init(void) {
+    if ( mysql_library_init(0, NULL, NULL) ) {
+        gl_error_quit("Couldn't initialize mysql library.");
+    }
+
+    pthread_key_create(&conn_key, NULL);
+    pthread_key_create(&thread_init_key, db_thread_end);
+    atexit(db_library_end);
+}
+
+static void db_library_end(void) {
+    mysql_library_end();
+}
+
+static void db_thread_end(void * value) {
+    (void)value;
+    mysql_thread_end();
+}
+
+static struct db_pool_conn * db_pool_acquire_slot(const bool wait) {
+    if ( !pthread_getspecific(thread_init_key) ) {
+        mysql_thread_init();
+        pthread_setspecific(thread_init_key, &thread_init_key);
+    }
+
+    pthread_mutex_lock(&pool.lock);
+
+    struct db_pool_conn * conn = NULL;
+    while ( pool.conns && !pool.closing && !conn ) {
+
+        /*  Prefer an already open connection to opening a new one.  */
+
+        for ( size_t i = 0; i < pool.size; ++i ) {
+            if ( !pool.conns[i].in_use &&
+                 (!conn || (pool.conns[i].mss && !conn->mss)) ) {
+                conn = &pool.conns[i];
+            }
+        }
+
+        if ( !conn ) {
+            if ( !wait ) {
+                pthread_mutex_unlock(&pool.lock);
+                return NULL;
+            }
+            pthread_cond_wait(&pool.available, &pool.lock);
+        }
+    }
+
+    if ( !conn ) {
+        pthread_mutex_unlock(&pool.lock);
+        gl_log_msg("Attempting to check out connection with no pool.");
+        return NULL;
+    }
+
+    conn->in_use = true;
+    pthread_mutex_unlock(&pool.lock);
+
+    /*  Connect and health check outside the lock, as they may block.  */
+
+    if ( conn->mss &&
+         difftime(time(NULL), conn->last_used) > POOL_IDLE_CHECK_SECONDS &&
+         mysql_ping(conn->mss) ) {
+        db_mysql_error_msg("Pooled connection lost, reconnecting", conn->mss);
+        mysql_close(conn->mss);
+        conn->mss = NULL;
+    }
+
+    if ( !conn->mss ) {
+        conn->mss = db_pool_open_connection();
+    }
+
+    if ( !conn->mss ) {
+        db_pool_release_slot(conn);
+        return NULL;
+    }
+
+    return conn;
+}
+
+static void db_pool_release_slot(struct db_pool_conn * conn) {
+    pthread_mutex_lock(&pool.lock);
+    conn->in_use = false;
+    conn->last_used = time(NULL);
+    pthread_cond_signal(&pool.available);
+    pthread_mutex_unlock(&pool.lock);
+}
+
+static MYSQL * db_pool_open_connection(void) {
+    MYSQL * mss = mysql_init(NULL);
+    if ( !mss ) {
+        db_mysql_error_msg("Couldn't initialize mysql.", NULL);
+        return NULL;
+    }
+
+    unsigned int local_infile = 1;
+    mysql_options(mss, MYSQL_OPT_LOCAL_INFILE, &local_infile);
+
+#ifdef DB_MYSQL_NONBLOCKING
+    mysql_options(mss, MYSQL_OPT_NONBLOCK, 0);
+#endif
+
+    if ( !mysql_real_connect(mss, ds_str_cstr(pool.host),
+                             ds_str_cstr(pool.username),
+                             ds_str_cstr(pool.password),
+                             ds_str_cstr(pool.database), 0, NULL, 0) ) {
+        db_mysql_error_msg("Couldn't connect to database", mss);
+        mysql_close(mss);
+        return NULL;
+    }
+
+    return mss;
+}
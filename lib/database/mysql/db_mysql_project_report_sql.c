@@ -0,0 +1,14 @@
+/*!
+ * \file            db_mysql_project_report_sql.c
+ * \brief           Returns MYSQL SQL query to select columns from a report
+ * query.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_project_report_sql(void) {
+    static const char * query = 
+        "SELECT %s FROM (%s) AS r";
+    return query;
+}
@@ -0,0 +1,13 @@
+/*!
+ * \file            db_mysql_quote_identifier_sql.c
+ * \brief           Returns MYSQL SQL query to quote an identifier.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_quote_identifier_sql(void) {
+    static const char * query = 
+        "`%s`";
+    return query;
+}
@@ -0,0 +1,18 @@
+/*!
+ * \file            db_mysql_rebuild_account_balances_sql.c
+ * \brief           Returns MYSQL SQL query to rebuild account balances.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_rebuild_account_balances_sql(void) {
+    static const char * query = 
+        "INSERT INTO account_balances (entity, account, balance)"
+        "  SELECT j.entity, l.account, sum(l.amount)"
+        "    FROM jelines AS l"
+        "    INNER JOIN jes AS j"
+        "      ON l.je = j.id"
+        "    GROUP BY j.entity, l.account";
+    return query;
+}
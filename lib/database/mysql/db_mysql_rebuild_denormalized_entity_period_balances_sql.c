@@ -0,0 +1,19 @@
+/*!
+ * \file            db_mysql_rebuild_denormalized_entity_period_balances_sql.c
+ * \brief           Returns MYSQL SQL query to rebuild denormalized entity
+ * period balances.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_rebuild_denormalized_entity_period_balances_sql(void) {
+    static const char * query = 
+        "INSERT INTO period_balances"
+        "    (entity, account, year, period, movement)"
+        "  SELECT entity, account, year, period, sum(amount)"
+        "    FROM jelines"
+        "    WHERE entity = %s"
+        "    GROUP BY entity, account, year, period";
+    return query;
+}
@@ -0,0 +1,13 @@
+/*!
+ * \file            db_mysql_remove_partitioning_sql.c
+ * \brief           Returns MYSQL SQL query to remove partitioning from a year
+ * archive table.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_remove_partitioning_sql(void) {
+    static const char * query = "ALTER TABLE %s_archive_%d REMOVE PARTITIONING";
+    return query;
+}
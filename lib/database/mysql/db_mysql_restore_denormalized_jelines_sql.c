@@ -0,0 +1,23 @@
+/*!
+ * \file            db_mysql_restore_denormalized_jelines_sql.c
+ * \brief           Returns MYSQL SQL query to restore denormalized JE lines
+ * from a scratch table.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_restore_denormalized_jelines_sql(void) {
+    static const char * query = 
+        "INSERT INTO jelines"
+        "    (je, line_no, entity, year, period, account, amount)"
+        "  SELECT c.je, c.line_no, j.entity, j.year, j.period,"
+        "         a.id, c.amount"
+        "    FROM jelines_copy AS c"
+        "    LEFT JOIN jes AS j"
+        "      ON j.id = c.je"
+        "    LEFT JOIN nomaccts AS a"
+        "      ON a.num = c.account"
+        "    ORDER BY j.entity, j.year, j.period, c.je, c.line_no";
+    return query;
+}
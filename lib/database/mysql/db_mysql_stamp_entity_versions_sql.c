@@ -0,0 +1,19 @@
+/*!
+ * \file            db_mysql_stamp_entity_versions_sql.c
+ * \brief           Returns MYSQL SQL query to set the version of a list of
+ * entities to the ledger version.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_stamp_entity_versions_sql(void) {
+    static const char * query = 
+        "REPLACE INTO entity_versions (entity, version)"
+        "  SELECT e.id, v.version"
+        "  FROM entities AS e"
+        "  INNER JOIN ledger_version AS v"
+        "    ON v.id = 1"
+        "  WHERE e.id IN (%s)";
+    return query;
+}
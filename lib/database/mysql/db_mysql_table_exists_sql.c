@@ -0,0 +1,15 @@
+/*!
+ * \file            db_mysql_table_exists_sql.c
+ * \brief           Returns MYSQL SQL query to check if a table exists.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_table_exists_sql(void) {
+    static const char * query = 
+        "SELECT COUNT(*) FROM information_schema.tables"
+        "  WHERE table_name = '%s'"
+        "    AND table_schema = DATABASE()";
+    return query;
+}
@@ -0,0 +1,12 @@
+/*!
+ * \file            db_sqlite_account_dictionary_sql.c
+ * \brief           Returns SQLite SQL query to get account numbers and IDs.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_account_dictionary_sql(void) {
+    static const char * query = "SELECT num, id FROM nomaccts";
+    return query;
+}
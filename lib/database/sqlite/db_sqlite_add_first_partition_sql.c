@@ -0,0 +1,14 @@
+/*!
+ * \file            db_sqlite_add_first_partition_sql.c
+ * \brief           Returns SQLite SQL query to add the first year partition.
+ * \details         SQLite does not partition tables, so there is no query.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <stddef.h>
+
+const char * db_add_first_partition_sql(void) {
+    return NULL;
+}
@@ -0,0 +1,15 @@
+/*!
+ * \file            db_sqlite_advance_je_sequence_sql.c
+ * \brief           Returns SQLite SQL query to reserve a block of JE IDs.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_advance_je_sequence_sql(void) {
+    static const char * query = 
+        "UPDATE sequences"
+        "  SET next_id = next_id + %s"
+        "  WHERE name = 'jes'";
+    return query;
+}
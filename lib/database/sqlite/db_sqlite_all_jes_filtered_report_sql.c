@@ -0,0 +1,27 @@
+/*!
+ * \file            db_sqlite_all_jes_filtered_report_sql.c
+ * \brief           Returns SQLite SQL query to show filtered detailed journal
+ * entries.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_all_jes_filtered_report_sql(void) {
+    static const char * query = 
+        "SELECT"
+        "    l.je AS \"JE\","
+        "    j.entity AS \"En\","
+        "    a.num AS \"A/C No.\","
+        "    a.description AS \"Description\","
+        "    printf('%%.2f', l.amount) AS \"Amount\""
+        "  FROM jelines AS l"
+        "  INNER JOIN jes AS j"
+        "    ON j.id = l.je"
+        "  INNER JOIN nomaccts AS a"
+        "    ON a.id = l.account"
+        "%s"
+        "  ORDER BY j.id ASC, a.num ASC"
+        "%s";
+    return query;
+}
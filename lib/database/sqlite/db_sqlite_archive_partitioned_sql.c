@@ -0,0 +1,15 @@
+/*!
+ * \file            db_sqlite_archive_partitioned_sql.c
+ * \brief           Returns SQLite SQL query to check if the archive table for
+ * a year is partitioned.
+ * \details         SQLite does not partition tables, so there is no query.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <stddef.h>
+
+const char * db_archive_partitioned_sql(void) {
+    return NULL;
+}
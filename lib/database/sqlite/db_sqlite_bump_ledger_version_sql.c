@@ -0,0 +1,13 @@
+/*!
+ * \file            db_sqlite_bump_ledger_version_sql.c
+ * \brief           Returns SQLite SQL query to increment the ledger version.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_bump_ledger_version_sql(void) {
+    static const char * query = 
+        "UPDATE ledger_version SET version = version + 1 WHERE id = 1";
+    return query;
+}
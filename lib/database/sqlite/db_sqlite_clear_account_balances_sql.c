@@ -0,0 +1,13 @@
+/*!
+ * \file            db_sqlite_clear_account_balances_sql.c
+ * \brief           Returns SQLite SQL query to clear account balances.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_clear_account_balances_sql(void) {
+    static const char * query = 
+        "DELETE FROM account_balances";
+    return query;
+}
@@ -0,0 +1,12 @@
+/*!
+ * \file            db_sqlite_clear_entity_closure_sql.c
+ * \brief           Returns SQLite SQL query to clear entity closure table.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_clear_entity_closure_sql(void) {
+    static const char * query = "DELETE FROM entity_closure";
+    return query;
+}
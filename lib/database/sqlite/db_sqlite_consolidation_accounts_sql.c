@@ -0,0 +1,16 @@
+/*!
+ * \file            db_sqlite_consolidation_accounts_sql.c
+ * \brief           Returns SQLite SQL query to get the nominal accounts for
+ * consolidation.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_consolidation_accounts_sql(void) {
+    static const char * query = 
+        "SELECT id, num, description"
+        "  FROM nomaccts"
+        "  ORDER BY num";
+    return query;
+}
@@ -0,0 +1,18 @@
+/*!
+ * \file            db_sqlite_consolidation_entities_sql.c
+ * \brief           Returns SQLite SQL query to get the entity hierarchy and
+ * entity versions.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_consolidation_entities_sql(void) {
+    static const char * query = 
+        "SELECT e.id, e.parent, COALESCE(v.version, 0)"
+        "  FROM entities AS e"
+        "  LEFT OUTER JOIN entity_versions AS v"
+        "    ON v.entity = e.id"
+        "  ORDER BY e.id";
+    return query;
+}
@@ -0,0 +1,47 @@
+/*!
+ * \file            db_sqlite_constraint_violations_report_sql.c
+ * \brief           Returns SQLite SQL query to count constraint violations.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_constraint_violations_report_sql(void) {
+    static const char * query = 
+        "SELECT 'entities.parent' AS \"Constraint\","
+        "    COUNT(*) AS \"Violations\""
+        "    FROM entities AS c"
+        "    LEFT OUTER JOIN entities AS p"
+        "      ON p.id = c.parent"
+        "    WHERE p.id IS NULL"
+        "  UNION ALL SELECT 'jes.user', COUNT(*)"
+        "    FROM jes AS j"
+        "    LEFT OUTER JOIN users AS u"
+        "      ON u.id = j.user"
+        "    WHERE u.id IS NULL"
+        "  UNION ALL SELECT 'jes.entity', COUNT(*)"
+        "    FROM jes AS j"
+        "    LEFT OUTER JOIN entities AS e"
+        "      ON e.id = j.entity"
+        "    WHERE e.id IS NULL"
+        "  UNION ALL SELECT 'jes.source', COUNT(*)"
+        "    FROM jes AS j"
+        "    LEFT OUTER JOIN jesrcs AS s"
+        "      ON s.name = j.source"
+        "    WHERE s.name IS NULL"
+        "  UNION ALL SELECT 'jelines.je', COUNT(*)"
+        "    FROM jelines AS l"
+        "    LEFT OUTER JOIN jes AS j"
+        "      ON j.id = l.je"
+        "    WHERE j.id IS NULL"
+        "  UNION ALL SELECT 'jelines.account', COUNT(*)"
+        "    FROM jelines AS l"
+        "    LEFT OUTER JOIN nomaccts AS a"
+        "      ON a.id = l.account"
+        "    WHERE a.id IS NULL"
+        "  UNION ALL SELECT 'users.user_name', COUNT(*)"
+        "    FROM (SELECT user_name FROM users"
+        "            GROUP BY user_name"
+        "            HAVING COUNT(*) > 1) AS d";
+    return query;
+}
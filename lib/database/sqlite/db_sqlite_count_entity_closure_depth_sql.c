@@ -0,0 +1,16 @@
+/*!
+ * \file            db_sqlite_count_entity_closure_depth_sql.c
+ * \brief           Returns SQLite SQL query to count the entity closure rows
+ * at a depth.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_count_entity_closure_depth_sql(void) {
+    static const char * query = 
+        "SELECT COUNT(*)"
+        "  FROM entity_closure"
+        "  WHERE depth = %s";
+    return query;
+}
@@ -0,0 +1,25 @@
+/*!
+ * \file            db_sqlite_create_account_balances_table_sql.c
+ * \brief           Returns SQLite SQL query to create account balances table.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_create_account_balances_table_sql(void) {
+    static const char * query = 
+        "CREATE TABLE account_balances ("
+        "    entity     INTEGER         NOT NULL,"
+        "    account    INTEGER         NOT NULL,"
+        "    balance    DECIMAL(20,2)   NOT NULL,"
+        "  CONSTRAINT account_balances_pk"
+        "    PRIMARY KEY (entity, account),"
+        "  CONSTRAINT account_balances_entity_fk"
+        "    FOREIGN KEY (entity)"
+        "    REFERENCES entities(id),"
+        "  CONSTRAINT account_balances_account_fk"
+        "    FOREIGN KEY (account)"
+        "    REFERENCES nomaccts(id)"
+        ");";
+    return query;
+}
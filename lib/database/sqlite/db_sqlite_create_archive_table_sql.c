@@ -0,0 +1,16 @@
+/*!
+ * \file            db_sqlite_create_archive_table_sql.c
+ * \brief           Returns SQLite SQL query to create a year archive table.
+ * \details         The table is created empty, with the columns of the
+ * table, and is filled by `db_exchange_partition_sql()`.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_create_archive_table_sql(void) {
+    static const char * query = 
+        "CREATE TABLE %s_archive_%d AS"
+        "  SELECT * FROM %s WHERE year = %d LIMIT 0";
+    return query;
+}
@@ -0,0 +1,26 @@
+/*!
+ * \file            db_sqlite_create_clustered_jelines_table_sql.c
+ * \brief           Returns SQLite SQL query to create clustered JE lines table.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_create_clustered_jelines_table_sql(void) {
+    static const char * query = 
+        "CREATE TABLE jelines ("
+        "    je         INTEGER         NOT NULL,"
+        "    line_no    INTEGER         NOT NULL,"
+        "    account    INTEGER         NOT NULL,"
+        "    amount     DECIMAL(20,2)   NOT NULL,"
+        "  CONSTRAINT jelines_pk"
+        "    PRIMARY KEY (je, line_no),"
+        "  CONSTRAINT jes_je_fk"
+        "    FOREIGN KEY (je)"
+        "    REFERENCES jes(id),"
+        "  CONSTRAINT jes_account_fk"
+        "    FOREIGN KEY (account)"
+        "    REFERENCES nomaccts(id)"
+        ") WITHOUT ROWID;";
+    return query;
+}
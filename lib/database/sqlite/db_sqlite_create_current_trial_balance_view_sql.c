@@ -0,0 +1,23 @@
+/*!
+ * \file            db_sqlite_create_current_trial_balance_view_sql.c
+ * \brief           Returns SQLite SQL query to create trial balance view.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_create_current_trial_balance_view_sql(void) {
+    static const char * query = 
+        "CREATE VIEW current_trial_balance AS"
+        "  SELECT"
+        "    b.entity AS \"Entity\","
+        "    a.num AS \"A/C No.\","
+        "    a.description AS \"Description\","
+        "    printf('%.2f', b.balance) AS \"Balance\""
+        "    FROM account_balances AS b"
+        "    INNER JOIN nomaccts AS a"
+        "      ON a.id = b.account"
+        "    ORDER BY b.entity ASC, a.num ASC";
+    return query;
+}
+
@@ -0,0 +1,22 @@
+/*!
+ * \file            db_sqlite_create_denormalized_account_balances_trigger_sql.c
+ * \brief           Returns SQLite SQL query to create denormalized account
+ * balances trigger.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_create_denormalized_account_balances_trigger_sql(void) {
+    static const char * query = 
+        "CREATE TRIGGER jelines_balances_insert"
+        "  AFTER INSERT ON jelines"
+        "  FOR EACH ROW"
+        "  BEGIN"
+        "    INSERT INTO account_balances (entity, account, balance)"
+        "      VALUES (NEW.entity, NEW.account, NEW.amount)"
+        "    ON CONFLICT (entity, account)"
+        "      DO UPDATE SET balance = ROUND(balance + excluded.balance, 2);"
+        "  END";
+    return query;
+}
@@ -0,0 +1,24 @@
+/*!
+ * \file            db_sqlite_create_denormalized_all_jes_view_sql.c
+ * \brief           Returns SQLite SQL query to create denormalized all JEs
+ * view.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_create_denormalized_all_jes_view_sql(void) {
+    static const char * query = 
+        "CREATE VIEW all_jes AS"
+        "  SELECT"
+        "    l.je AS \"JE\","
+        "    l.entity AS \"En\","
+        "    a.num AS \"A/C No.\","
+        "    a.description AS \"Description\","
+        "    printf('%.2f', l.amount) AS \"Amount\""
+        "    FROM jelines AS l"
+        "    INNER JOIN nomaccts AS a"
+        "      ON a.id = l.account"
+        "    ORDER BY l.je ASC, a.num ASC";
+    return query;
+}
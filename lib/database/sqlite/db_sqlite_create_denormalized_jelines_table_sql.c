@@ -0,0 +1,30 @@
+/*!
+ * \file            db_sqlite_create_denormalized_jelines_table_sql.c
+ * \brief           Returns SQLite SQL query to create denormalized JE lines
+ * table.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_create_denormalized_jelines_table_sql(void) {
+    static const char * query = 
+        "CREATE TABLE jelines ("
+        "    je         INTEGER         NOT NULL,"
+        "    line_no    INTEGER         NOT NULL,"
+        "    entity     INTEGER         NOT NULL,"
+        "    year       INTEGER         NOT NULL,"
+        "    period     INTEGER         NOT NULL,"
+        "    account    INTEGER         NOT NULL,"
+        "    amount     DECIMAL(20,2)   NOT NULL,"
+        "  CONSTRAINT jelines_pk"
+        "    PRIMARY KEY (entity, year, period, je, line_no),"
+        "  CONSTRAINT jes_je_fk"
+        "    FOREIGN KEY (je, entity, year, period)"
+        "    REFERENCES jes(id, entity, year, period),"
+        "  CONSTRAINT jes_account_fk"
+        "    FOREIGN KEY (account)"
+        "    REFERENCES nomaccts(id)"
+        ") WITHOUT ROWID;";
+    return query;
+}
@@ -0,0 +1,25 @@
+/*!
+ * \file            db_sqlite_create_denormalized_period_balances_trigger_sql.c
+ * \brief           Returns SQLite SQL query to create denormalized period
+ * balances trigger.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_create_denormalized_period_balances_trigger_sql(void) {
+    static const char * query = 
+        "CREATE TRIGGER jelines_period_balances_insert"
+        "  AFTER INSERT ON jelines"
+        "  FOR EACH ROW"
+        "  BEGIN"
+        "    INSERT INTO period_balances"
+        "        (entity, account, year, period, movement)"
+        "      VALUES (NEW.entity, NEW.account, NEW.year, NEW.period,"
+        "              NEW.amount)"
+        "    ON CONFLICT (entity, account, year, period)"
+        "      DO UPDATE SET"
+        "        movement = ROUND(movement + excluded.movement, 2);"
+        "  END";
+    return query;
+}
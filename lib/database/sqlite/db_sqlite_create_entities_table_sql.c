@@ -0,0 +1,25 @@
+/*!
+ * \file            db_sqlite_create_entities_table_sql.c
+ * \brief           Returns SQLite SQL query to create entities table.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_create_entities_table_sql(void) {
+    static const char * query = 
+        "CREATE TABLE entities ("
+        "    id         INTEGER         PRIMARY KEY,"
+        "    name       VARCHAR(100)    NOT NULL,"
+        "    shortname  VARCHAR(10)     NOT NULL,"
+        "    currency   CHAR(30)        NOT NULL DEFAULT 'USD',"
+        "    parent     INT             NOT NULL,"
+        "    aggregate  BOOLEAN         NOT NULL DEFAULT 0,"
+        "    enabled    BOOLEAN         NOT NULL DEFAULT 1,"
+        "  CONSTRAINT entities_parent_fk"
+        "    FOREIGN KEY (parent)"
+        "    REFERENCES entities(id)"
+        ");";
+    return query;
+}
+
@@ -0,0 +1,25 @@
+/*!
+ * \file            db_sqlite_create_entity_closure_table_sql.c
+ * \brief           Returns SQLite SQL query to create entity closure table.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_create_entity_closure_table_sql(void) {
+    static const char * query = 
+        "CREATE TABLE entity_closure ("
+        "    ancestor   INTEGER         NOT NULL,"
+        "    descendant INTEGER         NOT NULL,"
+        "    depth      INTEGER         NOT NULL,"
+        "  CONSTRAINT entity_closure_pk"
+        "    PRIMARY KEY (ancestor, descendant),"
+        "  CONSTRAINT entity_closure_ancestor_fk"
+        "    FOREIGN KEY (ancestor)"
+        "    REFERENCES entities(id),"
+        "  CONSTRAINT entity_closure_descendant_fk"
+        "    FOREIGN KEY (descendant)"
+        "    REFERENCES entities(id)"
+        ");";
+    return query;
+}
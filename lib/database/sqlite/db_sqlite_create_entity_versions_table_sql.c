@@ -0,0 +1,18 @@
+/*!
+ * \file            db_sqlite_create_entity_versions_table_sql.c
+ * \brief           Returns SQLite SQL query to create entity versions table.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_create_entity_versions_table_sql(void) {
+    static const char * query = 
+        "CREATE TABLE entity_versions ("
+        "    entity     INTEGER         NOT NULL,"
+        "    version    BIGINT          NOT NULL,"
+        "  CONSTRAINT entity_versions_pk"
+        "    PRIMARY KEY (entity)"
+        ");";
+    return query;
+}
@@ -0,0 +1,19 @@
+/*!
+ * \file            db_sqlite_create_ledger_version_table_sql.c
+ * \brief           Returns SQLite SQL query to create ledger version table.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_create_ledger_version_table_sql(void) {
+    static const char * query = 
+        "CREATE TABLE ledger_version ("
+        "    id         INTEGER         NOT NULL,"
+        "    epoch      VARCHAR(32)     NOT NULL,"
+        "    version    BIGINT          NOT NULL,"
+        "  CONSTRAINT ledger_version_pk"
+        "    PRIMARY KEY (id)"
+        ");";
+    return query;
+}
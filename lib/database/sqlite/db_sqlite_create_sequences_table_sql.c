@@ -0,0 +1,19 @@
+/*!
+ * \file            db_sqlite_create_sequences_table_sql.c
+ * \brief           Returns SQLite SQL query to create sequences table.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_create_sequences_table_sql(void) {
+    static const char * query = 
+        "CREATE TABLE sequences ("
+        "    name       VARCHAR(30)     NOT NULL,"
+        "    next_id    BIGINT          NOT NULL,"
+        "    generation BIGINT          NOT NULL DEFAULT 0,"
+        "  CONSTRAINT sequences_pk"
+        "    PRIMARY KEY (name)"
+        ");";
+    return query;
+}
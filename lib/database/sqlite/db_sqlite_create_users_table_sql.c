@@ -0,0 +1,22 @@
+/*!
+ * \file            db_sqlite_create_users_table_sql.c
+ * \brief           Returns SQLite SQL query to create users table.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_create_users_table_sql(void) {
+    static const char * query = 
+        "CREATE TABLE users ("
+        "    id         INTEGER     PRIMARY KEY,"
+        "    user_name  VARCHAR(30) NOT NULL UNIQUE,"
+        "    first_name VARCHAR(30) NOT NULL,"
+        "    last_name  VARCHAR(30) NOT NULL,"
+        "    password   VARCHAR(30)          DEFAULT NULL,"
+        "    enabled    BOOLEAN              DEFAULT 0,"
+        "    created    TIMESTAMP   NOT NULL DEFAULT CURRENT_TIMESTAMP"
+        ");";
+    return query;
+}
+
@@ -0,0 +1,24 @@
+/*!
+ * \file            db_sqlite_current_trial_balance_filtered_report_sql.c
+ * \brief           Returns SQLite SQL query to show a filtered current
+ * trial balance.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_current_trial_balance_filtered_report_sql(void) {
+    static const char * query = 
+        "SELECT"
+        "    b.entity AS \"Entity\","
+        "    a.num AS \"A/C No.\","
+        "    a.description AS \"Description\","
+        "    printf('%%.2f', b.balance) AS \"Balance\""
+        "  FROM account_balances AS b"
+        "  INNER JOIN nomaccts AS a"
+        "    ON a.id = b.account"
+        "%s"
+        "  ORDER BY b.entity ASC, a.num ASC"
+        "%s";
+    return query;
+}
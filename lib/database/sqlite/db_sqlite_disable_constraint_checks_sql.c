@@ -0,0 +1,15 @@
+/*!
+ * \file            db_sqlite_disable_constraint_checks_sql.c
+ * \brief           Returns SQLite SQL query to disable constraint checks.
+ * \details         SQLite cannot disable unique checks, and cannot disable
+ * foreign key checks inside a transaction, so they are deferred to commit.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_disable_constraint_checks_sql(void) {
+    static const char * query = 
+        "PRAGMA defer_foreign_keys = ON";
+    return query;
+}
@@ -0,0 +1,12 @@
+/*!
+ * \file            db_sqlite_drop_entity_closure_table_sql.c
+ * \brief           Returns SQLite SQL query to drop entity closure table.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_drop_entity_closure_table_sql(void) {
+    static const char * query = "DROP TABLE entity_closure";
+    return query;
+}
@@ -0,0 +1,12 @@
+/*!
+ * \file            db_sqlite_drop_partition_sql.c
+ * \brief           Returns SQLite SQL query to drop a year partition.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_drop_partition_sql(void) {
+    static const char * query = "DELETE FROM %s WHERE year = %d";
+    return query;
+}
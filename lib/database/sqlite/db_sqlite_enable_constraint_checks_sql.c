@@ -0,0 +1,13 @@
+/*!
+ * \file            db_sqlite_enable_constraint_checks_sql.c
+ * \brief           Returns SQLite SQL query to enable constraint checks.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_enable_constraint_checks_sql(void) {
+    static const char * query = 
+        "PRAGMA defer_foreign_keys = OFF";
+    return query;
+}
@@ -0,0 +1,14 @@
+/*!
+ * \file            db_sqlite_entity_closure_sql.c
+ * \brief           Returns SQLite SQL query to get the entity closure.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_entity_closure_sql(void) {
+    static const char * query = 
+        "SELECT ancestor, descendant"
+        "  FROM entity_closure";
+    return query;
+}
@@ -0,0 +1,14 @@
+/*!
+ * \file            db_sqlite_entity_subtree_predicate_sql.c
+ * \brief           Returns SQLite SQL query to test whether an entity is
+ * under another.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_entity_subtree_predicate_sql(void) {
+    static const char * query = 
+        "%s IN (SELECT descendant FROM entity_closure WHERE ancestor = %d)";
+    return query;
+}
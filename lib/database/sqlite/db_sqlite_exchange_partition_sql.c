@@ -0,0 +1,17 @@
+/*!
+ * \file            db_sqlite_exchange_partition_sql.c
+ * \brief           Returns SQLite SQL query to exchange a year partition with
+ * its archive table.
+ * \details         The year is copied into the archive table, and is
+ * deleted from the table by `db_drop_partition_sql()`.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_exchange_partition_sql(void) {
+    static const char * query = 
+        "INSERT INTO %s_archive_%d"
+        "  SELECT * FROM %s WHERE year = %d";
+    return query;
+}
@@ -0,0 +1,20 @@
+/*!
+ * \file            db_sqlite_extend_entity_closure_sql.c
+ * \brief           Returns SQLite SQL query to add the children of the
+ * descendants at a depth to the entity closure.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_extend_entity_closure_sql(void) {
+    static const char * query = 
+        "INSERT INTO entity_closure (ancestor, descendant, depth)"
+        "  SELECT c.ancestor, e.id, c.depth + 1"
+        "  FROM entity_closure AS c"
+        "  INNER JOIN entities AS e"
+        "    ON e.parent = c.descendant"
+        "  WHERE c.depth = %s"
+        "    AND e.id <> e.parent";
+    return query;
+}
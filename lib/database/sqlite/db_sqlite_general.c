@@ -0,0 +1,357 @@
+/*!
+ * \file            db_sqlite_general.c
+ * \brief           Implementation of SQLite database functionality.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <sqlite3.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "gl_general/gl_general.h"
+#include "database/db_internal.h"
+#include "db_sqlite_internal.h"
+
+/*!  Maximum length of a line in a bulk load file  */
+#define MAX_INFILE_LINE_SIZE 1024
+
+/*!  Number of leading records (field names and types) in a load file  */
+#define INFILE_HEADER_RECORDS 2
+
+/*!  Field delimiter in a bulk load file  */
+#define INFILE_DELIM ':'
+
+/*!
+ * \brief           Runs a statement which takes no parameters.
+ * \param sql       The SQL statement.
+ * \param msg       The message to log on failure.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool db_sqlite_run(const char * sql, const char * msg);
+
+/*!
+ * \brief           Creates an INSERT statement with a parameter per field.
+ * \param table     The table name.
+ * \param fields    A comma-separated list of field names.
+ * \param num_fields    Modified to contain the number of fields.
+ * \returns         The statement.
+ */
+static ds_str db_sqlite_insert_sql(const char * table, const char * fields,
+                                   size_t * num_fields);
+
+/*!
+ * \brief           Binds each field of a load file line to a statement.
+ * \param stmt      The prepared INSERT statement.
+ * \param line      The line, which is modified.
+ * \param num_fields    The number of parameters in the statement.
+ * \returns         `true` on success, `false` if the line has the wrong
+ * number of fields.
+ */
+static bool db_sqlite_bind_line(sqlite3_stmt * stmt, char * line,
+                                const size_t num_fields);
+
+bool db_execute_query(ds_str query) {
+    return db_sqlite_run(ds_str_cstr(query), "Query unsuccessful");
+}
+
+bool db_execute_load_query(ds_str query, size_t * rows) {
+    sqlite3 * db = db_sqlite_connection();
+
+    if ( !db ) {
+        gl_log_msg("Attempting to load data with no connection.");
+        return false;
+    }
+
+    /*  SQLite has no LOAD DATA statement, so unpack the one generated
+     *  from db_load_data_infile_sql() and insert each line of the file
+     *  with a single prepared statement instead.  */
+
+    const char * q = ds_str_cstr(query);
+    const size_t q_len = strlen(q) + 1;
+    char * filename = malloc(q_len);
+    char * table = malloc(q_len);
+    char * fields = malloc(q_len);
+
+    if ( !filename || !table || !fields ) {
+        free(filename);
+        free(table);
+        free(fields);
+        gl_log_msg("Couldn't allocate memory for load query.");
+        return false;
+    }
+
+    if ( sscanf(q, "LOAD DATA INFILE '%[^']' INTO TABLE %s (%[^)])",
+                filename, table, fields) != 3 ) {
+        free(filename);
+        free(table);
+        free(fields);
+        gl_log_msg("Malformed load query '%s'.", q);
+        return false;
+    }
+
+    size_t num_fields;
+    ds_str insert = db_sqlite_insert_sql(table, fields, &num_fields);
+    sqlite3_stmt * stmt = db_sqlite_prepare(ds_str_cstr(insert));
+    ds_str_destroy(insert);
+    free(table);
+    free(fields);
+
+    if ( !stmt ) {
+        free(filename);
+        return false;
+    }
+
+    FILE * fp = fopen(filename, "r");
+    if ( !fp ) {
+        gl_log_msg("Couldn't open file '%s'.", filename);
+        free(filename);
+        db_sqlite_release(stmt);
+        return false;
+    }
+
+    bool ret_val = true;
+    size_t num_rows = 0;
+    int records_skipped = 0;
+    char line[MAX_INFILE_LINE_SIZE];
+
+    while ( ret_val && fgets(line, sizeof line, fp) ) {
+        size_t length = strlen(line);
+
+        if ( line[length - 1] != '\n' && !feof(fp) ) {
+            gl_log_msg("Line too long in load file.");
+            ret_val = false;
+            break;
+        }
+
+        while ( length && isspace((unsigned char) line[length - 1]) ) {
+            line[--length] = '\0';
+        }
+
+        const char * p = line;
+        while ( isspace((unsigned char) *p) ) {
+            ++p;
+        }
+
+        if ( *p == '\0' || *p == '#' ||
+             records_skipped++ < INFILE_HEADER_RECORDS ) {
+            continue;
+        }
+
+        if ( !db_sqlite_bind_line(stmt, line, num_fields) ) {
+            gl_log_msg("Wrong number of fields in load file line %zu.",
+                       num_rows + 1);
+            ret_val = false;
+        }
+        else if ( sqlite3_step(stmt) != SQLITE_DONE ) {
+            db_sqlite_error_msg("Load unsuccessful", db);
+            ret_val = false;
+        }
+        else {
+            ++num_rows;
+        }
+
+        sqlite3_reset(stmt);
+    }
+
+    fclose(fp);
+    free(filename);
+    db_sqlite_release(stmt);
+
+    if ( ret_val && rows ) {
+        *rows = num_rows;
+    }
+
+    return ret_val;
+}
+
+bool db_begin_transaction(void) {
+    /*  Take the write lock up front, rather than on the first write, so
+     *  a transaction can't fail part way through when another connection
+     *  is writing.  */
+
+    return db_sqlite_run("BEGIN IMMEDIATE", "Couldn't begin transaction");
+}
+
+bool db_commit_transaction(void) {
+    if ( !db_sqlite_run("COMMIT", "Couldn't commit transaction") ) {
+
+        /*  A failed COMMIT leaves the transaction open.  */
+
+        db_sqlite_run("ROLLBACK", "Couldn't roll back transaction");
+        return false;
+    }
+
+    return true;
+}
+
+bool db_rollback_transaction(void) {
+    return db_sqlite_run("ROLLBACK", "Couldn't roll back transaction");
+}
+
+size_t db_max_query_length(void) {
+    static const size_t default_length = 1000000;
+
+    sqlite3 * db = db_sqlite_connection();
+    if ( !db ) {
+        return default_length;
+    }
+
+    int length = sqlite3_limit(db, SQLITE_LIMIT_SQL_LENGTH, -1);
+    return length > 0 ? (size_t) length : default_length;
+}
+
+bool db_query_foreach(ds_str query, db_header_callback header_cb,
+                      db_row_callback row_cb, void * ctx) {
+    sqlite3 * db = db_sqlite_connection();
+
+    if ( !db ) {
+        gl_log_msg("Attempting to run query with no connection.");
+        return false;
+    }
+
+    sqlite3_stmt * stmt = db_sqlite_prepare(ds_str_cstr(query));
+    if ( !stmt ) {
+        return false;
+    }
+
+    const size_t num_fields = (size_t) sqlite3_column_count(stmt);
+    const char ** names = malloc(num_fields * sizeof *names);
+    const char ** values = malloc(num_fields * sizeof *values);
+    size_t * lengths = malloc(num_fields * sizeof *lengths);
+    if ( !names || !values || !lengths ) {
+        free(names);
+        free(values);
+        free(lengths);
+        db_sqlite_release(stmt);
+        gl_log_msg("Couldn't allocate memory for query result.");
+        return false;
+    }
+
+    for ( size_t i = 0; i < num_fields; ++i ) {
+        names[i] = sqlite3_column_name(stmt, (int) i);
+    }
+
+    bool keep_going = header_cb ? header_cb(num_fields, names, ctx) : true;
+    int status = SQLITE_DONE;
+
+    while ( keep_going && (status = sqlite3_step(stmt)) == SQLITE_ROW ) {
+        for ( size_t i = 0; i < num_fields; ++i ) {
+            values[i] = (const char *) sqlite3_column_text(stmt, (int) i);
+            lengths[i] = (size_t) sqlite3_column_bytes(stmt, (int) i);
+        }
+
+        keep_going = row_cb(num_fields, values, lengths, ctx);
+    }
+
+    bool ret_val = true;
+    if ( keep_going && status != SQLITE_DONE ) {
+        db_sqlite_error_msg("Couldn't fetch row", db);
+        ret_val = false;
+    }
+
+    db_sqlite_release(stmt);
+    free(names);
+    free(values);
+    free(lengths);
+
+    return ret_val;
+}
+
+bool db_create_recordsets_from_queries(const size_t num_queries,
+                                       ds_str * queries,
+                                       ds_recordset * results) {
+
+    /*  With no network round trip to hide, running the queries one after
+     *  another is as fast as spreading them over pooled connections.  */
+
+    bool ret_val = true;
+    for ( size_t i = 0; i < num_queries; ++i ) {
+        results[i] = db_create_recordset_from_query(queries[i]);
+        if ( !results[i] ) {
+            ret_val = false;
+        }
+    }
+
+    return ret_val;
+}
+
+void db_sqlite_error_msg(const char * msg, sqlite3 * db) {
+    if ( db ) {
+        gl_log_msg("%s: %s", msg, sqlite3_errmsg(db));
+    }
+    else {
+        gl_log_msg("%s", msg);
+    }
+}
+
+static bool db_sqlite_run(const char * sql, const char * msg) {
+    sqlite3 * db = db_sqlite_connection();
+
+    if ( !db ) {
+        gl_log_msg("Attempting to write query with no connection.");
+        return false;
+    }
+
+    sqlite3_stmt * stmt = db_sqlite_prepare(sql);
+    if ( !stmt ) {
+        return false;
+    }
+
+    int status;
+    while ( (status = sqlite3_step(stmt)) == SQLITE_ROW ) {
+        ;
+    }
+
+    bool ret_val = true;
+    if ( status != SQLITE_DONE ) {
+        db_sqlite_error_msg(msg, db);
+        ret_val = false;
+    }
+
+    db_sqlite_release(stmt);
+    return ret_val;
+}
+
+static ds_str db_sqlite_insert_sql(const char * table, const char * fields,
+                                   size_t * num_fields) {
+    ds_str sql = ds_str_create_sprintf("INSERT INTO %s (%s) VALUES (?",
+                                       table, fields);
+
+    *num_fields = 1;
+    for ( const char * p = fields; *p; ++p ) {
+        if ( *p == ',' ) {
+            ds_str_concat_cstr(sql, ", ?");
+            ++*num_fields;
+        }
+    }
+    ds_str_concat_cstr(sql, ")");
+
+    return sql;
+}
+
+static bool db_sqlite_bind_line(sqlite3_stmt * stmt, char * line,
+                                const size_t num_fields) {
+    sqlite3_clear_bindings(stmt);
+
+    char * field = line;
+    for ( size_t i = 0; i < num_fields; ++i ) {
+        if ( !field ) {
+            return false;
+        }
+
+        char * delim = strchr(field, INFILE_DELIM);
+        if ( delim ) {
+            *delim = '\0';
+        }
+
+        sqlite3_bind_text(stmt, (int) i + 1, field, -1, SQLITE_TRANSIENT);
+        field = delim ? delim + 1 : NULL;
+    }
+
+    return field == NULL;
+}
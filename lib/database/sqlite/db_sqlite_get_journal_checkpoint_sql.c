@@ -0,0 +1,13 @@
+/*!
+ * \file            db_sqlite_get_journal_checkpoint_sql.c
+ * \brief           Returns SQLite SQL query to get a journal checkpoint.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_get_journal_checkpoint_sql(void) {
+    static const char * query = 
+        "SELECT seq FROM posting_journal WHERE journal = '%s'";
+    return query;
+}
@@ -0,0 +1,15 @@
+/*!
+ * \file            db_sqlite_init_je_sequence_sql.c
+ * \brief           Returns SQLite SQL query to initialize the JE ID sequence.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_init_je_sequence_sql(void) {
+    static const char * query = 
+        "INSERT INTO sequences (name, next_id)"
+        "  SELECT 'jes', COALESCE(MAX(id), 0) + 1"
+        "  FROM jes";
+    return query;
+}
@@ -0,0 +1,45 @@
+/*!
+ * \file            db_sqlite_internal.h
+ * \brief           Internal interface to SQLite database functionality.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_DATABASE_DB_SQLITE_INTERNAL_H
+#define PG_GENERAL_LEDGER_DATABASE_DB_SQLITE_INTERNAL_H
+
+#include <sqlite3.h>
+
+/*!
+ * \brief           Returns the connection checked out to the calling thread.
+ * \returns         The connection, or `NULL` if the thread has none.
+ */
+sqlite3 * db_sqlite_connection(void);
+
+/*!
+ * \brief           Prepares a statement on the calling thread's connection.
+ * \details         Short statements are kept in a per-connection cache, so
+ * a statement which is run repeatedly is only compiled once. The statement
+ * must be returned with `db_sqlite_release()`.
+ * \param sql       The SQL statement. Only a single statement is allowed.
+ * \returns         The prepared statement, or `NULL` on failure.
+ */
+sqlite3_stmt * db_sqlite_prepare(const char * sql);
+
+/*!
+ * \brief           Releases a statement returned by `db_sqlite_prepare()`.
+ * \details         Cached statements are reset and their bindings cleared
+ * for reuse, other statements are finalized.
+ * \param stmt      The statement.
+ */
+void db_sqlite_release(sqlite3_stmt * stmt);
+
+/*!
+ * \brief           Logs an error message with SQLite error information.
+ * \param msg       The message to log.
+ * \param db        The connection on which the error occurred, or `NULL`.
+ */
+void db_sqlite_error_msg(const char * msg, sqlite3 * db);
+
+#endif      /*  PG_GENERAL_LEDGER_DATABASE_DB_SQLITE_INTERNAL_H  */
@@ -0,0 +1,18 @@
+/*!
+ * \file            db_sqlite_je_page_end_sql.c
+ * \brief           Returns SQLite SQL query to get the last JE ID in a page of
+ * JEs.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_je_page_end_sql(void) {
+    static const char * query = 
+        "SELECT MAX(id) FROM"
+        "  (SELECT id FROM jes"
+        "    WHERE id > %s"
+        "    ORDER BY id ASC"
+        "    LIMIT %s) AS page";
+    return query;
+}
@@ -0,0 +1,16 @@
+/*!
+ * \file            db_sqlite_je_sequence_generation_sql.c
+ * \brief           Returns SQLite SQL query to get the generation of the JE
+ * ID sequence.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_je_sequence_generation_sql(void) {
+    static const char * query = 
+        "SELECT generation"
+        "  FROM sequences"
+        "  WHERE name = 'jes'";
+    return query;
+}
@@ -0,0 +1,13 @@
+/*!
+ * \file            db_sqlite_ledger_version_sql.c
+ * \brief           Returns SQLite SQL query to get the ledger version.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_ledger_version_sql(void) {
+    static const char * query = 
+        "SELECT epoch, version FROM ledger_version WHERE id = 1";
+    return query;
+}
@@ -0,0 +1,16 @@
+/*!
+ * \file            db_sqlite_ledgerstore_jelines_sql.c
+ * \brief           Returns SQLite SQL query to load ledger store JE lines.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_ledgerstore_jelines_sql(void) {
+    static const char * query = 
+        "SELECT l.je, a.num, l.amount"
+        "  FROM jelines AS l"
+        "  INNER JOIN nomaccts AS a"
+        "    ON a.id = l.account";
+    return query;
+}
@@ -0,0 +1,13 @@
+/*!
+ * \file            db_sqlite_ledgerstore_nomaccts_sql.c
+ * \brief           Returns SQLite SQL query to load ledger store accounts.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_ledgerstore_nomaccts_sql(void) {
+    static const char * query = 
+        "SELECT num, description FROM nomaccts";
+    return query;
+}
@@ -0,0 +1,13 @@
+/*!
+ * \file            db_sqlite_list_entity_ids_sql.c
+ * \brief           Returns SQLite SQL query to list entity IDs.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_list_entity_ids_sql(void) {
+    static const char * query = 
+        "SELECT id FROM entities ORDER BY id";
+    return query;
+}
@@ -0,0 +1,26 @@
+/*!
+ * \file            db_sqlite_list_jelines_filtered_report_sql.c
+ * \brief           Returns SQLite SQL query to show a filtered list of journal
+ * entry lines.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_list_jelines_filtered_report_sql(void) {
+    static const char * query = 
+        "SELECT"
+        "  l.je AS \"JE\","
+        "  l.line_no AS \"Line\","
+        "  a.num AS \"Account Number\","
+        "  printf('%%.2f', l.amount) AS \"Amount\""
+        "  FROM jelines AS l"
+        "  INNER JOIN jes AS j"
+        "    ON j.id = l.je"
+        "  INNER JOIN nomaccts AS a"
+        "    ON a.id = l.account"
+        "%s"
+        "  ORDER BY l.je, l.line_no"
+        "%s";
+    return query;
+}
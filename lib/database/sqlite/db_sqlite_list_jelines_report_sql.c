@@ -0,0 +1,22 @@
+/*!
+ * \file            db_sqlite_list_jelines_report_sql.c
+ * \brief           Returns SQLite SQL query to create JE lines report.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_list_jelines_report_sql(void) {
+    static const char * query = 
+        "SELECT"
+        "  l.je AS \"JE\","
+        "  l.line_no AS \"Line\","
+        "  a.num AS \"Account Number\","
+        "  printf('%.2f', l.amount) AS \"Amount\""
+        "  FROM jelines AS l"
+        "  INNER JOIN nomaccts AS a"
+        "    ON a.id = l.account"
+        "  ORDER BY l.je, l.line_no";
+    return query;
+}
+
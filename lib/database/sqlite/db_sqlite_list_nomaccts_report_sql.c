@@ -0,0 +1,27 @@
+/*!
+ * \file            db_sqlite_list_nomaccts_report_sql.c
+ * \brief           Returns SQLite SQL query to create list nominal accounts
+ * report.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_list_nomaccts_report_sql(void) {
+    static const char * query = 
+        "SELECT"
+        "  num AS \"A/C Number\","
+        "  description AS \"Description\","
+        "  CASE enabled"
+        "    WHEN 1"
+        "      THEN 'Yes'"
+        "    WHEN 0"
+        "      THEN 'No'"
+        "    ELSE 'Unknown'"
+        "  END"
+        "    AS \"Enabled?\""
+        "  FROM nomaccts"
+        "  ORDER BY num";
+    return query;
+}
+
@@ -0,0 +1,15 @@
+/*!
+ * \file            db_sqlite_load_data_infile_sql.c
+ * \brief           Returns SQLite SQL query to bulk load a data file.
+ * \details         SQLite has no `LOAD DATA` statement. This one is not
+ * passed to SQLite, but is interpreted by `db_execute_load_query()`.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_load_data_infile_sql(void) {
+    static const char * query = 
+        "LOAD DATA INFILE '%s' INTO TABLE %s (%s)";
+    return query;
+}
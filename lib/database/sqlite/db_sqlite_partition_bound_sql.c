@@ -0,0 +1,15 @@
+/*!
+ * \file            db_sqlite_partition_bound_sql.c
+ * \brief           Returns SQLite SQL query to get the year after the last
+ * year partition.
+ * \details         SQLite does not partition tables, so there is no query.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <stddef.h>
+
+const char * db_partition_bound_sql(void) {
+    return NULL;
+}
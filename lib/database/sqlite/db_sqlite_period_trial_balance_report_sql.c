@@ -0,0 +1,23 @@
+/*!
+ * \file            db_sqlite_period_trial_balance_report_sql.c
+ * \brief           Returns SQLite SQL query to run period trial balance report.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_period_trial_balance_report_sql(void) {
+    static const char * query = 
+        "SELECT"
+        "    b.entity AS \"Entity\","
+        "    a.num AS \"A/C No.\","
+        "    a.description AS \"Description\","
+        "    printf('%%.2f', sum(b.movement)) AS \"Balance\""
+        "  FROM period_balances AS b"
+        "  INNER JOIN nomaccts AS a"
+        "    ON a.id = b.account"
+        "  WHERE b.year < %s OR (b.year = %s AND b.period <= %s)"
+        "  GROUP BY b.entity, a.num, a.description"
+        "  ORDER BY b.entity ASC, a.num ASC";
+    return query;
+}
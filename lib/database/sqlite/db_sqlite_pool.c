@@ -0,0 +1,385 @@
+/*!
+ * \file            db_sqlite_pool.c
+ * \brief           Implementation of SQLite connection pool functionality.
+ * \details         Each pooled connection opens the same database file. The
+ * database is put into write-ahead log mode, so readers on one connection
+ * do not block a writer on another.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <sqlite3.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "gl_general/gl_general.h"
+#include "database/db_internal.h"
+#include "db_sqlite_internal.h"
+
+/*!  Default number of connections in the pool  */
+#define DEFAULT_POOL_SIZE 1
+
+/*!  Number of prepared statements cached per connection  */
+#define STMT_CACHE_SIZE 32
+
+/*!  Longest statement which will be cached  */
+#define STMT_CACHE_MAX_SQL 4096
+
+/*!  Milliseconds to wait for a lock held by another connection  */
+#define BUSY_TIMEOUT_MS 10000
+
+/*!  Extension appended to the database name to give its filename  */
+#define DB_FILE_EXTENSION ".db"
+
+/*!  Cached prepared statement structure  */
+struct db_stmt_cache_entry {
+    char * sql;                 /*!<  The statement text            */
+    sqlite3_stmt * stmt;        /*!<  The prepared statement        */
+    bool in_use;                /*!<  `true` from when the statement
+                                      is returned until released    */
+};
+
+/*!  Pooled connection structure  */
+struct db_pool_conn {
+    sqlite3 * db;               /*!<  The connection, or `NULL`     */
+    bool in_use;                /*!<  `true` if checked out         */
+    struct db_stmt_cache_entry cache[STMT_CACHE_SIZE];
+                                /*!<  Prepared statement cache      */
+    size_t next_evict;          /*!<  Next cache entry to replace   */
+};
+
+/*!  Connection pool structure  */
+struct db_pool {
+    struct db_pool_conn * conns;    /*!<  Array of connections      */
+    size_t size;                    /*!<  Number of connections     */
+    ds_str filename;                /*!<  Database filename         */
+    pthread_mutex_t lock;           /*!<  Protects the pool         */
+    pthread_cond_t available;       /*!<  Signalled on checkin      */
+    bool closing;                   /*!<  `true` while being closed */
+};
+
+/*!  The connection pool  */
+static struct db_pool pool = {
+    NULL, 0, NULL,
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, false
+};
+
+/*!  Requested pool size  */
+static size_t requested_pool_size = DEFAULT_POOL_SIZE;
+
+/*!  Key for the connection checked out to each thread  */
+static pthread_key_t conn_key;
+
+/*!  Ensures the thread key is created once only  */
+static pthread_once_t key_once = PTHREAD_ONCE_INIT;
+
+/*!
+ * \brief           Creates the thread key.
+ */
+static void db_key_init(void);
+
+/*!
+ * \brief           Opens a new connection to the pool database.
+ * \returns         The connection, or `NULL` on failure.
+ */
+static sqlite3 * db_pool_open_connection(void);
+
+/*!
+ * \brief           Finalizes all cached statements and closes a connection.
+ * \param conn      The pooled connection.
+ */
+static void db_pool_close_connection(struct db_pool_conn * conn);
+
+void db_set_pool_size(const size_t size) {
+    requested_pool_size = size ? size : DEFAULT_POOL_SIZE;
+}
+
+size_t db_pool_size(void) {
+    return pool.size;
+}
+
+bool db_connect(const char * host, const char * database,
+                const char * username, const char * password) {
+    (void)host;
+    (void)username;
+    (void)password;
+
+    pthread_once(&key_once, db_key_init);
+
+    pthread_mutex_lock(&pool.lock);
+    if ( pool.conns ) {
+        pthread_mutex_unlock(&pool.lock);
+        gl_log_msg("Connection pool is already open.");
+        return false;
+    }
+
+    pool.conns = calloc(requested_pool_size, sizeof *pool.conns);
+    if ( !pool.conns ) {
+        pthread_mutex_unlock(&pool.lock);
+        gl_log_msg("Couldn't allocate memory for connection pool.");
+        return false;
+    }
+
+    pool.size = requested_pool_size;
+    pool.filename = ds_str_create_sprintf("%s%s", database,
+                                          DB_FILE_EXTENSION);
+    pthread_mutex_unlock(&pool.lock);
+
+    if ( !db_pool_checkout() ) {
+        db_close();
+        return false;
+    }
+
+    return true;
+}
+
+void db_close(void) {
+    db_pool_checkin();
+
+    pthread_mutex_lock(&pool.lock);
+    if ( !pool.conns ) {
+        pthread_mutex_unlock(&pool.lock);
+        gl_error_quit("Closing connection which is not open.");
+    }
+
+    /*  Connections still checked out by other threads are waited for,
+     *  since those threads will write to their slots on checkin.      */
+
+    pool.closing = true;
+    pthread_cond_broadcast(&pool.available);
+
+    bool logged = false;
+    for ( size_t i = 0; i < pool.size; ++i ) {
+        while ( pool.conns[i].in_use ) {
+            if ( !logged ) {
+                gl_log_msg("Waiting for checked out connections to close.");
+                logged = true;
+            }
+            pthread_cond_wait(&pool.available, &pool.lock);
+        }
+        db_pool_close_connection(&pool.conns[i]);
+    }
+
+    free(pool.conns);
+    pool.conns = NULL;
+    pool.size = 0;
+    pool.closing = false;
+    ds_str_destroy(pool.filename);
+    pool.filename = NULL;
+
+    pthread_cond_broadcast(&pool.available);
+    pthread_mutex_unlock(&pool.lock);
+}
+
+bool db_pool_checkout(void) {
+    pthread_once(&key_once, db_key_init);
+
+    if ( pthread_getspecific(conn_key) ) {
+        return true;
+    }
+
+    pthread_mutex_lock(&pool.lock);
+
+    struct db_pool_conn * conn = NULL;
+    while ( pool.conns && !pool.closing && !conn ) {
+
+        /*  Prefer an already open connection to opening a new one.  */
+
+        for ( size_t i = 0; i < pool.size; ++i ) {
+            if ( !pool.conns[i].in_use &&
+                 (!conn || (pool.conns[i].db && !conn->db)) ) {
+                conn = &pool.conns[i];
+            }
+        }
+
+        if ( !conn ) {
+            pthread_cond_wait(&pool.available, &pool.lock);
+        }
+    }
+
+    if ( !conn ) {
+        pthread_mutex_unlock(&pool.lock);
+        gl_log_msg("Attempting to check out connection with no pool.");
+        return false;
+    }
+
+    conn->in_use = true;
+    pthread_mutex_unlock(&pool.lock);
+
+    if ( !conn->db ) {
+        conn->db = db_pool_open_connection();
+    }
+
+    if ( !conn->db ) {
+        pthread_mutex_lock(&pool.lock);
+        conn->in_use = false;
+        pthread_cond_signal(&pool.available);
+        pthread_mutex_unlock(&pool.lock);
+        return false;
+    }
+
+    pthread_setspecific(conn_key, conn);
+    return true;
+}
+
+void db_pool_checkin(void) {
+    pthread_once(&key_once, db_key_init);
+
+    struct db_pool_conn * conn = pthread_getspecific(conn_key);
+    if ( conn ) {
+        pthread_setspecific(conn_key, NULL);
+
+        pthread_mutex_lock(&pool.lock);
+        conn->in_use = false;
+        pthread_cond_signal(&pool.available);
+        pthread_mutex_unlock(&pool.lock);
+    }
+}
+
+sqlite3 * db_sqlite_connection(void) {
+    pthread_once(&key_once, db_key_init);
+
+    struct db_pool_conn * conn = pthread_getspecific(conn_key);
+    return conn ? conn->db : NULL;
+}
+
+sqlite3_stmt * db_sqlite_prepare(const char * sql) {
+    pthread_once(&key_once, db_key_init);
+
+    struct db_pool_conn * conn = pthread_getspecific(conn_key);
+    if ( !conn ) {
+        gl_log_msg("Attempting to prepare statement with no connection.");
+        return NULL;
+    }
+
+    const size_t length = strlen(sql);
+    bool cacheable = length <= STMT_CACHE_MAX_SQL;
+
+    /*  A cached statement not yet released, e.g. by an enclosing
+     *  db_query_foreach(), can't be shared, so prepare a fresh copy.
+     *  sqlite3_stmt_busy() is no guide, since a statement which has
+     *  been bound but not yet stepped is not busy.                     */
+
+    for ( size_t i = 0; cacheable && i < STMT_CACHE_SIZE; ++i ) {
+        if ( conn->cache[i].sql && !strcmp(conn->cache[i].sql, sql) ) {
+            if ( !conn->cache[i].in_use ) {
+                conn->cache[i].in_use = true;
+                return conn->cache[i].stmt;
+            }
+            cacheable = false;
+        }
+    }
+
+    sqlite3_stmt * stmt;
+    const char * tail;
+    if ( sqlite3_prepare_v2(conn->db, sql, (int) length + 1,
+                            &stmt, &tail) != SQLITE_OK ) {
+        db_sqlite_error_msg("Couldn't prepare statement", conn->db);
+        return NULL;
+    }
+
+    while ( *tail == ' ' || *tail == '\n' || *tail == '\t' ) {
+        ++tail;
+    }
+
+    if ( !stmt || *tail ) {
+        gl_log_msg("Query must contain exactly one statement.");
+        sqlite3_finalize(stmt);
+        return NULL;
+    }
+
+    /*  Only released statements are replaced, in turn. If every cached
+     *  statement is still held, the new one is not cached.             */
+
+    struct db_stmt_cache_entry * entry = NULL;
+    for ( size_t n = 0; cacheable && !entry && n < STMT_CACHE_SIZE; ++n ) {
+        struct db_stmt_cache_entry * candidate;
+        candidate = &conn->cache[conn->next_evict];
+        conn->next_evict = (conn->next_evict + 1) % STMT_CACHE_SIZE;
+        if ( !candidate->in_use ) {
+            entry = candidate;
+        }
+    }
+
+    char * sql_copy = entry ? malloc(length + 1) : NULL;
+    if ( sql_copy ) {
+        free(entry->sql);
+        sqlite3_finalize(entry->stmt);
+        entry->sql = memcpy(sql_copy, sql, length + 1);
+        entry->stmt = stmt;
+        entry->in_use = true;
+    }
+
+    return stmt;
+}
+
+void db_sqlite_release(sqlite3_stmt * stmt) {
+    struct db_pool_conn * conn = pthread_getspecific(conn_key);
+
+    if ( !stmt ) {
+        return;
+    }
+
+    for ( size_t i = 0; conn && i < STMT_CACHE_SIZE; ++i ) {
+        if ( conn->cache[i].stmt == stmt ) {
+            sqlite3_reset(stmt);
+            sqlite3_clear_bindings(stmt);
+            conn->cache[i].in_use = false;
+            return;
+        }
+    }
+
+    sqlite3_finalize(stmt);
+}
+
+static void db_key_init(void) {
+    pthread_key_create(&conn_key, NULL);
+}
+
+static sqlite3 * db_pool_open_connection(void) {
+    sqlite3 * db;
+    const char * filename = ds_str_cstr(pool.filename);
+
+    if ( sqlite3_open_v2(filename, &db,
+                         SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE |
+                         SQLITE_OPEN_NOMUTEX, NULL) != SQLITE_OK ) {
+        db_sqlite_error_msg("Couldn't open database", db);
+        sqlite3_close(db);
+        return NULL;
+    }
+
+    sqlite3_busy_timeout(db, BUSY_TIMEOUT_MS);
+
+    /*  Foreign keys are off by default and must be enabled for each
+     *  connection. In WAL mode, NORMAL synchronization avoids a sync on
+     *  every commit without risking corruption.  */
+
+    if ( sqlite3_exec(db, "PRAGMA journal_mode = WAL", NULL, NULL, NULL) ||
+         sqlite3_exec(db, "PRAGMA synchronous = NORMAL",
+                      NULL, NULL, NULL) ||
+         sqlite3_exec(db, "PRAGMA foreign_keys = ON", NULL, NULL, NULL) ) {
+        db_sqlite_error_msg("Couldn't configure database", db);
+        sqlite3_close(db);
+        return NULL;
+    }
+
+    return db;
+}
+
+static void db_pool_close_connection(struct db_pool_conn * conn) {
+    for ( size_t i = 0; i < STMT_CACHE_SIZE; ++i ) {
+        sqlite3_finalize(conn->cache[i].stmt);
+        free(conn->cache[i].sql);
+        conn->cache[i].stmt = NULL;
+        conn->cache[i].sql = NULL;
+    }
+    conn->next_evict = 0;
+
+    if ( conn->db ) {
+        sqlite3_close(conn->db);
+        conn->db = NULL;
+    }
+}
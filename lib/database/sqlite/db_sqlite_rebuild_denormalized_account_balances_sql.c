@@ -0,0 +1,17 @@
+/*!
+ * \file            db_sqlite_rebuild_denormalized_account_balances_sql.c
+ * \brief           Returns SQLite SQL query to rebuild denormalized account
+ * balances.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_rebuild_denormalized_account_balances_sql(void) {
+    static const char * query = 
+        "INSERT INTO account_balances (entity, account, balance)"
+        "  SELECT entity, account, ROUND(sum(amount), 2)"
+        "    FROM jelines"
+        "    GROUP BY entity, account";
+    return query;
+}
@@ -0,0 +1,21 @@
+/*!
+ * \file            db_sqlite_rebuild_entity_period_balances_sql.c
+ * \brief           Returns SQLite SQL query to rebuild entity period balances.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_rebuild_entity_period_balances_sql(void) {
+    static const char * query = 
+        "INSERT INTO period_balances"
+        "    (entity, account, year, period, movement)"
+        "  SELECT j.entity, l.account, j.year, j.period,"
+        "      ROUND(sum(l.amount), 2)"
+        "    FROM jelines AS l"
+        "    INNER JOIN jes AS j"
+        "      ON l.je = j.id"
+        "    WHERE j.entity = %s"
+        "    GROUP BY j.entity, l.account, j.year, j.period";
+    return query;
+}
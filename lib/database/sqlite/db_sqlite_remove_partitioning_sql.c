@@ -0,0 +1,15 @@
+/*!
+ * \file            db_sqlite_remove_partitioning_sql.c
+ * \brief           Returns SQLite SQL query to remove partitioning from a year
+ * archive table.
+ * \details         SQLite does not partition tables, so there is no query.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <stddef.h>
+
+const char * db_remove_partitioning_sql(void) {
+    return NULL;
+}
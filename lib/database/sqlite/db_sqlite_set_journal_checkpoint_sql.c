@@ -0,0 +1,14 @@
+/*!
+ * \file            db_sqlite_set_journal_checkpoint_sql.c
+ * \brief           Returns SQLite SQL query to set a journal checkpoint.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_set_journal_checkpoint_sql(void) {
+    static const char * query = 
+        "INSERT OR REPLACE INTO posting_journal (journal, seq)"
+        " VALUES ('%s', %s)";
+    return query;
+}
@@ -0,0 +1,13 @@
+/*!
+ * \file            db_sqlite_source_dictionary_sql.c
+ * \brief           Returns SQLite SQL query to get JE source names and
+ * descriptions.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_source_dictionary_sql(void) {
+    static const char * query = "SELECT name, description FROM jesrcs";
+    return query;
+}
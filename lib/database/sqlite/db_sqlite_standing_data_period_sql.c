@@ -0,0 +1,15 @@
+/*!
+ * \file            db_sqlite_standing_data_period_sql.c
+ * \brief           Returns SQLite SQL query to get the current year and
+ * period.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_standing_data_period_sql(void) {
+    static const char * query = 
+        "SELECT current_year, current_period, num_periods"
+        "  FROM standing_data";
+    return query;
+}
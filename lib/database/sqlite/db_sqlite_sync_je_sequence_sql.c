@@ -0,0 +1,18 @@
+/*!
+ * \file            db_sqlite_sync_je_sequence_sql.c
+ * \brief           Returns SQLite SQL query to move the JE ID sequence past
+ * the IDs in use.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_sync_je_sequence_sql(void) {
+    static const char * query = 
+        "UPDATE sequences"
+        "  SET next_id = MAX(next_id,"
+        "        (SELECT COALESCE(MAX(id), 0) + 1 FROM jes)),"
+        "      generation = generation + 1"
+        "  WHERE name = 'jes'";
+    return query;
+}
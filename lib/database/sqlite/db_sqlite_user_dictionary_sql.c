@@ -0,0 +1,12 @@
+/*!
+ * \file            db_sqlite_user_dictionary_sql.c
+ * \brief           Returns SQLite SQL query to get user IDs and user names.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+const char * db_user_dictionary_sql(void) {
+    static const char * query = "SELECT id, user_name FROM users";
+    return query;
+}
@@ -0,0 +1,13 @@
+local_dir := lib/database/sqlite
+local_lib := $(local_dir)/libdatabase_sqlite.a
+local_src := $(wildcard $(local_dir)/*.c)
+local_objs := $(subst .c,.o,$(local_src))
+
+libraries += $(local_lib)
+LDFLAGS   += -lsqlite3 -lpthread
+sources   += $(local_src)
+
+$(local_lib): $(local_objs)
+	@echo "Building SQLite database library..."
+	@$(AR) $(ARFLAGS) $@ $^
+
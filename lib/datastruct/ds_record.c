@@ -44,6 +44,30 @@ void ds_record_destructor(void * record) {
     ds_record_destroy(record);
 }
 
+ds_record ds_record_copy(ds_record record) {
+    assert(record);
+
+    const size_t size = ds_record_size(record);
+    ds_record new_record = ds_record_create(size);
+    if ( !new_record ) {
+        return NULL;
+    }
+
+    for ( size_t i = 0; i < size; ++i ) {
+        ds_str field = ds_record_get_field(record, i);
+        if ( field ) {
+            ds_str new_field = ds_str_dup(field);
+            if ( !new_field ) {
+                ds_record_destroy(new_record);
+                return NULL;
+            }
+            ds_record_set_field(new_record, i, new_field);
+        }
+    }
+
+    return new_record;
+}
+
 void ds_record_clear(ds_record record) {
     assert(record);
 
@@ -37,6 +37,13 @@ void ds_record_destroy(ds_record record);
  */
 void ds_record_destructor(void * record);
 
+/*!
+ * \brief           Creates a copy of a record and its fields.
+ * \param record    The record to copy.
+ * \returns         A pointer to the new record, or `NULL` on failure.
+ */
+ds_record ds_record_copy(ds_record record);
+
 /*!
  * \brief           Clears and `free()`s all the elements in a record.
  * \param record    The record.
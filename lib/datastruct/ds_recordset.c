@@ -148,6 +148,42 @@ void ds_recordset_destroy(ds_recordset set) {
     free(set);
 }
 
+ds_recordset ds_recordset_copy(ds_recordset set) {
+    assert(set);
+
+    ds_recordset new_set = ds_recordset_create(set->num_fields);
+    if ( !new_set ) {
+        return NULL;
+    }
+
+    for ( size_t i = 0; i < set->num_fields; ++i ) {
+        new_set->types[i] = set->types[i];
+    }
+
+    if ( set->headers ) {
+        ds_record headers = ds_record_copy(set->headers);
+        if ( !headers ) {
+            ds_recordset_destroy(new_set);
+            return NULL;
+        }
+        ds_recordset_set_headers(new_set, headers);
+    }
+
+    ds_record record;
+    ds_recordset_seek_start(set);
+    while ( (record = ds_recordset_next_record(set)) ) {
+        ds_record new_record = ds_record_copy(record);
+        if ( !new_record ) {
+            ds_recordset_destroy(new_set);
+            return NULL;
+        }
+        ds_recordset_add_record(new_set, new_record);
+    }
+    ds_recordset_seek_start(set);
+
+    return new_set;
+}
+
 ds_record ds_recordset_add_record(ds_recordset set,
                                    ds_record record) {
     assert(set && record);
@@ -180,6 +216,11 @@ void ds_recordset_set_headers(ds_recordset set,
     ds_recordset_update_field_lengths(set, headers);
 }
 
+ds_record ds_recordset_get_headers(ds_recordset set) {
+    assert(set);
+    return set->headers;
+}
+
 void ds_recordset_set_type(ds_recordset set,
                            const size_t index,
                            const enum ds_field_types type) {
@@ -246,6 +287,33 @@ ds_str ds_recordset_get_next_insert_query(ds_recordset set,
     return query_string;
 }
 
+ds_str ds_recordset_get_insert_prefix(ds_recordset set,
+                                      const char * table_name) {
+    static char basic_prefix[] = "INSERT INTO %s (%s) VALUES ";
+    assert(set && set->headers && table_name);
+
+    ds_str headers_line = ds_record_make_delim_string(set->headers, ',');
+    ds_str prefix = ds_str_create_sprintf(basic_prefix,
+            table_name,
+            ds_str_cstr(headers_line));
+    ds_str_destroy(headers_line);
+
+    return prefix;
+}
+
+ds_str ds_recordset_get_next_values_tuple(ds_recordset set) {
+    ds_record record = ds_recordset_next_record(set);
+    if ( !record ) {
+        return NULL;
+    }
+
+    ds_str record_line = ds_record_make_values_string(record, set->types);
+    ds_str tuple = ds_str_create_sprintf("(%s)", ds_str_cstr(record_line));
+    ds_str_destroy(record_line);
+
+    return tuple;
+}
+
 static ds_str ds_recordset_get_line_from_record(ds_recordset set,
                                                 ds_record record) {
     assert(set && record);
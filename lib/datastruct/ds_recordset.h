@@ -29,6 +29,14 @@ ds_recordset ds_recordset_create(const size_t num_fields);
  */
 void ds_recordset_destroy(ds_recordset set);
 
+/*!
+ * \brief           Creates a copy of a record set and its records.
+ * \details         The current record pointer of `set` is reset.
+ * \param set       The record set to copy.
+ * \returns         A pointer to the new record set, or `NULL` on failure.
+ */
+ds_recordset ds_recordset_copy(ds_recordset set);
+
 /*!
  * \brief           Adds a record to a record set.
  * \details         The record *must* have the same number of fields as
@@ -63,6 +71,13 @@ size_t ds_recordset_num_records(ds_recordset set);
  */
 void ds_recordset_set_headers(ds_recordset set, ds_record headers);
 
+/*!
+ * \brief           Returns the record headers in a record set.
+ * \param set       The record set.
+ * \returns         The headers, or `NULL` if none have been set.
+ */
+ds_record ds_recordset_get_headers(ds_recordset set);
+
 /*!
  * \brief           Sets the type for a specified field.
  * \param set       The record set.
@@ -89,6 +104,32 @@ ds_str ds_recordset_get_text_report(ds_recordset set);
  */
 ds_str ds_recordset_get_next_insert_query(ds_recordset set,
                                            const char * table_name);
+
+/*!
+ * \brief               Gets the leading part of a multi-row SQL INSERT query.
+ * \details             The returned string is of the form
+ * "INSERT INTO table (field, ...) VALUES ", and may be followed by one
+ * or more comma-separated values tuples obtained from
+ * `ds_recordset_get_next_values_tuple()`.
+ * \param set           The set.
+ * \param table_name    The table name into which to insert.
+ * \returns             The query prefix. Caller is responsible for
+ * `free()`ing.
+ */
+ds_str ds_recordset_get_insert_prefix(ds_recordset set,
+                                      const char * table_name);
+
+/*!
+ * \brief           Gets the SQL values tuple for the next record.
+ * \details         This function advances the current record pointer in
+ * the same way as `ds_recordset_next_record()`.
+ * \param set       The set.
+ * \returns         A string of the form "(value, ...)", or `NULL` if the
+ * end of the record set has been reached. Caller is responsible for
+ * `free()`ing.
+ */
+ds_str ds_recordset_get_next_values_tuple(ds_recordset set);
+
 /*!
  * \brief           Sets the current record to the first record.
  * \param set       The record set.
@@ -68,6 +68,12 @@ bool ds_report_add_header(ds_report report, ds_str name, ds_str value) {
 }
 
 void ds_report_print_text_report(ds_report report, FILE * outfile) {
+    ds_report_print_text_header(report, outfile);
+    fprintf(outfile, "%s", ds_str_cstr(report->report_text));
+    ds_report_print_text_footer(report, outfile);
+}
+
+void ds_report_print_text_header(ds_report report, FILE * outfile) {
     fprintf(outfile, "%s\n", ds_str_cstr(report->title));
     for ( size_t i = 0; i < ds_str_length(report->title); ++i ) {
         printf("=");
@@ -81,10 +87,9 @@ void ds_report_print_text_report(ds_report report, FILE * outfile) {
         fprintf(outfile, "%s: %s\n", ds_str_cstr(ds_kvpair_get_key(pair)),
                                      ds_str_cstr(ds_kvpair_get_value(pair)));
     }
+}
 
-
-    fprintf(outfile, "%s", ds_str_cstr(report->report_text));
-
+void ds_report_print_text_footer(ds_report report, FILE * outfile) {
     struct tm ct;
     struct tm * pct = gmtime_r(&report->created_time, &ct);
     if ( pct ) {
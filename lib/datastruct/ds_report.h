@@ -53,6 +53,23 @@ void ds_report_set_report_text(ds_report report, ds_str report_text);
  */
 void ds_report_print_text_report(ds_report report, FILE * outfile);
 
+/*!
+ * \brief           Prints the title and headers of a text report to a file.
+ * \details         Together with `ds_report_print_text_footer()`, this
+ * allows report text to be printed in pieces as it is produced, instead
+ * of being set on the report.
+ * \param report    The report.
+ * \param outfile   A pointer to the file to which to print.
+ */
+void ds_report_print_text_header(ds_report report, FILE * outfile);
+
+/*!
+ * \brief           Prints the creation time of a text report to a file.
+ * \param report    The report.
+ * \param outfile   A pointer to the file to which to print.
+ */
+void ds_report_print_text_footer(ds_report report, FILE * outfile);
+
 /*!
  * \brief           Adds a header to the report.
  * \param report    The report.
@@ -99,3 +99,15 @@ ds_recordset delim_file_read(const char * filename, const char delim) {
     return set;
 }
 
+ds_record delim_file_read_headers(const char * filename, const char delim) {
+    FILE * delim_file = fopen(filename, "r");
+    if ( !delim_file ) {
+        gl_log_msg("Couldn't open file '%s'.", filename);
+        return NULL;
+    }
+
+    ds_record headers = get_next_record(delim_file, delim);
+
+    fclose(delim_file);
+    return headers;
+}
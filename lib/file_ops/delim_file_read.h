@@ -19,5 +19,17 @@
  */
 ds_recordset delim_file_read(const char * filename, const char delim);
 
+/*!
+ * \brief           Reads only the field names from a delimited file.
+ * \details         The field names are the first record in the file. The
+ * rest of the file is not read, so this is suitable for files too large
+ * to construct a ds_recordset from.
+ * \param filename  The name of the delimited file.
+ * \param delim     The delimiting character.
+ * \returns         A record containing the field names, or `NULL` on
+ * failure.
+ */
+ds_record delim_file_read_headers(const char * filename, const char delim);
+
 #endif      /*  PG_GENERAL_LEDGER_FILE_OPS_DELIM_FILE_READ_H  */
 
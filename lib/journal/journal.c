@@ -0,0 +1,377 @@
+/*!
+ * \file            journal.c
+ * \brief           Implementation of the local posting journal.
+ * \details         Appending threads queue their records and wait. Whichever
+ * thread finds no sync underway becomes the leader: it waits for the batch
+ * window, takes up to a batch of records off the queue, writes them with a
+ * single `pwrite()` and `fdatasync()` without holding the lock, and then
+ * wakes every thread whose record is now durable. Records arriving during
+ * the sync queue up for the next leader.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+/*!  UNIX feature test macro  */
+#define _XOPEN_SOURCE 600
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "journal_internal.h"
+#include "gl_general/gl_general.h"
+
+/*!
+ * \brief           Waits until a record is durable, leading syncs as needed.
+ * \details         Must be called with the journal lock held.
+ * \param jnl       The journal.
+ * \param seq       The sequence number of the record.
+ * \returns         `true` if the record is durable, `false` if the journal
+ * failed first.
+ */
+static bool wait_durable(journal jnl, const uint64_t seq);
+
+/*!
+ * \brief           Syncs the next batch of queued records as leader.
+ * \details         Must be called with the journal lock held, which is
+ * released while the batch is written.
+ * \param jnl       The journal.
+ */
+static void sync_batch(journal jnl);
+
+/*!
+ * \brief           Writes a batch of records to the segment files.
+ * \param jnl       The journal.
+ * \param batch     The first record of the batch.
+ * \param syncs     Modified to contain the number of syncs performed.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool write_batch(journal jnl, struct journal_pending * batch,
+                        uint64_t * syncs);
+
+/*!
+ * \brief           Writes the batch buffer to the current segment and syncs.
+ * \param jnl       The journal.
+ * \param length    The number of bytes in the buffer.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool flush_write_buffer(journal jnl, const size_t length);
+
+/*!
+ * \brief           Frees a list of queued records.
+ * \param rec       The first record.
+ */
+static void free_pending(struct journal_pending * rec);
+
+journal journal_open(const char * dir, const size_t segment_size) {
+    if ( mkdir(dir, 0755) && errno != EEXIST ) {
+        gl_log_msg("Couldn't create journal directory '%s'.", dir);
+        return NULL;
+    }
+
+    struct journal * jnl = calloc(1, sizeof *jnl);
+    if ( !jnl || !(jnl->dir = strdup(dir)) ) {
+        gl_log_msg("Couldn't allocate memory for journal.");
+        free(jnl);
+        return NULL;
+    }
+
+    jnl->segment_size = segment_size ? segment_size :
+                                       JOURNAL_DEFAULT_SEGMENT_SIZE;
+    if ( jnl->segment_size < JOURNAL_MIN_SEGMENT_SIZE ) {
+        jnl->segment_size = JOURNAL_MIN_SEGMENT_SIZE;
+    }
+    jnl->max_batch = JOURNAL_DEFAULT_MAX_BATCH;
+    jnl->fd = -1;
+
+    pthread_mutex_init(&jnl->lock, NULL);
+    pthread_cond_init(&jnl->batch_ready, NULL);
+    pthread_cond_init(&jnl->synced, NULL);
+
+    if ( !journal_scan_segments(jnl) ) {
+        journal_close(jnl);
+        return NULL;
+    }
+
+    if ( jnl->stats.recovered ) {
+        gl_log_msg("Opened journal '%s' with %llu records.", dir,
+                   (unsigned long long) jnl->stats.recovered);
+    }
+
+    return jnl;
+}
+
+void journal_close(journal jnl) {
+    if ( !jnl ) {
+        return;
+    }
+
+    if ( jnl->fd != -1 ) {
+        close(jnl->fd);
+    }
+
+    free_pending(jnl->head);
+    pthread_cond_destroy(&jnl->synced);
+    pthread_cond_destroy(&jnl->batch_ready);
+    pthread_mutex_destroy(&jnl->lock);
+    free(jnl->write_buf);
+    free(jnl->segments);
+    free(jnl->dir);
+    free(jnl);
+}
+
+void journal_set_group_commit(journal jnl, const size_t max_batch,
+                              const long window_us) {
+    pthread_mutex_lock(&jnl->lock);
+    jnl->max_batch = max_batch ? max_batch : JOURNAL_DEFAULT_MAX_BATCH;
+    jnl->window_us = window_us > 0 ? window_us : 0;
+    pthread_mutex_unlock(&jnl->lock);
+}
+
+bool journal_append(journal jnl, const struct db_je * je, uint64_t * seq) {
+    return journal_append_batch(jnl, je, 1, seq);
+}
+
+bool journal_append_batch(journal jnl, const struct db_je * jes,
+                          const size_t num_jes, uint64_t * first_seq) {
+    struct journal_pending * first = NULL;
+    struct journal_pending * last = NULL;
+
+    for ( size_t i = 0; i < num_jes; ++i ) {
+        size_t length = journal_payload_size(&jes[i]);
+        size_t size = JOURNAL_HEADER_SIZE + length;
+        struct journal_pending * rec = NULL;
+
+        if ( size > jnl->segment_size ) {
+            gl_log_msg("Journal entry is too large for the journal.");
+        }
+        else if ( !(rec = malloc(sizeof *rec + size)) ) {
+            gl_log_msg("Couldn't allocate memory for journal record.");
+        }
+
+        if ( !rec ) {
+            free_pending(first);
+            return false;
+        }
+
+        journal_encode_payload(&jes[i], rec->data + JOURNAL_HEADER_SIZE);
+        rec->next = NULL;
+        rec->size = size;
+
+        if ( last ) {
+            last->next = rec;
+        }
+        else {
+            first = rec;
+        }
+        last = rec;
+    }
+
+    if ( !first ) {
+        return true;
+    }
+
+    pthread_mutex_lock(&jnl->lock);
+
+    if ( jnl->failed ) {
+        pthread_mutex_unlock(&jnl->lock);
+        free_pending(first);
+        return false;
+    }
+
+    /*  The checksum covers the sequence number, so headers can only be
+     *  written once the numbers are assigned.                        */
+
+    uint64_t seq = jnl->next_seq;
+    for ( struct journal_pending * rec = first; rec; rec = rec->next ) {
+        rec->seq = jnl->next_seq++;
+        journal_encode_header(rec->data, rec->seq,
+                              rec->size - JOURNAL_HEADER_SIZE);
+    }
+
+    if ( jnl->tail ) {
+        jnl->tail->next = first;
+    }
+    else {
+        jnl->head = first;
+    }
+    jnl->tail = last;
+
+    jnl->num_pending += num_jes;
+    if ( jnl->num_pending >= jnl->max_batch ) {
+        pthread_cond_signal(&jnl->batch_ready);
+    }
+
+    bool status = wait_durable(jnl, last->seq);
+
+    pthread_mutex_unlock(&jnl->lock);
+
+    if ( status && first_seq ) {
+        *first_seq = seq;
+    }
+
+    return status;
+}
+
+void journal_get_stats(journal jnl, struct journal_stats * stats) {
+    pthread_mutex_lock(&jnl->lock);
+    *stats = jnl->stats;
+    stats->last_seq = jnl->durable_seq;
+    pthread_mutex_unlock(&jnl->lock);
+}
+
+static bool wait_durable(journal jnl, const uint64_t seq) {
+    while ( jnl->durable_seq < seq && !jnl->failed ) {
+        if ( !jnl->syncing ) {
+            sync_batch(jnl);
+        }
+        else {
+            pthread_cond_wait(&jnl->synced, &jnl->lock);
+        }
+    }
+
+    return jnl->durable_seq >= seq;
+}
+
+static void sync_batch(journal jnl) {
+    jnl->syncing = true;
+
+    if ( jnl->window_us > 0 && jnl->num_pending < jnl->max_batch ) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += jnl->window_us / 1000000;
+        deadline.tv_nsec += (jnl->window_us % 1000000) * 1000;
+        if ( deadline.tv_nsec >= 1000000000 ) {
+            deadline.tv_nsec -= 1000000000;
+            ++deadline.tv_sec;
+        }
+
+        while ( jnl->num_pending < jnl->max_batch &&
+                pthread_cond_timedwait(&jnl->batch_ready, &jnl->lock,
+                                       &deadline) != ETIMEDOUT ) {
+            ;
+        }
+    }
+
+    struct journal_pending * batch = jnl->head;
+    struct journal_pending * last = NULL;
+    size_t count = 0;
+
+    while ( jnl->head && count < jnl->max_batch ) {
+        last = jnl->head;
+        jnl->head = jnl->head->next;
+        ++count;
+    }
+    if ( !jnl->head ) {
+        jnl->tail = NULL;
+    }
+    last->next = NULL;
+    jnl->num_pending -= count;
+
+    pthread_mutex_unlock(&jnl->lock);
+
+    uint64_t syncs = 0;
+    bool status = write_batch(jnl, batch, &syncs);
+    uint64_t last_seq = last->seq;
+    free_pending(batch);
+
+    pthread_mutex_lock(&jnl->lock);
+
+    if ( status ) {
+        jnl->durable_seq = last_seq;
+        jnl->segments[jnl->num_segments - 1].last_seq = last_seq;
+        jnl->stats.appended += count;
+    }
+    else {
+        gl_log_msg("Couldn't write to journal, no further postings "
+                   "will be accepted.");
+        jnl->failed = true;
+    }
+    jnl->stats.syncs += syncs;
+    jnl->syncing = false;
+
+    pthread_cond_broadcast(&jnl->synced);
+}
+
+static bool write_batch(journal jnl, struct journal_pending * batch,
+                        uint64_t * syncs) {
+    size_t used = 0;
+
+    for ( struct journal_pending * rec = batch; rec; rec = rec->next ) {
+        if ( jnl->write_pos + used + rec->size > jnl->segment_size ) {
+            if ( used ) {
+                if ( !flush_write_buffer(jnl, used) ) {
+                    return false;
+                }
+                ++*syncs;
+                used = 0;
+            }
+            if ( !journal_create_segment(jnl, rec->seq) ) {
+                return false;
+            }
+        }
+
+        if ( used + rec->size > jnl->write_buf_size ) {
+            size_t new_size = jnl->write_buf_size ?
+                              jnl->write_buf_size : 65536;
+            while ( new_size < used + rec->size ) {
+                new_size *= 2;
+            }
+            unsigned char * buf = realloc(jnl->write_buf, new_size);
+            if ( !buf ) {
+                gl_log_msg("Couldn't allocate memory for journal write.");
+                return false;
+            }
+            jnl->write_buf = buf;
+            jnl->write_buf_size = new_size;
+        }
+
+        memcpy(jnl->write_buf + used, rec->data, rec->size);
+        used += rec->size;
+    }
+
+    if ( used ) {
+        if ( !flush_write_buffer(jnl, used) ) {
+            return false;
+        }
+        ++*syncs;
+    }
+
+    return true;
+}
+
+static bool flush_write_buffer(journal jnl, const size_t length) {
+    size_t done = 0;
+    while ( done < length ) {
+        ssize_t n = pwrite(jnl->fd, jnl->write_buf + done, length - done,
+                           (off_t) (jnl->write_pos + done));
+        if ( n == -1 ) {
+            if ( errno == EINTR ) {
+                continue;
+            }
+            gl_log_msg("Couldn't write journal segment: %s.",
+                       strerror(errno));
+            return false;
+        }
+        done += (size_t) n;
+    }
+
+    if ( fdatasync(jnl->fd) ) {
+        gl_log_msg("Couldn't sync journal segment: %s.", strerror(errno));
+        return false;
+    }
+
+    jnl->write_pos += length;
+    return true;
+}
+
+static void free_pending(struct journal_pending * rec) {
+    while ( rec ) {
+        struct journal_pending * next = rec->next;
+        free(rec);
+        rec = next;
+    }
+}
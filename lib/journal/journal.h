@@ -0,0 +1,136 @@
+/*!
+ * \file            journal.h
+ * \brief           User interface to the local posting journal.
+ * \details         The posting journal is a write-ahead log of journal
+ * entries kept in local files. A posting is acknowledged as soon as it is
+ * durable in the journal, and is forwarded to the database later in large
+ * multi-row transactions. Concurrent postings share a single `fdatasync()`
+ * through group commit.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_JOURNAL_H
+#define PG_GENERAL_LEDGER_JOURNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "database/database.h"
+
+/*!  Opaque posting journal type  */
+typedef struct journal * journal;
+
+/*!  Posting journal statistics structure  */
+struct journal_stats {
+    uint64_t appended;          /*!<  Records appended since opening    */
+    uint64_t syncs;             /*!<  Batches synced since opening      */
+    uint64_t forwarded;         /*!<  Records forwarded since opening   */
+    uint64_t recovered;         /*!<  Records found when opening        */
+    uint64_t last_seq;          /*!<  Last durable sequence number      */
+};
+
+/*!
+ * \brief           Opens a posting journal.
+ * \details         The directory is created if it does not exist. Any
+ * existing segments are scanned, and a torn record left by a crash is
+ * discarded along with anything after it.
+ * \param dir       The journal directory.
+ * \param segment_size  The size of each preallocated segment file, or 0
+ * for the default.
+ * \returns         The journal, or `NULL` on failure.
+ */
+journal journal_open(const char * dir, const size_t segment_size);
+
+/*!
+ * \brief           Closes a posting journal.
+ * \param jnl       The journal.
+ */
+void journal_close(journal jnl);
+
+/*!
+ * \brief           Sets the group commit parameters.
+ * \details         A batch is synced when it holds `max_batch` records, or
+ * `window_us` microseconds after its first record arrived, whichever comes
+ * first. A window of 0 syncs whatever has arrived as soon as the previous
+ * sync completes.
+ * \param jnl       The journal.
+ * \param max_batch The maximum number of records in one sync, or 0 for
+ * the default.
+ * \param window_us The batch window in microseconds.
+ */
+void journal_set_group_commit(journal jnl, const size_t max_batch,
+                              const long window_us);
+
+/*!
+ * \brief           Appends a journal entry to the journal.
+ * \details         This function is thread-safe, and returns only once the
+ * entry is durable.
+ * \param jnl       The journal.
+ * \param je        The journal entry.
+ * \param seq       If not `NULL`, modified to contain the entry's sequence
+ * number.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool journal_append(journal jnl, const struct db_je * je, uint64_t * seq);
+
+/*!
+ * \brief           Appends several journal entries to the journal.
+ * \details         The entries get consecutive sequence numbers, and are
+ * synced in as few batches as the group commit settings allow. This
+ * function is thread-safe, and returns only once all the entries are
+ * durable.
+ * \param jnl       The journal.
+ * \param jes       The journal entries.
+ * \param num_jes   The number of entries.
+ * \param first_seq If not `NULL`, modified to contain the sequence number
+ * of the first entry.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool journal_append_batch(journal jnl, const struct db_je * jes,
+                          const size_t num_jes, uint64_t * first_seq);
+
+/*!
+ * \brief           Forwards durable entries from the journal to the database.
+ * \details         Entries after the database checkpoint for the journal
+ * are inserted in transactions of up to `batch_size` entries, each of
+ * which also advances the checkpoint, so an entry is never forwarded
+ * twice. Segments which have been entirely forwarded are deleted.
+ * `journal_recover()` must have been called first.
+ * \param jnl       The journal.
+ * \param name      The journal name used for the database checkpoint.
+ * \param batch_size    The maximum number of entries per transaction, or
+ * 0 for the default.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool journal_forward(journal jnl, const char * name,
+                     const size_t batch_size);
+
+/*!
+ * \brief           Aligns the journal with the database and replays it.
+ * \details         This should be called on startup, before any entries
+ * are appended. The journal is first checked against the epoch of the
+ * database, which is recorded in the journal directory while the journal
+ * is empty, and is refused if it belongs to another database, such as
+ * one since recreated. If the database checkpoint is ahead of the
+ * journal, for instance because the journal directory was lost, new
+ * sequence numbers start after the checkpoint. Any entries not yet
+ * forwarded are then forwarded.
+ * \param jnl       The journal.
+ * \param name      The journal name used for the database checkpoint.
+ * \param batch_size    The maximum number of entries per transaction, or
+ * 0 for the default.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool journal_recover(journal jnl, const char * name,
+                     const size_t batch_size);
+
+/*!
+ * \brief           Gets journal statistics.
+ * \param jnl       The journal.
+ * \param stats     Modified to contain the statistics.
+ */
+void journal_get_stats(journal jnl, struct journal_stats * stats);
+
+#endif      /*  PG_GENERAL_LEDGER_JOURNAL_H  */
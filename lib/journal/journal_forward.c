@@ -0,0 +1,325 @@
+/*!
+ * \file            journal_forward.c
+ * \brief           Implementation of posting journal forwarding.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+/*!  UNIX feature test macro  */
+#define _XOPEN_SOURCE 600
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "journal_internal.h"
+#include "gl_general/gl_general.h"
+
+/*!  Forwarding state structure  */
+struct forward_state {
+    const char * name;          /*!<  Journal name for the checkpoint   */
+    struct db_je * jes;         /*!<  Entries in the current batch      */
+    size_t count;               /*!<  Number of entries in the batch    */
+    size_t batch_size;          /*!<  Maximum entries in a batch        */
+    uint64_t checkpoint;        /*!<  Last sequence number committed    */
+    uint64_t last_seq;          /*!<  Last sequence number in the batch */
+    uint64_t forwarded;         /*!<  Entries forwarded                 */
+    bool status;                /*!<  `false` after any failure         */
+};
+
+/*!
+ * \brief           Record callback which adds a record to the batch.
+ * \param seq       The record sequence number.
+ * \param payload   The record payload.
+ * \param length    The payload length.
+ * \param ctx       A pointer to the forwarding state.
+ * \returns         `true` to continue, `false` on failure.
+ */
+static bool forward_record_cb(const uint64_t seq,
+                              const unsigned char * payload,
+                              const size_t length, void * ctx);
+
+/*!
+ * \brief           Inserts the current batch and advances the checkpoint.
+ * \details         Both happen in one transaction, so each entry is
+ * inserted exactly once even if forwarding is interrupted.
+ * \param state     The forwarding state.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool forward_batch(struct forward_state * state);
+
+/*!
+ * \brief           Checks that the journal belongs to the database.
+ * \details         A journal which does not yet record a database is
+ * bound to this one if it holds no records. A journal bound to another
+ * database, or holding records but bound to none, is refused, since its
+ * checkpoint in this database says nothing about which of its entries
+ * were already forwarded.
+ * \param jnl       The journal.
+ * \param name      The journal name.
+ * \returns         `true` if the journal may be forwarded to the database,
+ * `false` otherwise.
+ */
+static bool bind_database(journal jnl, const char * name);
+
+/*!
+ * \brief           Deletes segments whose records have all been forwarded.
+ * \details         The current segment is never deleted.
+ * \param jnl       The journal.
+ * \param checkpoint    The last sequence number forwarded.
+ */
+static void trim_segments(journal jnl, const uint64_t checkpoint);
+
+bool journal_forward(journal jnl, const char * name,
+                     const size_t batch_size) {
+    struct forward_state state = {
+        name, NULL, 0,
+        batch_size ? batch_size : JOURNAL_DEFAULT_FORWARD_BATCH,
+        0, 0, 0, true
+    };
+
+    if ( !jnl->bound ) {
+        gl_log_msg("Journal '%s' has not been recovered against the "
+                   "database.", name);
+        return false;
+    }
+
+    if ( !db_get_journal_checkpoint(name, &state.checkpoint) ) {
+        gl_log_msg("Couldn't get checkpoint for journal '%s'.", name);
+        return false;
+    }
+
+    state.jes = malloc(state.batch_size * sizeof *state.jes);
+    if ( !state.jes ) {
+        gl_log_msg("Couldn't allocate memory for journal forwarding.");
+        return false;
+    }
+
+    /*  Only records durable when forwarding starts are read, and the
+     *  segment list is copied, as appends may continue meanwhile.    */
+
+    pthread_mutex_lock(&jnl->lock);
+    uint64_t durable_seq = jnl->durable_seq;
+    size_t num_segments = jnl->num_segments;
+    struct journal_segment * segments =
+        malloc(num_segments * sizeof *segments);
+    if ( segments ) {
+        for ( size_t i = 0; i < num_segments; ++i ) {
+            segments[i] = jnl->segments[i];
+        }
+    }
+    pthread_mutex_unlock(&jnl->lock);
+
+    if ( !segments ) {
+        gl_log_msg("Couldn't allocate memory for journal forwarding.");
+        free(state.jes);
+        return false;
+    }
+
+    for ( size_t i = 0; state.status && i < num_segments; ++i ) {
+        uint64_t last_seq = segments[i].last_seq;
+        if ( i + 1 == num_segments || last_seq > durable_seq ) {
+            last_seq = durable_seq;
+        }
+
+        if ( last_seq > state.checkpoint &&
+             last_seq >= segments[i].first_seq ) {
+            state.status = journal_read_segment(jnl, segments[i].first_seq,
+                                                last_seq, forward_record_cb,
+                                                &state) &&
+                           state.status;
+        }
+    }
+
+    if ( state.status && state.count ) {
+        state.status = forward_batch(&state);
+    }
+
+    for ( size_t i = 0; i < state.count; ++i ) {
+        free(state.jes[i].lines);
+    }
+    free(state.jes);
+    free(segments);
+
+    pthread_mutex_lock(&jnl->lock);
+    jnl->stats.forwarded += state.forwarded;
+    pthread_mutex_unlock(&jnl->lock);
+
+    if ( state.forwarded ) {
+        gl_log_msg("Forwarded %llu journal entries to the database.",
+                   (unsigned long long) state.forwarded);
+    }
+
+    trim_segments(jnl, state.checkpoint);
+
+    return state.status;
+}
+
+bool journal_recover(journal jnl, const char * name,
+                     const size_t batch_size) {
+    if ( !bind_database(jnl, name) ) {
+        return false;
+    }
+
+    uint64_t checkpoint;
+    if ( !db_get_journal_checkpoint(name, &checkpoint) ) {
+        gl_log_msg("Couldn't get checkpoint for journal '%s'.", name);
+        return false;
+    }
+
+    pthread_mutex_lock(&jnl->lock);
+    bool behind = checkpoint >= jnl->next_seq;
+    if ( behind ) {
+        jnl->next_seq = checkpoint + 1;
+        jnl->durable_seq = checkpoint;
+    }
+    pthread_mutex_unlock(&jnl->lock);
+
+    if ( behind ) {
+        gl_log_msg("Journal '%s' is behind the database, continuing from "
+                   "sequence number %llu.", name,
+                   (unsigned long long) (checkpoint + 1));
+        if ( !journal_create_segment(jnl, checkpoint + 1) ) {
+            return false;
+        }
+    }
+
+    return journal_forward(jnl, name, batch_size);
+}
+
+static bool forward_record_cb(const uint64_t seq,
+                              const unsigned char * payload,
+                              const size_t length, void * ctx) {
+    struct forward_state * state = ctx;
+
+    if ( seq <= state->checkpoint ) {
+        return true;
+    }
+
+    if ( !journal_decode_payload(payload, length,
+                                 &state->jes[state->count]) ) {
+        gl_log_msg("Malformed journal record %llu.",
+                   (unsigned long long) seq);
+        state->status = false;
+        return false;
+    }
+    ++state->count;
+    state->last_seq = seq;
+
+    if ( state->count == state->batch_size ) {
+        state->status = forward_batch(state);
+        for ( size_t i = 0; i < state->count; ++i ) {
+            free(state->jes[i].lines);
+        }
+        state->count = 0;
+    }
+
+    return state->status;
+}
+
+static bool forward_batch(struct forward_state * state) {
+    if ( !db_reserve_je_ids(state->count) || !db_begin_transaction() ) {
+        return false;
+    }
+
+    bool status = db_insert_journal_entries(state->jes, state->count, NULL) &&
+                  db_set_journal_checkpoint(state->name, state->last_seq);
+
+    if ( status ) {
+        status = db_commit_transaction();
+    }
+    else {
+        db_rollback_transaction();
+    }
+
+    if ( status ) {
+        state->checkpoint = state->last_seq;
+        state->forwarded += state->count;
+    }
+    else {
+        gl_log_msg("Couldn't forward journal entries to the database.");
+    }
+
+    return status;
+}
+
+static bool bind_database(journal jnl, const char * name) {
+    ds_str epoch = db_get_ledger_epoch();
+    if ( !epoch ) {
+        gl_log_msg("Couldn't get the database epoch for journal '%s'.",
+                   name);
+        return false;
+    }
+
+    char * bound_epoch = NULL;
+    bool status = journal_read_database(jnl, &bound_epoch);
+
+    if ( status && bound_epoch ) {
+        status = !strcmp(bound_epoch, ds_str_cstr(epoch));
+        if ( !status ) {
+            gl_log_msg("Journal '%s' in '%s' belongs to the database "
+                       "created at %s, not this one, created at %s. Move "
+                       "the journal directory aside to post to this "
+                       "database.", name, jnl->dir, bound_epoch,
+                       ds_str_cstr(epoch));
+        }
+    }
+    else if ( status ) {
+        pthread_mutex_lock(&jnl->lock);
+        const bool empty = !jnl->num_segments ||
+                           jnl->durable_seq < jnl->segments[0].first_seq;
+        pthread_mutex_unlock(&jnl->lock);
+
+        status = empty;
+        if ( empty ) {
+            status = journal_write_database(jnl, ds_str_cstr(epoch));
+        }
+        else {
+            gl_log_msg("Journal '%s' in '%s' holds records but does not "
+                       "record which database they belong to. Move the "
+                       "journal directory aside to post to this database.",
+                       name, jnl->dir);
+        }
+    }
+
+    free(bound_epoch);
+    ds_str_destroy(epoch);
+
+    jnl->bound = status;
+    return status;
+}
+
+static void trim_segments(journal jnl, const uint64_t checkpoint) {
+    pthread_mutex_lock(&jnl->lock);
+
+    size_t num_trimmed = 0;
+    while ( num_trimmed + 1 < jnl->num_segments &&
+            jnl->segments[num_trimmed].last_seq <= checkpoint ) {
+        ++num_trimmed;
+    }
+
+    uint64_t * trimmed = num_trimmed ?
+                         malloc(num_trimmed * sizeof *trimmed) : NULL;
+    if ( !trimmed ) {
+        num_trimmed = 0;
+    }
+
+    for ( size_t i = 0; i < num_trimmed; ++i ) {
+        trimmed[i] = jnl->segments[i].first_seq;
+    }
+    for ( size_t i = num_trimmed; i < jnl->num_segments; ++i ) {
+        jnl->segments[i - num_trimmed] = jnl->segments[i];
+    }
+    jnl->num_segments -= num_trimmed;
+
+    pthread_mutex_unlock(&jnl->lock);
+
+    for ( size_t i = 0; i < num_trimmed; ++i ) {
+        char * path = journal_segment_path(jnl, trimmed[i]);
+        if ( path ) {
+            unlink(path);
+            free(path);
+        }
+    }
+    free(trimmed);
+}
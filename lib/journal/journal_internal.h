@@ -0,0 +1,226 @@
+/*!
+ * \file            journal_internal.h
+ * \brief           Internal interface to the local posting journal.
+ * \details         The journal is a sequence of segment files, each named
+ * after the sequence number of its first record and preallocated to a
+ * fixed size. A record is a 24 byte header, holding a magic number, the
+ * payload length, the sequence number and a CRC-32 of the sequence number
+ * and payload, followed by the payload. All integers are stored little
+ * endian. The unused tail of a segment is zero filled. The directory also
+ * holds a `database` file with the epoch of the database the journal
+ * forwards to, so that a journal is never replayed into a database
+ * recreated after its entries were forwarded.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_JOURNAL_INTERNAL_H
+#define PG_GENERAL_LEDGER_JOURNAL_INTERNAL_H
+
+#include <pthread.h>
+#include "journal.h"
+
+/*!  Record header magic number, "GLJ1"  */
+#define JOURNAL_MAGIC 0x314A4C47UL
+
+/*!  Size of a record header  */
+#define JOURNAL_HEADER_SIZE 24
+
+/*!  Default segment file size  */
+#define JOURNAL_DEFAULT_SEGMENT_SIZE (16 * 1024 * 1024)
+
+/*!  Smallest allowed segment file size  */
+#define JOURNAL_MIN_SEGMENT_SIZE (64 * 1024)
+
+/*!  Default maximum number of records per sync  */
+#define JOURNAL_DEFAULT_MAX_BATCH 256
+
+/*!  Default maximum number of entries per forwarding transaction  */
+#define JOURNAL_DEFAULT_FORWARD_BATCH 1000
+
+/*!  Record waiting to be synced  */
+struct journal_pending {
+    struct journal_pending * next;  /*!<  Next record in the queue      */
+    uint64_t seq;                   /*!<  Sequence number               */
+    size_t size;                    /*!<  Size of header and payload    */
+    unsigned char data[];           /*!<  Header and payload            */
+};
+
+/*!  Journal segment file  */
+struct journal_segment {
+    uint64_t first_seq;             /*!<  First sequence number         */
+    uint64_t last_seq;              /*!<  Last durable sequence number,
+                                          or 0 if none                  */
+};
+
+/*!  Posting journal structure  */
+struct journal {
+    char * dir;                     /*!<  Journal directory             */
+    size_t segment_size;            /*!<  Segment file size             */
+    size_t max_batch;               /*!<  Maximum records per sync      */
+    long window_us;                 /*!<  Batch window in microseconds  */
+
+    pthread_mutex_t lock;           /*!<  Protects everything below     */
+    pthread_cond_t batch_ready;     /*!<  Signalled when a batch fills  */
+    pthread_cond_t synced;          /*!<  Signalled after each sync     */
+
+    struct journal_pending * head;  /*!<  First record awaiting sync    */
+    struct journal_pending * tail;  /*!<  Last record awaiting sync     */
+    size_t num_pending;             /*!<  Records awaiting sync         */
+    uint64_t next_seq;              /*!<  Next sequence number          */
+    uint64_t durable_seq;           /*!<  Last durable sequence number  */
+    bool syncing;                   /*!<  `true` if a sync is underway  */
+    bool failed;                    /*!<  `true` after a write error    */
+    bool bound;                     /*!<  `true` once the journal is
+                                          checked against the database  */
+
+    struct journal_segment * segments;  /*!<  Segments, oldest first   */
+    size_t num_segments;            /*!<  Number of segments            */
+    size_t segments_capacity;       /*!<  Capacity of segment array     */
+    int fd;                         /*!<  Descriptor of last segment    */
+    size_t write_pos;               /*!<  Write offset in last segment  */
+    unsigned char * write_buf;      /*!<  Buffer for batch writes       */
+    size_t write_buf_size;          /*!<  Size of batch write buffer    */
+
+    struct journal_stats stats;     /*!<  Statistics                    */
+};
+
+/*!
+ * \brief           Record callback for `journal_read_segment()`.
+ * \param seq       The record sequence number.
+ * \param payload   The record payload.
+ * \param length    The payload length.
+ * \param ctx       The context pointer passed to `journal_read_segment()`.
+ * \returns         `true` to continue reading, `false` to stop.
+ */
+typedef bool (*journal_record_cb)(const uint64_t seq,
+                                  const unsigned char * payload,
+                                  const size_t length, void * ctx);
+
+/*!
+ * \brief           Updates a CRC-32 checksum.
+ * \param crc       The checksum so far, or 0 to start a new checksum.
+ * \param data      The data.
+ * \param length    The length of the data.
+ * \returns         The updated checksum.
+ */
+uint32_t journal_crc32(uint32_t crc, const void * data, const size_t length);
+
+/*!
+ * \brief           Returns the payload size needed to encode a journal entry.
+ * \param je        The journal entry.
+ * \returns         The payload size.
+ */
+size_t journal_payload_size(const struct db_je * je);
+
+/*!
+ * \brief           Encodes a journal entry as a record payload.
+ * \param je        The journal entry.
+ * \param payload   The buffer, of at least `journal_payload_size()` bytes.
+ */
+void journal_encode_payload(const struct db_je * je, unsigned char * payload);
+
+/*!
+ * \brief           Decodes a record payload into a journal entry.
+ * \param payload   The payload.
+ * \param length    The payload length.
+ * \param je        Modified to contain the journal entry. The lines should
+ * be freed with `free()`.
+ * \returns         `true` on success, `false` if the payload is malformed.
+ */
+bool journal_decode_payload(const unsigned char * payload,
+                            const size_t length, struct db_je * je);
+
+/*!
+ * \brief           Writes a record header.
+ * \details         The payload must already follow the header in the
+ * buffer, as it is included in the checksum.
+ * \param record    The record buffer.
+ * \param seq       The sequence number.
+ * \param length    The payload length.
+ */
+void journal_encode_header(unsigned char * record, const uint64_t seq,
+                           const size_t length);
+
+/*!
+ * \brief           Checks a record header and payload.
+ * \param record    The record buffer.
+ * \param available The number of bytes available in the buffer.
+ * \param seq       Modified to contain the sequence number.
+ * \param length    Modified to contain the payload length.
+ * \returns         `true` if the record is complete and its checksum
+ * matches, `false` otherwise.
+ */
+bool journal_check_record(const unsigned char * record,
+                          const size_t available,
+                          uint64_t * seq, size_t * length);
+
+/*!
+ * \brief           Makes the path of a segment file.
+ * \param jnl       The journal.
+ * \param first_seq The first sequence number in the segment.
+ * \returns         The path, which should be freed with `free()`, or
+ * `NULL` on failure.
+ */
+char * journal_segment_path(journal jnl, const uint64_t first_seq);
+
+/*!
+ * \brief           Scans the journal directory for existing segments.
+ * \details         On return the last segment is open for writing at the
+ * end of its last valid record, and the sequence numbers are set.
+ * \param jnl       The journal.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool journal_scan_segments(journal jnl);
+
+/*!
+ * \brief           Creates a new preallocated segment and makes it current.
+ * \param jnl       The journal.
+ * \param first_seq The sequence number of the first record it will hold.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool journal_create_segment(journal jnl, const uint64_t first_seq);
+
+/*!
+ * \brief           Reads the valid records in a segment file.
+ * \param jnl       The journal.
+ * \param first_seq The first sequence number of the segment.
+ * \param last_seq  Records after this sequence number are not read.
+ * \param callback  The function to call for each record.
+ * \param ctx       A context pointer to pass to the callback.
+ * \returns         `true` on success, `false` if the file could not be
+ * read.
+ */
+bool journal_read_segment(journal jnl, const uint64_t first_seq,
+                          const uint64_t last_seq,
+                          journal_record_cb callback, void * ctx);
+
+/*!
+ * \brief           Reads the epoch of the database the journal belongs to.
+ * \param jnl       The journal.
+ * \param epoch     Modified to contain the epoch, which should be freed
+ * with `free()`, or `NULL` if the journal does not record one.
+ * \returns         `true` on success, `false` if the file exists but could
+ * not be read.
+ */
+bool journal_read_database(journal jnl, char ** epoch);
+
+/*!
+ * \brief           Records the epoch of the database the journal belongs to.
+ * \details         The file is written under a temporary name, synced and
+ * renamed into place.
+ * \param jnl       The journal.
+ * \param epoch     The epoch.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool journal_write_database(journal jnl, const char * epoch);
+
+/*!
+ * \brief           Syncs a directory, so that file creations are durable.
+ * \param dir       The directory.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool journal_sync_dir(const char * dir);
+
+#endif      /*  PG_GENERAL_LEDGER_JOURNAL_INTERNAL_H  */
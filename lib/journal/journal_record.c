@@ -0,0 +1,261 @@
+/*!
+ * \file            journal_record.c
+ * \brief           Implementation of posting journal record encoding.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "journal_internal.h"
+
+/*!  CRC-32 lookup table  */
+static uint32_t crc_table[256];
+
+/*!  Once control for building the CRC-32 lookup table  */
+static pthread_once_t crc_table_once = PTHREAD_ONCE_INIT;
+
+/*!  Size of the fixed part of a payload  */
+#define PAYLOAD_FIXED_SIZE 22
+
+/*!  Size of the fixed part of an encoded line  */
+#define LINE_FIXED_SIZE 9
+
+/*!
+ * \brief           Builds the CRC-32 lookup table.
+ */
+static void make_crc_table(void);
+
+/*!
+ * \brief           Stores a 32 bit integer little endian.
+ * \param buffer    The buffer.
+ * \param value     The value.
+ * \returns         A pointer to the byte after the value.
+ */
+static unsigned char * put_u32(unsigned char * buffer, const uint32_t value);
+
+/*!
+ * \brief           Stores a 64 bit integer little endian.
+ * \param buffer    The buffer.
+ * \param value     The value.
+ * \returns         A pointer to the byte after the value.
+ */
+static unsigned char * put_u64(unsigned char * buffer, const uint64_t value);
+
+/*!
+ * \brief           Stores a short string with a one byte length prefix.
+ * \param buffer    The buffer.
+ * \param str       The string, of no more than 255 characters.
+ * \returns         A pointer to the byte after the string.
+ */
+static unsigned char * put_str(unsigned char * buffer, const char * str);
+
+/*!
+ * \brief           Loads a little endian 32 bit integer.
+ * \param buffer    The buffer.
+ * \returns         The value.
+ */
+static uint32_t get_u32(const unsigned char * buffer);
+
+/*!
+ * \brief           Loads a little endian 64 bit integer.
+ * \param buffer    The buffer.
+ * \returns         The value.
+ */
+static uint64_t get_u64(const unsigned char * buffer);
+
+/*!
+ * \brief           Loads a string stored by `put_str()`.
+ * \param pos       Pointer to the current position, advanced past the
+ * string on success.
+ * \param end       The end of the buffer.
+ * \param dst       The destination buffer.
+ * \param dst_size  The size of the destination buffer.
+ * \returns         `true` on success, `false` if the string overruns the
+ * buffer or does not fit in the destination.
+ */
+static bool get_str(const unsigned char ** pos, const unsigned char * end,
+                    char * dst, const size_t dst_size);
+
+uint32_t journal_crc32(uint32_t crc, const void * data, const size_t length) {
+    pthread_once(&crc_table_once, make_crc_table);
+
+    const unsigned char * p = data;
+    crc = ~crc;
+    for ( size_t i = 0; i < length; ++i ) {
+        crc = crc_table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+size_t journal_payload_size(const struct db_je * je) {
+    size_t size = PAYLOAD_FIXED_SIZE + strlen(je->source) + strlen(je->memo);
+    for ( size_t i = 0; i < je->num_lines; ++i ) {
+        size += LINE_FIXED_SIZE + strlen(je->lines[i].account);
+    }
+    return size;
+}
+
+void journal_encode_payload(const struct db_je * je,
+                            unsigned char * payload) {
+    unsigned char * p = payload;
+    p = put_u32(p, (uint32_t) je->user);
+    p = put_u32(p, (uint32_t) je->period);
+    p = put_u32(p, (uint32_t) je->year);
+    p = put_u32(p, (uint32_t) je->entity);
+    p = put_u32(p, (uint32_t) je->num_lines);
+    p = put_str(p, je->source);
+    p = put_str(p, je->memo);
+
+    for ( size_t i = 0; i < je->num_lines; ++i ) {
+        p = put_str(p, je->lines[i].account);
+        p = put_u64(p, (uint64_t) je->lines[i].amount);
+    }
+}
+
+bool journal_decode_payload(const unsigned char * payload,
+                            const size_t length, struct db_je * je) {
+    if ( length < PAYLOAD_FIXED_SIZE ) {
+        return false;
+    }
+
+    const unsigned char * end = payload + length;
+    je->user = (int) get_u32(payload);
+    je->period = (int) get_u32(payload + 4);
+    je->year = (int) get_u32(payload + 8);
+    je->entity = (int) get_u32(payload + 12);
+    je->num_lines = get_u32(payload + 16);
+    je->lines = NULL;
+
+    const unsigned char * p = payload + 20;
+    if ( !get_str(&p, end, je->source, sizeof je->source) ||
+         !get_str(&p, end, je->memo, sizeof je->memo) ||
+         je->num_lines > (size_t) (end - p) / LINE_FIXED_SIZE ) {
+        return false;
+    }
+
+    je->lines = malloc((je->num_lines ? je->num_lines : 1) *
+                       sizeof *je->lines);
+    if ( !je->lines ) {
+        return false;
+    }
+
+    for ( size_t i = 0; i < je->num_lines; ++i ) {
+        struct db_je_line * line = &je->lines[i];
+        if ( !get_str(&p, end, line->account, sizeof line->account) ||
+             end - p < 8 ) {
+            free(je->lines);
+            je->lines = NULL;
+            return false;
+        }
+        line->amount = (int64_t) get_u64(p);
+        p += 8;
+    }
+
+    return p == end;
+}
+
+void journal_encode_header(unsigned char * record, const uint64_t seq,
+                           const size_t length) {
+    unsigned char * p = record;
+    p = put_u32(p, JOURNAL_MAGIC);
+    p = put_u32(p, (uint32_t) length);
+    p = put_u64(p, seq);
+
+    uint32_t crc = journal_crc32(0, record + 8, 8);
+    crc = journal_crc32(crc, record + JOURNAL_HEADER_SIZE, length);
+    p = put_u32(p, crc);
+    put_u32(p, 0);
+}
+
+bool journal_check_record(const unsigned char * record,
+                          const size_t available,
+                          uint64_t * seq, size_t * length) {
+    if ( available < JOURNAL_HEADER_SIZE ||
+         get_u32(record) != JOURNAL_MAGIC ) {
+        return false;
+    }
+
+    size_t len = get_u32(record + 4);
+    if ( len > available - JOURNAL_HEADER_SIZE ) {
+        return false;
+    }
+
+    uint32_t crc = journal_crc32(0, record + 8, 8);
+    crc = journal_crc32(crc, record + JOURNAL_HEADER_SIZE, len);
+    if ( crc != get_u32(record + 16) ) {
+        return false;
+    }
+
+    *seq = get_u64(record + 8);
+    *length = len;
+    return true;
+}
+
+static void make_crc_table(void) {
+    for ( uint32_t i = 0; i < 256; ++i ) {
+        uint32_t c = i;
+        for ( int k = 0; k < 8; ++k ) {
+            c = (c & 1) ? 0xEDB88320UL ^ (c >> 1) : c >> 1;
+        }
+        crc_table[i] = c;
+    }
+}
+
+static unsigned char * put_u32(unsigned char * buffer,
+                               const uint32_t value) {
+    for ( int i = 0; i < 4; ++i ) {
+        buffer[i] = (unsigned char) (value >> (8 * i));
+    }
+    return buffer + 4;
+}
+
+static unsigned char * put_u64(unsigned char * buffer,
+                               const uint64_t value) {
+    for ( int i = 0; i < 8; ++i ) {
+        buffer[i] = (unsigned char) (value >> (8 * i));
+    }
+    return buffer + 8;
+}
+
+static unsigned char * put_str(unsigned char * buffer, const char * str) {
+    size_t length = strlen(str);
+    *buffer++ = (unsigned char) length;
+    memcpy(buffer, str, length);
+    return buffer + length;
+}
+
+static uint32_t get_u32(const unsigned char * buffer) {
+    uint32_t value = 0;
+    for ( int i = 3; i >= 0; --i ) {
+        value = (value << 8) | buffer[i];
+    }
+    return value;
+}
+
+static uint64_t get_u64(const unsigned char * buffer) {
+    uint64_t value = 0;
+    for ( int i = 7; i >= 0; --i ) {
+        value = (value << 8) | buffer[i];
+    }
+    return value;
+}
+
+static bool get_str(const unsigned char ** pos, const unsigned char * end,
+                    char * dst, const size_t dst_size) {
+    const unsigned char * p = *pos;
+    if ( p >= end ) {
+        return false;
+    }
+
+    size_t length = *p++;
+    if ( length >= dst_size || length > (size_t) (end - p) ) {
+        return false;
+    }
+
+    memcpy(dst, p, length);
+    dst[length] = '\0';
+    *pos = p + length;
+    return true;
+}
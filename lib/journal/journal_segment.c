@@ -0,0 +1,443 @@
+/*!
+ * \file            journal_segment.c
+ * \brief           Implementation of posting journal segment files.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+/*!  UNIX feature test macro  */
+#define _XOPEN_SOURCE 600
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "journal_internal.h"
+#include "gl_general/gl_general.h"
+
+/*!  Length of a segment file name  */
+#define SEGMENT_NAME_LEN 20
+
+/*!  Name of the file holding the database epoch  */
+#define DATABASE_FILE_NAME "database"
+
+/*!  Largest database epoch accepted from the file  */
+#define MAX_EPOCH_LEN 256
+
+/*!
+ * \brief           Reads an entire file into memory.
+ * \param fd        The file descriptor.
+ * \param size      Modified to contain the file size.
+ * \returns         The contents, which should be freed with `free()`, or
+ * `NULL` on failure.
+ */
+static unsigned char * read_file(const int fd, size_t * size);
+
+/*!
+ * \brief           Makes the path of a file in the journal directory.
+ * \param jnl       The journal.
+ * \param name      The file name.
+ * \returns         The path, which should be freed with `free()`, or
+ * `NULL` on failure.
+ */
+static char * file_path(journal jnl, const char * name);
+
+/*!
+ * \brief           Adds a segment to the end of the journal's list.
+ * \param jnl       The journal.
+ * \param first_seq The first sequence number of the segment.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool add_segment(journal jnl, const uint64_t first_seq);
+
+/*!
+ * \brief           Compares two segments by first sequence number.
+ * \param a         The first segment.
+ * \param b         The second segment.
+ * \returns         Less than, equal to or greater than zero, as for
+ * `qsort()`.
+ */
+static int compare_segments(const void * a, const void * b);
+
+/*!
+ * \brief           Opens the last segment and finds the end of its records.
+ * \details         Anything after the last valid record, such as a record
+ * torn by a crash, is overwritten with zeros so it cannot reappear later.
+ * \param jnl       The journal.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool open_last_segment(journal jnl);
+
+char * journal_segment_path(journal jnl, const uint64_t first_seq) {
+    size_t size = strlen(jnl->dir) + SEGMENT_NAME_LEN + 2;
+    char * path = malloc(size);
+    if ( path ) {
+        snprintf(path, size, "%s/%016" PRIx64 ".seg", jnl->dir, first_seq);
+    }
+    return path;
+}
+
+bool journal_scan_segments(journal jnl) {
+    DIR * dir = opendir(jnl->dir);
+    if ( !dir ) {
+        gl_log_msg("Couldn't open journal directory '%s'.", jnl->dir);
+        return false;
+    }
+
+    bool status = true;
+    struct dirent * entry;
+    while ( status && (entry = readdir(dir)) ) {
+        const char * name = entry->d_name;
+        char * end;
+
+        if ( strlen(name) == SEGMENT_NAME_LEN &&
+             !strcmp(name + SEGMENT_NAME_LEN - 4, ".seg") ) {
+            uint64_t first_seq = strtoull(name, &end, 16);
+            if ( end == name + SEGMENT_NAME_LEN - 4 && first_seq > 0 ) {
+                status = add_segment(jnl, first_seq);
+            }
+        }
+    }
+    closedir(dir);
+
+    if ( !status ) {
+        return false;
+    }
+
+    if ( jnl->num_segments == 0 ) {
+        jnl->next_seq = 1;
+        jnl->durable_seq = 0;
+        return journal_create_segment(jnl, 1);
+    }
+
+    qsort(jnl->segments, jnl->num_segments, sizeof *jnl->segments,
+          compare_segments);
+
+    /*  Every segment but the last is full, so its records are only
+     *  checked when they are read for forwarding.                  */
+
+    for ( size_t i = 0; i + 1 < jnl->num_segments; ++i ) {
+        jnl->segments[i].last_seq = jnl->segments[i + 1].first_seq - 1;
+    }
+
+    return open_last_segment(jnl);
+}
+
+bool journal_create_segment(journal jnl, const uint64_t first_seq) {
+    char * path = journal_segment_path(jnl, first_seq);
+    if ( !path ) {
+        gl_log_msg("Couldn't allocate memory for journal segment.");
+        return false;
+    }
+
+    int fd = open(path, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if ( fd == -1 ) {
+        gl_log_msg("Couldn't create journal segment '%s': %s.",
+                   path, strerror(errno));
+        free(path);
+        return false;
+    }
+
+    /*  Preallocating the segment means each sync only has to write the
+     *  data, not update the file size and block map as well.        */
+
+    int err = posix_fallocate(fd, 0, (off_t) jnl->segment_size);
+    if ( err ) {
+        err = ftruncate(fd, (off_t) jnl->segment_size) ? errno : 0;
+    }
+
+    if ( err || fdatasync(fd) || !journal_sync_dir(jnl->dir) ) {
+        gl_log_msg("Couldn't allocate journal segment '%s'.", path);
+        close(fd);
+        unlink(path);
+        free(path);
+        return false;
+    }
+    free(path);
+
+    pthread_mutex_lock(&jnl->lock);
+    if ( jnl->num_segments ) {
+        jnl->segments[jnl->num_segments - 1].last_seq = first_seq - 1;
+    }
+    bool status = add_segment(jnl, first_seq);
+    pthread_mutex_unlock(&jnl->lock);
+
+    if ( !status ) {
+        close(fd);
+        return false;
+    }
+
+    if ( jnl->fd != -1 ) {
+        close(jnl->fd);
+    }
+    jnl->fd = fd;
+    jnl->write_pos = 0;
+
+    return true;
+}
+
+bool journal_read_segment(journal jnl, const uint64_t first_seq,
+                          const uint64_t last_seq,
+                          journal_record_cb callback, void * ctx) {
+    char * path = journal_segment_path(jnl, first_seq);
+    int fd = path ? open(path, O_RDONLY) : -1;
+    if ( fd == -1 ) {
+        gl_log_msg("Couldn't open journal segment '%s'.",
+                   path ? path : "");
+        free(path);
+        return false;
+    }
+
+    size_t size;
+    unsigned char * data = read_file(fd, &size);
+    close(fd);
+
+    if ( !data ) {
+        gl_log_msg("Couldn't read journal segment '%s'.", path);
+        free(path);
+        return false;
+    }
+    free(path);
+
+    size_t pos = 0;
+    uint64_t expected = first_seq;
+    uint64_t seq;
+    size_t length;
+
+    while ( expected <= last_seq &&
+            journal_check_record(data + pos, size - pos, &seq, &length) &&
+            seq == expected ) {
+        if ( !callback(seq, data + pos + JOURNAL_HEADER_SIZE,
+                       length, ctx) ) {
+            break;
+        }
+        pos += JOURNAL_HEADER_SIZE + length;
+        ++expected;
+    }
+
+    free(data);
+    return true;
+}
+
+bool journal_read_database(journal jnl, char ** epoch) {
+    *epoch = NULL;
+
+    char * path = file_path(jnl, DATABASE_FILE_NAME);
+    if ( !path ) {
+        gl_log_msg("Couldn't allocate memory for journal path.");
+        return false;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if ( fd == -1 ) {
+        bool missing = errno == ENOENT;
+        if ( !missing ) {
+            gl_log_msg("Couldn't open '%s': %s.", path, strerror(errno));
+        }
+        free(path);
+        return missing;
+    }
+
+    size_t size;
+    unsigned char * data = read_file(fd, &size);
+    close(fd);
+
+    if ( data && size && size <= MAX_EPOCH_LEN &&
+         !memchr(data, '\0', size) && (*epoch = malloc(size + 1)) ) {
+        memcpy(*epoch, data, size);
+        (*epoch)[size] = '\0';
+    }
+    else {
+        gl_log_msg("Couldn't read '%s'.", path);
+    }
+
+    free(data);
+    free(path);
+    return *epoch != NULL;
+}
+
+bool journal_write_database(journal jnl, const char * epoch) {
+    char * path = file_path(jnl, DATABASE_FILE_NAME);
+    char * temp_path = file_path(jnl, DATABASE_FILE_NAME ".tmp");
+    if ( !path || !temp_path ) {
+        gl_log_msg("Couldn't allocate memory for journal path.");
+        free(path);
+        free(temp_path);
+        return false;
+    }
+
+    const size_t length = strlen(epoch);
+    int fd = open(temp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool status = fd != -1 &&
+                  write(fd, epoch, length) == (ssize_t) length &&
+                  fdatasync(fd) == 0;
+    if ( fd != -1 ) {
+        status = close(fd) == 0 && status;
+    }
+
+    status = status && rename(temp_path, path) == 0 &&
+             journal_sync_dir(jnl->dir);
+    if ( !status ) {
+        gl_log_msg("Couldn't write '%s': %s.", path, strerror(errno));
+        unlink(temp_path);
+    }
+
+    free(path);
+    free(temp_path);
+    return status;
+}
+
+bool journal_sync_dir(const char * dir) {
+    int fd = open(dir, O_RDONLY);
+    if ( fd == -1 ) {
+        return false;
+    }
+
+    bool status = fsync(fd) == 0 || errno == EINVAL;
+    close(fd);
+    return status;
+}
+
+static unsigned char * read_file(const int fd, size_t * size) {
+    struct stat st;
+    if ( fstat(fd, &st) ) {
+        return NULL;
+    }
+
+    *size = (size_t) st.st_size;
+    unsigned char * data = malloc(*size ? *size : 1);
+    if ( !data ) {
+        return NULL;
+    }
+
+    size_t done = 0;
+    while ( done < *size ) {
+        ssize_t n = pread(fd, data + done, *size - done, (off_t) done);
+        if ( n <= 0 ) {
+            if ( n == -1 && errno == EINTR ) {
+                continue;
+            }
+            free(data);
+            return NULL;
+        }
+        done += (size_t) n;
+    }
+
+    return data;
+}
+
+static char * file_path(journal jnl, const char * name) {
+    size_t size = strlen(jnl->dir) + strlen(name) + 2;
+    char * path = malloc(size);
+    if ( path ) {
+        snprintf(path, size, "%s/%s", jnl->dir, name);
+    }
+    return path;
+}
+
+static bool add_segment(journal jnl, const uint64_t first_seq) {
+    if ( jnl->num_segments == jnl->segments_capacity ) {
+        size_t capacity = jnl->segments_capacity ?
+                          jnl->segments_capacity * 2 : 16;
+        struct journal_segment * segments =
+            realloc(jnl->segments, capacity * sizeof *segments);
+        if ( !segments ) {
+            gl_log_msg("Couldn't allocate memory for journal segments.");
+            return false;
+        }
+        jnl->segments = segments;
+        jnl->segments_capacity = capacity;
+    }
+
+    jnl->segments[jnl->num_segments].first_seq = first_seq;
+    jnl->segments[jnl->num_segments].last_seq = 0;
+    ++jnl->num_segments;
+    return true;
+}
+
+static int compare_segments(const void * a, const void * b) {
+    const struct journal_segment * sa = a;
+    const struct journal_segment * sb = b;
+    return (sa->first_seq > sb->first_seq) - (sa->first_seq < sb->first_seq);
+}
+
+static bool open_last_segment(journal jnl) {
+    struct journal_segment * last = &jnl->segments[jnl->num_segments - 1];
+    char * path = journal_segment_path(jnl, last->first_seq);
+    int fd = path ? open(path, O_RDWR) : -1;
+    if ( fd == -1 ) {
+        gl_log_msg("Couldn't open journal segment '%s'.",
+                   path ? path : "");
+        free(path);
+        return false;
+    }
+
+    size_t size;
+    unsigned char * data = read_file(fd, &size);
+    if ( !data ) {
+        gl_log_msg("Couldn't read journal segment '%s'.", path);
+        close(fd);
+        free(path);
+        return false;
+    }
+
+    size_t pos = 0;
+    uint64_t expected = last->first_seq;
+    uint64_t seq;
+    size_t length;
+
+    while ( journal_check_record(data + pos, size - pos, &seq, &length) &&
+            seq == expected ) {
+        pos += JOURNAL_HEADER_SIZE + length;
+        ++expected;
+    }
+
+    /*  A batch is written with a single write, so a crash can leave later
+     *  records of the batch intact after a torn one. They were never
+     *  acknowledged, and must not be found by a later scan.          */
+
+    size_t dirty = size;
+    while ( dirty > pos && data[dirty - 1] == 0 ) {
+        --dirty;
+    }
+
+    bool status = true;
+    if ( dirty > pos ) {
+        gl_log_msg("Discarding %zu bytes of incomplete records from "
+                   "journal segment '%s'.", dirty - pos, path);
+        memset(data + pos, 0, dirty - pos);
+        status = pwrite(fd, data + pos, dirty - pos, (off_t) pos) ==
+                     (ssize_t) (dirty - pos) &&
+                 fdatasync(fd) == 0;
+        if ( !status ) {
+            gl_log_msg("Couldn't clear journal segment '%s'.", path);
+        }
+    }
+
+    free(data);
+    free(path);
+
+    if ( !status ) {
+        close(fd);
+        return false;
+    }
+
+    if ( jnl->num_segments > 1 ) {
+        jnl->stats.recovered = last->first_seq - jnl->segments[0].first_seq;
+    }
+    jnl->stats.recovered += expected - last->first_seq;
+
+    last->last_seq = expected > last->first_seq ? expected - 1 : 0;
+    jnl->next_seq = expected;
+    jnl->durable_seq = expected - 1;
+    jnl->fd = fd;
+    jnl->write_pos = pos;
+
+    return true;
+}
@@ -0,0 +1,13 @@
+local_dir := lib/journal
+local_lib := $(local_dir)/libjournal.a
+local_src := $(wildcard $(local_dir)/*.c)
+local_objs := $(subst .c,.o,$(local_src))
+
+libraries += $(local_lib)
+LDFLAGS   += -lpthread
+sources   += $(local_src)
+
+$(local_lib): $(local_objs)
+	@echo "Building posting journal library..."
+	@$(AR) $(ARFLAGS) $@ $^
+
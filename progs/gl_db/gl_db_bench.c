@@ -0,0 +1,528 @@
+/*!
+ * \file            gl_db_bench.c
+ * \brief           Implementation of GL DB posting benchmarks.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+/*!  UNIX feature test macro  */
+#define _XOPEN_SOURCE 600
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include "gl_db_bench.h"
+#include "journal/journal.h"
+#include "database/database.h"
+#include "gl_general/gl_general.h"
+
+/*!  Time each batch size or posting mode is run for, in seconds  */
+#define BENCH_SECONDS 2
+
+/*!  Number of entries per transaction in the batch posting mode  */
+#define BENCH_BATCH_SIZE 1000
+
+/*!  Number of entities in the sample data, which postings are spread over  */
+#define BENCH_ENTITIES 4
+
+/*!  Posting thread state structure  */
+struct bench_thread {
+    pthread_t thread;           /*!<  The thread                        */
+    journal jnl;                /*!<  The journal to post to            */
+    const struct timespec * end;    /*!<  Time to stop posting          */
+    unsigned long posted;       /*!<  Entries posted                    */
+    bool status;                /*!<  `false` if a posting failed       */
+};
+
+/*!
+ * \brief           Posting thread function.
+ * \param arg       A pointer to the thread state.
+ * \returns         `NULL`.
+ */
+static void * bench_thread_func(void * arg);
+
+/*!  Database posting thread state structure  */
+struct posting_thread {
+    pthread_t thread;           /*!<  The thread                        */
+    db_postsvc svc;             /*!<  The service to post through, or
+                                      `NULL` to post directly           */
+    int entity;                 /*!<  The entity to post to             */
+    int year;                   /*!<  The year to post to               */
+    int period;                 /*!<  The period to post to             */
+    const struct timespec * end;    /*!<  Time to stop posting          */
+    unsigned long posted;       /*!<  Entries posted                    */
+    double * latencies;         /*!<  Latency of each posting call, in
+                                      microseconds                      */
+    size_t num_latencies;       /*!<  Number of latencies recorded      */
+    size_t capacity;            /*!<  Number of latencies allocated     */
+    bool status;                /*!<  `false` if a posting failed       */
+};
+
+/*!
+ * \brief           Database posting thread function.
+ * \details         Each entry is posted in a transaction of its own, on
+ * a connection checked out for the posting, or through a posting service.
+ * \param arg       A pointer to the thread state.
+ * \returns         `NULL`.
+ */
+static void * posting_thread_func(void * arg);
+
+/*!
+ * \brief           Runs database posting threads for a fixed time and
+ * prints the results.
+ * \param mode      The name of the posting mode.
+ * \param threads   The thread states.
+ * \param num_threads   The number of threads.
+ * \param svc       The service to post through, or `NULL` to post
+ * directly.
+ * \param year      The year to post to.
+ * \param period    The period to post to.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool run_posting_threads(const char * mode,
+                                struct posting_thread * threads,
+                                const size_t num_threads, db_postsvc svc,
+                                const int year, const int period);
+
+/*!
+ * \brief           Fills in a three-line benchmark journal entry.
+ * \param je        The entry.
+ * \param lines     The three lines for the entry.
+ * \param entity    The entity to post to.
+ * \param year      The year to post to.
+ * \param period    The period to post to.
+ */
+static void fill_bench_je(struct db_je * je, struct db_je_line * lines,
+                          const int entity, const int year,
+                          const int period);
+
+/*!
+ * \brief           Records the latency of a posting call.
+ * \param state     The thread state.
+ * \param start     The time the call was made.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool record_latency(struct posting_thread * state,
+                           const struct timespec * start);
+
+/*!
+ * \brief           Prints a line of posting benchmark results.
+ * \param mode      The name of the posting mode.
+ * \param posted    The number of entries posted.
+ * \param transactions  The number of transactions committed.
+ * \param elapsed   The time taken, in seconds.
+ * \param latencies The latency of each posting call, which are sorted.
+ * \param count     The number of latencies.
+ */
+static void print_posting_result(const char * mode,
+                                 const unsigned long posted,
+                                 const unsigned long long transactions,
+                                 const double elapsed, double * latencies,
+                                 const size_t count);
+
+/*!
+ * \brief           Compares two doubles for `qsort()`.
+ * \param a         A pointer to the first double.
+ * \param b         A pointer to the second double.
+ * \returns         Less than, equal to or greater than zero if the first
+ * is less than, equal to or greater than the second.
+ */
+static int compare_doubles(const void * a, const void * b);
+
+/*!
+ * \brief           Returns the number of seconds since a given time.
+ * \param start     The time.
+ * \returns         The number of seconds elapsed.
+ */
+static double seconds_since(const struct timespec * start);
+
+/*!
+ * \brief           Removes a benchmark journal directory and its segments.
+ * \param dir       The directory.
+ */
+static void remove_bench_dir(const char * dir);
+
+bool run_journal_benchmark(const char * dir, const size_t segment_size,
+                           const long window_us, const size_t num_threads) {
+    static const size_t batch_sizes[] = {1, 4, 16, 64, 256, 0};
+
+    size_t len = strlen(dir) + 7;
+    char * bench_dir = malloc(len);
+    struct bench_thread * threads = calloc(num_threads, sizeof *threads);
+    if ( !bench_dir || !threads ) {
+        gl_log_msg("Couldn't allocate memory for benchmark.");
+        free(bench_dir);
+        free(threads);
+        return false;
+    }
+
+    /*  The journal only creates the last component of its path.  */
+
+    if ( mkdir(dir, 0755) && errno != EEXIST ) {
+        gl_log_msg("Couldn't create journal directory '%s'.", dir);
+        free(bench_dir);
+        free(threads);
+        return false;
+    }
+    snprintf(bench_dir, len, "%s/bench", dir);
+
+    printf("Posting journal benchmark, %zu threads, %ld us window\n",
+           num_threads, window_us);
+    printf("%10s %12s %10s %14s %12s\n",
+           "batch", "postings", "syncs", "postings/sec", "per sync");
+
+    bool status = true;
+    for ( size_t b = 0; status && batch_sizes[b]; ++b ) {
+        remove_bench_dir(bench_dir);
+        journal jnl = journal_open(bench_dir, segment_size);
+        if ( !jnl ) {
+            status = false;
+            break;
+        }
+        journal_set_group_commit(jnl, batch_sizes[b], window_us);
+
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        end = start;
+        end.tv_sec += BENCH_SECONDS;
+
+        size_t started = 0;
+        for ( ; started < num_threads; ++started ) {
+            threads[started].jnl = jnl;
+            threads[started].end = &end;
+            threads[started].posted = 0;
+            threads[started].status = true;
+            if ( pthread_create(&threads[started].thread, NULL,
+                                bench_thread_func, &threads[started]) ) {
+                gl_log_msg("Couldn't create benchmark thread.");
+                status = false;
+                break;
+            }
+        }
+
+        unsigned long posted = 0;
+        for ( size_t t = 0; t < started; ++t ) {
+            pthread_join(threads[t].thread, NULL);
+            posted += threads[t].posted;
+            status = status && threads[t].status;
+        }
+
+        double elapsed = seconds_since(&start);
+        struct journal_stats stats;
+        journal_get_stats(jnl, &stats);
+        journal_close(jnl);
+
+        printf("%10zu %12lu %10llu %14.0f %12.1f\n", batch_sizes[b],
+               posted, (unsigned long long) stats.syncs, posted / elapsed,
+               stats.syncs ? (double) posted / stats.syncs : 0.0);
+    }
+
+    remove_bench_dir(bench_dir);
+    free(bench_dir);
+    free(threads);
+
+    return status;
+}
+
+bool run_posting_benchmark(const size_t num_threads, const size_t num_shards,
+                           const long window_us) {
+    /*  Entries for closed periods are refused, so post to the current one.  */
+
+    int year, period;
+    if ( !db_get_current_period(&year, &period) ) {
+        return false;
+    }
+
+    struct db_je_line lines[3];
+    struct db_je * jes = calloc(BENCH_BATCH_SIZE, sizeof *jes);
+    struct posting_thread * threads = calloc(num_threads, sizeof *threads);
+    if ( !jes || !threads ) {
+        gl_log_msg("Couldn't allocate memory for benchmark.");
+        free(jes);
+        free(threads);
+        return false;
+    }
+
+    printf("Database posting benchmark, %zu threads, %zu shards, "
+           "%ld us window\n", num_threads, num_shards, window_us);
+    printf("%-10s %10s %13s %14s %10s %10s\n", "mode", "postings",
+           "transactions", "postings/sec", "p50 us", "p99 us");
+
+    /*  Batches of entries from one thread, on the connection checked
+     *  out by db_connect(). The latency is that of each batch.         */
+
+    for ( size_t i = 0; i < BENCH_BATCH_SIZE; ++i ) {
+        fill_bench_je(&jes[i], lines, (int) (i % BENCH_ENTITIES) + 1,
+                      year, period);
+    }
+
+    struct posting_thread batch = {0};
+    struct timespec start, end, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    end = start;
+    end.tv_sec += BENCH_SECONDS;
+
+    bool status = true;
+    do {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        status = db_post_journal_entries(jes, BENCH_BATCH_SIZE, NULL) &&
+                 record_latency(&batch, &now);
+        batch.posted += BENCH_BATCH_SIZE;
+    } while ( status && (now.tv_sec < end.tv_sec ||
+                         (now.tv_sec == end.tv_sec &&
+                          now.tv_nsec < end.tv_nsec)) );
+
+    if ( status ) {
+        print_posting_result("batch", batch.posted, batch.num_latencies,
+                             seconds_since(&start), batch.latencies,
+                             batch.num_latencies);
+    }
+    free(batch.latencies);
+    free(jes);
+
+    /*  The posting threads and shards need every pooled connection.  */
+
+    db_pool_checkin();
+
+    status = status && run_posting_threads("direct", threads, num_threads,
+                                           NULL, year, period);
+
+    db_postsvc svc = status ? db_postsvc_open(num_shards, 0, window_us)
+                            : NULL;
+    if ( svc ) {
+        status = run_posting_threads("service", threads, num_threads, svc,
+                                     year, period);
+        db_postsvc_close(svc);
+    }
+    else {
+        status = false;
+    }
+
+    status = db_pool_checkout() && status;
+    free(threads);
+
+    return status;
+}
+
+static bool run_posting_threads(const char * mode,
+                                struct posting_thread * threads,
+                                const size_t num_threads, db_postsvc svc,
+                                const int year, const int period) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    end = start;
+    end.tv_sec += BENCH_SECONDS;
+
+    bool status = true;
+    size_t started = 0;
+    for ( ; started < num_threads; ++started ) {
+        memset(&threads[started], 0, sizeof threads[started]);
+        threads[started].svc = svc;
+        threads[started].entity = (int) (started % BENCH_ENTITIES) + 1;
+        threads[started].year = year;
+        threads[started].period = period;
+        threads[started].end = &end;
+        threads[started].status = true;
+        if ( pthread_create(&threads[started].thread, NULL,
+                            posting_thread_func, &threads[started]) ) {
+            gl_log_msg("Couldn't create benchmark thread.");
+            status = false;
+            break;
+        }
+    }
+
+    unsigned long posted = 0;
+    size_t count = 0;
+    for ( size_t t = 0; t < started; ++t ) {
+        pthread_join(threads[t].thread, NULL);
+        posted += threads[t].posted;
+        count += threads[t].num_latencies;
+        status = status && threads[t].status;
+    }
+    double elapsed = seconds_since(&start);
+
+    double * latencies = malloc((count ? count : 1) * sizeof *latencies);
+    if ( !latencies ) {
+        gl_log_msg("Couldn't allocate memory for benchmark.");
+        status = false;
+    }
+
+    size_t n = 0;
+    for ( size_t t = 0; t < started; ++t ) {
+        if ( latencies ) {
+            memcpy(latencies + n, threads[t].latencies,
+                   threads[t].num_latencies * sizeof *latencies);
+            n += threads[t].num_latencies;
+        }
+        free(threads[t].latencies);
+    }
+
+    if ( status ) {
+        unsigned long long transactions = posted;
+        if ( svc ) {
+            struct db_postsvc_stats stats;
+            db_postsvc_get_stats(svc, &stats);
+            transactions = stats.transactions;
+        }
+        print_posting_result(mode, posted, transactions, elapsed,
+                             latencies, n);
+    }
+
+    free(latencies);
+    return status;
+}
+
+static void * posting_thread_func(void * arg) {
+    struct posting_thread * state = arg;
+    struct db_je_line lines[3];
+    struct db_je je;
+    fill_bench_je(&je, lines, state->entity, state->year, state->period);
+
+    struct timespec now;
+    do {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        bool posted;
+        if ( state->svc ) {
+            posted = db_postsvc_post(state->svc, &je, NULL);
+        }
+        else {
+            posted = db_pool_checkout() &&
+                     db_post_journal_entries(&je, 1, NULL);
+            db_pool_checkin();
+        }
+
+        if ( !posted || !record_latency(state, &now) ) {
+            state->status = false;
+            break;
+        }
+        ++state->posted;
+    } while ( now.tv_sec < state->end->tv_sec ||
+              (now.tv_sec == state->end->tv_sec &&
+               now.tv_nsec < state->end->tv_nsec) );
+
+    db_sequence_free();
+    return NULL;
+}
+
+static void fill_bench_je(struct db_je * je, struct db_je_line * lines,
+                          const int entity, const int year,
+                          const int period) {
+    static const struct db_je_line bench_lines[3] = {
+        {"60001000", 12345},
+        {"10003000", -10000},
+        {"20001000", -2345}
+    };
+    memcpy(lines, bench_lines, sizeof bench_lines);
+
+    memset(je, 0, sizeof *je);
+    je->user = 1;
+    je->period = period;
+    je->year = year;
+    strcpy(je->source, "MANUAL");
+    je->entity = entity;
+    strcpy(je->memo, "Benchmark posting");
+    je->num_lines = 3;
+    je->lines = lines;
+}
+
+static bool record_latency(struct posting_thread * state,
+                           const struct timespec * start) {
+    if ( state->num_latencies == state->capacity ) {
+        size_t capacity = state->capacity ? state->capacity * 2 : 1024;
+        double * latencies = realloc(state->latencies,
+                                     capacity * sizeof *latencies);
+        if ( !latencies ) {
+            gl_log_msg("Couldn't allocate memory for benchmark.");
+            return false;
+        }
+        state->latencies = latencies;
+        state->capacity = capacity;
+    }
+
+    state->latencies[state->num_latencies++] = seconds_since(start) * 1e6;
+    return true;
+}
+
+static void print_posting_result(const char * mode,
+                                 const unsigned long posted,
+                                 const unsigned long long transactions,
+                                 const double elapsed, double * latencies,
+                                 const size_t count) {
+    double p50 = 0.0, p99 = 0.0;
+    if ( count ) {
+        qsort(latencies, count, sizeof *latencies, compare_doubles);
+        p50 = latencies[(count - 1) / 2];
+        p99 = latencies[(count - 1) * 99 / 100];
+    }
+
+    printf("%-10s %10lu %13llu %14.0f %10.0f %10.0f\n", mode, posted,
+           transactions, posted / elapsed, p50, p99);
+}
+
+static int compare_doubles(const void * a, const void * b) {
+    const double x = *(const double *) a;
+    const double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+static void * bench_thread_func(void * arg) {
+    struct bench_thread * state = arg;
+    struct db_je_line lines[2] = {
+        {"76000000", 12345},
+        {"20001000", -12345}
+    };
+    struct db_je je = {1, 1, 2014, "MANUAL", 1, "Benchmark posting",
+                       2, lines};
+
+    struct timespec now;
+    do {
+        if ( !journal_append(state->jnl, &je, NULL) ) {
+            state->status = false;
+            break;
+        }
+        ++state->posted;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    } while ( now.tv_sec < state->end->tv_sec ||
+              (now.tv_sec == state->end->tv_sec &&
+               now.tv_nsec < state->end->tv_nsec) );
+
+    return NULL;
+}
+
+static double seconds_since(const struct timespec * start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) +
+           (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void remove_bench_dir(const char * dir) {
+    DIR * d = opendir(dir);
+    if ( !d ) {
+        return;
+    }
+
+    struct dirent * entry;
+    while ( (entry = readdir(d)) ) {
+        if ( strlen(entry->d_name) > 4 &&
+             !strcmp(entry->d_name + strlen(entry->d_name) - 4, ".seg") ) {
+            size_t len = strlen(dir) + strlen(entry->d_name) + 2;
+            char * path = malloc(len);
+            if ( path ) {
+                snprintf(path, len, "%s/%s", dir, entry->d_name);
+                unlink(path);
+                free(path);
+            }
+        }
+    }
+    closedir(d);
+    rmdir(dir);
+}
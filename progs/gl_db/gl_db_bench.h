@@ -0,0 +1,50 @@
+/*!
+ * \file            gl_db_bench.h
+ * \brief           Interface to GL DB posting benchmarks.
+ * \author          Paul Griffiths
+ * \copyright       Copyright 2014 Paul Griffiths. Distributed under the terms
+ * of the GNU General Public License. <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PG_GENERAL_LEDGER_GL_DB_BENCH_H
+#define PG_GENERAL_LEDGER_GL_DB_BENCH_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/*!
+ * \brief           Benchmarks posting to the journal at several batch sizes.
+ * \details         For each batch size a fresh journal is created in a
+ * `bench` subdirectory of the journal directory, and a number of threads
+ * post two-line journal entries to it for a fixed time. The postings per
+ * second and the number of syncs are printed, and the journal is removed.
+ * \param dir       The journal directory.
+ * \param segment_size  The journal segment size, or 0 for the default.
+ * \param window_us The group commit window in microseconds.
+ * \param num_threads   The number of posting threads.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool run_journal_benchmark(const char * dir, const size_t segment_size,
+                           const long window_us, const size_t num_threads);
+
+/*!
+ * \brief           Benchmarks posting three-line journal entries to the
+ * database.
+ * \details         The entries are really posted, so this should only be
+ * run on a test database loaded with the sample data. Each mode runs for
+ * a fixed time: one thread posting batches of 1,000 entries with
+ * `db_post_journal_entries()`, a number of threads each posting one entry
+ * per transaction, and the same threads posting one entry at a time
+ * through a posting service. The postings per second, the number of
+ * transactions, and the median and 99th percentile latency of each
+ * posting call are printed. The calling thread's connection is checked in
+ * while the posting threads run.
+ * \param num_threads   The number of posting threads.
+ * \param num_shards    The number of posting service shards.
+ * \param window_us The posting service batch window in microseconds.
+ * \returns         `true` on success, `false` on failure.
+ */
+bool run_posting_benchmark(const size_t num_threads, const size_t num_shards,
+                           const long window_us);
+
+#endif      /*  PG_GENERAL_LEDGER_GL_DB_BENCH_H  */
@@ -18,6 +18,15 @@
 #include "datastruct/data_structures.h"
 #include "gl_general/gl_general.h"
 
+/*!
+ * \brief           Sets a configuration value from a command line option.
+ * \param key       The configuration key.
+ * \param value     The value, or an empty string for an option with no
+ * argument.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool set_option(const char * key, const char * value);
+
 bool get_cmdline_options(int argc, char **argv, struct params *params) {
     enum opts {
         CMDLINE_HELP = 1,
@@ -26,6 +35,22 @@ bool get_cmdline_options(int argc, char **argv, struct params *params) {
         CMDLINE_CREATE,
         CMDLINE_DELETE,
         CMDLINE_SAMPLE,
+        CMDLINE_BULKLOAD,
+        CMDLINE_POST,
+        CMDLINE_FORWARD,
+        CMDLINE_CLOSE_PERIOD,
+        CMDLINE_CLOSE_YEAR,
+        CMDLINE_JOURNAL_BENCH,
+        CMDLINE_POSTING_BENCH,
+        CMDLINE_REBUILD_BALANCES,
+        CMDLINE_REBUILD_PERIOD_BALANCES,
+        CMDLINE_REBUILD_CLOSURE,
+        CMDLINE_REINDEX,
+        CMDLINE_DROPINDEXES,
+        CMDLINE_MIGRATE_JELINES,
+        CMDLINE_ADD_PARTITION,
+        CMDLINE_DROP_PARTITION,
+        CMDLINE_ARCHIVE_PARTITION,
     };
 
     /*  Temporarily disable warning  */
@@ -38,6 +63,24 @@ bool get_cmdline_options(int argc, char **argv, struct params *params) {
         {"create", no_argument, NULL, CMDLINE_CREATE},
         {"delete", no_argument, NULL, CMDLINE_DELETE},
         {"loadsample", no_argument, NULL, CMDLINE_SAMPLE},
+        {"bulkload", required_argument, NULL, CMDLINE_BULKLOAD},
+        {"post", required_argument, NULL, CMDLINE_POST},
+        {"forward", no_argument, NULL, CMDLINE_FORWARD},
+        {"close-period", no_argument, NULL, CMDLINE_CLOSE_PERIOD},
+        {"close-year", no_argument, NULL, CMDLINE_CLOSE_YEAR},
+        {"journal-bench", no_argument, NULL, CMDLINE_JOURNAL_BENCH},
+        {"posting-bench", no_argument, NULL, CMDLINE_POSTING_BENCH},
+        {"rebuild-balances", no_argument, NULL, CMDLINE_REBUILD_BALANCES},
+        {"rebuild-period-balances", no_argument, NULL,
+            CMDLINE_REBUILD_PERIOD_BALANCES},
+        {"rebuild-closure", no_argument, NULL, CMDLINE_REBUILD_CLOSURE},
+        {"reindex", no_argument, NULL, CMDLINE_REINDEX},
+        {"dropindexes", no_argument, NULL, CMDLINE_DROPINDEXES},
+        {"migrate-jelines", no_argument, NULL, CMDLINE_MIGRATE_JELINES},
+        {"add-partition", required_argument, NULL, CMDLINE_ADD_PARTITION},
+        {"drop-partition", required_argument, NULL, CMDLINE_DROP_PARTITION},
+        {"archive-partition", required_argument, NULL,
+            CMDLINE_ARCHIVE_PARTITION},
         {NULL, 0, NULL, 0}
     };
 
@@ -93,14 +136,150 @@ bool get_cmdline_options(int argc, char **argv, struct params *params) {
                 config_value_set(key, value);
                 break;
 
+            case CMDLINE_BULKLOAD:
+                if ( !set_option("login", "") ||
+                     !set_option("bulkload", optarg) ) {
+                    ret_val = false;
+                }
+                break;
+
+            case CMDLINE_POST:
+                if ( !set_option("login", "") ||
+                     !set_option("post", optarg) ) {
+                    ret_val = false;
+                }
+                break;
+
+            case CMDLINE_FORWARD:
+                if ( !set_option("login", "") ||
+                     !set_option("forward", "") ) {
+                    ret_val = false;
+                }
+                break;
+
+            case CMDLINE_CLOSE_PERIOD:
+                if ( !set_option("login", "") ||
+                     !set_option("close_period", "") ) {
+                    ret_val = false;
+                }
+                break;
+
+            case CMDLINE_CLOSE_YEAR:
+                if ( !set_option("login", "") ||
+                     !set_option("close_year", "") ) {
+                    ret_val = false;
+                }
+                break;
+
+            case CMDLINE_JOURNAL_BENCH:
+                if ( !set_option("journal_bench", "") ) {
+                    ret_val = false;
+                }
+                break;
+
+            case CMDLINE_POSTING_BENCH:
+                if ( !set_option("login", "") ||
+                     !set_option("posting_bench", "") ) {
+                    ret_val = false;
+                }
+                break;
+
+            case CMDLINE_REBUILD_BALANCES:
+                if ( !set_option("login", "") ||
+                     !set_option("rebuild_balances", "") ) {
+                    ret_val = false;
+                }
+                break;
+
+            case CMDLINE_REBUILD_PERIOD_BALANCES:
+                if ( !set_option("login", "") ||
+                     !set_option("rebuild_period_balances", "") ) {
+                    ret_val = false;
+                }
+                break;
+
+            case CMDLINE_REBUILD_CLOSURE:
+                if ( !set_option("login", "") ||
+                     !set_option("rebuild_closure", "") ) {
+                    ret_val = false;
+                }
+                break;
+
+            case CMDLINE_REINDEX:
+                if ( !set_option("login", "") ||
+                     !set_option("reindex", "") ) {
+                    ret_val = false;
+                }
+                break;
+
+            case CMDLINE_DROPINDEXES:
+                if ( !set_option("login", "") ||
+                     !set_option("dropindexes", "") ) {
+                    ret_val = false;
+                }
+                break;
+
+            case CMDLINE_MIGRATE_JELINES:
+                if ( !set_option("login", "") ||
+                     !set_option("migrate_jelines", "") ) {
+                    ret_val = false;
+                }
+                break;
+
+            case CMDLINE_ADD_PARTITION:
+                if ( !set_option("login", "") ||
+                     !set_option("add_partition", optarg) ) {
+                    ret_val = false;
+                }
+                break;
+
+            case CMDLINE_DROP_PARTITION:
+                if ( !set_option("login", "") ||
+                     !set_option("drop_partition", optarg) ) {
+                    ret_val = false;
+                }
+                break;
+
+            case CMDLINE_ARCHIVE_PARTITION:
+                if ( !set_option("login", "") ||
+                     !set_option("archive_partition", optarg) ) {
+                    ret_val = false;
+                }
+                break;
+
             default:
                 ret_val = false;
         }
     }
 
+    if ( ret_val && config_value_get_cstr("bulkload") ) {
+        if ( optind < argc ) {
+            ret_val = set_option("bulkload_file", argv[optind]);
+        }
+        else {
+            gl_log_msg("No file specified for bulk load.");
+            ret_val = false;
+        }
+    }
+
     ds_str_destroy(key);
     ds_str_destroy(value);
 
     return ret_val;
 }
 
+static bool set_option(const char * key, const char * value) {
+    ds_str k = ds_str_create(key);
+    ds_str v = ds_str_create(value);
+    bool status = k && v;
+    if ( status ) {
+        config_value_set(k, v);
+    }
+    if ( k ) {
+        ds_str_destroy(k);
+    }
+    if ( v ) {
+        ds_str_destroy(v);
+    }
+    return status;
+}
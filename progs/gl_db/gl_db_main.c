@@ -16,6 +16,8 @@
 #include "gl_db_config.h"
 #include "datastruct/data_structures.h"
 #include "file_ops/file_ops.h"
+#include "journal/journal.h"
+#include "gl_db_bench.h"
 
 /*!
  * \brief           Prints a program usage message.
@@ -35,6 +37,67 @@ void print_version_message(const char * progname);
  */
 void print_help_message(const char * progname);
 
+/*!
+ * \brief           Returns a positive integer configuration value.
+ * \param key       The configuration key.
+ * \returns         The value, or 0 if the key is not set or its value is
+ * not a positive integer.
+ */
+static size_t get_size_config_value(const char * key);
+
+/*!
+ * \brief           Returns a string configuration value.
+ * \param key       The configuration key.
+ * \param default_value The value to return if the key is not set.
+ * \returns         The value.
+ */
+static const char * get_cstr_config_value(const char * key,
+                                          const char * default_value);
+
+/*!
+ * \brief           Runs a partition maintenance command for a year.
+ * \param command   The command.
+ * \param year      The year, as given on the command line.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool run_partition_command(bool (*command)(const int),
+                                  ds_str year);
+
+/*!
+ * \brief           Opens the posting journal and replays it.
+ * \details         Any entries left in the journal which have not yet been
+ * forwarded to the database, for instance after a crash, are forwarded.
+ * \returns         The journal, or `NULL` on failure.
+ */
+static journal open_posting_journal(void);
+
+/*!
+ * \brief           Posts journal entries from a file through the journal.
+ * \details         The entries are acknowledged once they are durable in
+ * the journal, and are then forwarded to the database.
+ * \param filename  The file name.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool post_journal_file(const char * filename);
+
+/*!
+ * \brief           Forwards any unforwarded journal entries to the database.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool forward_posting_journal(void);
+
+/*!  Default posting journal directory  */
+static const char * default_journal_dir = "journal";
+
+/*!  Default posting journal name  */
+static const char * default_journal_name = "gl_db";
+
+/*!  Default number of benchmark posting threads  */
+static const size_t default_bench_threads = 64;
+
+/*!  Default number of database benchmark posting threads  */
+static const size_t default_posting_bench_threads = 16;
+
 /*!  Program name  */
 static const char * program = "gl_db";
 
@@ -49,6 +112,7 @@ int main(int argc, char ** argv) {
 
     struct params * params = params_init();
     bool status = get_cmdline_options(argc, argv, params);
+    ds_str value;
 
     if ( !status ) {
         print_usage_message(program);
@@ -59,11 +123,41 @@ int main(int argc, char ** argv) {
     else if ( config_value_get_cstr("version") ) {
         print_version_message(program);
     }
+    else if ( config_value_get_cstr("journal_bench") ) {
+        if ( !get_configuration(params, "conf_files/gl_db_conf.conf") ) {
+            gl_log_msg("Couldn't get parameters.");
+        }
+        else {
+            size_t threads = get_size_config_value("journal_bench_threads");
+            run_journal_benchmark(
+                    get_cstr_config_value("journal_dir",
+                                          default_journal_dir),
+                    get_size_config_value("journal_segment_size"),
+                    (long) get_size_config_value("journal_batch_window_us"),
+                    threads ? threads : default_bench_threads);
+        }
+    }
     else if ( config_value_get_cstr("login") ) {
         if ( !get_configuration(params, "conf_files/gl_db_conf.conf") ) {
             gl_log_msg("Couldn't get parameters.");
         }
         else {
+            db_set_load_batch_sizes(
+                    get_size_config_value("insert_batch_rows"),
+                    get_size_config_value("commit_batch_rows"));
+            db_set_pool_size(get_size_config_value("pool_size"));
+
+            value = config_value_get_cstr("jelines_layout");
+            if ( value && !ds_str_compare_cstr(value, "clustered") ) {
+                db_set_jelines_layout(DB_JELINES_CLUSTERED);
+            }
+            else if ( value && !ds_str_compare_cstr(value, "denormalized") ) {
+                db_set_jelines_layout(DB_JELINES_DENORMALIZED);
+            }
+            else if ( value && !ds_str_compare_cstr(value, "partitioned") ) {
+                db_set_jelines_layout(DB_JELINES_PARTITIONED);
+            }
+
             params->password = login();
             if ( params->password ) {
                 db_connect(ds_str_cstr(params->hostname),
@@ -85,10 +179,69 @@ int main(int argc, char ** argv) {
                 else if ( config_value_get_cstr("loadsample") ) {
                     db_load_sample_data();
                 }
+                else if ( (value = config_value_get_cstr("bulkload")) ) {
+                    ds_str file = config_value_get_cstr("bulkload_file");
+                    db_bulk_load(ds_str_cstr(value), ds_str_cstr(file));
+                }
+                else if ( config_value_get_cstr("rebuild_balances") ) {
+                    db_rebuild_account_balances();
+                }
+                else if ( config_value_get_cstr("rebuild_period_balances") ) {
+                    db_rebuild_period_balances();
+                }
+                else if ( config_value_get_cstr("rebuild_closure") ) {
+                    db_rebuild_entity_closure();
+                }
+                else if ( config_value_get_cstr("reindex") ) {
+                    db_reindex();
+                }
+                else if ( config_value_get_cstr("dropindexes") ) {
+                    db_drop_indexes();
+                }
+                else if ( config_value_get_cstr("migrate_jelines") ) {
+                    db_migrate_jelines_table();
+                }
+                else if ( (value = config_value_get_cstr("add_partition")) ) {
+                    run_partition_command(db_add_partition, value);
+                }
+                else if ( (value = config_value_get_cstr("drop_partition")) ) {
+                    run_partition_command(db_drop_partition, value);
+                }
+                else if ( (value =
+                            config_value_get_cstr("archive_partition")) ) {
+                    run_partition_command(db_archive_partition, value);
+                }
+                else if ( (value = config_value_get_cstr("post")) ) {
+                    post_journal_file(ds_str_cstr(value));
+                }
+                else if ( config_value_get_cstr("forward") ) {
+                    forward_posting_journal();
+                }
+                else if ( config_value_get_cstr("posting_bench") ) {
+                    size_t threads =
+                        get_size_config_value("posting_bench_threads");
+                    size_t shards =
+                        get_size_config_value("posting_service_shards");
+                    run_posting_benchmark(
+                        threads ? threads : default_posting_bench_threads,
+                        shards ? shards : db_pool_size(),
+                        (long) get_size_config_value(
+                            "posting_service_window_us"));
+                }
+                else if ( config_value_get_cstr("close_period") ) {
+                    db_close_period();
+                }
+                else if ( config_value_get_cstr("close_year") ) {
+                    size_t user = get_size_config_value("closing_user");
+                    db_close_year(user ? (int) user : 1);
+                }
                 else {
                     gl_log_msg("No supported option provided.");
                 }
 
+                db_closure_free();
+                db_sequence_free();
+                db_dimcache_free();
                 db_close();
             }
             else {
@@ -107,6 +260,100 @@ int main(int argc, char ** argv) {
     return EXIT_SUCCESS;
 }
 
+static size_t get_size_config_value(const char * key) {
+    ds_str value = config_value_get_cstr(key);
+    int ivalue;
+
+    if ( value && ds_str_intval(value, 10, &ivalue) && ivalue > 0 ) {
+        return (size_t) ivalue;
+    }
+
+    return 0;
+}
+
+static const char * get_cstr_config_value(const char * key,
+                                          const char * default_value) {
+    ds_str value = config_value_get_cstr(key);
+    return value && !ds_str_is_empty(value) ? ds_str_cstr(value) :
+                                              default_value;
+}
+
+static bool run_partition_command(bool (*command)(const int),
+                                  ds_str year) {
+    int iyear;
+    if ( !ds_str_intval(year, 10, &iyear) || iyear <= 0 ) {
+        gl_log_msg("Invalid partition year '%s'.", ds_str_cstr(year));
+        return false;
+    }
+    return command(iyear);
+}
+
+static journal open_posting_journal(void) {
+    journal jnl = journal_open(get_cstr_config_value("journal_dir",
+                                                     default_journal_dir),
+                               get_size_config_value("journal_segment_size"));
+    if ( !jnl ) {
+        return NULL;
+    }
+
+    journal_set_group_commit(jnl,
+            get_size_config_value("journal_batch_size"),
+            (long) get_size_config_value("journal_batch_window_us"));
+
+    if ( !journal_recover(jnl, get_cstr_config_value("journal_name",
+                                                     default_journal_name),
+                          get_size_config_value("journal_forward_batch")) ) {
+        journal_close(jnl);
+        return NULL;
+    }
+
+    return jnl;
+}
+
+static bool post_journal_file(const char * filename) {
+    journal jnl = open_posting_journal();
+    if ( !jnl ) {
+        return false;
+    }
+
+    size_t num_jes;
+    uint64_t first_seq = 0;
+    struct db_je * jes = db_read_journal_entries(filename, &num_jes);
+    bool status = jes && db_journal_entries_balance(jes, num_jes) &&
+                  db_journal_entries_open(jes, num_jes) &&
+                  journal_append_batch(jnl, jes, num_jes, &first_seq);
+    db_free_journal_entries(jes, num_jes);
+
+    if ( status ) {
+        struct journal_stats stats;
+        journal_get_stats(jnl, &stats);
+        gl_log_msg("Posted %zu journal entries to the journal as "
+                   "%llu to %llu.", num_jes,
+                   (unsigned long long) first_seq,
+                   (unsigned long long) stats.last_seq);
+        status = journal_forward(jnl,
+                    get_cstr_config_value("journal_name",
+                                          default_journal_name),
+                    get_size_config_value("journal_forward_batch"));
+    }
+    else {
+        gl_log_msg("Couldn't post journal entries from '%s'.", filename);
+    }
+
+    journal_close(jnl);
+    return status;
+}
+
+static bool forward_posting_journal(void) {
+    journal jnl = open_posting_journal();
+    if ( !jnl ) {
+        return false;
+    }
+
+    journal_close(jnl);
+    return true;
+}
+
 void print_usage_message(const char * progname) {
     fprintf(stderr, "Usage: %s [options]\n", progname);
 }
@@ -120,9 +367,47 @@ void print_help_message(const char * progname) {
     printf("  --create          Create database structure\n");
     printf("  --delete          Delete database structure\n");
     printf("  --loadsample      Load sample data\n");
+    printf("  --bulkload <table> <file>\n");
+    printf("                    Bulk load <file> into <table>\n");
+    printf("  --rebuild-balances\n");
+    printf("                    Recalculate account balances from JE");
+    printf(" lines\n");
+    printf("  --rebuild-period-balances\n");
+    printf("                    Recalculate period balances from JE");
+    printf(" lines, one\n");
+    printf("                    entity per pooled connection\n");
+    printf("  --rebuild-closure Recalculate the entity closure from the");
+    printf(" entities\n");
+    printf("  --dropindexes     Drop secondary indexes, e.g. before a");
+    printf(" large bulk load\n");
+    printf("  --reindex         Rebuild secondary indexes\n");
+    printf("  --migrate-jelines Rebuild the JE lines table in the");
+    printf(" configured layout\n");
+    printf("  --add-partition <year>\n");
+    printf("                    Add the partition for <year> in the");
+    printf(" partitioned layout\n");
+    printf("  --drop-partition <year>\n");
+    printf("                    Drop the partition for <year> with its");
+    printf(" JEs\n");
+    printf("  --archive-partition <year>\n");
+    printf("                    Move the partition for <year> into");
+    printf(" archive tables\n");
     printf("  --init            Combines --create, --delete, and");
     printf(" --loadsample\n");
     printf("                    in one operation.\n");
+    printf("\nPosting options:\n");
+    printf("  --post <file>     Post journal entries in <file> through");
+    printf(" the journal\n");
+    printf("  --forward         Forward unforwarded journal entries to");
+    printf(" the database\n");
+    printf("  --journal-bench   Benchmark journal postings per second\n");
+    printf("  --posting-bench   Benchmark direct and posting service");
+    printf(" database postings\n");
+    printf("\nClosing options:\n");
+    printf("  --close-period    Close the current period\n");
+    printf("  --close-year      Post closing entries to retained earnings");
+    printf(" and close\n");
+    printf("                    the current year, in its last period\n");
 }
 
 void print_version_message(const char * progname) {
@@ -13,6 +13,8 @@
 #define _XOPEN_SOURCE 500
 
 #include <stdlib.h>
+#include <string.h>
+#include <limits.h>
 #include <assert.h>
 #include <getopt.h>
 #include "gl_reports_config.h"
@@ -20,6 +22,56 @@
 #include "datastruct/data_structures.h"
 #include "gl_general/gl_general.h"
 
+/*!
+ * \brief           Sets a configuration value from a command line option.
+ * \param key       The configuration key.
+ * \param value     The value, or an empty string for an option with no
+ * argument.
+ * \returns         `true` on success, `false` on failure.
+ */
+static bool set_option(const char * key, const char * value);
+
+/*!
+ * \brief           Sets an integer configuration value from a command line
+ * option.
+ * \param key       The configuration key.
+ * \param value     The value.
+ * \param min       The smallest valid value.
+ * \returns         `true` on success, `false` if the value is not an
+ * integer of at least `min`, or on failure.
+ */
+static bool set_int_option(const char * key, const char * value,
+                           const int min);
+
+/*!
+ * \brief           Sets the first and last JEs to show from a JE range.
+ * \details         The range is given as `<first>..<last>`, and is stored
+ * as the JE after which to start and the last JE to show.
+ * \param range     The range.
+ * \returns         `true` on success, `false` if the range is invalid.
+ */
+static bool set_je_range(const char * range);
+
+/*!
+ * \brief           Sets a filter range.
+ * \details         The range is given as `<first>..<last>`, either end of
+ * which may be omitted, or as a single value which is both the first and
+ * the last.
+ * \param range     The range.
+ * \param first_key The configuration key for the first value.
+ * \param last_key  The configuration key for the last value.
+ * \param numeric   `true` if the values must be positive integers.
+ * \returns         `true` on success, `false` if the range is invalid.
+ */
+static bool set_range(const char * range, const char * first_key,
+                      const char * last_key, const bool numeric);
+
+/*!
+ * \brief           Checks whether any report filter options are set.
+ * \returns         `true` if any are set, `false` otherwise.
+ */
+static bool filter_options_set(void);
+
 bool get_cmdline_options(int argc, char **argv, struct params *params) {
     enum opts {
         CMDLINE_HELP = 1,
@@ -33,8 +85,20 @@ bool get_cmdline_options(int argc, char **argv, struct params *params) {
         CMDLINE_SHOWSTANDINGDATA,
         CMDLINE_CURRENTTB,
         CMDLINE_CHECKTOTALS,
+        CMDLINE_CONSOLIDATEDTB,
         CMDLINE_ALLJES,
         CMDLINE_ENTITY,
+        CMDLINE_SUBTREE,
+        CMDLINE_YEAR,
+        CMDLINE_PERIOD,
+        CMDLINE_CACHE_STATS,
+        CMDLINE_PAGE_SIZE,
+        CMDLINE_AFTER_JE,
+        CMDLINE_JE_RANGE,
+        CMDLINE_ACCOUNT,
+        CMDLINE_SOURCE,
+        CMDLINE_COLUMNS,
+        CMDLINE_LIMIT,
     };
 
     /*  Temporarily disable warning  */
@@ -52,8 +116,20 @@ bool get_cmdline_options(int argc, char **argv, struct params *params) {
         {"standingdata", no_argument, NULL, CMDLINE_SHOWSTANDINGDATA},
         {"currenttb", no_argument, NULL, CMDLINE_CURRENTTB},
         {"checktotals", no_argument, NULL, CMDLINE_CHECKTOTALS},
+        {"consolidatedtb", no_argument, NULL, CMDLINE_CONSOLIDATEDTB},
         {"entries", optional_argument, NULL, CMDLINE_ALLJES},
         {"entity", required_argument, NULL, CMDLINE_ENTITY},
+        {"subtree", no_argument, NULL, CMDLINE_SUBTREE},
+        {"year", required_argument, NULL, CMDLINE_YEAR},
+        {"period", required_argument, NULL, CMDLINE_PERIOD},
+        {"cache-stats", no_argument, NULL, CMDLINE_CACHE_STATS},
+        {"page-size", required_argument, NULL, CMDLINE_PAGE_SIZE},
+        {"after-je", required_argument, NULL, CMDLINE_AFTER_JE},
+        {"je-range", required_argument, NULL, CMDLINE_JE_RANGE},
+        {"account", required_argument, NULL, CMDLINE_ACCOUNT},
+        {"source", required_argument, NULL, CMDLINE_SOURCE},
+        {"columns", required_argument, NULL, CMDLINE_COLUMNS},
+        {"limit", required_argument, NULL, CMDLINE_LIMIT},
         {NULL, 0, NULL, 0}
     };
 
@@ -153,6 +229,13 @@ bool get_cmdline_options(int argc, char **argv, struct params *params) {
                 config_value_set(key, value);
                 break;
 
+            case CMDLINE_CONSOLIDATEDTB:
+                if ( !set_option("login", "") ||
+                     !set_option("report", "consolidatedtb") ) {
+                    ret_val = false;
+                }
+                break;
+
             case CMDLINE_ALLJES:
                 assert(ds_str_assign_cstr(key, "login"));
                 config_value_set(key, value);
@@ -186,14 +269,263 @@ bool get_cmdline_options(int argc, char **argv, struct params *params) {
                 }
                 break;
 
+            case CMDLINE_SUBTREE:
+                if ( !set_option("subtree", "") ) {
+                    ret_val = false;
+                }
+                break;
+
+            case CMDLINE_YEAR:
+                if ( !set_int_option("year", optarg, INT_MIN) ) {
+                    gl_log_msg("Invalid year: %s", optarg);
+                    ret_val = false;
+                }
+                break;
+
+            case CMDLINE_PERIOD:
+                if ( !set_range(optarg, "first_period", "last_period",
+                                true) ||
+                     (!strstr(optarg, "..") &&
+                      !set_option("period", optarg)) ) {
+                    gl_log_msg("Invalid period: %s", optarg);
+                    ret_val = false;
+                }
+                break;
+
+            case CMDLINE_ACCOUNT:
+                if ( !set_range(optarg, "first_account", "last_account",
+                                false) ) {
+                    gl_log_msg("Invalid account range: %s", optarg);
+                    ret_val = false;
+                }
+                break;
+
+            case CMDLINE_SOURCE:
+                if ( !set_option("source", optarg) ) {
+                    ret_val = false;
+                }
+                break;
+
+            case CMDLINE_COLUMNS:
+                if ( !set_option("columns", optarg) ) {
+                    ret_val = false;
+                }
+                break;
+
+            case CMDLINE_LIMIT:
+                if ( !set_int_option("limit", optarg, 1) ) {
+                    gl_log_msg("Invalid limit: %s", optarg);
+                    ret_val = false;
+                }
+                break;
+
+            case CMDLINE_CACHE_STATS:
+                if ( !set_option("login", "") ||
+                     !set_option("cache_stats", "") ) {
+                    ret_val = false;
+                }
+                break;
+
+            case CMDLINE_PAGE_SIZE:
+                if ( !set_int_option("page_size", optarg, 1) ) {
+                    gl_log_msg("Invalid page size: %s", optarg);
+                    ret_val = false;
+                }
+                break;
+
+            case CMDLINE_AFTER_JE:
+                if ( !set_int_option("after_je", optarg, 0) ) {
+                    gl_log_msg("Invalid JE number: %s", optarg);
+                    ret_val = false;
+                }
+                break;
+
+            case CMDLINE_JE_RANGE:
+                if ( !set_je_range(optarg) ) {
+                    gl_log_msg("Invalid JE range: %s", optarg);
+                    ret_val = false;
+                }
+                break;
+
             default:
                 ret_val = false;
         }
     }
 
+    if ( ret_val && (config_value_get_cstr("page_size") ||
+                     config_value_get_cstr("after_je") ||
+                     config_value_get_cstr("last_je")) ) {
+        ds_str report = config_value_get_cstr("report");
+        if ( !report || ds_str_compare_cstr(report, "entries") ||
+             config_value_get_cstr("je_num") ) {
+            gl_log_msg("Paging options may only be specified with "
+                       "--entries for all journal entries.");
+            ret_val = false;
+        }
+    }
+
+    if ( ret_val && (config_value_get_cstr("first_period") ||
+                     config_value_get_cstr("last_period")) &&
+         !config_value_get_cstr("year") ) {
+        gl_log_msg("A period may only be specified with a year.");
+        ret_val = false;
+    }
+
+    if ( ret_val && config_value_get_cstr("subtree") &&
+         !config_value_get_cstr("entity") ) {
+        gl_log_msg("--subtree may only be specified with --entity.");
+        ret_val = false;
+    }
+
+    if ( ret_val && filter_options_set() ) {
+        ds_str report = config_value_get_cstr("report");
+        if ( config_value_get_cstr("page_size") ||
+             config_value_get_cstr("after_je") ||
+             config_value_get_cstr("last_je") ||
+             config_value_get_cstr("je_num") ) {
+            gl_log_msg("Filter options may not be specified with a JE "
+                       "number or paging options.");
+            ret_val = false;
+        }
+        else if ( report && !ds_str_compare_cstr(report, "currenttb") &&
+                  config_value_get_cstr("year") ) {
+            gl_log_msg("Only --entity and a single --period may be "
+                       "specified with a trial balance for a year.");
+            ret_val = false;
+        }
+        else if ( !report || (ds_str_compare_cstr(report, "listjes") &&
+                              ds_str_compare_cstr(report, "listjelines") &&
+                              ds_str_compare_cstr(report, "listnomaccts") &&
+                              ds_str_compare_cstr(report, "entries") &&
+                              ds_str_compare_cstr(report, "currenttb")) ) {
+            gl_log_msg("Filter options may only be specified with "
+                       "--listjes, --listjelines, --listnomaccts, "
+                       "--entries or --currenttb.");
+            ret_val = false;
+        }
+    }
+
     ds_str_destroy(key);
     ds_str_destroy(value);
 
     return ret_val;
 }
 
+static bool set_option(const char * key, const char * value) {
+    ds_str k = ds_str_create(key);
+    ds_str v = ds_str_create(value);
+    bool status = k && v;
+    if ( status ) {
+        config_value_set(k, v);
+    }
+    if ( k ) {
+        ds_str_destroy(k);
+    }
+    if ( v ) {
+        ds_str_destroy(v);
+    }
+    return status;
+}
+
+static bool set_int_option(const char * key, const char * value,
+                           const int min) {
+    ds_str v = ds_str_create(value);
+    int n;
+    bool status = v && ds_str_intval(v, 10, &n) && n >= min;
+    if ( v ) {
+        ds_str_destroy(v);
+    }
+    return status && set_option(key, value);
+}
+
+static bool set_je_range(const char * range) {
+    const char * sep = strstr(range, "..");
+    if ( !sep ) {
+        return false;
+    }
+
+    int first, last;
+    ds_str first_str = ds_str_create_sprintf("%.*s", (int) (sep - range),
+                                             range);
+    ds_str last_str = ds_str_create(sep + 2);
+    bool status = ds_str_intval(first_str, 10, &first) &&
+                  ds_str_intval(last_str, 10, &last) &&
+                  first > 0 && last >= first;
+
+    if ( status ) {
+        ds_str key = ds_str_create("after_je");
+        ds_str value = ds_str_create_sprintf("%d", first - 1);
+        status = key && value;
+        if ( status ) {
+            config_value_set(key, value);
+            if ( !ds_str_assign_cstr(key, "last_je") ) {
+                status = false;
+            }
+        }
+        if ( status ) {
+            config_value_set(key, last_str);
+        }
+        if ( key ) {
+            ds_str_destroy(key);
+        }
+        if ( value ) {
+            ds_str_destroy(value);
+        }
+    }
+
+    ds_str_destroy(first_str);
+    ds_str_destroy(last_str);
+    return status;
+}
+
+static bool set_range(const char * range, const char * first_key,
+                      const char * last_key, const bool numeric) {
+    const char * sep = strstr(range, "..");
+    ds_str first = sep ? ds_str_create_sprintf("%.*s", (int) (sep - range),
+                                               range)
+                       : ds_str_create(range);
+    ds_str last = ds_str_create(sep ? sep + 2 : range);
+    bool status = !ds_str_is_empty(first) || !ds_str_is_empty(last);
+
+    ds_str ends[2] = {first, last};
+    for ( size_t i = 0; status && i < 2; ++i ) {
+        int n;
+        if ( numeric && !ds_str_is_empty(ends[i]) &&
+             !(ds_str_intval(ends[i], 10, &n) && n > 0) ) {
+            status = false;
+        }
+    }
+
+    if ( status ) {
+        ds_str key = ds_str_create(first_key);
+        status = key != NULL;
+        if ( status && !ds_str_is_empty(first) ) {
+            config_value_set(key, first);
+        }
+        if ( status && !ds_str_assign_cstr(key, last_key) ) {
+            status = false;
+        }
+        if ( status && !ds_str_is_empty(last) ) {
+            config_value_set(key, last);
+        }
+        if ( key ) {
+            ds_str_destroy(key);
+        }
+    }
+
+    ds_str_destroy(first);
+    ds_str_destroy(last);
+    return status;
+}
+
+static bool filter_options_set(void) {
+    return ((config_value_get_cstr("first_period") ||
+             config_value_get_cstr("last_period")) &&
+            !config_value_get_cstr("period")) ||
+           config_value_get_cstr("first_account") ||
+           config_value_get_cstr("last_account") ||
+           config_value_get_cstr("subtree") ||
+           config_value_get_cstr("source") ||
+           config_value_get_cstr("columns") ||
+           config_value_get_cstr("limit");
+}
@@ -35,6 +35,53 @@ void print_version_message(const char * progname);
  */
 void print_help_message(const char * progname);
 
+/*!  Filterable report structure  */
+struct filtered_report {
+    const char * name;                  /*!<  Report option value       */
+    enum db_filtered_report report;     /*!<  The report                */
+    const char * title;                 /*!<  Report title              */
+};
+
+/*!
+ * \brief           Gets the filter for a report from the options.
+ * \details         A report is filtered if any filter option applies to
+ * it, and is otherwise run as before.
+ * \param name      The report option value.
+ * \param filter    Modified to contain the filter.
+ * \returns         The report to filter, or `NULL` if the report is not
+ * filtered.
+ */
+static const struct filtered_report *
+get_report_filter(ds_str name, struct db_report_filter * filter);
+
+/*!
+ * \brief           Prints query result cache statistics.
+ * \param ran_report    `true` if a report was run, so that the hits and
+ * misses of this run are printed as well as the contents of the cache
+ * directory.
+ */
+static void print_cache_stats(const bool ran_report);
+
+/*!
+ * \brief           Prints the detailed journal entry report a page at a
+ * time.
+ * \details         Each page is printed as soon as it is fetched, so the
+ * report is never held in memory in full.
+ * \param report    The report, with its title set.
+ */
+static void print_paged_entries(ds_report report);
+
+/*!
+ * \brief           Prints one page of a report.
+ * \param page      The page.
+ * \param ctx       The file to which to print.
+ * \returns         `true`, to continue with the next page.
+ */
+static bool print_page(ds_str page, void * ctx);
+
+/*!  Default number of journal entries on each report page  */
+#define DEFAULT_PAGE_SIZE 100
+
 /*!  Program name  */
 static const char * program = "gl_reports";
 
@@ -61,10 +108,30 @@ int main(int argc, char ** argv) {
         print_version_message(program);
     }
     else if ( config_value_get_cstr("login") ) {
-        if ( !get_configuration(params, "conf_files/gl_db_conf.conf") ) {
+        if ( !get_configuration(params, "conf_files/gl_reports_conf.conf") ) {
             gl_log_msg("Couldn't get parameters.");
         }
         else {
+            int pool_size;
+            value = config_value_get_cstr("pool_size");
+            if ( value && ds_str_intval(value, 10, &pool_size) &&
+                 pool_size > 0 ) {
+                db_set_pool_size((size_t) pool_size);
+            }
+
+            value = config_value_get_cstr("report_engine");
+            if ( value && !ds_str_compare_cstr(value, "native") ) {
+                db_ledgerstore_enable(true);
+            }
+
+            value = config_value_get_cstr("query_cache");
+            if ( value && !ds_str_compare_cstr(value, "on") ) {
+                value = config_value_get_cstr("query_cache_dir");
+                db_querycache_enable(true,
+                        value && !ds_str_is_empty(value) ?
+                        ds_str_cstr(value) : NULL);
+            }
+
             params->password = login();
             if ( params->password ) {
                 db_connect(ds_str_cstr(params->hostname),
@@ -76,8 +143,28 @@ int main(int argc, char ** argv) {
                     ds_report report = ds_report_create();
                     assert(report);
                     bool no_report = false;
+                    bool printed = false;
+                    struct db_report_filter filter;
+                    const struct filtered_report * filtered =
+                        get_report_filter(value, &filter);
+
+                    if ( filtered ) {
+                        ds_report_set_report_text(report,
+                            db_filtered_report(filtered->report, &filter));
+                        ds_report_set_title(report,
+                            ds_str_create(filtered->title));
 
-                    if ( !ds_str_compare_cstr(value, "listusers") ) {
+                        if ( filtered->report == DB_REPORT_CURRENT_TB ) {
+                            ds_str h_name = ds_str_create("Entity");
+                            ds_str h_value = filter.entity ?
+                                db_get_entity_name_from_id(filter.entity) :
+                                ds_str_create("All entities");
+                            ds_report_add_header(report, h_name, h_value);
+                            ds_str_destroy(h_name);
+                            ds_str_destroy(h_value);
+                        }
+                    }
+                    else if ( !ds_str_compare_cstr(value, "listusers") ) {
                         ds_report_set_report_text(report,
                                                   db_list_users_report());
                         ds_report_set_title(report,
@@ -119,24 +206,61 @@ int main(int argc, char ** argv) {
                         ds_report_set_title(report,
                             ds_str_create("Standing Data Report"));
                     }
+                    else if ( !ds_str_compare_cstr(value, "currenttb") &&
+                              config_value_get_cstr("year") ) {
+                        ds_str entity = config_value_get_cstr("entity");
+                        ds_str year = config_value_get_cstr("year");
+                        ds_str period = config_value_get_cstr("period");
+                        ds_report_set_report_text(report,
+                            db_period_trial_balance_report(entity, year,
+                                                           period));
+                        ds_report_set_title(report,
+                            ds_str_create("Trial Balance"));
+
+                        ds_str h_name = ds_str_create("Entity");
+                        ds_str h_value = entity ?
+                            db_get_entity_name_from_id(entity) :
+                            ds_str_create("All entities");
+                        ds_report_add_header(report, h_name, h_value);
+                        ds_str_destroy(h_value);
+
+                        ds_str_assign_cstr(h_name, "As at");
+                        h_value = period ?
+                            ds_str_create_sprintf("Period %s, %s",
+                                                  ds_str_cstr(period),
+                                                  ds_str_cstr(year)) :
+                            ds_str_create_sprintf("End of %s",
+                                                  ds_str_cstr(year));
+                        ds_report_add_header(report, h_name, h_value);
+                        ds_str_destroy(h_name);
+                        ds_str_destroy(h_value);
+                    }
                     else if ( !ds_str_compare_cstr(value, "currenttb") ) {
                         ds_str entity = config_value_get_cstr("entity");
+                        ds_str h_value;
                         ds_report_set_report_text(report,
-                                      db_current_trial_balance_report(entity));
+                            db_current_trial_balance_report_with_name(entity,
+                                                                &h_value));
                         ds_report_set_title(report,
                             ds_str_create("Current Trial Balance"));
 
                         ds_str h_name = ds_str_create("Entity");
-                        ds_str h_value = db_get_entity_name_from_id(entity);
-                        /*
-                        if ( entity ) {
-                            h_value = ds_str_create_sprintf("[%s]",
-                                    ds_str_cstr(entity));
-                        }
-                        else {
-                            h_value = ds_str_create("All entities");
-                        }
-                        */
+                        ds_report_add_header(report, h_name, h_value);
+                        ds_str_destroy(h_name);
+                        ds_str_destroy(h_value);
+                    }
+                    else if ( !ds_str_compare_cstr(value,
+                                                   "consolidatedtb") ) {
+                        ds_str entity = config_value_get_cstr("entity");
+                        ds_report_set_report_text(report,
+                            db_consolidated_trial_balance_report(entity));
+                        ds_report_set_title(report,
+                            ds_str_create("Consolidated Trial Balance"));
+
+                        ds_str h_name = ds_str_create("Entity");
+                        ds_str h_value = entity ?
+                            db_get_entity_name_from_id(entity) :
+                            ds_str_create("All top-level entities");
                         ds_report_add_header(report, h_name, h_value);
                         ds_str_destroy(h_name);
                         ds_str_destroy(h_value);
@@ -148,6 +272,15 @@ int main(int argc, char ** argv) {
                         ds_report_set_title(report,
                             ds_str_create("Double Entry Check Total Report"));
                     }
+                    else if ( !ds_str_compare_cstr(value, "entries") &&
+                              (config_value_get_cstr("page_size") ||
+                               config_value_get_cstr("after_je") ||
+                               config_value_get_cstr("last_je")) ) {
+                        ds_report_set_title(report,
+                            ds_str_create("Detailed Journal Entry Report"));
+                        print_paged_entries(report);
+                        printed = true;
+                    }
                     else if ( !ds_str_compare_cstr(value, "entries") ) {
                         ds_str je_num = config_value_get_cstr("je_num");
                         ds_report_set_report_text(report,
@@ -160,17 +293,29 @@ int main(int argc, char ** argv) {
                     }
 
                     if ( !no_report ) {
-                        ds_report_print_text_report(report, stdout);
+                        if ( !printed ) {
+                            ds_report_print_text_report(report, stdout);
+                        }
                         ds_report_destroy(report);
                     }
                     else {
                         gl_log_msg("Unrecognized report.");
                     }
                 }
-                else {
+                else if ( !config_value_get_cstr("cache_stats") ) {
                     gl_log_msg("No supported option provided.");
                 }
 
+                if ( config_value_get_cstr("cache_stats") ) {
+                    print_cache_stats(config_value_get_cstr("report") !=
+                                      NULL);
+                }
+
+                db_consolidation_free();
+                db_closure_free();
+                db_dimcache_free();
+                db_querycache_free();
+                db_ledgerstore_free();
                 db_close();
             }
             else {
@@ -189,6 +334,156 @@ int main(int argc, char ** argv) {
     return EXIT_SUCCESS;
 }
 
+static const struct filtered_report *
+get_report_filter(ds_str name, struct db_report_filter * filter) {
+    static const struct filtered_report reports[] = {
+        {"listjes", DB_REPORT_LIST_JES, "Journal Entries Report"},
+        {"listjelines", DB_REPORT_LIST_JELINES,
+         "Journal Entry Lines Report"},
+        {"listnomaccts", DB_REPORT_LIST_NOMACCTS, "Nominal Accounts List"},
+        {"entries", DB_REPORT_ALL_JES, "Detailed Journal Entry Report"},
+        {"currenttb", DB_REPORT_CURRENT_TB, "Current Trial Balance"}
+    };
+
+    const struct filtered_report * found = NULL;
+    for ( size_t i = 0; !found && i < sizeof reports / sizeof *reports;
+          ++i ) {
+        if ( !ds_str_compare_cstr(name, reports[i].name) ) {
+            found = &reports[i];
+        }
+    }
+
+    /*  JE numbers and paging have their own reports, and the trial
+     *  balance for a year is a period trial balance.                   */
+
+    if ( !found || config_value_get_cstr("je_num") ||
+         config_value_get_cstr("page_size") ||
+         config_value_get_cstr("after_je") ||
+         config_value_get_cstr("last_je") ||
+         (found->report == DB_REPORT_CURRENT_TB &&
+          config_value_get_cstr("year")) ) {
+        return NULL;
+    }
+
+    ds_str value;
+    int ivalue;
+    memset(filter, 0, sizeof *filter);
+
+    filter->entity = config_value_get_cstr("entity");
+    filter->subtree = config_value_get_cstr("subtree") != NULL;
+    if ( (value = config_value_get_cstr("year")) ) {
+        ds_str_intval(value, 10, &filter->year);
+    }
+    if ( (value = config_value_get_cstr("first_period")) ) {
+        ds_str_intval(value, 10, &filter->first_period);
+    }
+    if ( (value = config_value_get_cstr("last_period")) ) {
+        ds_str_intval(value, 10, &filter->last_period);
+    }
+    if ( (value = config_value_get_cstr("first_account")) ) {
+        filter->first_account = ds_str_cstr(value);
+    }
+    if ( (value = config_value_get_cstr("last_account")) ) {
+        filter->last_account = ds_str_cstr(value);
+    }
+    if ( (value = config_value_get_cstr("source")) ) {
+        filter->source = ds_str_cstr(value);
+    }
+    if ( (value = config_value_get_cstr("columns")) ) {
+        filter->columns = ds_str_cstr(value);
+    }
+    if ( (value = config_value_get_cstr("limit")) &&
+         ds_str_intval(value, 10, &ivalue) ) {
+        filter->limit = (size_t) ivalue;
+    }
+
+    /*  The unfiltered trial balance already takes an entity.  */
+
+    const bool takes_entity = found->report == DB_REPORT_CURRENT_TB;
+
+    if ( (filter->entity && !takes_entity) || filter->subtree ||
+         filter->year || filter->first_period || filter->last_period ||
+         filter->first_account || filter->last_account ||
+         filter->source || filter->columns || filter->limit ) {
+        return found;
+    }
+    return NULL;
+}
+
+static void print_cache_stats(const bool ran_report) {
+    ds_str value = config_value_get_cstr("query_cache");
+    if ( !value || ds_str_compare_cstr(value, "on") ) {
+        gl_log_msg("The query cache is not enabled.");
+        return;
+    }
+
+    if ( ran_report ) {
+        struct db_querycache_stats stats;
+        db_querycache_get_stats(&stats);
+        gl_log_msg("Query cache: %llu memory hits, %llu disk hits, "
+                   "%llu misses, %llu invalidations.",
+                   (unsigned long long) stats.memory_hits,
+                   (unsigned long long) stats.disk_hits,
+                   (unsigned long long) stats.misses,
+                   (unsigned long long) stats.invalidations);
+    }
+
+    struct db_querycache_dir_stats dir_stats;
+    if ( db_querycache_get_dir_stats(&dir_stats) ) {
+        gl_log_msg("Query cache directory: %llu results, %llu current, "
+                   "%llu bytes.",
+                   (unsigned long long) dir_stats.results,
+                   (unsigned long long) dir_stats.current,
+                   (unsigned long long) dir_stats.bytes);
+    }
+    else if ( !ran_report ) {
+        gl_log_msg("The query cache has no directory.");
+    }
+}
+
+static void print_paged_entries(ds_report report) {
+    int page_size = DEFAULT_PAGE_SIZE;
+    int after_je = 0;
+    int last_je = 0;
+    ds_str value;
+
+    if ( (value = config_value_get_cstr("page_size")) ) {
+        ds_str_intval(value, 10, &page_size);
+    }
+    if ( (value = config_value_get_cstr("after_je")) ) {
+        ds_str_intval(value, 10, &after_je);
+    }
+    if ( (value = config_value_get_cstr("last_je")) ) {
+        ds_str_intval(value, 10, &last_je);
+    }
+
+    ds_str h_name = ds_str_create("Journal entries");
+    ds_str h_value = last_je ?
+        ds_str_create_sprintf("%d to %d", after_je + 1, last_je) :
+        ds_str_create_sprintf("From %d", after_je + 1);
+    ds_report_add_header(report, h_name, h_value);
+    ds_str_destroy(h_value);
+
+    ds_str_assign_cstr(h_name, "Page size");
+    h_value = ds_str_create_sprintf("%d journal entries", page_size);
+    ds_report_add_header(report, h_name, h_value);
+    ds_str_destroy(h_name);
+    ds_str_destroy(h_value);
+
+    ds_report_print_text_header(report, stdout);
+    if ( !db_all_jes_report_paged((uint64_t) after_je, (uint64_t) last_je,
+                                  (size_t) page_size, print_page, stdout) ) {
+        gl_log_msg("Couldn't create the report.");
+    }
+    ds_report_print_text_footer(report, stdout);
+}
+
+static bool print_page(ds_str page, void * ctx) {
+    fputs(ds_str_cstr(page), ctx);
+    fflush(ctx);
+    return true;
+}
+
 void print_usage_message(const char * progname) {
     fprintf(stderr, "Usage: %s [options]\n", progname);
 }
@@ -207,12 +502,42 @@ void print_help_message(const char * progname) {
     printf("  --listjelines         Show a list of journal entry lines\n");
     printf("  --listjesrcs          Show a list of journal entry sources\n");
     printf("  --standingdata        Show the standing data\n");
+    printf("  --year <year>         Specifies a year\n");
+    printf("  --period <period>     Specifies a period within <year>\n");
+    printf("  --period <a>..<b>     Specifies periods <a> to <b> within");
+    printf(" <year>\n");
     printf("  --currenttb           Show a current trial balance\n");
-    printf("                               (optionally for <entity>)\n");
+    printf("                               (optionally for <entity>, and");
+    printf(" as at\n");
+    printf("                               the end of <year> or");
+    printf(" <period>)\n");
+    printf("  --consolidatedtb      Show a consolidated trial balance\n");
+    printf("                               (optionally for <entity> and");
+    printf(" the entities\n");
+    printf("                               below it)\n");
     printf("  --checktotal          Show double entry check totals\n");
     printf("                               (optionally for <entity>)\n");
     printf("  --entries[=<je_num>]  Show detailed journal entries\n");
     printf("                               (optionally for <je_num> only)\n");
+    printf("  --page-size=<n>       Show --entries <n> journal entries at a");
+    printf(" time (default %d)\n", DEFAULT_PAGE_SIZE);
+    printf("  --after-je=<je_num>   Show --entries after <je_num>, a page at");
+    printf(" a time\n");
+    printf("  --je-range=<a>..<b>   Show --entries <a> to <b>, a page at a");
+    printf(" time\n");
+    printf("\nFilter options, for --listjes, --listjelines,");
+    printf(" --listnomaccts,\n--entries and --currenttb:\n");
+    printf("  --account=<a>..<b>    Show accounts <a> to <b> only, either");
+    printf(" end optional\n");
+    printf("  --source=<source>     Show journal entries from <source>");
+    printf(" only\n");
+    printf("  --columns=<c>,...     Show the named columns only\n");
+    printf("  --limit=<n>           Show the first <n> rows only\n");
+    printf("  --subtree             Include the entities below --entity\n");
+    printf("  --entity, --year and --period also filter these reports\n");
+    printf("\nOther options:\n");
+    printf("  --cache-stats         Show query cache statistics after the");
+    printf(" report\n");
 }
 
 void print_version_message(const char * progname) {